@@ -22,15 +22,13 @@
 #include <QDateTime>
 #include <QDebug>
 #include <qmath.h>
+#include <string.h>
 
 #include "audiocapture.h"
 #include "beattracker.h"
 
-#define USE_HANNING
 #define CLEAR_FFT_NOISE
 
-#define M_2PI       6.28318530718           /* 2*pi */
-
 AudioCapture::AudioCapture (QObject* parent)
     : QThread (parent)
     , m_userStop(true)
@@ -38,14 +36,16 @@ AudioCapture::AudioCapture (QObject* parent)
     , m_captureSize(0)
     , m_sampleRate(0)
     , m_channels(0)
+    , m_hopSize(0)
     , m_audioBuffer(NULL)
-    , m_audioMixdown(NULL)
     , m_fftInputBuffer(NULL)
     , m_fftOutputBuffer(NULL)
+    , m_busConsumers(0)
 {
     m_bufferSize = AUDIO_DEFAULT_BUFFER_SIZE;
     m_sampleRate = AUDIO_DEFAULT_SAMPLE_RATE;
     m_channels = AUDIO_DEFAULT_CHANNELS;
+    m_hopSize = AUDIO_DEFAULT_HOP_SIZE;
 
     QSettings settings;
     QVariant var = settings.value(SETTINGS_AUDIO_INPUT_SRATE);
@@ -58,12 +58,23 @@ AudioCapture::AudioCapture (QObject* parent)
     if (var.isValid() == true)
         m_channels = var.toInt();
 
-    qDebug() << "[AudioCapture] initialize" << m_sampleRate << m_channels;
+    var = settings.value(SETTINGS_AUDIO_INPUT_HOP_SIZE);
+
+    if (var.isValid() == true)
+        m_hopSize = qBound(64u, var.toUInt(), m_bufferSize);
+
+    var = settings.value(SETTINGS_AUDIO_INPUT_WINDOW);
 
-    m_captureSize = m_bufferSize * m_channels;
+    if (var.isValid() == true)
+        m_preprocessor.setWindowType(AudioPreprocessor::stringToWindowType(var.toString()));
+
+    qDebug() << "[AudioCapture] initialize" << m_sampleRate << m_channels << "hop size" << m_hopSize;
+
+    // only the new samples are read before each analysis
+    m_captureSize = m_hopSize * m_channels;
 
     m_audioBuffer = new int16_t[m_captureSize];
-    m_audioMixdown = new int16_t[m_bufferSize];
+    m_preprocessor.setFormat(m_bufferSize, m_channels, m_hopSize);
     m_fftInputBuffer = new double[m_bufferSize];
 #ifdef HAS_FFTW3
     m_fftOutputBuffer = fftw_malloc(sizeof(fftw_complex) * m_bufferSize);
@@ -72,7 +83,9 @@ AudioCapture::AudioCapture (QObject* parent)
     m_plan_forward = fftw_plan_dft_r2c_1d(m_bufferSize, m_fftInputBuffer,
                                           reinterpret_cast<fftw_complex*>(m_fftOutputBuffer), 0);
 #endif
-    m_beatTracker = new BeatTracker(m_sampleRate, m_bufferSize, m_channels, 86, 1.3);
+    // mono frames come from the preprocessor, every hop. Keep ~4s of history
+    m_beatTracker = new BeatTracker(m_sampleRate, m_bufferSize, 1, (86 * m_bufferSize) / m_hopSize, 1.3);
+    m_beatTracker->setHopSize(m_hopSize);
     m_beatTracker->setBand(40.0, 400.0);      // bit wider band for now
     m_beatTracker->setFluxSmoothing(0.6);     // less smoothing
     m_beatTracker->setMinBeatInterval(0.20);  // ~300 BPM max
@@ -84,7 +97,6 @@ AudioCapture::~AudioCapture()
     Q_ASSERT(!this->isRunning());
 
     delete[] m_audioBuffer;
-    delete[] m_audioMixdown;
     delete[] m_fftInputBuffer;
 #ifdef HAS_FFTW3
     fftw_destroy_plan(m_plan_forward);
@@ -105,7 +117,7 @@ void AudioCapture::registerBandsNumber(int number)
 
     QMutexLocker locker(&m_mutex);
 
-    bool firstBand = m_fftMagnitudeMap.isEmpty();
+    bool firstBand = m_fftMagnitudeMap.isEmpty() && m_busConsumers == 0;
     if (number > 0 && number <= FREQ_SUBBANDS_MAX_NUMBER)
     {
         if (m_fftMagnitudeMap.contains(number) == false)
@@ -138,7 +150,7 @@ void AudioCapture::unregisterBandsNumber(int number)
         if (m_fftMagnitudeMap[number].m_registerCounter == 0)
             m_fftMagnitudeMap.remove(number);
 
-        if (m_fftMagnitudeMap.isEmpty())
+        if (m_fftMagnitudeMap.isEmpty() && m_busConsumers == 0)
         {
             locker.unlock();
             stop();
@@ -146,84 +158,96 @@ void AudioCapture::unregisterBandsNumber(int number)
     }
 }
 
-void AudioCapture::stop()
+void AudioCapture::registerBusConsumer()
 {
-    qDebug() << "[AudioCapture] stop capture";
-    while (this->isRunning())
+    qDebug() << "[AudioCapture] registering a bus consumer";
+
+    QMutexLocker locker(&m_mutex);
+
+    bool first = m_fftMagnitudeMap.isEmpty() && m_busConsumers == 0;
+    m_busConsumers++;
+
+    if (first)
     {
-        m_userStop = true;
-        usleep(10000);
+        locker.unlock();
+        start();
     }
 }
 
-double AudioCapture::fillBandsData(int number)
+void AudioCapture::unregisterBusConsumer()
 {
-    // m_fftOutputBuffer contains the real and imaginary data of a spectrum
-    // representing all the frequencies from 0 to m_sampleRate Hz.
-    // I will just consider 0 to 5000Hz and will calculate average magnitude
-    // for the number of desired bands.
-    double maxMagnitude = 0.;
-#ifdef HAS_FFTW3
-    unsigned int i = 1; // skip DC bin
-    int subBandWidth = ((m_bufferSize * SPECTRUM_MAX_FREQUENCY) / m_sampleRate) / number;
+    qDebug() << "[AudioCapture] unregistering a bus consumer";
+
+    QMutexLocker locker(&m_mutex);
 
-    for (int b = 0; b < number; b++)
+    if (m_busConsumers == 0)
+        return;
+
+    m_busConsumers--;
+
+    if (m_fftMagnitudeMap.isEmpty() && m_busConsumers == 0)
     {
-        double magnitudeSum = 0.;
-        for (int s = 0; s < subBandWidth; s++, i++)
-        {
-            if (i == m_bufferSize)
-                break;
-            magnitudeSum += qSqrt((((fftw_complex*)m_fftOutputBuffer)[i][0] * ((fftw_complex*)m_fftOutputBuffer)[i][0]) +
-                                  (((fftw_complex*)m_fftOutputBuffer)[i][1] * ((fftw_complex*)m_fftOutputBuffer)[i][1]));
-        }
-        double bandMagnitude = (magnitudeSum / (subBandWidth * M_2PI));
-        m_fftMagnitudeMap[number].m_fftMagnitudeBuffer[b] = bandMagnitude;
-        if (maxMagnitude < bandMagnitude)
-            maxMagnitude = bandMagnitude;
+        locker.unlock();
+        stop();
     }
-#else
-    Q_UNUSED(number)
-#endif
-    return maxMagnitude;
 }
 
-void AudioCapture::processData()
+const AudioSpectrumBus *AudioCapture::spectrumBus() const
 {
-    unsigned int i, j;
-    double pwrSum = 0.;
-    double maxMagnitude = 0.;
+    return &m_spectrumBus;
+}
 
-    // 2) Mix down to mono (int16 -> int16)
-    for (i = 0; i < m_bufferSize; i++)
-    {
-        m_audioMixdown[i] = 0;
-        for (j = 0; j < m_channels; j++)
-            m_audioMixdown[i] += m_audioBuffer[i*m_channels + j] / m_channels;
-    }
+AudioPreprocessor::WindowType AudioCapture::windowType() const
+{
+    return m_preprocessor.windowType();
+}
 
-    // 2a) DC removal + RMS (silence gate)
-    // Compute mean (DC)
-    long long acc = 0;
-    for (i = 0; i < m_bufferSize; ++i)
-        acc += m_audioMixdown[i];
-    const double mean = double(acc) / double(m_bufferSize);
+int AudioCapture::hopSize() const
+{
+    return m_hopSize;
+}
 
-    // Remove DC, compute RMS in one pass (normalize to [-1,1])
-    double sumSq = 0.0;
-    for (i = 0; i < m_bufferSize; ++i)
+void AudioCapture::stop()
+{
+    qDebug() << "[AudioCapture] stop capture";
+    while (this->isRunning())
     {
-        const double x = (double(m_audioMixdown[i]) - mean) / 32768.0;
-        sumSq += x * x;
-        m_fftInputBuffer[i] = x; // will be windowed right below
+        m_userStop = true;
+        usleep(10000);
     }
-    const double rms = qSqrt(sumSq / double(m_bufferSize));
+}
+
+double AudioCapture::fillBandsData(const AudioSpectrumFrame &frame, int number)
+{
+    // The frame contains the magnitudes of the frequencies from 0 to 5000Hz.
+    // Calculate the average magnitude for the number of desired bands.
+    return AudioSpectrumBus::bands(frame, number, m_fftMagnitudeMap[number].m_fftMagnitudeBuffer.data());
+}
+
+void AudioCapture::processData(AudioSpectrumFrame *frame)
+{
+    double maxMagnitude = 0.;
+
+    // 1) DC removal, RMS (silence gate) and window of the
+    // last m_bufferSize samples, mixed down when captured
+    const double rms = m_preprocessor.process(m_fftInputBuffer);
+
+    frame->timestamp = QDateTime::currentMSecsSinceEpoch();
+    frame->rms = rms;
+    frame->beat = false;
+    frame->binsCount = qMin(int((m_bufferSize * SPECTRUM_MAX_FREQUENCY) / m_sampleRate),
+                            qMin(int(m_bufferSize) - 1, AUDIO_SPECTRUM_MAX_BINS));
+#ifndef HAS_FFTW3
+    frame->binsCount = 0;
+#endif
 
     // If the frame is effectively silent, emit zeros and bail early.
     // Threshold is tunable; ~0.002 ≈ -54 dBFS works well for typical PC inputs.
     static constexpr double kSilenceRms = 0.002;
     if (rms < kSilenceRms)
     {
+        memset(frame->magnitudes, 0, frame->binsCount * sizeof(double));
+
         double maxMagnitude = 0.0;
         quint32 power = 0;
         for (int barsNumber : m_fftMagnitudeMap.keys())
@@ -239,28 +263,11 @@ void AudioCapture::processData()
         return;
     }
 
-    // 2b) Apply window to doubles already placed in m_fftInputBuffer
-#ifdef USE_BLACKMAN
-    const double a0 = (1-0.16)/2, a1 = 0.5, a2 = 0.16/2;
-    for (i = 0; i < bufferSize; i++)
-        m_fftInputBuffer[i] = m_fftInputBuffer[i] *
-                              (a0 - a1 * qCos((M_2PI * i) / (bufferSize - 1)) +
-                               a2 * qCos((2 * M_2PI * i) / (bufferSize - 1)));
-#endif
-#ifdef USE_HANNING
-    for (i = 0; i < m_bufferSize; i++)
-        m_fftInputBuffer[i] = m_fftInputBuffer[i] *
-                              (0.5 * (1.0 - qCos((M_2PI * i) / (m_bufferSize - 1))));
-#endif
-#ifdef USE_NO_WINDOW
-    // already filled: keep as-is
-#endif
-
 #ifdef HAS_FFTW3
-    // 3) FFT
+    // 2) FFT
     fftw_execute(m_plan_forward);
 
-    // 4) Clear low-bin FFT noise
+    // 3) Clear low-bin FFT noise
 #ifdef CLEAR_FFT_NOISE
     for (int n = 0; n < 5; n++)
     {
@@ -268,17 +275,21 @@ void AudioCapture::processData()
         ((fftw_complex*)m_fftOutputBuffer)[n][1] = 0;
     }
 #endif
+
+    // 3a) Keep the magnitudes up to the max frequency, skipping the DC bin
+    for (int n = 0; n < frame->binsCount; n++)
+    {
+        const fftw_complex &bin = ((fftw_complex*)m_fftOutputBuffer)[n + 1];
+        frame->magnitudes[n] = qSqrt((bin[0] * bin[0]) + (bin[1] * bin[1]));
+    }
 #endif
 
-    // 5) Fill per-band magnitudes and compute power
+    // 4) Fill per-band magnitudes and compute power
     for (int barsNumber : m_fftMagnitudeMap.keys())
     {
-        maxMagnitude = fillBandsData(barsNumber); // fills & returns max per-band
-        pwrSum = 0.;
-        for (int n = 0; n < barsNumber; n++)
-            pwrSum += m_fftMagnitudeMap[barsNumber].m_fftMagnitudeBuffer[n];
-
-        m_signalPower = 32768 * pwrSum * qSqrt(M_2PI) / (double)barsNumber;
+        maxMagnitude = fillBandsData(*frame, barsNumber); // fills & returns max per-band
+        m_signalPower = AudioSpectrumBus::power(m_fftMagnitudeMap[barsNumber].m_fftMagnitudeBuffer.constData(),
+                                                barsNumber);
         emit dataProcessed(m_fftMagnitudeMap[barsNumber].m_fftMagnitudeBuffer.data(),
                            m_fftMagnitudeMap[barsNumber].m_fftMagnitudeBuffer.size(),
                            maxMagnitude, m_signalPower);
@@ -298,6 +309,9 @@ void AudioCapture::run()
         return;
     }
 
+    // start from silence, with the channels actually opened
+    m_preprocessor.setFormat(m_bufferSize, m_channels, m_hopSize);
+
     while (!m_userStop)
     {
         if (m_pause == false && m_captureSize != 0)
@@ -305,9 +319,15 @@ void AudioCapture::run()
             if (readAudio(m_captureSize) == true)
             {
                 QMutexLocker locker(&m_mutex);
-                processData();
+                m_preprocessor.push(m_audioBuffer, m_hopSize);
+
+                AudioSpectrumFrame *frame = m_spectrumBus.beginWrite();
+                processData(frame);
+
+                frame->beat = m_beatTracker->processFrame(m_preprocessor.samples(), m_bufferSize, m_hopSize);
+                m_spectrumBus.endWrite();
 
-                if (m_beatTracker->processAudio(m_audioBuffer, m_captureSize))
+                if (frame->beat)
                     emit beatDetected();
             }
             else
@@ -31,13 +31,19 @@
 #include "fftw3.h"
 #endif
 
+#include "audiospectrumbus.h"
+#include "audiopreprocessor.h"
+
 #define SETTINGS_AUDIO_INPUT_DEVICE   "audio/input"
 #define SETTINGS_AUDIO_INPUT_SRATE    "audio/samplerate"
 #define SETTINGS_AUDIO_INPUT_CHANNELS "audio/channels"
+#define SETTINGS_AUDIO_INPUT_WINDOW   "audio/window"
+#define SETTINGS_AUDIO_INPUT_HOP_SIZE "audio/hopsize"
 
 #define AUDIO_DEFAULT_SAMPLE_RATE     44100
 #define AUDIO_DEFAULT_CHANNELS        1
 #define AUDIO_DEFAULT_BUFFER_SIZE     2048 // bytes per channel
+#define AUDIO_DEFAULT_HOP_SIZE        1024 // frames captured between two analyses
 
 #define FREQ_SUBBANDS_MAX_NUMBER        32
 #define FREQ_SUBBANDS_DEFAULT_NUMBER    16
@@ -81,8 +87,28 @@ public:
     void unregisterBandsNumber(int number);
     //int bandsNumber();
 
+    /**
+     * Request the analysis frames published on the spectrum bus,
+     * without any dataProcessed() signal. Capture runs as long as
+     * there are bands or bus consumers registered
+     */
+    void registerBusConsumer();
+
+    /** Cancel a previous request of the spectrum bus */
+    void unregisterBusConsumer();
+
+    /** Get the bus where the analysis of each captured block is published */
+    const AudioSpectrumBus *spectrumBus() const;
+
     static int maxFrequency() { return SPECTRUM_MAX_FREQUENCY; }
 
+    /** Get the window applied to the audio before the FFT */
+    AudioPreprocessor::WindowType windowType() const;
+
+    /** Get the number of frames captured between two analyses.
+     *  When smaller than the FFT size, analysis frames overlap */
+    int hopSize() const;
+
     /*!
      *  Adjusts the audio output volume
      */
@@ -134,14 +160,14 @@ protected:
     virtual bool readAudio(int maxSize) = 0;
 
     /** This is called at every processData to fill a single BandsData structure */
-    double fillBandsData(int number);
+    double fillBandsData(const AudioSpectrumFrame &frame, int number);
 
-    /** This is the method where captured audio data is processed in this order
+    /** This is the method where the analysis frame is processed in this order
      *  1) calculates the signal power, which will be the volume bar
-     *  2) perform the FFT
+     *  2) perform the FFT and store its magnitudes in $frame
      *  3) retrieve the signal magnitude for each registered number of bands
      */
-    void processData();
+    void processData(AudioSpectrumFrame *frame);
 
 signals:
     void dataProcessed(double *spectrumBands, int size, double maxMagnitude, quint32 power);
@@ -152,11 +178,16 @@ protected:
     QMutex m_mutex;
 
     bool m_userStop, m_pause;
+    /** m_bufferSize is the FFT size, m_captureSize the number of
+     *  samples read from the sound card for each analysis */
     unsigned int m_bufferSize, m_captureSize, m_sampleRate, m_channels;
+    unsigned int m_hopSize;
 
     /** Data buffer for audio data coming from the sound card */
     int16_t *m_audioBuffer;
-    int16_t *m_audioMixdown;
+
+    /** Mixdown, DC removal and window of the captured audio */
+    AudioPreprocessor m_preprocessor;
 
     quint32 m_signalPower;
 
@@ -170,6 +201,11 @@ protected:
     /** Map of the registered clients (key is the number of bands) */
     QMap <int, BandsData> m_fftMagnitudeMap;
 
+    /** Number of clients reading the spectrum bus */
+    int m_busConsumers;
+
+    AudioSpectrumBus m_spectrumBus;
+
     /** Reference to the beat tracking processor */
     BeatTracker *m_beatTracker;
 };
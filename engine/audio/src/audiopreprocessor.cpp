@@ -0,0 +1,266 @@
+/*
+  Q Light Controller Plus
+  audiopreprocessor.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QDebug>
+#include <qmath.h>
+#include <string.h>
+
+#include "audiopreprocessor.h"
+
+#define M_2PI       6.28318530718           /* 2*pi */
+
+#define KXMLQLCWindowRectangular    QStringLiteral("Rectangular")
+#define KXMLQLCWindowHann           QStringLiteral("Hann")
+#define KXMLQLCWindowHamming        QStringLiteral("Hamming")
+#define KXMLQLCWindowBlackman       QStringLiteral("Blackman")
+
+/* Number of independent accumulators used by the reductions. Summing
+ * into a single variable is a dependency chain that the compiler can't
+ * split across SIMD lanes without relaxing the floating point rules */
+#define ACCUMULATORS    4
+
+AudioPreprocessor::AudioPreprocessor()
+    : m_frameSize(0)
+    , m_channels(1)
+    , m_hopSize(0)
+    , m_windowType(HannWindow)
+{
+}
+
+AudioPreprocessor::~AudioPreprocessor()
+{
+}
+
+/*********************************************************************
+ * Format
+ *********************************************************************/
+
+void AudioPreprocessor::setFormat(int frameSize, int channels, int hopSize)
+{
+    m_frameSize = qMax(1, frameSize);
+    m_channels = qMax(1, channels);
+    m_hopSize = qBound(1, hopSize, m_frameSize);
+
+    m_samples.fill(0.0, m_frameSize);
+    updateWindow();
+
+    qDebug() << "[AudioPreprocessor] frame size" << m_frameSize << "channels" << m_channels
+             << "hop size" << m_hopSize << "window" << windowTypeToString(m_windowType);
+}
+
+int AudioPreprocessor::frameSize() const
+{
+    return m_frameSize;
+}
+
+int AudioPreprocessor::channels() const
+{
+    return m_channels;
+}
+
+int AudioPreprocessor::hopSize() const
+{
+    return m_hopSize;
+}
+
+/*********************************************************************
+ * Window
+ *********************************************************************/
+
+void AudioPreprocessor::setWindowType(AudioPreprocessor::WindowType type)
+{
+    if (type == m_windowType)
+        return;
+
+    m_windowType = type;
+    updateWindow();
+}
+
+AudioPreprocessor::WindowType AudioPreprocessor::windowType() const
+{
+    return m_windowType;
+}
+
+QString AudioPreprocessor::windowTypeToString(AudioPreprocessor::WindowType type)
+{
+    switch (type)
+    {
+        case RectangularWindow:
+            return KXMLQLCWindowRectangular;
+        case HammingWindow:
+            return KXMLQLCWindowHamming;
+        case BlackmanWindow:
+            return KXMLQLCWindowBlackman;
+        default:
+        case HannWindow:
+            return KXMLQLCWindowHann;
+    }
+}
+
+AudioPreprocessor::WindowType AudioPreprocessor::stringToWindowType(const QString &str)
+{
+    if (str == KXMLQLCWindowRectangular)
+        return RectangularWindow;
+    else if (str == KXMLQLCWindowHamming)
+        return HammingWindow;
+    else if (str == KXMLQLCWindowBlackman)
+        return BlackmanWindow;
+    else
+        return HannWindow;
+}
+
+QStringList AudioPreprocessor::windowTypes()
+{
+    QStringList list;
+    list << KXMLQLCWindowRectangular;
+    list << KXMLQLCWindowHann;
+    list << KXMLQLCWindowHamming;
+    list << KXMLQLCWindowBlackman;
+    return list;
+}
+
+void AudioPreprocessor::updateWindow()
+{
+    m_window.resize(m_frameSize);
+    if (m_frameSize == 0)
+        return;
+
+    double *window = m_window.data();
+    const double span = m_frameSize > 1 ? double(m_frameSize - 1) : 1.0;
+
+    for (int i = 0; i < m_frameSize; i++)
+    {
+        const double x = (M_2PI * i) / span;
+
+        switch (m_windowType)
+        {
+            case RectangularWindow:
+                window[i] = 1.0;
+            break;
+            case HammingWindow:
+                window[i] = 0.54 - 0.46 * qCos(x);
+            break;
+            case BlackmanWindow:
+            {
+                const double a0 = (1 - 0.16) / 2, a1 = 0.5, a2 = 0.16 / 2;
+                window[i] = a0 - a1 * qCos(x) + a2 * qCos(2 * x);
+            }
+            break;
+            default:
+            case HannWindow:
+                window[i] = 0.5 * (1.0 - qCos(x));
+            break;
+        }
+    }
+}
+
+/*********************************************************************
+ * Processing
+ *********************************************************************/
+
+void AudioPreprocessor::push(const int16_t *buffer, int frames)
+{
+    if (buffer == NULL || frames <= 0 || m_frameSize == 0)
+        return;
+
+    // only the most recent frames fit in the analysis frame
+    if (frames > m_frameSize)
+    {
+        buffer += (frames - m_frameSize) * m_channels;
+        frames = m_frameSize;
+    }
+
+    // drop the oldest samples
+    const int keep = m_frameSize - frames;
+    double *samples = m_samples.data();
+    if (keep > 0)
+        memmove(samples, samples + frames, keep * sizeof(double));
+
+    // mix down and normalize in a single multiplication,
+    // instead of dividing every sample by the channels number
+    double *out = samples + keep;
+    const double scale = 1.0 / (32768.0 * m_channels);
+
+    switch (m_channels)
+    {
+        case 1:
+            for (int i = 0; i < frames; i++)
+                out[i] = buffer[i] * scale;
+        break;
+        case 2:
+            for (int i = 0; i < frames; i++)
+                out[i] = (int(buffer[i * 2]) + int(buffer[i * 2 + 1])) * scale;
+        break;
+        default:
+            for (int i = 0; i < frames; i++)
+            {
+                const int16_t *frame = buffer + i * m_channels;
+                int sum = 0;
+                for (int c = 0; c < m_channels; c++)
+                    sum += frame[c];
+                out[i] = sum * scale;
+            }
+        break;
+    }
+}
+
+const double *AudioPreprocessor::samples() const
+{
+    return m_samples.constData();
+}
+
+double AudioPreprocessor::process(double *output) const
+{
+    const int count = m_frameSize;
+    if (output == NULL || count == 0)
+        return 0.0;
+
+    const double *in = m_samples.constData();
+    const double *window = m_window.constData();
+
+    // 1) mean and mean square in a single pass
+    double sum[ACCUMULATORS] = { 0.0, 0.0, 0.0, 0.0 };
+    double sumSq[ACCUMULATORS] = { 0.0, 0.0, 0.0, 0.0 };
+    const int blocks = count - (count % ACCUMULATORS);
+
+    for (int i = 0; i < blocks; i += ACCUMULATORS)
+    {
+        for (int a = 0; a < ACCUMULATORS; a++)
+        {
+            const double x = in[i + a];
+            sum[a] += x;
+            sumSq[a] += x * x;
+        }
+    }
+    for (int i = blocks; i < count; i++)
+    {
+        sum[0] += in[i];
+        sumSq[0] += in[i] * in[i];
+    }
+
+    const double mean = (sum[0] + sum[1] + sum[2] + sum[3]) / count;
+    const double meanSq = (sumSq[0] + sumSq[1] + sumSq[2] + sumSq[3]) / count;
+
+    // 2) remove DC and apply the window
+    for (int i = 0; i < count; i++)
+        output[i] = (in[i] - mean) * window[i];
+
+    // the variance is the mean square of the signal without DC
+    return qSqrt(qMax(0.0, meanSq - (mean * mean)));
+}
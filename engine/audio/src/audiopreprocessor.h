@@ -0,0 +1,124 @@
+/*
+  Q Light Controller Plus
+  audiopreprocessor.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef AUDIOPREPROCESSOR_H
+#define AUDIOPREPROCESSOR_H
+
+#include <stdint.h>
+#include <QStringList>
+#include <QVector>
+
+/** @addtogroup engine_audio Audio
+ * @{
+ */
+
+/**
+ * AudioPreprocessor prepares the captured audio for the FFT.
+ *
+ * Captured blocks of $hopSize interleaved frames are mixed down to mono
+ * and appended to an analysis frame of $frameSize samples, dropping the
+ * oldest ones. When the hop size is smaller than the frame size, frames
+ * overlap, so the analysis can run more often than once per frame.
+ *
+ * process() removes the DC offset, computes the RMS and applies the
+ * window, using a table computed once for the frame size. All the loops
+ * work on contiguous arrays without branches, so that the compiler can
+ * vectorize them.
+ */
+class AudioPreprocessor final
+{
+public:
+    AudioPreprocessor();
+    ~AudioPreprocessor();
+
+    /*********************************************************************
+     * Format
+     *********************************************************************/
+public:
+    /**
+     * Set the analysis frame size (in samples), the number of interleaved
+     * channels of the captured audio and the number of frames captured
+     * between two analyses. This clears the analysis frame.
+     */
+    void setFormat(int frameSize, int channels, int hopSize);
+
+    int frameSize() const;
+    int channels() const;
+    int hopSize() const;
+
+private:
+    int m_frameSize;
+    int m_channels;
+    int m_hopSize;
+
+    /*********************************************************************
+     * Window
+     *********************************************************************/
+public:
+    enum WindowType
+    {
+        RectangularWindow = 0,
+        HannWindow,
+        HammingWindow,
+        BlackmanWindow
+    };
+
+    void setWindowType(WindowType type);
+    WindowType windowType() const;
+
+    static QString windowTypeToString(WindowType type);
+    static WindowType stringToWindowType(const QString& str);
+    static QStringList windowTypes();
+
+private:
+    void updateWindow();
+
+private:
+    WindowType m_windowType;
+    QVector<double> m_window;
+
+    /*********************************************************************
+     * Processing
+     *********************************************************************/
+public:
+    /**
+     * Mix down $frames interleaved frames of $buffer and append them
+     * to the analysis frame. At most frameSize() frames are used.
+     */
+    void push(const int16_t *buffer, int frames);
+
+    /** Get the mono samples of the analysis frame, normalized to [-1, 1].
+     *  The oldest sample comes first */
+    const double *samples() const;
+
+    /**
+     * Remove the DC offset from the analysis frame, apply the
+     * window and write frameSize() samples to $output.
+     *
+     * @return the RMS of the frame, without DC offset
+     */
+    double process(double *output) const;
+
+private:
+    QVector<double> m_samples;
+};
+
+/** @} */
+
+#endif // AUDIOPREPROCESSOR_H
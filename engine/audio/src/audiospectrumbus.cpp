@@ -0,0 +1,138 @@
+/*
+  Q Light Controller Plus
+  audiospectrumbus.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <qmath.h>
+#include <string.h>
+#include <atomic>
+
+#include "audiospectrumbus.h"
+
+#define M_2PI       6.28318530718           /* 2*pi */
+
+AudioSpectrumBus::AudioSpectrumBus()
+    : m_latest(-1)
+    , m_latestSequence(0)
+    , m_writeSlot(0)
+    , m_sequence(0)
+{
+    memset(m_frames, 0, sizeof(m_frames));
+}
+
+AudioSpectrumBus::~AudioSpectrumBus()
+{
+}
+
+/*********************************************************************
+ * Writer
+ *********************************************************************/
+
+AudioSpectrumFrame *AudioSpectrumBus::beginWrite()
+{
+    int latest = m_latest.loadAcquire();
+    m_writeSlot = (latest + 1) % AUDIO_SPECTRUM_BUS_SLOTS;
+
+    // odd: readers copying this slot will retry
+    m_slotSequence[m_writeSlot].fetchAndAddOrdered(1);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    return &m_frames[m_writeSlot];
+}
+
+void AudioSpectrumBus::endWrite()
+{
+    m_frames[m_writeSlot].sequence = ++m_sequence;
+    if (m_sequence == 0)
+        m_frames[m_writeSlot].sequence = m_sequence = 1;
+
+    m_slotSequence[m_writeSlot].fetchAndAddRelease(1);
+    m_latest.storeRelease(m_writeSlot);
+    m_latestSequence.storeRelease(int(m_sequence));
+}
+
+/*********************************************************************
+ * Readers
+ *********************************************************************/
+
+bool AudioSpectrumBus::read(AudioSpectrumFrame &frame) const
+{
+    forever
+    {
+        int slot = m_latest.loadAcquire();
+        if (slot < 0)
+            return false;
+
+        int before = m_slotSequence[slot].loadAcquire();
+        if (before & 1)
+            continue;
+
+        const AudioSpectrumFrame &src = m_frames[slot];
+        frame.sequence = src.sequence;
+        frame.timestamp = src.timestamp;
+        frame.rms = src.rms;
+        frame.beat = src.beat;
+        frame.binsCount = qBound(0, src.binsCount, AUDIO_SPECTRUM_MAX_BINS);
+        memcpy(frame.magnitudes, src.magnitudes, frame.binsCount * sizeof(double));
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (m_slotSequence[slot].loadAcquire() == before)
+            return true;
+    }
+}
+
+quint32 AudioSpectrumBus::latestSequence() const
+{
+    return quint32(m_latestSequence.loadAcquire());
+}
+
+double AudioSpectrumBus::bands(const AudioSpectrumFrame &frame, int number, double *bands)
+{
+    double maxMagnitude = 0.;
+
+    if (number <= 0)
+        return maxMagnitude;
+
+    int subBandWidth = frame.binsCount / number;
+    int i = 0;
+
+    for (int b = 0; b < number; b++)
+    {
+        double magnitudeSum = 0.;
+        for (int s = 0; s < subBandWidth && i < frame.binsCount; s++, i++)
+            magnitudeSum += frame.magnitudes[i];
+
+        double bandMagnitude = subBandWidth ? magnitudeSum / (subBandWidth * M_2PI) : 0.;
+        bands[b] = bandMagnitude;
+        if (maxMagnitude < bandMagnitude)
+            maxMagnitude = bandMagnitude;
+    }
+
+    return maxMagnitude;
+}
+
+quint32 AudioSpectrumBus::power(const double *bands, int number)
+{
+    if (number <= 0)
+        return 0;
+
+    double pwrSum = 0.;
+    for (int n = 0; n < number; n++)
+        pwrSum += bands[n];
+
+    return 32768 * pwrSum * qSqrt(M_2PI) / double(number);
+}
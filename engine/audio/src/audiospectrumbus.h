@@ -0,0 +1,124 @@
+/*
+  Q Light Controller Plus
+  audiospectrumbus.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef AUDIOSPECTRUMBUS_H
+#define AUDIOSPECTRUMBUS_H
+
+#include <QAtomicInt>
+#include <QtGlobal>
+
+/** @addtogroup engine_audio Audio
+ * @{
+ */
+
+/** Maximum number of FFT bins published with each frame */
+#define AUDIO_SPECTRUM_MAX_BINS     1024
+
+/** Number of frames the bus rotates. Readers only retry when the writer
+ *  laps a slot while it is being copied, which takes two whole frames */
+#define AUDIO_SPECTRUM_BUS_SLOTS    3
+
+/**
+ * The result of the analysis of a block of captured audio
+ */
+typedef struct
+{
+    /** Incremented for every frame published, 0 means no frame */
+    quint32 sequence;
+    /** Time of the capture, in ms since the epoch */
+    qint64 timestamp;
+    /** RMS of the block, normalized to [0, 1] */
+    double rms;
+    /** True if a beat has been detected in the block */
+    bool beat;
+    /** Number of valid entries in $magnitudes */
+    int binsCount;
+    /** FFT magnitudes from the first bin above DC, up to
+     *  AudioCapture::maxFrequency(). All 0 on silence */
+    double magnitudes[AUDIO_SPECTRUM_MAX_BINS];
+} AudioSpectrumFrame;
+
+/**
+ * AudioSpectrumBus hands the analysis frames over from the audio capture
+ * thread to any number of readers, without locks and without signals.
+ *
+ * The single writer fills the slot after the latest one and then publishes
+ * it. Each slot is guarded by a sequence counter, odd while it is being
+ * written: readers copy the latest slot and check that the counter did not
+ * change meanwhile, retrying otherwise. The writer never waits and readers
+ * only retry if they are preempted for a couple of audio frames.
+ *
+ * Spectrum bands of any number are derived from the published bins with
+ * bands(), so consumers don't need to register their bands count.
+ */
+class AudioSpectrumBus final
+{
+public:
+    AudioSpectrumBus();
+    ~AudioSpectrumBus();
+
+    /*********************************************************************
+     * Writer
+     *********************************************************************/
+public:
+    /** Get the frame to fill. To be called by the writer only */
+    AudioSpectrumFrame *beginWrite();
+
+    /** Publish the frame returned by beginWrite() */
+    void endWrite();
+
+private:
+    AudioSpectrumFrame m_frames[AUDIO_SPECTRUM_BUS_SLOTS];
+    QAtomicInt m_slotSequence[AUDIO_SPECTRUM_BUS_SLOTS];
+    QAtomicInt m_latest;
+    QAtomicInt m_latestSequence;
+    int m_writeSlot;
+    quint32 m_sequence;
+
+    /*********************************************************************
+     * Readers
+     *********************************************************************/
+public:
+    /**
+     * Copy the latest published frame into $frame.
+     * Only the valid magnitudes are copied.
+     *
+     * @return false if no frame has been published yet
+     */
+    bool read(AudioSpectrumFrame &frame) const;
+
+    /** Get the sequence number of the latest frame, 0 if none */
+    quint32 latestSequence() const;
+
+    /**
+     * Average the magnitudes of $frame into $number bands, the same way
+     * AudioCapture does for the dataProcessed() signal.
+     *
+     * @param bands must hold at least $number values
+     * @return the maximum band magnitude
+     */
+    static double bands(const AudioSpectrumFrame &frame, int number, double *bands);
+
+    /** Get the signal power of $number bands, as emitted by dataProcessed() */
+    static quint32 power(const double *bands, int number);
+};
+
+/** @} */
+
+#endif // AUDIOSPECTRUMBUS_H
@@ -45,6 +45,7 @@ BeatTracker::BeatTracker(int sampleRate,
                          double sensitivity)
     : m_sampleRate(sampleRate),
     m_frameSize(bufferSize),
+    m_hopSize(bufferSize),
     m_fftSize(nextPowerOfTwo(bufferSize)),
     m_channels(std::max(1, channels)),
     m_sensitivity(sensitivity),
@@ -78,6 +79,7 @@ BeatTracker::BeatTracker(int sampleRate,
     allocateFft();
 
     // Window and magnitude history
+    m_mono.resize(m_frameSize);
     m_window.resize(m_frameSize);
     m_prevMag.assign(m_fftSize / 2 + 1, 0.0);
 
@@ -94,7 +96,7 @@ BeatTracker::BeatTracker(int sampleRate,
     m_samplesSinceBeat = minSamplesBetweenBeats;
 
     // Silence reset: after ~2 seconds of silence, reset BPM memory
-    double framesPerSecond = (m_frameSize > 0) ? (double(m_sampleRate) / double(m_frameSize)) : 0.0;
+    double framesPerSecond = (m_hopSize > 0) ? (double(m_sampleRate) / double(m_hopSize)) : 0.0;
     m_silenceResetFrames = (framesPerSecond > 0.0) ? int(framesPerSecond * 2.0) : 0;
 
 #ifdef BEAT_DEBUG
@@ -211,11 +213,13 @@ void BeatTracker::setFormat(int sampleRate,
 
     m_sampleRate = sampleRate;
     m_frameSize  = bufferSize;
+    m_hopSize    = std::min(m_hopSize, m_frameSize);
     m_channels   = channels;
     m_fftSize    = nextPowerOfTwo(m_frameSize);
 
     allocateFft();
 
+    m_mono.resize(m_frameSize);
     m_window.clear();
     initWindow();
 
@@ -237,7 +241,7 @@ void BeatTracker::setFormat(int sampleRate,
     m_samplesSinceBeat = minSamplesBetweenBeats;
 
     // Recompute silence reset frames
-    double framesPerSecond = (m_frameSize > 0) ? (double(m_sampleRate) / double(m_frameSize)) : 0.0;
+    double framesPerSecond = (m_hopSize > 0) ? (double(m_sampleRate) / double(m_hopSize)) : 0.0;
     m_silenceResetFrames = (framesPerSecond > 0.0) ? int(framesPerSecond * 2.0) : 0;
     m_consecutiveSilentFrames = 0;
 
@@ -253,6 +257,24 @@ void BeatTracker::setFormat(int sampleRate,
 #endif
 }
 
+void BeatTracker::setHopSize(int hopSize)
+{
+    if (hopSize <= 0)
+        return;
+
+    m_hopSize = std::min(hopSize, m_frameSize);
+
+    // Silence reset counts blocks, which now come every hop
+    double framesPerSecond = double(m_sampleRate) / double(m_hopSize);
+    m_silenceResetFrames = int(framesPerSecond * 2.0);
+    m_consecutiveSilentFrames = 0;
+
+#ifdef BEAT_DEBUG
+    qDebug() << "[BeatTracker] setHopSize" << m_hopSize
+             << "silenceResetFrames" << m_silenceResetFrames;
+#endif
+}
+
 // spectral flux with log compression + low-frequency weighting
 double BeatTracker::computeSpectralFlux()
 {
@@ -336,9 +358,6 @@ bool BeatTracker::processAudio(int16_t *buffer, int bufferSize)
 
     int frames = std::min(framesAvailable, m_frameSize);
 
-    // Sample index at the start of this frame block
-    int frameStartSample = m_totalSamplesProcessed;
-
 #ifdef BEAT_DEBUG
     static bool s_formatLogged = false;
     if (!s_formatLogged)
@@ -352,8 +371,7 @@ bool BeatTracker::processAudio(int16_t *buffer, int bufferSize)
     }
 #endif
 
-    // 1. Mix to mono and apply window
-    double maxAbsSample = 0.0;
+    // Mix to mono, normalized to [-1, 1]
     for (int i = 0; i < frames; ++i)
     {
         int32_t sum = 0;
@@ -361,8 +379,28 @@ bool BeatTracker::processAudio(int16_t *buffer, int bufferSize)
         for (int c = 0; c < m_channels; ++c)
             sum += framePtr[c];
 
-        // Average and normalize to [-1, 1]
-        double s = static_cast<double>(sum) / (32768.0 * m_channels);
+        m_mono[i] = static_cast<double>(sum) / (32768.0 * m_channels);
+    }
+
+    return processFrame(m_mono.data(), frames, frames);
+}
+
+// process a block of mono samples
+bool BeatTracker::processFrame(const double *samples, int frames, int advance)
+{
+    if (!samples || frames <= 0 || advance <= 0)
+        return false;
+
+    frames = std::min(frames, m_frameSize);
+
+    // Sample index at the start of the new samples of this block
+    int frameStartSample = m_totalSamplesProcessed;
+
+    // 1. Apply window
+    double maxAbsSample = 0.0;
+    for (int i = 0; i < frames; ++i)
+    {
+        double s = samples[i];
         if (std::fabs(s) > maxAbsSample)
             maxAbsSample = std::fabs(s);
 
@@ -395,7 +433,7 @@ bool BeatTracker::processAudio(int16_t *buffer, int bufferSize)
 
         // Refractory update: we still advance time
         int minSamplesBetweenBeats = int(m_minBeatIntervalSec * m_sampleRate);
-        m_samplesSinceBeat += frames;
+        m_samplesSinceBeat += advance;
         if (m_samplesSinceBeat > minSamplesBetweenBeats)
             m_samplesSinceBeat = minSamplesBetweenBeats;
 
@@ -409,7 +447,7 @@ bool BeatTracker::processAudio(int16_t *buffer, int bufferSize)
         }
 
         // Advance global sample counter
-        m_totalSamplesProcessed += frames;
+        m_totalSamplesProcessed += advance;
 
 #ifdef BEAT_DEBUG
         static int s_frameCounterSilent = 0;
@@ -474,8 +512,9 @@ bool BeatTracker::processAudio(int16_t *buffer, int bufferSize)
     // --- BPM estimation: if we detected a beat, update intervals ---
     if (isBeat)
     {
-        // Approximate beat position at the center of the frame
-        int beatSample = frameStartSample + frames / 2;
+        // Approximate beat position at the center of the block,
+        // which ends with the new samples
+        int beatSample = frameStartSample + advance - frames / 2;
 
         if (m_lastBeatSample >= 0)
         {
@@ -495,7 +534,7 @@ bool BeatTracker::processAudio(int16_t *buffer, int bufferSize)
     }
 
     // Update samplesSinceBeat for next call
-    m_samplesSinceBeat += frames;
+    m_samplesSinceBeat += advance;
 
     // Clamp to avoid overflow and keep it meaningful
     if (m_samplesSinceBeat > minSamplesBetweenBeats)
@@ -505,7 +544,7 @@ bool BeatTracker::processAudio(int16_t *buffer, int bufferSize)
         m_samplesSinceBeat = 0;
 
     // Update total processed samples (for future beat positions)
-    m_totalSamplesProcessed += frames;
+    m_totalSamplesProcessed += advance;
 
 #ifdef BEAT_DEBUG
     static int s_frameCounter = 0;
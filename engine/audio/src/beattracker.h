@@ -50,6 +50,16 @@ public:
     // Returns true if beat onset detected in this block.
     bool processAudio(int16_t *buffer, int bufferSize);
 
+    // Process a block of mono samples, normalized to [-1, 1].
+    // Consecutive blocks may overlap: advance is the number of new
+    // samples since the previous block (the hop size).
+    // Returns true if beat onset detected in this block.
+    bool processFrame(const double *samples, int frames, int advance);
+
+    // Set the number of new samples between two overlapping blocks,
+    // which sets the rate of the blocks. Defaults to the block size.
+    void setHopSize(int hopSize);
+
     // Optional: set band where we measure flux (Hz)
     // For rock, try: setBand(40.0, 250.0);
     void setBand(double minHz, double maxHz);
@@ -78,6 +88,7 @@ private:
 private:
     int m_sampleRate;
     int m_frameSize;      // frames per block
+    int m_hopSize;        // new frames per block
     int m_fftSize;
     int m_channels;
 
@@ -91,6 +102,7 @@ private:
 #endif
 
     // Window + magnitude history
+    std::vector<double> m_mono;
     std::vector<double> m_window;
     std::vector<double> m_prevMag;
 
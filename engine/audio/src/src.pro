@@ -20,6 +20,8 @@ HEADERS += audio.h \
            audioparameters.h \
            audiocapture.h \
            audioplugincache.h \
+           audiopreprocessor.h \
+           audiospectrumbus.h \
            beattracker.h
 
 lessThan(QT_MAJOR_VERSION, 5) {
@@ -38,6 +40,8 @@ SOURCES += audio.cpp \
            audioparameters.cpp \
            audiocapture.cpp \
            audioplugincache.cpp \
+           audiopreprocessor.cpp \
+           audiospectrumbus.cpp \
            beattracker.cpp
 
 lessThan(QT_MAJOR_VERSION, 5) {
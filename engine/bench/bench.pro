@@ -0,0 +1,23 @@
+include(../../variables.pri)
+
+TEMPLATE = app
+LANGUAGE = C++
+TARGET   = qlcplus-bench
+
+CONFIG  -= app_bundle
+CONFIG  += console
+qmlui|greaterThan(QT_MAJOR_VERSION, 5) {
+  QT += qml
+} else {
+  QT += script
+}
+
+DEPENDPATH   += ../src
+INCLUDEPATH  += ../../plugins/interfaces
+INCLUDEPATH  += ../src
+INCLUDEPATH  += ../audio/src
+QMAKE_LIBDIR += ../src
+LIBS         += -lqlcplusengine
+LIBS         += -L../audio/src -lqlcplusaudio
+
+SOURCES += qlcplusbench.cpp
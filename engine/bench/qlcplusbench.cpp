@@ -0,0 +1,891 @@
+/*
+  Q Light Controller Plus
+  qlcplusbench.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QAtomicInteger>
+#include <QTextStream>
+#include <QVector>
+#include <QDebug>
+#include <QFile>
+#include <QDir>
+#include <qmath.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+#define private public
+#define protected public
+#include "audiopreprocessor.h"
+#include "genericdmxsource.h"
+#include "qlcfixturedefcache.h"
+#include "rgbscriptscache.h"
+#include "inputoutputmap.h"
+#include "qlcfixturemode.h"
+#include "qlcfixturehead.h"
+#include "qlcfixturedef.h"
+#include "ioplugincache.h"
+#include "rgbalgorithm.h"
+#include "fixturegroup.h"
+#include "mastertimer.h"
+#include "chaserstep.h"
+#include "qlcchannel.h"
+#include "rgbmatrix.h"
+#include "universe.h"
+#include "fixture.h"
+#include "chaser.h"
+#include "scene.h"
+#include "efx.h"
+#include "doc.h"
+#undef protected
+#undef private
+
+/*****************************************************************************
+ * Allocation counter
+ *****************************************************************************/
+
+/* Every allocation made by the process is counted, including the ones made
+ * by the engine and Qt shared libraries. On glibc, malloc itself is
+ * interposed, so that Qt containers (which don't go through operator new)
+ * are accounted as well. Elsewhere only operator new can be counted. */
+
+static QAtomicInteger<quint32> s_allocations;
+
+#if defined(__GLIBC__)
+extern "C"
+{
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+void *malloc(size_t size) noexcept
+{
+    s_allocations.fetchAndAddRelaxed(1);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) noexcept
+{
+    s_allocations.fetchAndAddRelaxed(1);
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size) noexcept
+{
+    s_allocations.fetchAndAddRelaxed(1);
+    return __libc_realloc(ptr, size);
+}
+}
+
+#define ALLOCATOR_NAME "malloc"
+#else
+void *operator new(std::size_t size)
+{
+    s_allocations.fetchAndAddRelaxed(1);
+    void *ptr = std::malloc(size ? size : 1);
+    if (ptr == NULL)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+#define ALLOCATOR_NAME "operator new"
+#endif
+
+/*****************************************************************************
+ * Workspace
+ *****************************************************************************/
+
+/* Every universe is laid out the same way:
+ *   0 - 255: generic dimmers, 4 channels each
+ * 256 - 267: pan/tilt heads (Pan, Tilt, Dimmer), driven by an EFX
+ * 288 - 479: an RGB panel of 2 rows, 32 pixels each, driven by 2 RGB matrices
+ */
+#define DIMMER_CHANNELS     4
+#define MAX_DIMMERS         64
+#define MOVER_ADDRESS       256
+#define MOVER_HEADS         4
+#define PANEL_ADDRESS       288
+#define PANEL_COLUMNS       32
+#define PANEL_ROWS          2
+
+#define STUB_PLUGIN_NAME    "I/O Plugin Stub"
+#define DEFAULT_SCRIPT      "Plasma"
+
+typedef struct
+{
+    int universes;
+    int dimmers;
+    int scenes;
+    int ticks;
+    int warmup;
+    QString pluginDir;
+    QString scriptDir;
+    QString script;
+} BenchConfig;
+
+typedef struct
+{
+    int fixtures;
+    int scenes;
+    int chasers;
+    int efxs;
+    int matrices;
+    int scriptMatrices;
+    int patchedUniverses;
+    QList<GenericDMXSource *> sources;
+} BenchWorkspace;
+
+static QLCFixtureDef *moverDef(Doc *doc)
+{
+    QLCFixtureDef *def = new QLCFixtureDef();
+    def->setManufacturer("QLC+");
+    def->setModel("Bench Mover");
+    def->setType(QLCFixtureDef::MovingHead);
+
+    QLCChannel *pan = new QLCChannel();
+    pan->setName("Pan");
+    pan->setGroup(QLCChannel::Pan);
+    def->addChannel(pan);
+
+    QLCChannel *tilt = new QLCChannel();
+    tilt->setName("Tilt");
+    tilt->setGroup(QLCChannel::Tilt);
+    def->addChannel(tilt);
+
+    QLCChannel *dimmer = new QLCChannel();
+    dimmer->setName("Dimmer");
+    dimmer->setGroup(QLCChannel::Intensity);
+    def->addChannel(dimmer);
+
+    QLCFixtureMode *mode = new QLCFixtureMode(def);
+    mode->setName("3 Channel");
+    mode->insertChannel(pan, 0);
+    mode->insertChannel(tilt, 1);
+    mode->insertChannel(dimmer, 2);
+
+    QLCFixtureHead head;
+    head.addChannel(0);
+    head.addChannel(1);
+    head.addChannel(2);
+    mode->insertHead(-1, head);
+
+    def->addMode(mode);
+    doc->fixtureDefCache()->addFixtureDef(def);
+
+    return def;
+}
+
+static quint32 addFixture(Doc *doc, Fixture *fxi, quint32 universe, quint32 address)
+{
+    fxi->setUniverse(universe);
+    fxi->setAddress(address);
+    doc->addFixture(fxi);
+    return fxi->id();
+}
+
+static BenchWorkspace buildWorkspace(Doc *doc, const BenchConfig &config)
+{
+    BenchWorkspace ws = { 0, 0, 0, 0, 0, 0, 0, QList<GenericDMXSource *>() };
+    InputOutputMap *ioMap = doc->inputOutputMap();
+
+    QLCFixtureDef *mover = moverDef(doc);
+    QLCFixtureDef *rowDef = NULL;
+    QLCFixtureMode *rowMode = NULL;
+
+    QLCIOPlugin *stub = doc->ioPluginCache()->plugin(STUB_PLUGIN_NAME);
+    int stubOutputs = stub != NULL ? stub->outputs().count() : 0;
+
+    bool scriptLoaded = doc->rgbScriptsCache()->names().contains(config.script);
+
+    // The stub has a few outputs only: universes share them
+    for (int u = 0; u < int(ioMap->universesCount()); u++)
+    {
+        if (stubOutputs > 0 &&
+            ioMap->setOutputPatch(quint32(u), STUB_PLUGIN_NAME, QString(), quint32(u % stubOutputs)))
+            ws.patchedUniverses++;
+    }
+
+    for (int u = 0; u < config.universes; u++)
+    {
+        quint32 universe = quint32(u);
+
+        /* Dimmers, scenes and a chaser cycling through them */
+        QList<quint32> dimmers;
+        for (int d = 0; d < config.dimmers; d++)
+        {
+            Fixture *fxi = new Fixture(doc);
+            fxi->setName(QString("Dimmer %1.%2").arg(u + 1).arg(d + 1));
+            fxi->setChannels(DIMMER_CHANNELS);
+            dimmers << addFixture(doc, fxi, universe, quint32(d * DIMMER_CHANNELS));
+            ws.fixtures++;
+        }
+
+        Chaser *chaser = new Chaser(doc);
+        chaser->setName(QString("Chaser %1").arg(u + 1));
+        chaser->setFadeInMode(Chaser::Common);
+        chaser->setFadeOutMode(Chaser::Common);
+        chaser->setDurationMode(Chaser::Common);
+        chaser->setFadeInSpeed(200);
+        chaser->setFadeOutSpeed(200);
+        chaser->setDuration(500);
+
+        for (int s = 0; s < config.scenes; s++)
+        {
+            Scene *scene = new Scene(doc);
+            scene->setName(QString("Scene %1.%2").arg(u + 1).arg(s + 1));
+
+            for (int d = 0; d < dimmers.count(); d++)
+            {
+                for (quint32 ch = 0; ch < DIMMER_CHANNELS; ch++)
+                    scene->setValue(dimmers.at(d), ch, uchar((s * 37 + d * 11 + ch * 5) % 256));
+            }
+
+            doc->addFunction(scene);
+            chaser->addStep(ChaserStep(scene->id()));
+            ws.scenes++;
+        }
+
+        doc->addFunction(chaser);
+        ws.chasers++;
+
+        /* Pan/tilt heads moved by an EFX */
+        EFX *efx = new EFX(doc);
+        efx->setName(QString("EFX %1").arg(u + 1));
+        efx->setAlgorithm(EFX::Circle);
+        efx->setWidth(100);
+        efx->setHeight(100);
+        efx->setDuration(2000);
+
+        for (int h = 0; h < MOVER_HEADS; h++)
+        {
+            Fixture *fxi = new Fixture(doc);
+            fxi->setName(QString("Mover %1.%2").arg(u + 1).arg(h + 1));
+            fxi->setFixtureDefinition(mover, mover->modes().first());
+            efx->addFixture(addFixture(doc, fxi, universe, quint32(MOVER_ADDRESS + h * 3)));
+            ws.fixtures++;
+        }
+
+        doc->addFunction(efx);
+        ws.efxs++;
+
+        /* RGB panel rows, each one driven by a matrix */
+        for (int r = 0; r < PANEL_ROWS; r++)
+        {
+            Fixture *fxi = new Fixture(doc);
+            fxi->setName(QString("Panel %1 - Row %2").arg(u + 1).arg(r + 1));
+            if (rowDef == NULL)
+                rowDef = fxi->genericRGBPanelDef(PANEL_COLUMNS, Fixture::RGB, false);
+            if (rowMode == NULL)
+                rowMode = fxi->genericRGBPanelMode(rowDef, Fixture::RGB, false, 1000, 100);
+            fxi->setFixtureDefinition(rowDef, rowMode);
+            quint32 fxiId = addFixture(doc, fxi, universe, quint32(PANEL_ADDRESS + r * PANEL_COLUMNS * 3));
+            ws.fixtures++;
+
+            FixtureGroup *grp = new FixtureGroup(doc);
+            grp->setName(fxi->name());
+            grp->setSize(QSize(PANEL_COLUMNS, 1));
+            doc->addFixtureGroup(grp);
+            grp->assignFixture(fxiId, QLCPoint(0, 0));
+
+            // odd rows run the script, when available
+            bool useScript = scriptLoaded && (r % 2) == 1;
+
+            RGBMatrix *matrix = new RGBMatrix(doc);
+            matrix->setName(QString("Matrix %1.%2").arg(u + 1).arg(r + 1));
+            matrix->setFixtureGroup(grp->id());
+            matrix->setAlgorithm(RGBAlgorithm::algorithm(doc, useScript ? config.script : QString("Plain Color")));
+            matrix->setDuration(100);
+            doc->addFunction(matrix);
+            ws.matrices++;
+            if (useScript)
+                ws.scriptMatrices++;
+        }
+
+        /* A channel overridden as a Virtual Console slider would do */
+        if (dimmers.isEmpty() == false)
+        {
+            GenericDMXSource *source = new GenericDMXSource(doc);
+            source->set(dimmers.first(), 0, 255);
+            source->setOutputEnabled(true);
+            ws.sources << source;
+        }
+    }
+
+    return ws;
+}
+
+/*****************************************************************************
+ * Measurement
+ *****************************************************************************/
+
+/* The phases of MasterTimer::timerTick(), plus the work that every
+ * universe thread does once woken up by MasterTimer::tickReady() */
+enum BenchPhase
+{
+    FunctionsPhase = 0,
+    DMXSourcesPhase,
+    UniversesPhase,
+    PhasesCount
+};
+
+static const char *s_phaseNames[PhasesCount] = { "functions", "dmxsources", "universes" };
+
+typedef struct
+{
+    QVector<qint64> nsecs;
+    quint64 allocations;
+} PhaseSamples;
+
+static QJsonObject phaseReport(PhaseSamples &samples, int ticks)
+{
+    QVector<qint64> &ns = samples.nsecs;
+    std::sort(ns.begin(), ns.end());
+
+    qint64 sum = 0;
+    foreach (qint64 n, ns)
+        sum += n;
+
+    QJsonObject obj;
+    obj["meanNs"] = double(sum) / ticks;
+    obj["medianNs"] = double(ns.at(ns.count() / 2));
+    obj["p99Ns"] = double(ns.at(qMin(ns.count() - 1, ns.count() * 99 / 100)));
+    obj["maxNs"] = double(ns.last());
+    obj["allocationsPerTick"] = double(samples.allocations) / ticks;
+
+    return obj;
+}
+
+static QJsonObject runBench(Doc *doc, const BenchConfig &config)
+{
+    MasterTimer *timer = doc->masterTimer();
+    InputOutputMap *ioMap = doc->inputOutputMap();
+
+    PhaseSamples samples[PhasesCount + 1];
+    for (int p = 0; p <= PhasesCount; p++)
+    {
+        samples[p].nsecs.resize(config.ticks);
+        samples[p].allocations = 0;
+    }
+
+    quint64 outputBytes = 0;
+    QElapsedTimer clock;
+    clock.start();
+
+    // Universe threads are never started: the universes are processed
+    // in line, so that their cost can be measured in the same tick
+    for (int t = 0; t < config.warmup + config.ticks; t++)
+    {
+        qint64 ns[PhasesCount + 1];
+        quint32 allocs[PhasesCount + 1];
+
+        ns[0] = clock.nsecsElapsed();
+        allocs[0] = s_allocations.loadAcquire();
+
+        QList<Universe *> universes = ioMap->claimUniverses();
+        timer->timerTickFunctions(universes);
+
+        ns[1] = clock.nsecsElapsed();
+        allocs[1] = s_allocations.loadAcquire();
+
+        timer->timerTickDMXSources(universes);
+        ioMap->releaseUniverses();
+
+        ns[2] = clock.nsecsElapsed();
+        allocs[2] = s_allocations.loadAcquire();
+
+        foreach (Universe *universe, universes)
+            universe->processFaders();
+
+        ns[3] = clock.nsecsElapsed();
+        allocs[3] = s_allocations.loadAcquire();
+
+        if (t >= config.warmup)
+        {
+            int i = t - config.warmup;
+            for (int p = 0; p < PhasesCount; p++)
+            {
+                samples[p].nsecs[i] = ns[p + 1] - ns[p];
+                samples[p].allocations += allocs[p + 1] - allocs[p];
+            }
+            samples[PhasesCount].nsecs[i] = ns[PhasesCount] - ns[0];
+            samples[PhasesCount].allocations += allocs[PhasesCount] - allocs[0];
+
+            foreach (Universe *universe, universes)
+                outputBytes += quint64(universe->usedChannels()) * universe->outputPatchesCount();
+        }
+
+        // deliver the signals queued by the engine, outside of the measures
+        QCoreApplication::processEvents();
+    }
+
+    // MasterTimer::stopAllFunctions() waits for the timer thread,
+    // which is not running here: the request is served in line
+    timer->m_stopAllFunctions = true;
+    QList<Universe *> universes = ioMap->claimUniverses();
+    timer->timerTickFunctions(universes);
+    ioMap->releaseUniverses();
+    timer->m_stopAllFunctions = false;
+
+    QJsonObject phases;
+    for (int p = 0; p < PhasesCount; p++)
+        phases[s_phaseNames[p]] = phaseReport(samples[p], config.ticks);
+
+    QJsonObject result;
+    result["phases"] = phases;
+    result["tick"] = phaseReport(samples[PhasesCount], config.ticks);
+    result["outputBytesPerTick"] = double(outputBytes) / config.ticks;
+    result["outputBytesPerSecond"] = double(outputBytes) * MasterTimer::frequency() / config.ticks;
+
+    return result;
+}
+
+/*****************************************************************************
+ * Audio analysis
+ *****************************************************************************/
+
+/* The audio capture defaults: a 2048 samples FFT at 44.1kHz */
+#define AUDIO_SAMPLE_RATE   44100
+#define AUDIO_FRAME_SIZE    2048
+
+typedef struct
+{
+    int channels;
+    int hopSize;
+    int frames;
+    int warmup;
+} AudioBenchConfig;
+
+/* The pre-processing done by AudioCapture before AudioPreprocessor, kept as
+ * a reference: mixdown dividing every sample by the channels number, DC
+ * and RMS in separate passes and the Hann window computed for every sample.
+ * It analyses one whole frame every time, without overlap */
+static double legacyPreprocess(const int16_t *buffer, int frameSize, int channels,
+                               int16_t *mixdown, double *output)
+{
+    for (int i = 0; i < frameSize; i++)
+    {
+        mixdown[i] = 0;
+        for (int j = 0; j < channels; j++)
+            mixdown[i] += buffer[i * channels + j] / channels;
+    }
+
+    long long acc = 0;
+    for (int i = 0; i < frameSize; i++)
+        acc += mixdown[i];
+    const double mean = double(acc) / double(frameSize);
+
+    double sumSq = 0.0;
+    for (int i = 0; i < frameSize; i++)
+    {
+        const double x = (double(mixdown[i]) - mean) / 32768.0;
+        sumSq += x * x;
+        output[i] = x;
+    }
+
+    for (int i = 0; i < frameSize; i++)
+        output[i] = output[i] * (0.5 * (1.0 - qCos((2 * M_PI * i) / (frameSize - 1))));
+
+    return qSqrt(sumSq / double(frameSize));
+}
+
+/* A few seconds of a kick-like low tone, a lead tone and some noise */
+static QVector<int16_t> audioSignal(int channels, int frames)
+{
+    QVector<int16_t> signal(frames * channels);
+    quint32 seed = 12345;
+
+    for (int i = 0; i < frames; i++)
+    {
+        double t = double(i) / AUDIO_SAMPLE_RATE;
+        double value = 0.5 * qSin(2 * M_PI * 55 * t) * ((i % (AUDIO_SAMPLE_RATE / 2)) < 4000 ? 1.0 : 0.2)
+                     + 0.2 * qSin(2 * M_PI * 880 * t);
+
+        for (int c = 0; c < channels; c++)
+        {
+            seed = seed * 1664525 + 1013904223;
+            double noise = (double(seed >> 16) / 65536.0 - 0.5) * 0.05;
+            signal[i * channels + c] = int16_t(qBound(-1.0, value + noise, 1.0) * 32767);
+        }
+    }
+
+    return signal;
+}
+
+static QJsonObject audioReport(PhaseSamples &samples, int frames, double analysesPerSecond)
+{
+    QJsonObject obj = phaseReport(samples, frames);
+    obj["analysesPerSecond"] = analysesPerSecond;
+    // the cost of analysing one second of captured audio
+    obj["nsPerAudioSecond"] = obj["meanNs"].toDouble() * analysesPerSecond;
+    obj["latencyMs"] = 1000.0 / analysesPerSecond;
+
+    return obj;
+}
+
+static QJsonObject runAudioBench(const AudioBenchConfig &config)
+{
+    const int blockFrames = config.hopSize;
+    const int signalFrames = AUDIO_SAMPLE_RATE * 4;
+    QVector<int16_t> signal = audioSignal(config.channels, signalFrames);
+    QVector<int16_t> mixdown(AUDIO_FRAME_SIZE);
+    QVector<double> output(AUDIO_FRAME_SIZE);
+    QElapsedTimer clock;
+    double rmsSum = 0;
+
+    QJsonObject results;
+
+    /* Reference: a whole frame read and analysed at a time */
+    {
+        PhaseSamples samples;
+        samples.nsecs.resize(config.frames);
+        samples.allocations = 0;
+        int position = 0;
+
+        clock.start();
+        for (int f = 0; f < config.warmup + config.frames; f++)
+        {
+            if (position + AUDIO_FRAME_SIZE > signalFrames)
+                position = 0;
+
+            qint64 start = clock.nsecsElapsed();
+            quint32 allocs = s_allocations.loadAcquire();
+
+            rmsSum += legacyPreprocess(signal.constData() + position * config.channels,
+                                       AUDIO_FRAME_SIZE, config.channels,
+                                       mixdown.data(), output.data());
+
+            if (f >= config.warmup)
+            {
+                samples.nsecs[f - config.warmup] = clock.nsecsElapsed() - start;
+                samples.allocations += s_allocations.loadAcquire() - allocs;
+            }
+            position += AUDIO_FRAME_SIZE;
+        }
+
+        results["legacy"] = audioReport(samples, config.frames, double(AUDIO_SAMPLE_RATE) / AUDIO_FRAME_SIZE);
+    }
+
+    /* AudioPreprocessor: a hop read and a whole frame analysed */
+    foreach (QString windowName, AudioPreprocessor::windowTypes())
+    {
+        AudioPreprocessor preprocessor;
+        preprocessor.setWindowType(AudioPreprocessor::stringToWindowType(windowName));
+        preprocessor.setFormat(AUDIO_FRAME_SIZE, config.channels, config.hopSize);
+
+        PhaseSamples samples;
+        samples.nsecs.resize(config.frames);
+        samples.allocations = 0;
+        int position = 0;
+
+        clock.start();
+        for (int f = 0; f < config.warmup + config.frames; f++)
+        {
+            if (position + blockFrames > signalFrames)
+                position = 0;
+
+            qint64 start = clock.nsecsElapsed();
+            quint32 allocs = s_allocations.loadAcquire();
+
+            preprocessor.push(signal.constData() + position * config.channels, blockFrames);
+            rmsSum += preprocessor.process(output.data());
+
+            if (f >= config.warmup)
+            {
+                samples.nsecs[f - config.warmup] = clock.nsecsElapsed() - start;
+                samples.allocations += s_allocations.loadAcquire() - allocs;
+            }
+            position += blockFrames;
+        }
+
+        results[windowName] = audioReport(samples, config.frames, double(AUDIO_SAMPLE_RATE) / config.hopSize);
+    }
+
+    // use the results, so that the compiler can't drop the work
+    results["rmsSum"] = rmsSum;
+
+    return results;
+}
+
+/*****************************************************************************
+ * Report
+ *****************************************************************************/
+
+static void printPhase(QTextStream &out, const QString &name, const QJsonObject &obj)
+{
+    out << QString("%1").arg(name, -12)
+        << QString("%1").arg(qint64(obj["meanNs"].toDouble()), 12)
+        << QString("%1").arg(qint64(obj["medianNs"].toDouble()), 12)
+        << QString("%1").arg(qint64(obj["p99Ns"].toDouble()), 12)
+        << QString("%1").arg(qint64(obj["maxNs"].toDouble()), 12)
+        << QString("%1").arg(obj["allocationsPerTick"].toDouble(), 14, 'f', 1) << "\n";
+}
+
+static void printReport(const QJsonObject &report)
+{
+    QTextStream out(stdout);
+    QJsonObject ws = report["workspace"].toObject();
+    QJsonObject res = report["results"].toObject();
+
+    out << "Universes: " << ws["universes"].toInt()
+        << " (" << ws["patchedUniverses"].toInt() << " patched)"
+        << ", fixtures: " << ws["fixtures"].toInt()
+        << ", scenes: " << ws["scenes"].toInt()
+        << ", chasers: " << ws["chasers"].toInt()
+        << ", EFX: " << ws["efxs"].toInt()
+        << ", matrices: " << ws["matrices"].toInt()
+        << " (" << ws["scriptMatrices"].toInt() << " scripted)\n";
+    out << "Ticks: " << report["config"].toObject()["ticks"].toInt()
+        << " at " << report["tickFrequency"].toInt() << "Hz"
+        << ", allocations counted with " << report["allocator"].toString() << "\n\n";
+
+    out << QString("%1%2%3%4%5%6\n").arg("phase", -12).arg("mean ns", 12).arg("median ns", 12)
+                                    .arg("p99 ns", 12).arg("max ns", 12).arg("allocs/tick", 14);
+
+    QJsonObject phases = res["phases"].toObject();
+    for (int p = 0; p < PhasesCount; p++)
+        printPhase(out, s_phaseNames[p], phases[s_phaseNames[p]].toObject());
+    printPhase(out, "tick", res["tick"].toObject());
+
+    out << "\nOutput: " << qint64(res["outputBytesPerTick"].toDouble()) << " bytes/tick, "
+        << qint64(res["outputBytesPerSecond"].toDouble()) << " bytes/s\n";
+}
+
+static void printAudioReport(const QJsonObject &report)
+{
+    QTextStream out(stdout);
+    QJsonObject cfg = report["config"].toObject();
+    QJsonObject res = report["results"].toObject();
+
+    out << "Audio analysis: " << AUDIO_FRAME_SIZE << " samples frame at " << AUDIO_SAMPLE_RATE << "Hz"
+        << ", " << cfg["channels"].toInt() << " channels, hop " << cfg["hopSize"].toInt()
+        << ", " << cfg["frames"].toInt() << " frames measured\n\n";
+
+    out << QString("%1%2%3%4%5%6%7\n").arg("pipeline", -14).arg("mean ns", 12).arg("p99 ns", 12)
+                                      .arg("frames/s", 10).arg("latency ms", 12).arg("us/audio s", 12)
+                                      .arg("allocs/frame", 14);
+
+    QStringList names;
+    names << "legacy" << AudioPreprocessor::windowTypes();
+    foreach (QString name, names)
+    {
+        QJsonObject obj = res[name].toObject();
+        out << QString("%1").arg(name, -14)
+            << QString("%1").arg(qint64(obj["meanNs"].toDouble()), 12)
+            << QString("%1").arg(qint64(obj["p99Ns"].toDouble()), 12)
+            << QString("%1").arg(obj["analysesPerSecond"].toDouble(), 10, 'f', 1)
+            << QString("%1").arg(obj["latencyMs"].toDouble(), 12, 'f', 1)
+            << QString("%1").arg(obj["nsPerAudioSecond"].toDouble() / 1000.0, 12, 'f', 1)
+            << QString("%1").arg(obj["allocationsPerTick"].toDouble(), 14, 'f', 1) << "\n";
+    }
+}
+
+static bool writeJson(const QJsonObject &report, const QString &jsonPath)
+{
+    QFile file(jsonPath);
+    bool ok = (jsonPath == "-") ? file.open(stdout, QIODevice::WriteOnly)
+                                : file.open(QIODevice::WriteOnly);
+    if (ok == false)
+    {
+        qWarning() << "Unable to write" << jsonPath;
+        return false;
+    }
+
+    file.write(QJsonDocument(report).toJson());
+    file.close();
+
+    return true;
+}
+
+static void messageHandler(QtMsgType type, const QMessageLogContext &context, const QString &msg)
+{
+    Q_UNUSED(context)
+
+    // the engine is quite verbose while building the workspace
+    if (type == QtDebugMsg || type == QtInfoMsg)
+        return;
+
+    fprintf(stderr, "%s\n", qPrintable(msg));
+}
+
+/*****************************************************************************
+ * Main
+ *****************************************************************************/
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("qlcplus-bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Measure the QLC+ engine tick pipeline on a synthetic workspace");
+    parser.addHelpOption();
+
+    QCommandLineOption universesOption("universes", "Number of universes", "N", "4");
+    QCommandLineOption dimmersOption("fixtures", "Dimmer fixtures per universe (max 64)", "M", "32");
+    QCommandLineOption scenesOption("scenes", "Scenes per universe, chased in a loop", "S", "8");
+    QCommandLineOption ticksOption("ticks", "Number of ticks measured", "T", "1000");
+    QCommandLineOption warmupOption("warmup", "Number of ticks run before measuring", "W", "100");
+    QCommandLineOption pluginsOption("plugins", "Directory of the I/O plugin stub", "dir", "../test/iopluginstub");
+    QCommandLineOption scriptsOption("scripts", "Directory of the RGB scripts", "dir");
+    QCommandLineOption scriptOption("script", "RGB script run by the scripted matrices", "name", DEFAULT_SCRIPT);
+    QCommandLineOption jsonOption("json", "Write the results as JSON to the given file ('-' for stdout)", "file");
+    QCommandLineOption maxAllocOption("max-allocations",
+                                      "Fail if a tick allocates more than the given amount on average", "N");
+    QCommandLineOption verboseOption("verbose", "Show the engine debug messages");
+    QCommandLineOption audioOption("audio", "Measure the audio capture pre-processing instead of the tick pipeline");
+    QCommandLineOption audioChannelsOption("audio-channels", "Channels of the captured audio", "C", "2");
+    QCommandLineOption audioHopOption("audio-hop", "Samples captured between two audio analyses", "H", "1024");
+
+    parser.addOptions({ universesOption, dimmersOption, scenesOption, ticksOption, warmupOption,
+                        pluginsOption, scriptsOption, scriptOption, jsonOption, maxAllocOption, verboseOption,
+                        audioOption, audioChannelsOption, audioHopOption });
+    parser.process(app);
+
+    if (parser.isSet(verboseOption) == false)
+        qInstallMessageHandler(messageHandler);
+
+    if (parser.isSet(audioOption))
+    {
+        AudioBenchConfig audioConfig;
+        audioConfig.channels = qBound(1, parser.value(audioChannelsOption).toInt(), 8);
+        audioConfig.hopSize = qBound(64, parser.value(audioHopOption).toInt(), AUDIO_FRAME_SIZE);
+        audioConfig.frames = qMax(1, parser.value(ticksOption).toInt());
+        audioConfig.warmup = qMax(0, parser.value(warmupOption).toInt());
+
+        QJsonObject cfg;
+        cfg["channels"] = audioConfig.channels;
+        cfg["hopSize"] = audioConfig.hopSize;
+        cfg["frames"] = audioConfig.frames;
+        cfg["warmup"] = audioConfig.warmup;
+
+        QJsonObject report;
+        report["config"] = cfg;
+        report["allocator"] = ALLOCATOR_NAME;
+        report["results"] = runAudioBench(audioConfig);
+
+        QString jsonPath = parser.value(jsonOption);
+        if (jsonPath != "-")
+            printAudioReport(report);
+        if (jsonPath.isEmpty() == false && writeJson(report, jsonPath) == false)
+            return 1;
+
+        return 0;
+    }
+
+    BenchConfig config;
+    config.universes = qMax(1, parser.value(universesOption).toInt());
+    config.dimmers = qBound(0, parser.value(dimmersOption).toInt(), MAX_DIMMERS);
+    config.scenes = qMax(1, parser.value(scenesOption).toInt());
+    config.ticks = qMax(1, parser.value(ticksOption).toInt());
+    config.warmup = qMax(0, parser.value(warmupOption).toInt());
+    config.pluginDir = parser.value(pluginsOption);
+    config.script = parser.value(scriptOption);
+
+    if (parser.isSet(scriptsOption))
+        config.scriptDir = parser.value(scriptsOption);
+    else if (QDir("../../resources/rgbscripts").exists())
+        config.scriptDir = "../../resources/rgbscripts";
+    else
+        config.scriptDir = RGBScriptsCache::systemScriptsDirectory().absolutePath();
+
+    Doc *doc = new Doc(NULL, config.universes);
+    doc->ioPluginCache()->load(QDir(config.pluginDir));
+    if (doc->ioPluginCache()->plugin(STUB_PLUGIN_NAME) == NULL)
+        qWarning() << "I/O plugin stub not found in" << config.pluginDir << "- output is not measured";
+
+    doc->rgbScriptsCache()->load(QDir(config.scriptDir));
+    if (doc->rgbScriptsCache()->names().contains(config.script) == false)
+        qWarning() << "RGB script" << config.script << "not found in" << config.scriptDir;
+
+    BenchWorkspace ws = buildWorkspace(doc, config);
+
+    doc->setMode(Doc::Operate);
+    foreach (Function *function, doc->functions())
+    {
+        // scenes are started by the chasers
+        if (function->type() != Function::SceneType)
+            function->start(doc->masterTimer(), FunctionParent::master());
+    }
+
+    QJsonObject cfg;
+    cfg["universes"] = config.universes;
+    cfg["fixtures"] = config.dimmers;
+    cfg["scenes"] = config.scenes;
+    cfg["ticks"] = config.ticks;
+    cfg["warmup"] = config.warmup;
+    cfg["script"] = config.script;
+
+    QJsonObject workspace;
+    workspace["universes"] = config.universes;
+    workspace["patchedUniverses"] = ws.patchedUniverses;
+    workspace["fixtures"] = ws.fixtures;
+    workspace["scenes"] = ws.scenes;
+    workspace["chasers"] = ws.chasers;
+    workspace["efxs"] = ws.efxs;
+    workspace["matrices"] = ws.matrices;
+    workspace["scriptMatrices"] = ws.scriptMatrices;
+
+    QJsonObject report;
+    report["config"] = cfg;
+    report["workspace"] = workspace;
+    report["allocator"] = ALLOCATOR_NAME;
+    report["tickFrequency"] = int(MasterTimer::frequency());
+    report["results"] = runBench(doc, config);
+
+    QString jsonPath = parser.value(jsonOption);
+    int ret = 0;
+
+    // the JSON report replaces the text one on stdout
+    if (jsonPath != "-")
+        printReport(report);
+
+    if (jsonPath.isEmpty() == false && writeJson(report, jsonPath) == false)
+        ret = 1;
+
+    // a steady state tick is expected not to allocate at all,
+    // so this can be used to catch regressions in the tick path
+    if (parser.isSet(maxAllocOption))
+    {
+        double allocations = report["results"].toObject()["tick"].toObject()["allocationsPerTick"].toDouble();
+        if (allocations > parser.value(maxAllocOption).toDouble())
+        {
+            qWarning() << "Allocations per tick exceeded:" << allocations;
+            ret = 2;
+        }
+    }
+
+    qDeleteAll(ws.sources);
+    delete doc;
+
+    return ret;
+}
@@ -4,4 +4,5 @@ SUBDIRS += audio
 SUBDIRS += src
 !android:!ios {
   SUBDIRS += test
+  SUBDIRS += bench
 }
@@ -0,0 +1,291 @@
+/*
+  Q Light Controller Plus
+  beatclock.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QDeadlineTimer>
+#include <QMutexLocker>
+#include <QDebug>
+#include <qmath.h>
+
+#include "beatclock.h"
+
+#define NSECS_PER_MINUTE    60000000000.0
+
+/* Intervals within this ratio of the period refine the tempo.
+ * Others are missed or extra beats, unless they repeat */
+#define TEMPO_MIN_RATIO     0.8
+#define TEMPO_MAX_RATIO     1.25
+
+/* How close two intervals out of the tempo must be to relock on them */
+#define RELOCK_TOLERANCE    0.1
+
+/* Weight of a beat in the confidence */
+#define CONFIDENCE_GAIN     0.3
+
+/* Beats that can be missed before the confidence decreases */
+#define CONFIDENCE_MISSED   2.0
+
+BeatClock::BeatClock()
+    : m_period(0)
+    , m_anchorPosition(0)
+    , m_anchorTime(0)
+    , m_rate(0)
+    , m_lastBeatTime(-1)
+    , m_pendingInterval(0)
+    , m_confidence(0)
+    , m_beatsPerBar(4)
+    , m_barOrigin(0)
+{
+}
+
+BeatClock::~BeatClock()
+{
+}
+
+qint64 BeatClock::now() const
+{
+    return QDeadlineTimer::current(Qt::PreciseTimer).deadlineNSecs();
+}
+
+/*********************************************************************
+ * Sources
+ *********************************************************************/
+
+void BeatClock::setTempo(double bpm, qint64 time)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (time < 0)
+        time = now();
+
+    double position = positionAt(time);
+
+    m_lastBeatTime = -1;
+    m_pendingInterval = 0;
+
+    if (bpm <= 0)
+    {
+        m_period = 0;
+        m_confidence = 0;
+        anchor(time, position, 0);
+        return;
+    }
+
+    m_period = NSECS_PER_MINUTE / bpm;
+    m_confidence = 1.0;
+    anchor(time, position, 1.0 / m_period);
+}
+
+void BeatClock::beatReceived(qint64 time, double weight)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (time < 0)
+        time = now();
+
+    weight = qBound(0.0, weight, 1.0);
+
+    double position = positionAt(time);
+    qint64 interval = m_lastBeatTime >= 0 ? time - m_lastBeatTime : 0;
+    m_lastBeatTime = time;
+
+    /* 1) tempo, from the interval with the previous beat */
+    const double minPeriod = NSECS_PER_MINUTE / BEATCLOCK_MAX_BPM;
+    const double maxPeriod = NSECS_PER_MINUTE / BEATCLOCK_MIN_BPM;
+    bool locked = false;
+    double phaseGain = BEATCLOCK_PHASE_GAIN * weight;
+
+    if (interval >= minPeriod && interval <= maxPeriod)
+    {
+        double ratio = m_period > 0 ? interval / m_period : 0;
+
+        if (m_period == 0)
+        {
+            m_period = interval;
+            locked = true;
+        }
+        else if (ratio >= TEMPO_MIN_RATIO && ratio <= TEMPO_MAX_RATIO)
+        {
+            m_period += BEATCLOCK_TEMPO_GAIN * weight * (interval - m_period);
+            m_pendingInterval = 0;
+        }
+        else if (m_pendingInterval > 0 &&
+                 qAbs(interval - m_pendingInterval) < RELOCK_TOLERANCE * m_pendingInterval)
+        {
+            // the source has really changed tempo: follow it
+            // and recover the whole phase error at once
+            qDebug() << "[BeatClock] relock from" << NSECS_PER_MINUTE / m_period << "BPM to"
+                     << NSECS_PER_MINUTE * 2.0 / (interval + m_pendingInterval) << "BPM";
+            m_period = (interval + m_pendingInterval) / 2.0;
+            m_pendingInterval = 0;
+            phaseGain = 1.0;
+        }
+        else
+        {
+            m_pendingInterval = interval;
+        }
+    }
+
+    /* 2) phase */
+    if (m_period == 0)
+    {
+        // no tempo yet: step to the next beat and wait there
+        anchor(time, qFloor(position) + 1, 0);
+        m_confidence = 0;
+        return;
+    }
+
+    if (locked || m_rate == 0)
+    {
+        // the clock was waiting on the previous beat
+        anchor(time, qFloor(position) + 1, 1.0 / m_period);
+        m_confidence = CONFIDENCE_GAIN * weight;
+        return;
+    }
+
+    // steer the speed for the next period so that the position
+    // converges to an integer on the beats, without ever jumping
+    double error = position - qRound(position);
+    anchor(time, position, (1.0 - phaseGain * error) / m_period);
+
+    double accuracy = (1.0 - 2.0 * qAbs(error)) * weight;
+    m_confidence += CONFIDENCE_GAIN * (accuracy - m_confidence);
+}
+
+void BeatClock::tempoReceived(double bpm, qint64 time)
+{
+    if (bpm < BEATCLOCK_MIN_BPM || bpm > BEATCLOCK_MAX_BPM)
+        return;
+
+    QMutexLocker locker(&m_mutex);
+
+    if (time < 0)
+        time = now();
+
+    double position = positionAt(time);
+
+    m_period = NSECS_PER_MINUTE / bpm;
+    m_pendingInterval = 0;
+
+    // a stopped clock starts on the next beat
+    if (m_rate > 0)
+        anchor(time, position, 1.0 / m_period);
+}
+
+void BeatClock::reset(qint64 time)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (time < 0)
+        time = now();
+
+    anchor(time, positionAt(time), 0);
+    m_period = 0;
+    m_lastBeatTime = -1;
+    m_pendingInterval = 0;
+    m_confidence = 0;
+}
+
+double BeatClock::positionAt(qint64 time) const
+{
+    if (m_rate <= 0)
+        return m_anchorPosition;
+
+    double elapsed = qMax(qint64(0), time - m_anchorTime);
+
+    // the phase correction lasts for one period,
+    // then the clock runs at the tempo
+    if (m_period > 0 && elapsed > m_period)
+        return m_anchorPosition + m_rate * m_period + (elapsed - m_period) / m_period;
+
+    return m_anchorPosition + m_rate * elapsed;
+}
+
+void BeatClock::anchor(qint64 time, double position, double rate)
+{
+    m_anchorTime = time;
+    m_anchorPosition = position;
+    m_rate = rate;
+}
+
+/*********************************************************************
+ * Position
+ *********************************************************************/
+
+double BeatClock::position(qint64 time) const
+{
+    QMutexLocker locker(&m_mutex);
+    return positionAt(time < 0 ? now() : time);
+}
+
+double BeatClock::bpm() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_period > 0 ? NSECS_PER_MINUTE / m_period : 0;
+}
+
+double BeatClock::confidence(qint64 time) const
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (m_lastBeatTime < 0 || m_period == 0)
+        return m_confidence;
+
+    if (time < 0)
+        time = now();
+
+    double missed = (time - m_lastBeatTime) / m_period - CONFIDENCE_MISSED;
+    if (missed <= 0)
+        return m_confidence;
+
+    // halve for every further beat missed
+    return m_confidence * qPow(0.5, missed);
+}
+
+void BeatClock::setBeatsPerBar(int beats)
+{
+    QMutexLocker locker(&m_mutex);
+    m_beatsPerBar = qMax(1, beats);
+}
+
+int BeatClock::beatsPerBar() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_beatsPerBar;
+}
+
+void BeatClock::alignBar(int beatNumber, qint64 time)
+{
+    if (beatNumber < 0)
+        return;
+
+    QMutexLocker locker(&m_mutex);
+
+    if (time < 0)
+        time = now();
+
+    // the beat is the closest integer position
+    m_barOrigin = qRound64(positionAt(time)) - beatNumber;
+}
+
+double BeatClock::barPosition(double position) const
+{
+    QMutexLocker locker(&m_mutex);
+    position -= m_barOrigin;
+    return position - qFloor(position / m_beatsPerBar) * m_beatsPerBar;
+}
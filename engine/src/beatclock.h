@@ -0,0 +1,163 @@
+/*
+  Q Light Controller Plus
+  beatclock.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef BEATCLOCK_H
+#define BEATCLOCK_H
+
+#include <QMutex>
+
+/** @addtogroup engine Engine
+ * @{
+ */
+
+/** Tempo range accepted from the beat sources */
+#define BEATCLOCK_MIN_BPM       30
+#define BEATCLOCK_MAX_BPM       300
+
+/** How much of the interval between two beats corrects the tempo */
+#define BEATCLOCK_TEMPO_GAIN    0.25
+
+/** How much of the phase error is recovered within the next beat */
+#define BEATCLOCK_PHASE_GAIN    0.5
+
+/**
+ * BeatClock is the musical time of the engine: a continuous beat position
+ * (beats since the clock started, with the phase of the current beat as
+ * fractional part) that can be read at any time, with sub-tick precision.
+ *
+ * The clock either runs freely at a given tempo (the internal generator),
+ * or is driven by the beats received from an external source (audio beat
+ * tracker, OS2L, MIDI clock). In the latter case it is phase-locked to the
+ * beats: each beat corrects the tempo with the measured interval and the
+ * phase by steering the speed of the clock until the next beat, so the
+ * position never jumps and jitter in the beat timestamps is filtered out.
+ * When the source stops sending beats the clock keeps running at the last
+ * tempo, with a decreasing confidence.
+ *
+ * Times are in nanoseconds of the clock time base, see now(). All the
+ * methods are thread safe.
+ */
+class BeatClock final
+{
+public:
+    BeatClock();
+    ~BeatClock();
+
+    /** Get the current time of the clock, in ns. This is the same
+     *  time base of QLCIOPlugin::clockTimestamp() */
+    qint64 now() const;
+
+    /*********************************************************************
+     * Sources
+     *********************************************************************/
+public:
+    /**
+     * Run freely at $bpm from $time (or now() if -1), keeping the current
+     * position. This is how the internal generator drives the clock.
+     */
+    void setTempo(double bpm, qint64 time = -1);
+
+    /**
+     * Lock the clock to a beat received at $time (or now() if -1) from an
+     * external source. $weight, in [0, 1], is how much the source trusts
+     * the beat and scales the corrections it makes.
+     */
+    void beatReceived(qint64 time = -1, double weight = 1.0);
+
+    /**
+     * Set the tempo measured by an external source at $time (or now() if
+     * -1), like a MIDI clock. This is more accurate than the intervals of
+     * the beats, so it replaces the current tempo, keeping the position.
+     * The phase still follows the beats received.
+     */
+    void tempoReceived(double bpm, qint64 time = -1);
+
+    /** Forget the tempo and wait for the next beats, keeping the position */
+    void reset(qint64 time = -1);
+
+private:
+    /** Get the position at $time. Must be called with m_mutex locked */
+    double positionAt(qint64 time) const;
+
+    /** Restart the clock from $position at $time, running at $rate
+     *  beats per ns until the next beat. Must be called with m_mutex locked */
+    void anchor(qint64 time, double position, double rate);
+
+    /*********************************************************************
+     * Position
+     *********************************************************************/
+public:
+    /** Get the beat position at $time (or now() if -1). The integer
+     *  part is the number of beats since the clock started */
+    double position(qint64 time) const;
+
+    /** Get the current tempo in beats per minute, 0 if unknown */
+    double bpm() const;
+
+    /** Get how reliable the position is at $time (or now() if -1), in
+     *  [0, 1]. This decreases when the external source misses its beats */
+    double confidence(qint64 time) const;
+
+    /** Set the number of beats of a bar */
+    void setBeatsPerBar(int beats);
+    int beatsPerBar() const;
+
+    /**
+     * Align the bars to the number of the beat received at $time (or now()
+     * if -1), counted by the source from its transport start, so that its
+     * beat 0 starts a bar. The position doesn't change.
+     */
+    void alignBar(int beatNumber, qint64 time = -1);
+
+    /** Get the position of $position within its bar, in beats */
+    double barPosition(double position) const;
+
+private:
+    mutable QMutex m_mutex;
+
+    /** Duration of a beat in ns, 0 when the tempo is unknown */
+    double m_period;
+
+    /** The position at m_anchorTime */
+    double m_anchorPosition;
+    qint64 m_anchorTime;
+
+    /** Beats per ns from m_anchorTime for one period, including
+     *  the phase correction. The clock is stopped when 0 */
+    double m_rate;
+
+    /** Time of the last beat received, -1 if none */
+    qint64 m_lastBeatTime;
+
+    /** An interval far from the tempo, waiting for another
+     *  one to confirm that the tempo has changed */
+    qint64 m_pendingInterval;
+
+    /** Confidence at m_lastBeatTime */
+    double m_confidence;
+
+    int m_beatsPerBar;
+
+    /** The position where the bars are counted from */
+    qint64 m_barOrigin;
+};
+
+/** @} */
+
+#endif
@@ -24,6 +24,7 @@
 #include <QRandomGenerator>
 #endif
 #include <QDebug>
+#include <qmath.h>
 
 #include "chaserrunner.h"
 #include "mastertimer.h"
@@ -43,6 +44,10 @@ ChaserRunner::ChaserRunner(const Doc *doc, const Chaser *chaser, quint32 startTi
     , m_lastFunctionID(Function::invalidId())
     , m_roundTime(new QElapsedTimer())
     , m_order()
+    , m_nextStepBeat(-1)
+    , m_preparedStep(NULL)
+    , m_preparedFunctionID(Function::invalidId())
+    , m_nextStepPrepared(false)
 {
     Q_ASSERT(chaser != NULL);
 
@@ -84,6 +89,7 @@ ChaserRunner::ChaserRunner(const Doc *doc, const Chaser *chaser, quint32 startTi
 ChaserRunner::~ChaserRunner()
 {
     clearRunningList();
+    clearPreparedStep();
     delete m_roundTime;
 }
 
@@ -95,6 +101,10 @@ void ChaserRunner::slotChaserChanged()
 {
     // Handle (possible) speed change on the next write() pass
     m_updateOverrideSpeeds = true;
+
+    // steps might have been moved or removed: look for the next one again
+    clearPreparedStep();
+    m_nextStepPrepared = false;
     QList<ChaserRunnerStep*> delList;
     foreach (ChaserRunnerStep *step, m_runnerSteps)
     {
@@ -487,13 +497,21 @@ void ChaserRunner::startNewStep(int index, MasterTimer *timer, qreal mIntensity,
     if (index < 0 || index >= m_chaser->stepsCount())
         index = 0; // fallback to the first step
 
-    ChaserStep step(m_chaser->steps().at(index));
-    Function *func = m_doc->function(step.fid);
-    if (func == NULL)
-        return;
+    // most of the times the step has been resolved while the previous one was running
+    ChaserRunnerStep *newStep = takePreparedStep(index);
+    if (newStep == NULL)
+    {
+        Function *function = m_doc->function(m_chaser->steps().at(index).fid);
+        if (function == NULL)
+            return;
 
-    ChaserRunnerStep *newStep = new ChaserRunnerStep();
-    newStep->m_index = index;
+        newStep = new ChaserRunnerStep();
+        newStep->m_index = index;
+        newStep->m_function = function;
+    }
+
+    Function *func = newStep->m_function;
+    m_nextStepPrepared = false;
 
     // check if blending between Scenes is needed
     if (m_lastFunctionID != Function::invalidId() &&
@@ -544,14 +562,22 @@ void ChaserRunner::startNewStep(int index, MasterTimer *timer, qreal mIntensity,
         newStep->m_elapsed = m_startOffset + MasterTimer::tick();
     else
         newStep->m_elapsed = MasterTimer::tick() + elapsed;
-    newStep->m_elapsedBeats = 0; //(newStep->m_elapsed / timer->beatTimeDuration()) * 1000;
+    newStep->m_elapsedBeats = 0;
 
-    m_startOffset = 0;
+    // start counting the beats where the previous step ended, so the
+    // steps stay locked to the beat clock, or from the current beat
+    if (m_nextStepBeat >= 0)
+        newStep->m_beatStart = m_nextStepBeat;
+    else
+        newStep->m_beatStart = qFloor(timer->beatPosition());
+    newStep->m_beatStartElapsed = 0;
+    m_nextStepBeat = -1;
 
-    newStep->m_function = func;
+    m_startOffset = 0;
 
     if (m_chaser->type() == Function::SequenceType)
     {
+        ChaserStep step(m_chaser->steps().at(index));
         Scene *s = qobject_cast<Scene*>(func);
         // blind == true is a workaround to reuse the same scene
         // without messing up the previous values
@@ -584,6 +610,60 @@ void ChaserRunner::startNewStep(int index, MasterTimer *timer, qreal mIntensity,
     m_roundTime->restart();
 }
 
+void ChaserRunner::prepareStep(int index)
+{
+    clearPreparedStep();
+    m_nextStepPrepared = true;
+
+    if (index < 0 || index >= m_chaser->stepsCount())
+        return;
+
+    quint32 fid = m_chaser->steps().at(index).fid;
+    Function *func = m_doc->function(fid);
+    if (func == NULL)
+        return;
+
+    // a Sequence sets the values of its Scene when a step starts,
+    // so there is nothing to resolve in advance in that case
+    if (func->type() == Function::SceneType && m_chaser->type() != Function::SequenceType)
+    {
+        Scene *scene = qobject_cast<Scene *>(func);
+        scene->prepareValues();
+    }
+
+    m_preparedStep = new ChaserRunnerStep();
+    m_preparedStep->m_index = index;
+    m_preparedStep->m_function = func;
+    m_preparedFunctionID = fid;
+}
+
+ChaserRunnerStep *ChaserRunner::takePreparedStep(int index)
+{
+    ChaserRunnerStep *step = m_preparedStep;
+    m_preparedStep = NULL;
+
+    if (step == NULL)
+        return NULL;
+
+    // a different step is requested (e.g. by the user),
+    // or the steps have been edited in the meantime
+    if (step->m_index != index || index >= m_chaser->stepsCount() ||
+        m_chaser->steps().at(index).fid != m_preparedFunctionID)
+    {
+        delete step;
+        return NULL;
+    }
+
+    return step;
+}
+
+void ChaserRunner::clearPreparedStep()
+{
+    delete m_preparedStep;
+    m_preparedStep = NULL;
+    m_preparedFunctionID = Function::invalidId();
+}
+
 int ChaserRunner::getNextStepIndex()
 {
     int currentStepIndex = m_lastRunStepIdx;
@@ -713,7 +793,12 @@ void ChaserRunner::setPause(bool enable, QList<Universe *> universes)
     qDebug() << "[ChaserRunner] processing pause request:" << enable;
 
     foreach (ChaserRunnerStep *step, m_runnerSteps)
+    {
         step->m_function->setPause(enable);
+        // the beats elapsed while paused are not counted
+        if (enable == false)
+            step->m_beatStart = -1;
+    }
 
     // there might be a Scene fading out, so request pause
     // to faders bound to the Scene ID running on universes
@@ -769,10 +854,19 @@ bool ChaserRunner::write(MasterTimer *timer, QList<Universe *> universes)
 
     foreach (ChaserRunnerStep *step, m_runnerSteps)
     {
-        if (m_chaser->tempoType() == Function::Beats && timer->isBeat())
+        if (m_chaser->tempoType() == Function::Beats)
         {
-            step->m_elapsedBeats += 1000;
-            qDebug() << "[ChaserRunner] Function" << step->m_function->name() << "duration:" << step->m_duration << "beats:" << step->m_elapsedBeats;
+            double position = timer->beatPosition();
+            if (step->m_beatStart < 0)
+            {
+                step->m_beatStart = position;
+                step->m_beatStartElapsed = step->m_elapsedBeats;
+            }
+
+            // measured from the step start on every tick,
+            // so that the rounding errors don't add up
+            double elapsed = step->m_beatStartElapsed + (position - step->m_beatStart) * 1000.0;
+            step->m_elapsedBeats = elapsed < UINT_MAX ? quint32(qRound64(qMax(0.0, elapsed))) : UINT_MAX;
         }
 
         if (step->m_duration != Function::infiniteSpeed() &&
@@ -782,6 +876,9 @@ bool ChaserRunner::write(MasterTimer *timer, QList<Universe *> universes)
             if (step->m_duration != 0)
                 prevStepRoundElapsed = step->m_elapsed % step->m_duration;
 
+            if (m_chaser->tempoType() == Function::Beats)
+                m_nextStepBeat = step->m_beatStart + (double(step->m_duration) - step->m_beatStartElapsed) / 1000.0;
+
             m_lastFunctionID = step->m_function->type() == Function::SceneType ? step->m_function->id() : Function::invalidId();
             step->m_function->stop(functionParent(), m_chaser->type() == Function::SequenceType);
             m_runnerSteps.removeOne(step);
@@ -792,6 +889,11 @@ bool ChaserRunner::write(MasterTimer *timer, QList<Universe *> universes)
             if (step->m_elapsed < UINT_MAX)
                 step->m_elapsed += MasterTimer::tick();
 
+            // resolve the next step while the current one is running. This is
+            // not done in the same tick a step starts, to spread the load
+            if (m_nextStepPrepared == false && step->m_index == m_lastRunStepIdx)
+                prepareStep(computeNextStep(m_lastRunStepIdx));
+
             // When the speeds of the chaser change, they need to be updated to the lower
             // level (only current function) as well. Otherwise the new speeds would take
             // effect only on the next step change.
@@ -46,6 +46,8 @@ typedef struct
     Function *m_function;               //! Currently active function
     quint32 m_elapsed;                  //! Elapsed milliseconds
     quint32 m_elapsedBeats;             //! Elapsed beats
+    double m_beatStart;                 //! Beat position the elapsed beats are counted from
+    quint32 m_beatStartElapsed;         //! Elapsed beats at m_beatStart
     uint m_fadeIn;                      //! Step fade in in ms
     uint m_fadeOut;                     //! Step fade out in ms
     uint m_duration;                    //! Step hold in ms
@@ -158,6 +160,7 @@ private:
     quint32 m_lastFunctionID;               //! ID of the last Function ran (Scene only)
     QElapsedTimer *m_roundTime;             //! Counts the time between steps
     QVector<int> m_order;                   //! Array of step indices in a randomized order
+    double m_nextStepBeat;                  //! Beat position where the last Beats step ended, -1 if none
 
     /************************************************************************
      * Intensity
@@ -195,6 +198,29 @@ private:
      */
     int getNextStepIndex();
 
+    /**
+     * Resolve the step with the given $index ahead of time: look up its
+     * Function and, for Scenes, resolve their channels. This is done while
+     * the previous step is running, so that the tick ending it can start
+     * the next one straight away.
+     */
+    void prepareStep(int index);
+
+    /**
+     * Return the prepared step if it is the one with the given $index
+     * and its Function has not been replaced meanwhile, otherwise NULL.
+     * The step is handed over to the caller.
+     */
+    ChaserRunnerStep *takePreparedStep(int index);
+
+    /** Discard the prepared step, if any */
+    void clearPreparedStep();
+
+private:
+    ChaserRunnerStep *m_preparedStep;       //! The next step, resolved ahead of time
+    quint32 m_preparedFunctionID;           //! ID of the Function of m_preparedStep
+    bool m_nextStepPrepared;                //! The next step has been looked for since the last start
+
 private:
     FunctionParent functionParent() const;
 
@@ -72,6 +72,7 @@ Doc::Doc(QObject* parent, int universes)
     , m_loadStatus(Cleared)
     , m_clipboard(new QLCClipboard(this))
     , m_fixturesListCacheUpToDate(false)
+    , m_universeFixturesUpToDate(false)
     , m_latestFixtureId(0)
     , m_latestFixtureGroupId(0)
     , m_latestChannelsGroupId(0)
@@ -179,6 +180,7 @@ void Doc::clearContents()
         emit fixtureRemoved(fxID);
     }
     m_fixturesListCacheUpToDate = false;
+    m_universeFixturesUpToDate = false;
 
     m_orderedGroups.clear();
 
@@ -402,6 +404,37 @@ quint32 Doc::createFixtureId()
     return m_latestFixtureId;
 }
 
+/**
+ * Inform the universes of the coarse/fine channel pairs of $fixture.
+ * The coarse channel is not always the one before its fine channel, and
+ * the two might even be split across two universes. Such a pair can't
+ * be mixed as a whole, so it is left to the 8 bit behaviour.
+ */
+static void setFixtureFineChannels(Fixture *fixture, const QList<Universe *> &universes)
+{
+    QLCFixtureMode *mode = fixture->fixtureMode();
+    if (mode == NULL)
+        return;
+
+    quint32 baseAddress = fixture->universeAddress();
+
+    for (quint32 i = 0; i < fixture->channels(); i++)
+    {
+        quint32 coarse = mode->primaryChannel(i);
+        if (coarse == QLCChannel::invalid() || coarse >= fixture->channels())
+            continue;
+
+        quint32 coarseAddress = baseAddress + coarse;
+        quint32 fineAddress = baseAddress + i;
+        quint32 uni = coarseAddress / UNIVERSE_SIZE;
+
+        if (uni != fineAddress / UNIVERSE_SIZE || uni >= quint32(universes.count()))
+            continue;
+
+        universes.at(uni)->setChannelFine(coarseAddress % UNIVERSE_SIZE, fineAddress % UNIVERSE_SIZE);
+    }
+}
+
 bool Doc::addFixture(Fixture* fixture, quint32 id, bool crossUniverse)
 {
     Q_ASSERT(fixture != NULL);
@@ -433,6 +466,7 @@ bool Doc::addFixture(Fixture* fixture, quint32 id, bool crossUniverse)
     fixture->setID(id);
     m_fixtures.insert(id, fixture);
     m_fixturesListCacheUpToDate = false;
+    m_universeFixturesUpToDate = false;
 
     /* Patch fixture change signals thru Doc */
     connect(fixture, SIGNAL(changed(quint32)),
@@ -488,6 +522,10 @@ bool Doc::addFixture(Fixture* fixture, quint32 id, bool crossUniverse)
         ChannelModifier *mod = fixture->channelModifier(i);
         universes.at(uni)->setChannelModifier(addr, mod);
     }
+
+    // Inform Universes of coarse/fine channel pairs, once all
+    // the channels capabilities are set
+    setFixtureFineChannels(fixture, universes);
     inputOutputMap()->releaseUniverses(true);
 
     emit fixtureAdded(id);
@@ -503,6 +541,7 @@ bool Doc::deleteFixture(quint32 id)
         Fixture* fxi = m_fixtures.take(id);
         Q_ASSERT(fxi != NULL);
         m_fixturesListCacheUpToDate = false;
+        m_universeFixturesUpToDate = false;
 
         /* Keep track of fixture addresses */
         QMutableHashIterator <uint,uint> it(m_addresses);
@@ -542,6 +581,7 @@ bool Doc::replaceFixtures(QList<Fixture*> newFixturesList)
                    this, SLOT(slotFixtureChanged(quint32)));
         delete fxi;
         m_fixturesListCacheUpToDate = false;
+        m_universeFixturesUpToDate = false;
     }
     m_latestFixtureId = 0;
     m_addresses.clear();
@@ -599,6 +639,7 @@ bool Doc::replaceFixtures(QList<Fixture*> newFixturesList)
 
         m_fixtures.insert(id, newFixture);
         m_fixturesListCacheUpToDate = false;
+        m_universeFixturesUpToDate = false;
 
         /* Patch fixture change signals thru Doc */
         connect(newFixture, SIGNAL(changed(quint32)),
@@ -653,6 +694,9 @@ bool Doc::updateFixtureChannelCapabilities(quint32 id, QList<int> forcedHTP, QLi
         universe->setChannelModifier(fxAddress + i, mod);
     }
 
+    // Inform Universes of coarse/fine channel pairs
+    setFixtureFineChannels(fixture, universes);
+
     inputOutputMap()->releaseUniverses(true);
 
     return true;
@@ -686,6 +730,36 @@ Fixture* Doc::fixture(quint32 id) const
     return m_fixtures.value(id, NULL);
 }
 
+static bool fixtureAddressLessThan(const Fixture *a, const Fixture *b)
+{
+    return a->address() < b->address();
+}
+
+QVector<Fixture*> const& Doc::fixturesInUniverse(quint32 universe) const
+{
+    if (!m_universeFixturesUpToDate)
+    {
+        QHash<quint32, QVector<Fixture*> > &index =
+            const_cast<QHash<quint32, QVector<Fixture*> >&>(m_universeFixtures);
+        index.clear();
+
+        foreach (Fixture *fixture, m_fixtures)
+            index[fixture->universe()].append(fixture);
+
+        QMutableHashIterator<quint32, QVector<Fixture*> > it(index);
+        while (it.hasNext())
+        {
+            it.next();
+            std::sort(it.value().begin(), it.value().end(), fixtureAddressLessThan);
+        }
+        const_cast<bool&>(m_universeFixturesUpToDate) = true;
+    }
+
+    static const QVector<Fixture*> noFixtures;
+    QHash<quint32, QVector<Fixture*> >::const_iterator it = m_universeFixtures.constFind(universe);
+    return it == m_universeFixtures.constEnd() ? noFixtures : it.value();
+}
+
 quint32 Doc::fixtureForAddress(quint32 universeAddress) const
 {
     return m_addresses.value(universeAddress, Fixture::invalidId());
@@ -723,6 +797,8 @@ int Doc::totalPowerConsumption(int& fuzzy) const
 
 void Doc::slotFixtureChanged(quint32 id)
 {
+    m_universeFixturesUpToDate = false;
+
     /* Keep track of fixture addresses */
     Fixture* fxi = fixture(id);
 
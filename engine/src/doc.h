@@ -306,6 +306,13 @@ public:
      */
     int fixturesCount() const;
 
+    /**
+     * Get the fixtures patched on the given universe, ordered by address.
+     * The index is rebuilt only when fixtures are added, removed or changed,
+     * so this can be called on every universe update.
+     */
+    QVector<Fixture*> const& fixturesInUniverse(quint32 universe) const;
+
     /**
      * Get the fixture that occupies the given DMX address. If multiple fixtures
      * occupy the same address, the one that has been last modified is returned.
@@ -352,6 +359,10 @@ protected:
     bool m_fixturesListCacheUpToDate;
     QList<Fixture*> m_fixturesListCache;
 
+    /** Fixtures of each universe, ordered by address */
+    bool m_universeFixturesUpToDate;
+    QHash<quint32, QVector<Fixture*> > m_universeFixtures;
+
     /** Map of the addresses occupied by fixtures */
     QHash <quint32, quint32> m_addresses;
 
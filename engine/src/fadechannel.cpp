@@ -31,6 +31,7 @@ FadeChannel::FadeChannel()
     , m_fixture(Fixture::invalidId())
     , m_universe(Universe::invalid())
     , m_primaryChannel(QLCChannel::invalid())
+    , m_channelsCount(0)
     , m_address(QLCChannel::invalid())
     , m_channelRef(NULL)
     , m_start(0)
@@ -47,7 +48,7 @@ FadeChannel::FadeChannel(const FadeChannel& ch)
     , m_fixture(ch.m_fixture)
     , m_universe(ch.m_universe)
     , m_primaryChannel(ch.m_primaryChannel)
-    , m_channels(ch.m_channels)
+    , m_channelsCount(ch.m_channelsCount)
     , m_address(ch.m_address)
     , m_channelRef(ch.m_channelRef)
     , m_start(ch.m_start)
@@ -58,11 +59,14 @@ FadeChannel::FadeChannel(const FadeChannel& ch)
     , m_elapsed(ch.m_elapsed)
 {
     //qDebug() << Q_FUNC_INFO;
+    for (int i = 0; i < m_channelsCount; i++)
+        m_channels[i] = ch.m_channels[i];
 }
 
 FadeChannel::FadeChannel(const Doc *doc, quint32 fxi, quint32 channel)
     : m_flags(0)
     , m_fixture(fxi)
+    , m_channelsCount(1)
     , m_channelRef(NULL)
     , m_start(0)
     , m_target(0)
@@ -71,7 +75,7 @@ FadeChannel::FadeChannel(const Doc *doc, quint32 fxi, quint32 channel)
     , m_fadeTime(0)
     , m_elapsed(0)
 {
-    m_channels.append(channel);
+    m_channels[0] = channel;
     autoDetect(doc);
 }
 
@@ -87,7 +91,9 @@ FadeChannel &FadeChannel::operator=(const FadeChannel &fc)
         m_fixture = fc.m_fixture;
         m_universe = fc.m_universe;
         m_primaryChannel = fc.m_primaryChannel;
-        m_channels = fc.m_channels;
+        m_channelsCount = fc.m_channelsCount;
+        for (int i = 0; i < m_channelsCount; i++)
+            m_channels[i] = fc.m_channels[i];
         m_channelRef = fc.m_channelRef;
         m_address = fc.m_address;
         m_start = fc.m_start;
@@ -161,6 +167,10 @@ void FadeChannel::autoDetect(const Doc *doc)
 
         quint32 chIndex = channel();
         m_primaryChannel = mode ? mode->primaryChannel(chIndex) : QLCChannel::invalid();
+        // multiple channels are faded as contiguous addresses,
+        // so a primary channel elsewhere is not handled here
+        if (m_primaryChannel != QLCChannel::invalid() && m_primaryChannel + 1 != chIndex)
+            m_primaryChannel = QLCChannel::invalid();
         m_channelRef = fixture->channel(chIndex);
 
         // non existing channel within fixture
@@ -206,11 +216,17 @@ quint32 FadeChannel::universe() const
 
 void FadeChannel::addChannel(quint32 num)
 {
-    m_channels.append(num);
-    //qDebug() << "[FadeChannel] ADD channel" << num << "count:" << m_channels.count();
+    if (m_channelsCount == FADECHANNEL_MAX_CHANNELS)
+    {
+        qWarning() << "[FadeChannel] cannot handle more than" << FADECHANNEL_MAX_CHANNELS << "channels";
+        return;
+    }
+
+    m_channels[m_channelsCount++] = num;
+    //qDebug() << "[FadeChannel] ADD channel" << num << "count:" << m_channelsCount;
 
     // on secondary channel, shift values 8bits up
-    if (m_channels.count() > 1)
+    if (m_channelsCount > 1)
     {
         m_start = m_start << 8;
         m_target = m_target << 8;
@@ -220,21 +236,25 @@ void FadeChannel::addChannel(quint32 num)
 
 int FadeChannel::channelCount() const
 {
-    if (m_channels.isEmpty())
+    if (m_channelsCount == 0)
         return 1;
 
-    return m_channels.count();
+    return m_channelsCount;
 }
 
 quint32 FadeChannel::channel() const
 {
-    return m_channels.isEmpty() ? QLCChannel::invalid() : m_channels.first();
+    return m_channelsCount == 0 ? QLCChannel::invalid() : m_channels[0];
 }
 
 int FadeChannel::channelIndex(quint32 channel)
 {
-    int idx = m_channels.indexOf(channel);
-    return idx < 0 ? 0 : idx;
+    for (int i = 0; i < m_channelsCount; i++)
+    {
+        if (m_channels[i] == channel)
+            return i;
+    }
+    return 0;
 }
 
 quint32 FadeChannel::primaryChannel() const
@@ -333,6 +353,17 @@ quint32 FadeChannel::current(qreal intensity) const
     return quint32(floor((qreal(m_current) * intensity) + 0.5));
 }
 
+quint32 FadeChannel::currentHighPrecision(qreal intensity) const
+{
+    qreal value = m_current;
+
+    // recalculate the fade step as done by calculateCurrent, without truncation
+    if (m_ready == false && m_elapsed > 0 && m_elapsed < m_fadeTime)
+        value = qreal(m_start) + (qreal(m_target) - qreal(m_start)) * (qreal(m_elapsed) / qreal(m_fadeTime));
+
+    return quint32(floor((value * intensity * 256.0) + 0.5));
+}
+
 void FadeChannel::setReady(bool rdy)
 {
     m_ready = rdy;
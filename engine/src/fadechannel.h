@@ -28,6 +28,10 @@
  * @{
  */
 
+/** The maximum number of channels handled by a FadeChannel.
+ *  Values are packed with one byte per channel in a quint32 */
+#define FADECHANNEL_MAX_CHANNELS    4
+
 /**
  * FadeChannel represents one fixture channel that is to be faded from $start to
  * $target, with X steps between, determined by $fadeTime. The actual fading process
@@ -121,7 +125,12 @@ private:
     quint32 m_fixture;
     quint32 m_universe;
     quint32 m_primaryChannel;
-    QVector<quint32> m_channels;
+
+    /** Channels are stored inline, so that FadeChannels can be
+     *  created and copied in the tick path without any allocation */
+    quint32 m_channels[FADECHANNEL_MAX_CHANNELS];
+    int m_channelsCount;
+
     quint32 m_address;
 
     /** Cache channel reference for faster lookup */
@@ -160,6 +169,11 @@ public:
     uchar current(qreal intensity, int index) const;
     quint32 current(qreal intensity) const;
 
+    /** Get the current value as 8.8 fixed point, modified by $intensity.
+     *  Unlike current(), the fractional part of a fade step is preserved.
+     *  This is meaningful only for single channel faders */
+    quint32 currentHighPrecision(qreal intensity) const;
+
     /** Mark this channel as ready (useful for writing LTP values only once). */
     void setReady(bool rdy);
 
@@ -50,6 +50,7 @@ Fixture::Fixture(QObject* parent) : QObject(parent)
 
     m_fixtureDef = NULL;
     m_fixtureMode = NULL;
+    m_hasAliases = false;
 }
 
 Fixture::~Fixture()
@@ -569,26 +570,37 @@ bool Fixture::setChannelValues(const QByteArray &values)
     if (addr >= values.size())
         return false;
 
-    const int chNum = qMin(values.size() - addr, (int)channels());
-    bool changed = false;
+    const int chNum = qMin(qMin(values.size() - addr, (int)channels()), m_values.size());
+    const char *newValues = values.constData() + addr;
+
+    // Most of the times there are no changes, so
+    // compare the whole block before taking the lock
+    if (chNum <= 0 || memcmp(m_values.constData(), newValues, chNum) == 0)
+        return false;
 
-    // Most of the times there are no changes,
-    // so the lock is inside the cycle
-    for (int i = 0; i < chNum; i++)
     {
-        if (m_values.at(i) != values.at(i + addr))
+        QMutexLocker locker(&m_channelsInfoMutex);
+
+        if (m_hasAliases == false)
+        {
+            memcpy(m_values.data(), newValues, chNum);
+        }
+        else
         {
-            changed = true;
-            QMutexLocker locker(&m_channelsInfoMutex);
-            m_values[i] = values.at(i + addr);
-            checkAlias(i, m_values[i]);
+            for (int i = 0; i < chNum; i++)
+            {
+                if (m_values.at(i) == newValues[i])
+                    continue;
+
+                m_values[i] = newValues[i];
+                checkAlias(i, uchar(newValues[i]));
+            }
         }
     }
 
-    if (changed == true)
-        emit valuesChanged();
+    emit valuesChanged();
 
-    return changed;
+    return true;
 }
 
 QByteArray Fixture::channelValues()
@@ -684,6 +696,7 @@ void Fixture::setFixtureDefinition(QLCFixtureDef* fixtureDef,
         }
 
         m_aliasInfo.resize(chNum);
+        m_hasAliases = false;
 
         for (i = 0; i < chNum; i++)
         {
@@ -700,7 +713,10 @@ void Fixture::setFixtureDefinition(QLCFixtureDef* fixtureDef,
             foreach (QLCCapability *cap, capsList)
             {
                 if (cap->preset() == QLCCapability::Alias)
+                {
                     m_aliasInfo[i].m_hasAlias = true;
+                    m_hasAliases = true;
+                }
             }
         }
 
@@ -359,7 +359,8 @@ protected:
      * Channel info
      *********************************************************************/
 public:
-    /** Store DMX values for this fixture. If values have changed,
+    /** Store DMX values for this fixture, taken from the universe
+     * $values at the fixture address. If values have changed,
      * it returns true, otherwise false */
     bool setChannelValues(const QByteArray &values);
 
@@ -384,6 +385,10 @@ protected:
     QVector<ChannelAlias> m_aliasInfo;
     QMutex m_channelsInfoMutex;
 
+    /** Flag raised when at least a channel has aliases,
+     *  so the values must be checked one by one */
+    bool m_hasAliases;
+
     /*********************************************************************
      * Fixture definition
      *********************************************************************/
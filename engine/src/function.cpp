@@ -91,6 +91,8 @@ Function::Function(QObject *parent)
     , m_flashing(false)
     , m_elapsed(0)
     , m_elapsedBeats(0)
+    , m_beatStartPosition(-1)
+    , m_beatStartElapsed(0)
     , m_stop(true)
     , m_running(false)
     , m_paused(false)
@@ -121,6 +123,8 @@ Function::Function(Doc* doc, Type t)
     , m_flashing(false)
     , m_elapsed(0)
     , m_elapsedBeats(0)
+    , m_beatStartPosition(-1)
+    , m_beatStartElapsed(0)
     , m_stop(true)
     , m_running(false)
     , m_paused(false)
@@ -1102,6 +1106,7 @@ void Function::resetElapsed()
     qDebug() << Q_FUNC_INFO;
     m_elapsed = 0;
     m_elapsedBeats = 0;
+    m_beatStartPosition = -1;
 }
 
 void Function::incrementElapsed()
@@ -1113,9 +1118,23 @@ void Function::incrementElapsed()
         m_elapsed = UINT_MAX;
 }
 
-void Function::incrementElapsedBeats()
+void Function::updateElapsedBeats(MasterTimer *timer)
 {
-    m_elapsedBeats += 1000;
+    double position = timer->beatPosition();
+
+    // Count from the beat the function started in, so its beats
+    // fall on the beats of the clock. When resuming from pause,
+    // carry on from where the function was paused
+    if (m_beatStartPosition < 0)
+    {
+        m_beatStartPosition = m_elapsedBeats == 0 ? floor(position) : position;
+        m_beatStartElapsed = m_elapsedBeats;
+    }
+
+    // measured from the start position on every tick,
+    // so that the rounding errors don't add up
+    double elapsed = m_beatStartElapsed + (position - m_beatStartPosition) * 1000.0;
+    m_elapsedBeats = elapsed < UINT_MAX ? quint32(qRound64(qMax(0.0, elapsed))) : UINT_MAX;
 }
 
 void Function::roundElapsed(quint32 roundTime)
@@ -1126,6 +1145,22 @@ void Function::roundElapsed(quint32 roundTime)
         m_elapsed %= roundTime;
 }
 
+void Function::roundElapsedBeats(quint32 roundBeats)
+{
+    if (roundBeats == 0)
+    {
+        m_elapsedBeats = 0;
+        m_beatStartPosition = -1;
+    }
+    else
+    {
+        // the next round starts exactly where this one ended
+        if (m_beatStartPosition >= 0)
+            m_beatStartPosition += double(m_elapsedBeats / roundBeats) * roundBeats / 1000.0;
+        m_elapsedBeats %= roundBeats;
+    }
+}
+
 /*****************************************************************************
  * Start & Stop
  *****************************************************************************/
@@ -1156,6 +1191,7 @@ void Function::start(MasterTimer* timer, FunctionParent source, quint32 startTim
 
     m_elapsed = startTime;
     m_elapsedBeats = 0;
+    m_beatStartPosition = -1;
     m_overrideFadeInSpeed = overrideFadeIn;
     m_overrideFadeOutSpeed = overrideFadeOut;
     m_overrideDuration = overrideDuration;
@@ -1170,6 +1206,10 @@ void Function::setPause(bool enable)
     if (enable && isRunning() == false)
         return;
 
+    // the beats elapsed while paused are not counted
+    if (enable == false && m_paused)
+        m_beatStartPosition = -1;
+
     m_paused = enable;
 }
 
@@ -761,16 +761,23 @@ protected:
     /** Increment the elapsed timer ticks by one */
     void incrementElapsed();
 
-    /** Increment the elapsed beats by one */
-    void incrementElapsedBeats();
+    /** Update the elapsed beats from the beat position of $timer. This
+     *  must be called on every tick while the function is not paused. */
+    void updateElapsedBeats(MasterTimer *timer);
 
     void roundElapsed(quint32 roundTime);
 
+    void roundElapsedBeats(quint32 roundBeats);
+
 private:
     /* The elapsed time in ms when tempoType is Time */
     quint32 m_elapsed;
     /* The elapsed beats when tempoType is Beats */
     quint32 m_elapsedBeats;
+    /* The beat position the elapsed beats are counted from, -1 if none */
+    double m_beatStartPosition;
+    /* The elapsed beats at m_beatStartPosition */
+    quint32 m_beatStartElapsed;
 
     /*********************************************************************
      * Start & Stop
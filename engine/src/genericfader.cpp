@@ -18,6 +18,7 @@
 */
 
 #include <QDebug>
+#include <math.h>
 
 #include "genericfader.h"
 #include "fadechannel.h"
@@ -36,6 +37,10 @@ GenericFader::GenericFader(QObject *parent)
     , m_deleteRequest(false)
     , m_blendMode(Universe::NormalBlend)
     , m_monitoring(false)
+    , m_layerFirst(0)
+    , m_layerCount(0)
+    , m_layerFadeTime(0)
+    , m_layerElapsed(0)
 {
 }
 
@@ -129,6 +134,8 @@ void GenericFader::removeAll()
 {
     QWriteLocker l(&m_channelsLock);
     m_channels.clear();
+    m_layerMask.clear();
+    m_layerCount = 0;
 }
 
 bool GenericFader::deleteRequested()
@@ -143,7 +150,23 @@ void GenericFader::requestDelete()
 
 FadeChannel *GenericFader::getChannelFader(const Doc *doc, Universe *universe, quint32 fixtureID, quint32 channel)
 {
-    FadeChannel fc(doc, fixtureID, channel);
+    // Callers like EFX request the same channels on every tick, so look
+    // them up before building a new FadeChannel, which requires Doc lookups.
+    // Absolute addresses and primary channels can only be hashed afterwards.
+    if (handleSecondary() == false && fixtureID != Fixture::invalidId())
+    {
+        QReadLocker l(&m_channelsLock);
+        QHash<quint32,FadeChannel>::iterator channelIterator = m_channels.find(channelHash(fixtureID, channel));
+        if (channelIterator != m_channels.end())
+            return &channelIterator.value();
+    }
+
+    return getChannelFader(universe, FadeChannel(doc, fixtureID, channel));
+}
+
+FadeChannel *GenericFader::getChannelFader(Universe *universe, const FadeChannel &channel)
+{
+    FadeChannel fc(channel);
     quint32 primary = fc.primaryChannel();
     quint32 hash;
 
@@ -165,8 +188,8 @@ FadeChannel *GenericFader::getChannelFader(const Doc *doc, Universe *universe, q
             fcFound->channelCount() == 1 &&
             primary != QLCChannel::invalid())
         {
-            //qDebug() << "Adding channel to primary" << channel;
-            fcFound->addChannel(channel);
+            //qDebug() << "Adding channel to primary" << fc.channel();
+            fcFound->addChannel(fc.channel());
             if (universe)
                 fcFound->setCurrent(universe->preGMValue(fcFound->address() + 1), 1);
         }
@@ -271,6 +294,13 @@ void GenericFader::write(Universe *universe)
                                 flags & FadeChannel::ForceLTP ? true : false);
             continue;
         }
+        else if (universe->highPrecision() && channelCount == 1 && fc.canFade() &&
+                 ((flags & FadeChannel::CrossFade) == 0 || fc.fadeTime() != 0))
+        {
+            // keep the fractional part of the fade step
+            qreal chIntensity = (flags & FadeChannel::Intensity) ? compIntensity : 1.0;
+            universe->writeBlendedHighPrecision(address, fc.currentHighPrecision(chIntensity), m_blendMode);
+        }
         else
         {
             // treat value as a whole, so do this just once per FadeChannel
@@ -291,8 +321,11 @@ void GenericFader::write(Universe *universe)
             it.remove();
     }
 
+    if (m_layerCount)
+        writeLayer(universe, compIntensity);
+
     // self-request deletion when fadeout is complete
-    if (m_fadeOut && m_channels.isEmpty())
+    if (m_fadeOut && m_channels.isEmpty() && m_layerCount == 0)
     {
         m_fadeOut = false;
         requestDelete();
@@ -349,6 +382,8 @@ bool GenericFader::isFadingOut() const
 void GenericFader::setFadeOut(bool enable, uint fadeTime)
 {
     m_fadeOut = enable;
+    m_layerFadeTime = fadeTime;
+    m_layerElapsed = 0;
 
     if (fadeTime == 0)
         return;
@@ -397,3 +432,100 @@ void GenericFader::resetCrossfade()
         fc.removeFlag(FadeChannel::CrossFade);
     }
 }
+
+void GenericFader::setLayerMask(const QByteArray &mask, const QByteArray &intensityMask)
+{
+    QWriteLocker l(&m_channelsLock);
+
+    m_layerMask = mask;
+    m_layerIntensityMask = intensityMask;
+    if (m_layerIntensityMask.size() != m_layerMask.size())
+        m_layerIntensityMask = QByteArray(m_layerMask.size(), char(0));
+    if (m_layerValues.size() != m_layerMask.size())
+        m_layerValues = QByteArray(m_layerMask.size(), char(0));
+
+    // write only the range of channels covered by the layer
+    m_layerFirst = 0;
+    m_layerCount = 0;
+    for (int i = 0; i < m_layerMask.size(); i++)
+    {
+        if (m_layerMask.at(i) == 0)
+            continue;
+
+        if (m_layerCount == 0)
+            m_layerFirst = i;
+        m_layerCount = i - m_layerFirst + 1;
+    }
+}
+
+void GenericFader::setLayerValues(const QByteArray &values)
+{
+    QWriteLocker l(&m_channelsLock);
+
+    if (values.size() != m_layerMask.size())
+    {
+        qWarning() << Q_FUNC_INFO << "Layer values don't match the layer mask";
+        return;
+    }
+
+    m_layerValues = values;
+}
+
+bool GenericFader::hasLayer() const
+{
+    QReadLocker l(&m_channelsLock);
+    return m_layerCount > 0;
+}
+
+void GenericFader::writeLayer(Universe *universe, qreal intensity)
+{
+    // the layer fades out as a whole, scaling the
+    // channels that can be scaled by the intensity
+    if (m_fadeOut)
+    {
+        if (m_paused == false)
+            m_layerElapsed += MasterTimer::tick();
+
+        if (m_layerElapsed >= m_layerFadeTime)
+        {
+            m_layerMask.clear();
+            m_layerCount = 0;
+            return;
+        }
+
+        intensity *= 1.0 - qreal(m_layerElapsed) / qreal(m_layerFadeTime);
+    }
+
+    const uchar *values = reinterpret_cast<const uchar *>(m_layerValues.constData());
+    const uchar *mask = reinterpret_cast<const uchar *>(m_layerMask.constData());
+    const uchar *intensityMask = reinterpret_cast<const uchar *>(m_layerIntensityMask.constData());
+    int last = m_layerFirst + m_layerCount;
+
+    // high precision and blend modes are handled channel by channel
+    if (universe->highPrecision() || m_blendMode != Universe::NormalBlend)
+    {
+        for (int i = m_layerFirst; i < last; i++)
+        {
+            if (mask[i] == 0)
+                continue;
+
+            qreal chIntensity = intensityMask[i] ? intensity : 1.0;
+            universe->writeBlendedHighPrecision(i, quint32(floor((qreal(values[i]) * chIntensity * 256.0) + 0.5)),
+                                                m_blendMode);
+        }
+        return;
+    }
+
+    if (intensity != 1.0)
+    {
+        if (m_layerScaled.size() != m_layerValues.size())
+            m_layerScaled.resize(m_layerValues.size());
+
+        uchar *scaled = reinterpret_cast<uchar *>(m_layerScaled.data());
+        for (int i = m_layerFirst; i < last; i++)
+            scaled[i] = intensityMask[i] ? uchar(floor((qreal(values[i]) * intensity) + 0.5)) : values[i];
+        values = scaled;
+    }
+
+    universe->writeLayer(m_layerFirst, values + m_layerFirst, mask + m_layerFirst, m_layerCount);
+}
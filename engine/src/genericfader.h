@@ -105,6 +105,10 @@ public:
      *  Also, new channels will have a start value set depending on their type */
     FadeChannel *getChannelFader(const Doc *doc, Universe *universe, quint32 fixtureID, quint32 channel);
 
+    /** Same as above, but using an already detected FadeChannel as template
+     *  for new channels, thus avoiding any Doc lookup */
+    FadeChannel *getChannelFader(Universe *universe, const FadeChannel &channel);
+
     /** Get all channels in a non-modifiable hashmap */
     QHash <quint32,FadeChannel> channels() const;
 
@@ -155,6 +159,30 @@ public:
     /** Remove the Crossfade flag from every fader handled by this class */
     void resetCrossfade();
 
+    /**
+     * Set the channels of the Universe owned by the byte layer of this fader.
+     * Functions writing many channels without fading, like RGBMatrix, can
+     * set their values directly in the layer, which is written in one pass
+     * after the fading channels, instead of using a FadeChannel for each one.
+     *
+     * @param mask 0xFF for each channel of the layer, 0x00 for the others.
+     *             An empty mask removes the layer
+     * @param intensityMask 0xFF for the channels of the layer that are
+     *                      scaled by the fader intensity
+     */
+    void setLayerMask(const QByteArray& mask, const QByteArray& intensityMask);
+
+    /** Set the values of the byte layer, one for each channel of the Universe.
+     *  They are written on every tick until they are set again */
+    void setLayerValues(const QByteArray& values);
+
+    /** Return true if this fader has a byte layer */
+    bool hasLayer() const;
+
+private:
+    /** Write the byte layer to $universe, applying $intensity */
+    void writeLayer(Universe *universe, qreal intensity);
+
 signals:
     /** Signal emitted when monitoring is enabled.
      *  Data is preGM and includes the whole universe */
@@ -175,6 +203,18 @@ private:
     bool m_deleteRequest;
     Universe::BlendMode m_blendMode;
     bool m_monitoring;
+
+    /** The byte layer values and masks, and the range of channels it covers */
+    QByteArray m_layerValues;
+    QByteArray m_layerMask;
+    QByteArray m_layerIntensityMask;
+    QByteArray m_layerScaled;
+    int m_layerFirst;
+    int m_layerCount;
+
+    /** Time of the byte layer fade out */
+    uint m_layerFadeTime;
+    uint m_layerElapsed;
 };
 
 /** @} */
@@ -25,7 +25,6 @@
 
 #include <QXmlStreamReader>
 #include <QXmlStreamWriter>
-#include <QElapsedTimer>
 #include <QSettings>
 #include <QDebug>
 #include <qmath.h>
@@ -37,6 +36,7 @@
 #include "qlcioplugin.h"
 #include "outputpatch.h"
 #include "inputpatch.h"
+#include "latencytracer.h"
 #include "qlcconfig.h"
 #include "universe.h"
 #include "qlcfile.h"
@@ -49,9 +49,9 @@ InputOutputMap::InputOutputMap(const Doc *doc, quint32 universes)
     , m_universeChanged(false)
     , m_localProfilesLoaded(false)
     , m_currentBPM(0)
-    , m_beatTime(new QElapsedTimer())
 {
     m_grandMaster = new GrandMaster(this);
+    m_latencyTracer = new LatencyTracer();
     for (quint32 i = 0; i < universes; i++)
         addUniverse();
 
@@ -64,7 +64,7 @@ InputOutputMap::~InputOutputMap()
 {
     removeAllUniverses();
     delete m_grandMaster;
-    delete m_beatTime;
+    delete m_latencyTracer;
     qDeleteAll(m_profiles);
 }
 
@@ -155,14 +155,16 @@ bool InputOutputMap::addUniverse(quint32 id)
             while (id > universesCount())
             {
                 uni = new Universe(universesCount(), m_grandMaster);
-                connect(m_doc->masterTimer(), SIGNAL(tickReady()), uni, SLOT(tick()), Qt::QueuedConnection);
+                uni->setLatencyTracer(m_latencyTracer);
+                connect(m_doc->masterTimer(), SIGNAL(tickReady()), uni, SLOT(tick()), Qt::DirectConnection);
                 connect(uni, SIGNAL(universeWritten(quint32,QByteArray)), this, SIGNAL(universeWritten(quint32,QByteArray)));
                 m_universeArray.append(uni);
             }
         }
 
         uni = new Universe(id, m_grandMaster);
-        connect(m_doc->masterTimer(), SIGNAL(tickReady()), uni, SLOT(tick()), Qt::QueuedConnection);
+        uni->setLatencyTracer(m_latencyTracer);
+        connect(m_doc->masterTimer(), SIGNAL(tickReady()), uni, SLOT(tick()), Qt::DirectConnection);
         connect(uni, SIGNAL(universeWritten(quint32,QByteArray)), this, SIGNAL(universeWritten(quint32,QByteArray)));
         m_universeArray.append(uni);
     }
@@ -249,6 +251,20 @@ bool InputOutputMap::getUniversePassthrough(int index)
     return m_universeArray.at(index)->passthrough();
 }
 
+void InputOutputMap::setUniverseHighPrecision(int index, bool enable)
+{
+    if (index < 0 || index >= m_universeArray.count())
+        return;
+    m_universeArray.at(index)->setHighPrecision(enable);
+}
+
+bool InputOutputMap::getUniverseHighPrecision(int index)
+{
+    if (index < 0 || index >= m_universeArray.count())
+        return false;
+    return m_universeArray.at(index)->highPrecision();
+}
+
 void InputOutputMap::setUniverseMonitor(int index, bool enable)
 {
     if (index < 0 || index >= m_universeArray.count())
@@ -381,6 +397,15 @@ uchar InputOutputMap::grandMasterValue()
     return m_grandMaster->value();
 }
 
+/*********************************************************************
+ * Latency
+ *********************************************************************/
+
+LatencyTracer *InputOutputMap::latencyTracer() const
+{
+    return m_latencyTracer;
+}
+
 /*********************************************************************
  * Patch
  *********************************************************************/
@@ -415,6 +440,8 @@ bool InputOutputMap::setInputPatch(quint32 universe, const QString &pluginName,
         {
             disconnect(currInPatch, SIGNAL(inputValueChanged(quint32,quint32,uchar,const QString&)),
                        this, SLOT(slotPluginBeat(quint32,quint32,uchar,const QString&)));
+            disconnect(currInPatch, SIGNAL(clockEventReceived(quint32,int,qint64,qint64)),
+                       this, SLOT(slotPluginClock(quint32,int,qint64,qint64)));
         }
     }
     InputPatch *ip = NULL;
@@ -448,6 +475,8 @@ bool InputOutputMap::setInputPatch(quint32 universe, const QString &pluginName,
             {
                 connect(ip, SIGNAL(inputValueChanged(quint32,quint32,uchar,const QString&)),
                         this, SLOT(slotPluginBeat(quint32,quint32,uchar,const QString&)));
+                connect(ip, SIGNAL(clockEventReceived(quint32,int,qint64,qint64)),
+                        this, SLOT(slotPluginClock(quint32,int,qint64,qint64)));
             }
         }
     }
@@ -1017,7 +1046,7 @@ void InputOutputMap::setBeatGeneratorType(InputOutputMap::BeatGeneratorType type
 
     if (m_beatGeneratorType == Audio)
     {
-        m_inputCapture->unregisterBandsNumber(4);
+        m_inputCapture->unregisterBusConsumer();
         disconnect(m_inputCapture, SIGNAL(beatDetected()), this, SLOT(slotProcessBeat()));
     }
 
@@ -1037,7 +1066,6 @@ void InputOutputMap::setBeatGeneratorType(InputOutputMap::BeatGeneratorType type
             m_doc->masterTimer()->setBeatSourceType(MasterTimer::External);
             // reset the current BPM number and detect it from the MIDI beats
             setBpmNumber(0);
-            m_beatTime->restart();
         }
         break;
         case Audio:
@@ -1045,11 +1073,10 @@ void InputOutputMap::setBeatGeneratorType(InputOutputMap::BeatGeneratorType type
             m_doc->masterTimer()->setBeatSourceType(MasterTimer::External);
             // reset the current BPM number and detect it from the audio input
             setBpmNumber(0);
-            m_beatTime->restart();
             QSharedPointer<AudioCapture> capture(m_doc->audioInputCapture());
             m_inputCapture = capture.data();
             connect(m_inputCapture, SIGNAL(beatDetected()), this, SLOT(slotProcessBeat()));
-            m_inputCapture->registerBandsNumber(4);
+            m_inputCapture->registerBusConsumer();
         }
         break;
         case Disabled:
@@ -1114,21 +1141,16 @@ int InputOutputMap::bpmNumber() const
 
 void InputOutputMap::slotProcessBeat()
 {
-    // process the timer as first thing, to avoid wasting time
-    // with the operations below
-    qint64 elapsed = m_beatTime->elapsed();
-    m_beatTime->restart();
-
-    int bpm = qRound(60000.0 / (float)elapsed);
-    float currBpmTime = 60000.0 / (float)m_currentBPM;
-    // here we check if the difference between the current BPM duration
-    // and the current time elapsed is within a range of +/-1ms.
-    // If it isn't, then the BPM number has really changed, otherwise
-    // it's just a tiny time drift
-    if (qAbs((float)elapsed - currBpmTime) > 1)
+    // process the beat as first thing, so the beat clock gets
+    // the most accurate timestamp. The clock filters the jitter
+    // of the beats and estimates the tempo from their intervals
+    MasterTimer *timer = m_doc->masterTimer();
+    timer->requestBeat();
+
+    int bpm = qRound(timer->beatClockBpm());
+    if (bpm > 0)
         setBpmNumber(bpm);
 
-    m_doc->masterTimer()->requestBeat();
     emit beat();
 }
 
@@ -1148,11 +1170,54 @@ void InputOutputMap::slotPluginBeat(quint32 universe, quint32 channel, uchar val
     if (m_beatGeneratorType != Plugin || value == 0 || key != "beat")
         return;
 
-    qDebug() << "Plugin beat:" << channel << m_beatTime->elapsed();
+    qDebug() << "Plugin beat:" << channel;
 
     slotProcessBeat();
 }
 
+void InputOutputMap::slotPluginClock(quint32 universe, int event, qint64 timestamp, qint64 value)
+{
+    Q_UNUSED(universe)
+
+    MasterTimer *timer = m_doc->masterTimer();
+
+    // the time code doesn't depend on the beat generator
+    if (event == QLCIOPlugin::ClockTimecode)
+    {
+        timer->setTimecode(value, timestamp);
+        return;
+    }
+
+    if (m_beatGeneratorType != Plugin)
+        return;
+
+    switch (event)
+    {
+        case QLCIOPlugin::ClockTempo:
+            timer->requestTempo(value / 1000.0, timestamp);
+            setBpmNumber(qRound(value / 1000.0));
+        break;
+        case QLCIOPlugin::ClockBeat:
+            timer->requestBeat(timestamp, int(value));
+            emit beat();
+        break;
+        case QLCIOPlugin::ClockStart:
+            // the song restarts: lock on its first beat rather
+            // than steering the old phase over the next beats
+            timer->requestBeatStop(timestamp);
+        break;
+        case QLCIOPlugin::ClockContinue:
+            // the song continues from where it stopped: its next
+            // beats lock the clock again and their numbers the bars
+        break;
+        case QLCIOPlugin::ClockStop:
+            timer->requestBeatStop(timestamp);
+        break;
+        default:
+        break;
+    }
+}
+
 /*********************************************************************
  * Defaults - !! FALLBACK !!
  *********************************************************************/
@@ -30,11 +30,11 @@
 
 class QXmlStreamReader;
 class QXmlStreamWriter;
-class QElapsedTimer;
 class QLCInputSource;
 class AudioCapture;
 class QLCIOPlugin;
 class OutputPatch;
+class LatencyTracer;
 class InputPatch;
 class Universe;
 class Doc;
@@ -205,6 +205,20 @@ public:
      */
     bool getUniversePassthrough(int index);
 
+    /**
+     * Enable/disable the high precision mode for the universe with the given index
+     * @param index The universe index
+     * @param enable The high precision mode flag
+     */
+    void setUniverseHighPrecision(int index, bool enable);
+
+    /**
+     * Retrieve the high precision mode of the universe at the given index
+     * @param index The universe index
+     * @return true = high precision, false = normal mode
+     */
+    bool getUniverseHighPrecision(int index);
+
     /**
      * Enable/disable the monitor mode for the universe with the given index
      * @param index The universe index
@@ -319,6 +333,19 @@ private:
     /** The Grand Master reference */
     GrandMaster *m_grandMaster;
 
+    /*********************************************************************
+     * Latency
+     *********************************************************************/
+public:
+    /**
+     * Get the tracer measuring the time taken by input values to reach
+     * the outputs of all the universes. It is disabled by default.
+     */
+    LatencyTracer *latencyTracer() const;
+
+private:
+    LatencyTracer *m_latencyTracer;
+
     /*********************************************************************
      * Patch
      *********************************************************************/
@@ -601,6 +628,7 @@ public:
 protected slots:
     void slotMasterTimerBeat();
     void slotPluginBeat(quint32 universe, quint32 channel, uchar value, const QString &key);
+    void slotPluginClock(quint32 universe, int event, qint64 timestamp, qint64 value);
     void slotProcessBeat();
 
 signals:
@@ -611,7 +639,6 @@ signals:
 private:
     BeatGeneratorType m_beatGeneratorType;
     int m_currentBPM;
-    QElapsedTimer *m_beatTime;
     AudioCapture *m_inputCapture;
 
     /*********************************************************************
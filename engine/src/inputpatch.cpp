@@ -27,6 +27,7 @@
 
 #include "qlcinputchannel.h"
 #include "qlcioplugin.h"
+#include "latencytracer.h"
 #include "inputpatch.h"
 
 #define GRACE_MS 1
@@ -41,6 +42,7 @@ InputPatch::InputPatch(QObject *parent)
     , m_plugin(NULL)
     , m_pluginLine(QLCIOPlugin::invalidLine())
     , m_profile(NULL)
+    , m_latencyTracer(NULL)
     , m_nextPageCh(USHRT_MAX)
     , m_prevPageCh(USHRT_MAX)
     , m_pageSetCh(USHRT_MAX)
@@ -54,6 +56,7 @@ InputPatch::InputPatch(quint32 inputUniverse, QObject* parent)
     , m_plugin(NULL)
     , m_pluginLine(QLCIOPlugin::invalidLine())
     , m_profile(NULL)
+    , m_latencyTracer(NULL)
     , m_nextPageCh(USHRT_MAX)
     , m_prevPageCh(USHRT_MAX)
     , m_pageSetCh(USHRT_MAX)
@@ -83,6 +86,8 @@ bool InputPatch::set(QLCIOPlugin* plugin, quint32 input, QLCInputProfile* profil
     {
         disconnect(m_plugin, SIGNAL(valueChanged(quint32,quint32,quint32,uchar,QString)),
                    this, SLOT(slotValueChanged(quint32,quint32,quint32,uchar,QString)));
+        disconnect(m_plugin, SIGNAL(clockEventReceived(quint32,quint32,int,qint64,qint64)),
+                   this, SLOT(slotClockEventReceived(quint32,quint32,int,qint64,qint64)));
         m_plugin->closeInput(m_pluginLine, m_universe);
     }
 
@@ -104,6 +109,8 @@ bool InputPatch::set(QLCIOPlugin* plugin, quint32 input, QLCInputProfile* profil
     {
         connect(m_plugin, SIGNAL(valueChanged(quint32,quint32,quint32,uchar,QString)),
                 this, SLOT(slotValueChanged(quint32,quint32,quint32,uchar,QString)));
+        connect(m_plugin, SIGNAL(clockEventReceived(quint32,quint32,int,qint64,qint64)),
+                this, SLOT(slotClockEventReceived(quint32,quint32,int,qint64,qint64)));
         result = m_plugin->openInput(m_pluginLine, m_universe);
 
         if (m_profile != NULL)
@@ -222,8 +229,12 @@ void InputPatch::slotValueChanged(quint32 universe, quint32 input, quint32 chann
     {
         if (universe == UINT_MAX || universe == m_universe)
         {
+            qint64 receiveTime = 0;
+            if (m_latencyTracer != NULL && m_latencyTracer->isEnabled())
+                receiveTime = m_latencyTracer->timestamp();
+
             QMutexLocker inputBufferLocker(&m_inputBufferMutex);
-            InputValue val(value, key);
+            InputValue val(value, key, receiveTime);
             if (m_inputBuffer.contains(channel))
             {
                 InputValue const& curVal = m_inputBuffer.value(channel);
@@ -234,6 +245,11 @@ void InputPatch::slotValueChanged(quint32 universe, quint32 input, quint32 chann
                     {
                         emit inputValueChanged(m_universe, channel, curVal.value, curVal.key);
                     }
+                    // latency is measured from the first value not flushed yet
+                    else if (curVal.receiveTime != 0)
+                    {
+                        val.receiveTime = curVal.receiveTime;
+                    }
                     m_inputBuffer.insert(channel, val);
                 }
             }
@@ -245,6 +261,25 @@ void InputPatch::slotValueChanged(quint32 universe, quint32 input, quint32 chann
     }
 }
 
+void InputPatch::slotClockEventReceived(quint32 universe, quint32 input,
+                                        int event, qint64 timestamp, qint64 value)
+{
+    if (input != m_pluginLine)
+        return;
+
+    if (universe == UINT_MAX || universe == m_universe)
+        emit clockEventReceived(m_universe, event, timestamp, value);
+}
+
+/*****************************************************************************
+ * Latency
+ *****************************************************************************/
+
+void InputPatch::setLatencyTracer(LatencyTracer *tracer)
+{
+    m_latencyTracer = tracer;
+}
+
 void InputPatch::setProfilePageControls()
 {
     if (m_profile != NULL)
@@ -288,6 +323,9 @@ void InputPatch::flush(quint32 universe)
         for (QHash<quint32, InputValue>::const_iterator it = m_inputBuffer.begin(); it != m_inputBuffer.end(); ++it)
         {
             emit inputValueChanged(m_universe, it.key(), it.value().value, it.value().key);
+
+            if (m_latencyTracer != NULL)
+                m_latencyTracer->inputFlushed(it.value().receiveTime);
         }
         m_inputBuffer.clear();
     }
@@ -26,6 +26,7 @@
 
 #include "qlcinputprofile.h"
 
+class LatencyTracer;
 class QLCIOPlugin;
 
 /** @addtogroup engine Engine
@@ -127,6 +128,10 @@ signals:
     void inputValueChanged(quint32 inputUniverse, quint32 channel,
                            uchar value, const QString& key = 0);
 
+    /** A clock event received by the plugin line, see QLCIOPlugin::ClockEvent.
+     *  Clock events are not buffered and are emitted as soon as received */
+    void clockEventReceived(quint32 inputUniverse, int event, qint64 timestamp, qint64 value);
+
     void inputNameChanged();
     void pluginNameChanged();
     void profileNameChanged();
@@ -134,6 +139,8 @@ signals:
 private slots:
     void slotValueChanged(quint32 universe, quint32 input,
                           quint32 channel, uchar value, const QString& key = 0);
+    void slotClockEventReceived(quint32 universe, quint32 input,
+                                int event, qint64 timestamp, qint64 value);
 
 private:
     /** The reference of the plugin associated by this Input patch */
@@ -145,6 +152,16 @@ private:
     /** The patch parameters cache */
     QMap<QString, QVariant>m_parametersCache;
 
+    /************************************************************************
+     * Latency
+     ************************************************************************/
+public:
+    /** Set the tracer used to timestamp the received values (NULL for none) */
+    void setLatencyTracer(LatencyTracer *tracer);
+
+private:
+    LatencyTracer *m_latencyTracer;
+
     /************************************************************************
      * Pages
      ************************************************************************/
@@ -160,12 +177,16 @@ public:
     struct InputValue
     {
         InputValue() {}
-        InputValue(uchar v, QString const& k)
+        InputValue(uchar v, QString const& k, qint64 t = 0)
             : value(v)
             , key(k)
+            , receiveTime(t)
         {}
         uchar value;
         QString key;
+        /** When the first value not flushed yet has been received,
+         *  or 0 when latency is not traced */
+        qint64 receiveTime;
     };
 
     QMutex m_inputBufferMutex;
@@ -0,0 +1,249 @@
+/*
+  Q Light Controller Plus
+  latencytracer.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QMutexLocker>
+#include <QDebug>
+
+#include <string.h>
+
+#include "latencytracer.h"
+
+LatencyTracer::LatencyTracer()
+    : m_enabled(0)
+    , m_probeUniverse(UINT_MAX)
+    , m_probeChannel(UINT_MAX)
+    , m_probeValue(0)
+    , m_pendingCount(0)
+    , m_droppedCount(0)
+{
+    m_clock.start();
+    reset();
+}
+
+LatencyTracer::~LatencyTracer()
+{
+}
+
+void LatencyTracer::setEnabled(bool enable)
+{
+    if (enable)
+        reset();
+
+    m_enabled.storeRelease(enable ? 1 : 0);
+}
+
+bool LatencyTracer::isEnabled() const
+{
+    return m_enabled.loadAcquire() != 0;
+}
+
+void LatencyTracer::setProbe(quint32 universe, quint32 channel)
+{
+    QMutexLocker locker(&m_mutex);
+    m_probeUniverse = universe;
+    m_probeChannel = channel;
+    m_probeValue = 0;
+    m_pendingCount = 0;
+}
+
+quint32 LatencyTracer::probeUniverse() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_probeUniverse;
+}
+
+quint32 LatencyTracer::probeChannel() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_probeChannel;
+}
+
+void LatencyTracer::reset()
+{
+    QMutexLocker locker(&m_mutex);
+    m_pendingCount = 0;
+    m_droppedCount = 0;
+    memset(m_histograms, 0, sizeof(m_histograms));
+}
+
+qint64 LatencyTracer::timestamp() const
+{
+    return m_clock.nsecsElapsed() + 1;
+}
+
+/*********************************************************************
+ * Events
+ *********************************************************************/
+
+void LatencyTracer::inputFlushed(qint64 receiveTime)
+{
+    if (isEnabled() == false || receiveTime <= 0)
+        return;
+
+    qint64 now = timestamp();
+
+    QMutexLocker locker(&m_mutex);
+    addSample(InputQueue, now - receiveTime);
+
+    // without a probe there is no output known to show this value
+    if (hasProbe() == false)
+        return;
+
+    if (m_pendingCount == LATENCYTRACER_MAX_PENDING)
+    {
+        m_droppedCount++;
+        return;
+    }
+
+    m_pending[m_pendingCount].receiveTime = receiveTime;
+    m_pending[m_pendingCount].flushTime = now;
+    m_pendingCount++;
+}
+
+void LatencyTracer::outputWritten(quint32 universe, const QByteArray &data)
+{
+    if (isEnabled() == false)
+        return;
+
+    QMutexLocker locker(&m_mutex);
+
+    if (hasProbe() == false || universe != m_probeUniverse)
+        return;
+
+    // the probe value is followed even with nothing pending,
+    // otherwise a change could be detected against a stale value
+    uchar value = m_probeChannel < quint32(data.size()) ? uchar(data.at(m_probeChannel)) : 0;
+    bool changed = value != m_probeValue;
+    m_probeValue = value;
+
+    if (changed == false || m_pendingCount == 0)
+        return;
+
+    qint64 now = timestamp();
+
+    for (int i = 0; i < m_pendingCount; i++)
+    {
+        addSample(Output, now - m_pending[i].flushTime);
+        addSample(EndToEnd, now - m_pending[i].receiveTime);
+    }
+
+    m_pendingCount = 0;
+}
+
+bool LatencyTracer::hasProbe() const
+{
+    return m_probeUniverse != UINT_MAX && m_probeChannel != UINT_MAX;
+}
+
+void LatencyTracer::addSample(Stage stage, qint64 nsecs)
+{
+    Histogram &h = m_histograms[stage];
+    nsecs = qMax(qint64(0), nsecs);
+
+    int bucket = 0;
+    qint64 usecs = nsecs / 1000;
+    while (usecs > 0 && bucket < LATENCYTRACER_BUCKETS - 1)
+    {
+        usecs >>= 1;
+        bucket++;
+    }
+
+    h.buckets[bucket]++;
+
+    if (h.count == 0 || nsecs < h.min)
+        h.min = nsecs;
+    if (nsecs > h.max)
+        h.max = nsecs;
+
+    h.sum += nsecs;
+    h.count++;
+}
+
+/*********************************************************************
+ * Statistics
+ *********************************************************************/
+
+quint32 LatencyTracer::samplesCount(Stage stage) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_histograms[stage].count;
+}
+
+qint64 LatencyTracer::minimum(Stage stage) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_histograms[stage].min;
+}
+
+qint64 LatencyTracer::maximum(Stage stage) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_histograms[stage].max;
+}
+
+qint64 LatencyTracer::mean(Stage stage) const
+{
+    QMutexLocker locker(&m_mutex);
+    const Histogram &h = m_histograms[stage];
+    if (h.count == 0)
+        return 0;
+
+    return h.sum / h.count;
+}
+
+qint64 LatencyTracer::percentile(Stage stage, qreal fraction) const
+{
+    QMutexLocker locker(&m_mutex);
+    const Histogram &h = m_histograms[stage];
+    if (h.count == 0)
+        return 0;
+
+    quint64 target = qMax(quint64(1), quint64(qBound(0.0, fraction, 1.0) * h.count + 0.5));
+    quint64 accumulated = 0;
+
+    for (int i = 0; i < LATENCYTRACER_BUCKETS; i++)
+    {
+        accumulated += h.buckets[i];
+        if (accumulated >= target)
+            return qMin(bucketUpperBound(i), h.max);
+    }
+
+    return h.max;
+}
+
+QVector<quint32> LatencyTracer::histogram(Stage stage) const
+{
+    QMutexLocker locker(&m_mutex);
+    QVector<quint32> buckets(LATENCYTRACER_BUCKETS);
+    for (int i = 0; i < LATENCYTRACER_BUCKETS; i++)
+        buckets[i] = m_histograms[stage].buckets[i];
+
+    return buckets;
+}
+
+qint64 LatencyTracer::bucketUpperBound(int bucket)
+{
+    return (qint64(1) << bucket) * 1000;
+}
+
+quint32 LatencyTracer::droppedCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_droppedCount;
+}
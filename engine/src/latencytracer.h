@@ -0,0 +1,178 @@
+/*
+  Q Light Controller Plus
+  latencytracer.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef LATENCYTRACER_H
+#define LATENCYTRACER_H
+
+#include <QElapsedTimer>
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QVector>
+#include <QMutex>
+
+/** @addtogroup engine Engine
+ * @{
+ */
+
+/** Number of histogram buckets. Bucket 0 counts the samples below 1us,
+ *  bucket i the ones in [2^(i-1), 2^i) us and the last one everything above */
+#define LATENCYTRACER_BUCKETS       32
+
+/** Maximum number of input events waiting for an output frame */
+#define LATENCYTRACER_MAX_PENDING   256
+
+/**
+ * LatencyTracer measures the time an input value takes to reach the outputs.
+ *
+ * Input patches timestamp the values when they are received from a plugin
+ * and report them when they are flushed into the engine on the next tick.
+ * An input value can drive any output channel, or none at all, so the
+ * output stages are measured only against a probe: one channel of one
+ * universe that the input is known to drive (e.g. a test fader).
+ * Each flushed value is paired with the first output frame where the
+ * probe channel changes afterwards, which is the first moment its effect
+ * can be seen on the wire. Without a probe only InputQueue is measured.
+ *
+ * Samples are collected in logarithmic histograms, one per stage:
+ * - InputQueue: from reception to the flush into the engine
+ * - Output: from the flush to the output frame written to the plugins
+ * - EndToEnd: from reception to the output frame
+ *
+ * Tracing is disabled by default and costs a single atomic read per
+ * input value and output frame in that case.
+ */
+class LatencyTracer
+{
+public:
+    enum Stage
+    {
+        InputQueue = 0,
+        Output,
+        EndToEnd,
+        StagesCount
+    };
+
+    LatencyTracer();
+    ~LatencyTracer();
+
+    /** Enable or disable tracing. Enabling clears the collected data */
+    void setEnabled(bool enable);
+    bool isEnabled() const;
+
+    /**
+     * Set the output channel used to measure the Output and EndToEnd
+     * stages. Input values flushed while no probe is set are not traced
+     * to the outputs.
+     *
+     * @param universe the universe of the probe, or UINT_MAX for no probe
+     * @param channel the channel of $universe whose value has to change,
+     *                or UINT_MAX for no probe
+     */
+    void setProbe(quint32 universe, quint32 channel);
+    quint32 probeUniverse() const;
+    quint32 probeChannel() const;
+
+    /** Clear the collected data and the pending events */
+    void reset();
+
+    /** Get the current time in nanoseconds, as used for the traces.
+     *  It never returns 0, which means "not traced" */
+    qint64 timestamp() const;
+
+    /*********************************************************************
+     * Events
+     *********************************************************************/
+public:
+    /** An input value received at $receiveTime has been flushed into the engine */
+    void inputFlushed(qint64 receiveTime);
+
+    /** An output frame of $universe has been written to the plugins */
+    void outputWritten(quint32 universe, const QByteArray& data);
+
+private:
+    /** Return true if a probe channel is set. m_mutex must be locked */
+    bool hasProbe() const;
+
+    void addSample(Stage stage, qint64 nsecs);
+
+private:
+    typedef struct
+    {
+        qint64 receiveTime;
+        qint64 flushTime;
+    } PendingEvent;
+
+    QElapsedTimer m_clock;
+    QAtomicInt m_enabled;
+
+    /** Guards everything but m_enabled. Input is flushed and
+     *  output is written by the MasterTimer or universe threads,
+     *  while statistics are read by anyone */
+    mutable QMutex m_mutex;
+
+    quint32 m_probeUniverse;
+    quint32 m_probeChannel;
+    uchar m_probeValue;
+
+    PendingEvent m_pending[LATENCYTRACER_MAX_PENDING];
+    int m_pendingCount;
+    quint32 m_droppedCount;
+
+    /*********************************************************************
+     * Statistics
+     *********************************************************************/
+public:
+    /** Get the number of samples collected for a stage */
+    quint32 samplesCount(Stage stage) const;
+
+    /** Get the minimum, maximum and mean of a stage in nanoseconds */
+    qint64 minimum(Stage stage) const;
+    qint64 maximum(Stage stage) const;
+    qint64 mean(Stage stage) const;
+
+    /** Get the upper bound in nanoseconds of the histogram bucket
+     *  holding the given percentile (0.0 - 1.0) of a stage */
+    qint64 percentile(Stage stage, qreal fraction) const;
+
+    /** Get a copy of the histogram of a stage */
+    QVector<quint32> histogram(Stage stage) const;
+
+    /** Get the upper bound in nanoseconds of a histogram bucket */
+    static qint64 bucketUpperBound(int bucket);
+
+    /** Get the number of input events dropped because too
+     *  many of them were waiting for an output frame */
+    quint32 droppedCount() const;
+
+private:
+    typedef struct
+    {
+        quint32 buckets[LATENCYTRACER_BUCKETS];
+        quint32 count;
+        qint64 min;
+        qint64 max;
+        qint64 sum;
+    } Histogram;
+
+    Histogram m_histograms[StagesCount];
+};
+
+/** @} */
+
+#endif
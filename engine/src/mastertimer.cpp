@@ -21,6 +21,7 @@
 #include <QDebug>
 #include <QSettings>
 #include <QMutexLocker>
+#include <qmath.h>
 
 #if defined(WIN32) || defined(Q_OS_WIN)
 #   include "mastertimer-win32.h"
@@ -40,6 +41,11 @@
 #define MASTERTIMER_FREQUENCY "mastertimer/frequency"
 #define LATE_TO_BEAT_THRESHOLD 25
 
+/** How long the time code position runs on from the last
+ *  one received, and how long until it is considered lost, in ms */
+#define TIMECODE_FREEWHEEL_MS  100
+#define TIMECODE_TIMEOUT_MS    1000
+
 /** The timer tick frequency in Hertz */
 uint MasterTimer::s_frequency = 50;
 uint MasterTimer::s_tick = 20;
@@ -65,7 +71,10 @@ MasterTimer::MasterTimer(Doc* doc)
     , m_currentBPM(120)
     , m_beatTimeDuration(500)
     , m_beatRequested(false)
-    , m_lastBeatOffset(0)
+    , m_beatPosition(0)
+    , m_beatConfidence(0)
+    , m_timecodePosition(-1)
+    , m_timecodeTimestamp(0)
 {
     Q_ASSERT(doc != NULL);
     Q_ASSERT(d_ptr != NULL);
@@ -109,48 +118,22 @@ void MasterTimer::timerTick()
     qDebug() << "[MasterTimer] *********** tick:" << ticksCount++ << "**********";
 #endif
 
-    switch (m_beatSourceType)
-    {
-        case Internal:
-        {
-            int elapsedTime = qRound((double)m_beatTimer.nsecsElapsed() / 1000000) + m_lastBeatOffset;
-            //qDebug() << "Elapsed beat:" << elapsedTime;
-            if (elapsedTime >= m_beatTimeDuration)
-            {
-                // it's time to fire a beat
-                m_beatRequested = true;
-
-                // restart the time for the next beat, starting at a delta
-                // milliseconds, otherwise it will generate an unpleasant drift
-                //qDebug() << "Elapsed:" << elapsedTime << ", delta:" << elapsedTime - m_beatTimeDuration;
-                m_lastBeatOffset = elapsedTime - m_beatTimeDuration;
-                m_beatTimer.restart();
-
-                // inform the listening classes that a beat is happening
-                emit beat();
-            }
-        }
-        break;
-        case External:
-        break;
-
-        case None:
-        default:
-            m_beatRequested = false;
-        break;
-    }
+    timerTickBeats();
 
     QList<Universe *> universes = doc->inputOutputMap()->claimUniverses();
 
     timerTickFunctions(universes);
     timerTickDMXSources(universes);
 
+    // Universes just release a semaphore to wake up their thread, so they
+    // are ticked directly from here, without posting an event per universe.
+    // This is done before releasing them, so none can be removed meanwhile.
+    //qDebug() << ">>>>>>>> MASTERTIMER TICK";
+    emit tickReady();
+
     doc->inputOutputMap()->releaseUniverses();
 
     m_beatRequested = false;
-
-    //qDebug() << ">>>>>>>> MASTERTIMER TICK";
-    emit tickReady();
 }
 
 uint MasterTimer::frequency()
@@ -217,12 +200,8 @@ int MasterTimer::runningFunctions() const
     return m_functionList.size();
 }
 
-void MasterTimer::timerTickFunctions(QList<Universe *> universes)
+void MasterTimer::timerTickFunctions(const QList<Universe *> &universes)
 {
-    // List of m_functionList indices that should be removed at the end of this
-    // function. The functions at the indices have been stopped.
-    QList<int> removeList;
-
     bool functionListHasChanged = false;
     bool stoppedAFunction = true;
     bool firstIteration = true;
@@ -230,7 +209,10 @@ void MasterTimer::timerTickFunctions(QList<Universe *> universes)
     while (stoppedAFunction)
     {
         stoppedAFunction = false;
-        removeList.clear();
+
+        // List of m_functionList indices that should be removed at the end of this
+        // round. The functions at the indices have been stopped.
+        m_removeList.clear();
 
         for (int i = 0; i < m_functionList.size(); i++)
         {
@@ -252,7 +234,7 @@ void MasterTimer::timerTickFunctions(QList<Universe *> universes)
                     /* Function should be stopped instead */
                     function->postRun(this, universes);
                     //qDebug() << "[MasterTimer] Add function (ID: " << function->id() << ") to remove list ";
-                    removeList << i; // Don't remove the item from the list just yet.
+                    m_removeList.append(i); // Don't remove the item from the list just yet.
                     functionListHasChanged = true;
                     stoppedAFunction = true;
 
@@ -268,10 +250,8 @@ void MasterTimer::timerTickFunctions(QList<Universe *> universes)
         // on this round. The indices in removeList are automatically sorted because the
         // list is iterated with an int above from 0 to size, so iterating the removeList
         // backwards here will always remove the correct indices.
-        QListIterator <int> it(removeList);
-        it.toBack();
-        while (it.hasPrevious() == true)
-            m_functionList.removeAt(it.previous());
+        for (int i = m_removeList.count() - 1; i >= 0; i--)
+            m_functionList.removeAt(m_removeList.at(i));
 
         firstIteration = false;
     }
@@ -329,7 +309,7 @@ void MasterTimer::unregisterDMXSource(DMXSource *source)
     m_dmxSourceList.removeAll(source);
 }
 
-void MasterTimer::timerTickDMXSources(QList<Universe *> universes)
+void MasterTimer::timerTickDMXSources(const QList<Universe *> &universes)
 {
     /* Lock before accessing the DMX sources list. */
     QMutexLocker lock(&m_dmxSourceListMutex);
@@ -356,10 +336,14 @@ void MasterTimer::setBeatSourceType(MasterTimer::BeatsSourceType type)
     if (type == m_beatSourceType)
         return;
 
-    // alright, this causes a time drift of maximum 1ms per beat
-    // but at the moment I am not looking for a better solution
     m_beatTimeDuration = 60000 / m_currentBPM;
-    m_beatTimer.restart();
+
+    // the beat position carries on, so Functions
+    // don't jump when the source changes
+    if (type == Internal)
+        m_beatClock.setTempo(m_currentBPM);
+    else
+        m_beatClock.reset();
 
     m_beatSourceType = type;
 }
@@ -371,12 +355,15 @@ MasterTimer::BeatsSourceType MasterTimer::beatSourceType() const
 
 void MasterTimer::requestBpmNumber(int bpm)
 {
-    if (bpm == m_currentBPM)
+    if (bpm == m_currentBPM || bpm <= 0)
         return;
 
     m_currentBPM = bpm;
     m_beatTimeDuration = 60000 / m_currentBPM;
-    m_beatTimer.restart();
+
+    // external sources drive the clock tempo with their beats
+    if (m_beatSourceType == Internal)
+        m_beatClock.setTempo(m_currentBPM);
 
     emit bpmNumberChanged(bpm);
 }
@@ -393,7 +380,8 @@ int MasterTimer::beatTimeDuration() const
 
 int MasterTimer::timeToNextBeat() const
 {
-    return m_beatTimeDuration - m_beatTimer.elapsed();
+    double position = m_beatClock.position(-1);
+    return qRound((qFloor(position) + 1 - position) * m_beatTimeDuration);
 }
 
 int MasterTimer::nextBeatTimeOffset() const
@@ -419,9 +407,120 @@ bool MasterTimer::isBeat() const
     return m_beatRequested;
 }
 
-void MasterTimer::requestBeat()
+void MasterTimer::requestBeat(qint64 timestamp, int number)
+{
+    if (timestamp < 0)
+        timestamp = m_beatClock.now();
+
+    // timestamp the beat right away, if the source didn't: the
+    // clock is phase-locked to it at the next timerTick call
+    m_beatClock.beatReceived(timestamp);
+
+    // a source counting its beats tells where the bars start
+    if (number >= 0)
+        m_beatClock.alignBar(number, timestamp);
+}
+
+void MasterTimer::requestTempo(double bpm, qint64 timestamp)
+{
+    m_beatClock.tempoReceived(bpm, timestamp);
+}
+
+void MasterTimer::requestBeatStop(qint64 timestamp)
+{
+    m_beatClock.reset(timestamp);
+}
+
+double MasterTimer::beatPosition() const
+{
+    return m_beatPosition;
+}
+
+double MasterTimer::beatPhase() const
+{
+    return m_beatPosition - qFloor(m_beatPosition);
+}
+
+double MasterTimer::barPosition() const
+{
+    return m_beatClock.barPosition(m_beatPosition);
+}
+
+double MasterTimer::beatConfidence() const
+{
+    return m_beatConfidence;
+}
+
+double MasterTimer::beatClockBpm() const
 {
-    // forceful request of a beat, processed at
-    // the next timerTick call
-    m_beatRequested = true;
+    return m_beatClock.bpm();
+}
+
+void MasterTimer::setBeatsPerBar(int beats)
+{
+    m_beatClock.setBeatsPerBar(beats);
+}
+
+int MasterTimer::beatsPerBar() const
+{
+    return m_beatClock.beatsPerBar();
+}
+
+void MasterTimer::timerTickBeats()
+{
+    if (m_beatSourceType == None)
+    {
+        m_beatRequested = false;
+        return;
+    }
+
+    qint64 now = m_beatClock.now();
+    double previous = m_beatPosition;
+
+    m_beatPosition = m_beatClock.position(now);
+    m_beatConfidence = m_beatClock.confidence(now);
+
+    // a beat happens on the first tick after
+    // the position crosses an integer
+    m_beatRequested = qFloor(m_beatPosition) > qFloor(previous);
+
+    // inform the listening classes that a beat is happening
+    if (m_beatRequested && m_beatSourceType == Internal)
+        emit beat();
+}
+
+/*****************************************************************************
+ * Time code
+ *****************************************************************************/
+
+void MasterTimer::setTimecode(qint64 position, qint64 timestamp)
+{
+    QMutexLocker locker(&m_timecodeMutex);
+    m_timecodePosition = position;
+    m_timecodeTimestamp = timestamp;
+}
+
+bool MasterTimer::timecodeValid() const
+{
+    QMutexLocker locker(&m_timecodeMutex);
+
+    if (m_timecodePosition < 0)
+        return false;
+
+    qint64 elapsed = (m_beatClock.now() - m_timecodeTimestamp) / 1000000;
+    return elapsed < TIMECODE_TIMEOUT_MS;
+}
+
+qint64 MasterTimer::timecodePosition() const
+{
+    QMutexLocker locker(&m_timecodeMutex);
+
+    if (m_timecodePosition < 0)
+        return -1;
+
+    // the source sends a position every quarter frame while it plays,
+    // and only when it locates otherwise: run on between two positions,
+    // but not too far, or a stopped source would drift
+    qint64 elapsed = (m_beatClock.now() - m_timecodeTimestamp) / 1000000;
+    return m_timecodePosition + qBound(qint64(0), elapsed, qint64(TIMECODE_FREEWHEEL_MS));
 }
@@ -21,12 +21,14 @@
 #ifndef MASTERTIMER_H
 #define MASTERTIMER_H
 
-#include <QElapsedTimer>
+#include <QVector>
 #include <QHash>
 #include <QObject>
 #include <QMutex>
 #include <QList>
 
+#include "beatclock.h"
+
 class MasterTimerPrivate;
 class GenericFader;
 class FadeChannel;
@@ -74,6 +76,8 @@ public:
     static uint tick();
 
 signals:
+    /** Emitted by the timer thread at the end of each tick, while
+     *  the universes are still claimed. Connect directly only */
     void tickReady();
 
 private:
@@ -119,13 +123,17 @@ signals:
 
 private:
     /** Execute one timer tick for each registered Function */
-    void timerTickFunctions(QList<Universe *> universes);
+    void timerTickFunctions(const QList<Universe *> &universes);
 
 private:
     /** List of currently running functions */
     QList <Function*> m_functionList;
     QList <Function*> m_startQueue;
 
+    /** Indices of m_functionList to be removed at the end of a tick.
+     *  Kept as a member, so that its storage is reused on every tick */
+    QVector <int> m_removeList;
+
     /** Mutex that guards access to m_startQueue */
     QMutex m_functionListMutex;
 
@@ -155,7 +163,7 @@ public:
 
 private:
     /** Execute one timer tick for each registered DMXSource */
-    void timerTickDMXSources(QList<Universe *> universes);
+    void timerTickDMXSources(const QList<Universe *> &universes);
 
 private:
     /** List of currently registered DMX sources */
@@ -217,18 +225,54 @@ public:
     /** Return true if the current tick is also a beat, otherwise false */
     bool isBeat() const;
 
-    /** Request MasterTimer to generate a beat. This is typically used by
-     *  external beat detectors/generators. Note that this is a request, and
-     *  not an immediate beat generation, since MasterTimer still works with ticks
-     *  so the requested beat will happen in the worst case after a s_tick time, so typically 20ms
-     *  unless otherwise specified by MASTERTIMER_FREQUENCY.
-     *  This is quite safe cause even 300bpm should happen every 200ms. */
-    void requestBeat();
+    /** Inform MasterTimer that an external source generated a beat at
+     *  $timestamp (see QLCIOPlugin::clockTimestamp()), or now if -1.
+     *  This is typically used by external beat detectors/generators.
+     *  The beat locks the beat clock, so isBeat() happens at the first tick
+     *  after the beat predicted by the clock, rather than after the beat
+     *  itself. This filters out the jitter of the beat timestamps.
+     *  $number, if not -1, is the number of the beat counted by the
+     *  source from its transport start, which aligns the bars */
+    void requestBeat(qint64 timestamp = -1, int number = -1);
+
+    /** Inform MasterTimer that an external source measured its tempo,
+     *  like a MIDI clock, at $timestamp (or now if -1) */
+    void requestTempo(double bpm, qint64 timestamp = -1);
+
+    /** Inform MasterTimer that the external source stopped at $timestamp
+     *  (or now if -1). The beat position holds until the next beats */
+    void requestBeatStop(qint64 timestamp = -1);
+
+    /** Get the beat position at the current tick. The integer part counts
+     *  the beats since the clock started, the fractional part is the phase
+     *  of the current beat. Functions with a Beats tempo measure their
+     *  elapsed beats from this, instead of counting isBeat() ticks */
+    double beatPosition() const;
+
+    /** Get the phase of the current beat at the current tick, in [0, 1) */
+    double beatPhase() const;
+
+    /** Get the position within the current bar at the current tick, in beats */
+    double barPosition() const;
+
+    /** Get how reliable the beat position is, in [0, 1] */
+    double beatConfidence() const;
+
+    /** Get the tempo estimated by the beat clock, 0 if unknown */
+    double beatClockBpm() const;
+
+    /** Set/Get the number of beats of a bar */
+    void setBeatsPerBar(int beats);
+    int beatsPerBar() const;
 
 signals:
     void bpmNumberChanged(int bpm);
     void beat();
 
+private:
+    /** Update the beat position and isBeat() for the current tick */
+    void timerTickBeats();
+
 private:
     /** The current type of beat source */
     BeatsSourceType m_beatSourceType;
@@ -236,12 +280,35 @@ private:
     int m_currentBPM;
     /** The duration of a beat in milliseconds according to m_currentBPM */
     int m_beatTimeDuration;
-    /** Flag to request a beat generation at the next MasterTimer tick */
+    /** Flag raised when the current tick is a beat */
     bool m_beatRequested;
-    /** The reference of a platform dependent timer to measure precise elapsed time */
-    QElapsedTimer m_beatTimer;
-    /** Time offset in milliseconds when the last beat occurred */
-    int m_lastBeatOffset;
+    /** The musical time, driven by the current beat source */
+    BeatClock m_beatClock;
+    /** The beat position and its confidence at the current tick */
+    double m_beatPosition;
+    double m_beatConfidence;
+
+    /*********************************************************************
+     * Time code
+     *********************************************************************/
+public:
+    /** Set the position of an external time code, in milliseconds, as
+     *  received at $timestamp (see QLCIOPlugin::clockTimestamp()) */
+    void setTimecode(qint64 position, qint64 timestamp);
+
+    /** Return true if a time code has been received recently */
+    bool timecodeValid() const;
+
+    /** Get the current time code position in milliseconds, running on
+     *  from the last one received for a few frames, -1 if not valid */
+    qint64 timecodePosition() const;
+
+private:
+    mutable QMutex m_timecodeMutex;
+    /** The last time code position received, -1 if none */
+    qint64 m_timecodePosition;
+    /** When m_timecodePosition has been received, in ns */
+    qint64 m_timecodeTimestamp;
 };
 
 /** @} */
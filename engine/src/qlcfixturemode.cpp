@@ -23,6 +23,7 @@
 #include <QString>
 #include <QDebug>
 #include <QVector>
+#include <QSet>
 
 #include "qlcfixturemode.h"
 #include "qlcfixturehead.h"
@@ -307,6 +308,9 @@ int QLCFixtureMode::headForChannel(quint32 chnum) const
 void QLCFixtureMode::cacheHeads()
 {
     QLCChannel *lastChannel = NULL;
+    QSet<quint32> primaryChannels;
+
+    m_secondaryMap.clear();
 
     for (int i = 0; i < m_heads.size(); i++)
     {
@@ -336,6 +340,33 @@ void QLCFixtureMode::cacheHeads()
         {
             //qDebug() << "Channel" << lastChannel->name() << "is primary and" << channel->name() << "is secondary";
             m_secondaryMap[i] = i - 1;
+            primaryChannels.insert(i - 1);
+        }
+        else if (channel->controlByte() == QLCChannel::LSB)
+        {
+            /** A secondary channel not preceded by its primary channel, like
+             *  in Pan, Tilt, Pan Fine, Tilt Fine, goes with the closest
+             *  previous primary channel of the same kind and head */
+            int head = headForChannel(i);
+
+            for (int j = int(i) - 2; j >= 0; j--)
+            {
+                QLCChannel *primary = m_channels.at(j);
+
+                if (primary->controlByte() != QLCChannel::MSB ||
+                    primary->group() != channel->group() ||
+                    primary->colour() != channel->colour() ||
+                    headForChannel(j) != head)
+                    continue;
+
+                // a primary channel has one secondary channel only
+                if (primaryChannels.contains(quint32(j)) == false)
+                {
+                    m_secondaryMap[i] = j;
+                    primaryChannels.insert(j);
+                }
+                break;
+            }
         }
 
         lastChannel = channel;
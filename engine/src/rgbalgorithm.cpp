@@ -29,6 +29,7 @@
 #include "rgbimage.h"
 #include "rgbplain.h"
 #include "rgbtext.h"
+#include "rgbvideo.h"
 #include "doc.h"
 
 #ifdef QT_QML_LIB
@@ -73,10 +74,12 @@ QStringList RGBAlgorithm::algorithms(Doc * doc)
     RGBText text(doc);
     RGBImage image(doc);
     RGBAudio audio(doc);
+    RGBVideo video(doc);
     list << plain.name();
     list << text.name();
     list << image.name();
     list << audio.name();
+    list << video.name();
     list << doc->rgbScriptsCache()->names();
     return list;
 }
@@ -87,6 +90,7 @@ RGBAlgorithm* RGBAlgorithm::algorithm(Doc * doc, const QString& name)
     RGBImage image(doc);
     RGBAudio audio(doc);
     RGBPlain plain(doc);
+    RGBVideo video(doc);
     if (name == text.name())
         return text.clone();
     else if (name == image.name())
@@ -95,6 +99,8 @@ RGBAlgorithm* RGBAlgorithm::algorithm(Doc * doc, const QString& name)
         return audio.clone();
     else if (name == plain.name())
         return plain.clone();
+    else if (name == video.name())
+        return video.clone();
     else
         return doc->rgbScriptsCache()->script(name);
 }
@@ -146,6 +152,12 @@ RGBAlgorithm* RGBAlgorithm::loader(Doc * doc, QXmlStreamReader &root)
         if (plain.loadXML(root) == true)
             algo = plain.clone();
     }
+    else if (type == KXMLQLCRGBVideo)
+    {
+        RGBVideo video(doc);
+        if (video.loadXML(root) == true)
+            algo = video.clone();
+    }
     else
     {
         qWarning() << "Unrecognized RGB algorithm type:" << type;
@@ -54,7 +54,8 @@ public:
         Script,
         Image,
         Audio,
-        Plain
+        Plain,
+        Video
     };
 
     /** Create a clone of the algorithm. Caller takes ownership of the pointer. */
@@ -83,6 +84,13 @@ public:
     /** Load a RGBMap for the given step. */
     virtual void rgbMap(const QSize& size, uint rgb, int step, RGBMap &map) = 0;
 
+    /** Load a RGBMap for the given step to be shown in a preview. Algorithms
+     *  rendering a running source must not drive it from here */
+    virtual void rgbMapPreview(const QSize& size, uint rgb, int step, RGBMap &map)
+    {
+        rgbMap(size, rgb, step, map);
+    }
+
     /** Release resources that may have been acquired in rgbMap() */
     virtual void postRun() {}
 
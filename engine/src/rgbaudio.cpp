@@ -28,27 +28,29 @@
 RGBAudio::RGBAudio(Doc * doc)
     : RGBAlgorithm(doc)
     , m_audioInput(NULL)
-    , m_bandsNumber(-1)
     , m_maxMagnitude(0)
+    , m_volumePower(0)
 {
+    m_frame.sequence = 0;
+    m_frame.binsCount = 0;
 }
 
 RGBAudio::RGBAudio(const RGBAudio& a, QObject *parent)
     : QObject(parent)
     , RGBAlgorithm(a.doc())
     , m_audioInput(NULL)
-    , m_bandsNumber(-1)
     , m_maxMagnitude(0)
+    , m_volumePower(0)
 {
+    m_frame.sequence = 0;
+    m_frame.binsCount = 0;
 }
 
 RGBAudio::~RGBAudio()
 {
     QSharedPointer<AudioCapture> capture(doc()->audioInputCapture());
-    if (capture.data() == m_audioInput && m_bandsNumber > 0)
-    {
-        m_audioInput->unregisterBandsNumber(m_bandsNumber);
-    }
+    if (m_audioInput != NULL && capture.data() == m_audioInput)
+        m_audioInput->unregisterBusConsumer();
 }
 
 RGBAlgorithm* RGBAudio::clone() const
@@ -61,25 +63,36 @@ void RGBAudio::setAudioCapture(AudioCapture* cap)
 {
     qDebug() << Q_FUNC_INFO << "Audio capture set";
 
+    // the previous capture is gone (e.g. the input device changed),
+    // so there's nothing to unregister from
     m_audioInput = cap;
-    connect(m_audioInput, SIGNAL(dataProcessed(double*,int,double,quint32)),
-            this, SLOT(slotAudioBarsChanged(double*,int,double,quint32)));
-    m_bandsNumber = -1;
+    m_frame.sequence = 0;
+    m_spectrumValues.clear();
+    m_maxMagnitude = 0;
+    m_volumePower = 0;
+
+    if (m_audioInput != NULL)
+        m_audioInput->registerBusConsumer();
 }
 
-void RGBAudio::slotAudioBarsChanged(double *spectrumBands, int size,
-                                    double maxMagnitude, quint32 power)
+void RGBAudio::updateSpectrum(int bandsNumber)
 {
-    if (size != m_bandsNumber)
+    if (m_audioInput == NULL)
         return;
 
-    QMutexLocker locker(&m_mutex);
+    const AudioSpectrumBus *bus = m_audioInput->spectrumBus();
 
-    m_spectrumValues.clear();
-    for (int i = 0; i < m_bandsNumber; i++)
-        m_spectrumValues.append(spectrumBands[i]);
-    m_maxMagnitude = maxMagnitude;
-    m_volumePower = power;
+    // nothing new since the last step. Just keep the bars
+    // unless the matrix has been resized
+    if (bus->latestSequence() == m_frame.sequence && m_spectrumValues.count() == bandsNumber)
+        return;
+
+    if (bus->read(m_frame) == false)
+        return;
+
+    m_spectrumValues.resize(bandsNumber);
+    m_maxMagnitude = AudioSpectrumBus::bands(m_frame, bandsNumber, m_spectrumValues.data());
+    m_volumePower = AudioSpectrumBus::power(m_spectrumValues.constData(), bandsNumber);
 }
 
 void RGBAudio::calculateColors(int barsHeight)
@@ -150,15 +163,8 @@ void RGBAudio::rgbMap(const QSize& size, uint rgb, int step, RGBMap &map)
         map[y].fill(0);
     }
 
-    // on the first round, just set the proper number of
-    // spectrum bands to receive
-    if (m_bandsNumber == -1)
-    {
-        m_bandsNumber = size.width();
-        qDebug() << "[RGBAudio] set" << m_bandsNumber << "bars";
-        m_audioInput->registerBandsNumber(m_bandsNumber);
-        return;
-    }
+    updateSpectrum(size.width());
+
     if (m_barColors.count() == 0)
         calculateColors(size.height());
 
@@ -189,15 +195,11 @@ void RGBAudio::postRun()
     QMutexLocker locker(&m_mutex);
 
     QSharedPointer<AudioCapture> capture = doc()->audioInputCapture();
-    if (capture.data() == m_audioInput)
-    {
-        disconnect(m_audioInput, SIGNAL(dataProcessed(double*,int,double,quint32)),
-                   this, SLOT(slotAudioBarsChanged(double*,int,double,quint32)));
-        if (m_bandsNumber > 0)
-            m_audioInput->unregisterBandsNumber(m_bandsNumber);
-    }
+    if (m_audioInput != NULL && capture.data() == m_audioInput)
+        m_audioInput->unregisterBusConsumer();
+
     m_audioInput = NULL;
-    m_bandsNumber = -1;
+    m_spectrumValues.clear();
 }
 
 QString RGBAudio::name() const
@@ -24,6 +24,7 @@
 #include <QMutex>
 
 #include "rgbalgorithm.h"
+#include "audiospectrumbus.h"
 
 /** @addtogroup engine_functions Functions
  * @{
@@ -48,16 +49,18 @@ public:
 private:
     void setAudioCapture(AudioCapture* cap);
 
-protected slots:
-    void slotAudioBarsChanged(double *spectrumBands, int size, double maxMagnitude, quint32 power);
+    /** Read the latest frame of the spectrum bus and compute
+     *  $bandsNumber bands out of it */
+    void updateSpectrum(int bandsNumber);
 
 private:
     void calculateColors(int barsHeight = 0);
 
 protected:
     AudioCapture *m_audioInput;
-    int m_bandsNumber;
     QMutex m_mutex;
+    /** The last frame read from the spectrum bus */
+    AudioSpectrumFrame m_frame;
     QVector<double>m_spectrumValues;
     double m_maxMagnitude;
     quint32 m_volumePower;
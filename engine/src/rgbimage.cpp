@@ -24,6 +24,8 @@
 #include <QPainter>
 #include <QDebug>
 
+#include <string.h>
+
 #include "rgbimage.h"
 #include "qlcmacros.h"
 #include "doc.h"
@@ -34,6 +36,223 @@
 #define KXMLQLCRGBImageOffsetX        QStringLiteral("X")
 #define KXMLQLCRGBImageOffsetY        QStringLiteral("Y")
 
+/****************************************************************************
+ * RGBImageDecoder
+ ****************************************************************************/
+
+RGBImageDecoder::RGBImageDecoder()
+    : QThread()
+    , m_quit(false)
+    , m_cacheLimit(RGBIMAGE_FRAME_CACHE_LIMIT)
+    , m_request(0)
+    , m_requestPending(false)
+    , m_streaming(false)
+    , m_nextFrame(0)
+    , m_decodedCount(0)
+    , m_decodeNext(false)
+    , m_rewind(false)
+{
+}
+
+RGBImageDecoder::~RGBImageDecoder()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_quit = true;
+        m_condition.wakeOne();
+    }
+    wait();
+}
+
+void RGBImageDecoder::request(const QString &filename, const QSize &size, qint64 cacheLimit)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (filename == m_filename && size == m_size && cacheLimit == m_cacheLimit)
+        return;
+
+    m_filename = filename;
+    m_size = size;
+    m_cacheLimit = cacheLimit;
+    m_request++;
+    m_requestPending = true;
+    m_frames.clear();
+    m_streaming = false;
+    m_decodedCount = 0;
+
+    if (isRunning() == false)
+        start();
+    else
+        m_condition.wakeOne();
+}
+
+void RGBImageDecoder::reset()
+{
+    QMutexLocker locker(&m_mutex);
+
+    // the frames being decoded, if any, are discarded
+    m_filename.clear();
+    m_size = QSize();
+    m_request++;
+    m_requestPending = false;
+    m_frames.clear();
+    m_streaming = false;
+    m_decodedCount = 0;
+}
+
+void RGBImageDecoder::rewind()
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_nextFrame = 0;
+    if (m_streaming && m_frames.isEmpty() == false)
+    {
+        m_rewind = true;
+        m_condition.wakeOne();
+    }
+}
+
+bool RGBImageDecoder::takeFrame(QVector<QRgb> &pixels)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (m_frames.isEmpty())
+        return false;
+
+    if (m_streaming)
+    {
+        pixels = m_frames.at(0);
+        m_decodeNext = true;
+        m_condition.wakeOne();
+        return true;
+    }
+
+    pixels = m_frames.at(m_nextFrame);
+    m_nextFrame = (m_nextFrame + 1) % m_frames.count();
+    return true;
+}
+
+int RGBImageDecoder::framesCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_frames.count();
+}
+
+bool RGBImageDecoder::isStreaming() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_streaming;
+}
+
+quint32 RGBImageDecoder::decodedCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_decodedCount;
+}
+
+void RGBImageDecoder::run()
+{
+    // the movie lives and is used on this thread only
+    QMovie movie;
+    QSize size;
+    quint32 request = 0;
+
+    QMutexLocker locker(&m_mutex);
+
+    while (m_quit == false)
+    {
+        if (m_requestPending)
+        {
+            m_requestPending = false;
+            request = m_request;
+            size = m_size;
+            QString filename = m_filename;
+            qint64 cacheLimit = m_cacheLimit;
+            locker.unlock();
+
+            movie.setFileName(filename);
+            int framesCount = movie.frameCount();
+            qint64 frameBytes = qint64(size.width()) * size.height() * qint64(sizeof(QRgb));
+            bool streaming = framesCount <= 0 || framesCount * frameBytes > cacheLimit;
+
+            if (streaming)
+                qDebug() << "[RGBImage] Animation of" << framesCount << "frames exceeds the cache, decoding while playing";
+
+            QVector<QVector<QRgb> > frames;
+            movie.jumpToFrame(0);
+            frames.append(scaleFrame(movie.currentImage(), size));
+
+            for (int i = 1; streaming == false && i < framesCount; i++)
+            {
+                if (movie.jumpToNextFrame() == false)
+                    break;
+                frames.append(scaleFrame(movie.currentImage(), size));
+            }
+
+            locker.relock();
+            if (request == m_request)
+            {
+                m_frames = frames;
+                m_streaming = streaming;
+                m_nextFrame = 0;
+                m_decodedCount = frames.count();
+                m_decodeNext = false;
+                m_rewind = false;
+            }
+            continue;
+        }
+
+        if (m_streaming && (m_decodeNext || m_rewind) && request == m_request)
+        {
+            bool rewind = m_rewind;
+            m_decodeNext = false;
+            m_rewind = false;
+            locker.unlock();
+
+            // restart from the first frame when the animation is over
+            if (rewind || movie.jumpToNextFrame() == false)
+                movie.jumpToFrame(0);
+            QVector<QRgb> frame = scaleFrame(movie.currentImage(), size);
+
+            locker.relock();
+            if (request == m_request && m_frames.isEmpty() == false)
+            {
+                m_frames[0] = frame;
+                m_decodedCount++;
+            }
+            continue;
+        }
+
+        m_condition.wait(&m_mutex);
+    }
+}
+
+QVector<QRgb> RGBImageDecoder::scaleFrame(const QImage &image, const QSize &size)
+{
+    QVector<QRgb> pixels(size.width() * size.height(), 0);
+    if (image.isNull())
+        return pixels;
+
+    QImage frame = image.scaled(size).convertToFormat(QImage::Format_ARGB32);
+    int width = qMin(size.width(), frame.width());
+    int height = qMin(size.height(), frame.height());
+
+    for (int y = 0; y < height; y++)
+    {
+        const QRgb *line = reinterpret_cast<const QRgb *>(frame.constScanLine(y));
+        QRgb *row = pixels.data() + y * size.width();
+
+        for (int x = 0; x < width; x++)
+            row[x] = qAlpha(line[x]) == 0 ? 0 : line[x];
+    }
+
+    return pixels;
+}
+
+/****************************************************************************
+ * RGBImage
+ ****************************************************************************/
+
 RGBImage::RGBImage(Doc * doc)
     : RGBAlgorithm(doc)
     , m_filename("")
@@ -41,6 +260,9 @@ RGBImage::RGBImage(Doc * doc)
     , m_animationStyle(Static)
     , m_xOffset(0)
     , m_yOffset(0)
+    , m_framesCount(0)
+    , m_frameCacheValid(false)
+    , m_frameCacheLimit(RGBIMAGE_FRAME_CACHE_LIMIT)
 {
 }
 
@@ -51,6 +273,9 @@ RGBImage::RGBImage(const RGBImage& i)
     , m_animationStyle(i.animationStyle())
     , m_xOffset(i.xOffset())
     , m_yOffset(i.yOffset())
+    , m_framesCount(0)
+    , m_frameCacheValid(false)
+    , m_frameCacheLimit(i.frameCacheLimit())
 {
     reloadImage();
 }
@@ -101,6 +326,7 @@ void RGBImage::setImageData(int width, int height, const QByteArray &pixelData)
         }
     }
     m_image = newImg;
+    invalidateFrameCache();
 }
 
 bool RGBImage::animatedSource() const
@@ -110,13 +336,18 @@ bool RGBImage::animatedSource() const
 
 void RGBImage::rewindAnimation()
 {
+    QMutexLocker locker(&m_mutex);
+
     if (m_animatedSource)
-        m_animatedPlayer.jumpToFrame(0);
+        m_decoder.rewind();
 }
 
 void RGBImage::reloadImage()
 {
+    QMutexLocker locker(&m_mutex);
+
     m_animatedSource = false;
+    invalidateFrameCache();
 
     if (m_filename.isEmpty())
     {
@@ -124,8 +355,6 @@ void RGBImage::reloadImage()
         return;
     }
 
-    QMutexLocker locker(&m_mutex);
-
     if (m_filename.endsWith(".gif"))
     {
         m_animatedPlayer.setFileName(m_filename);
@@ -218,6 +447,72 @@ int RGBImage::yOffset() const
     return m_yOffset;
 }
 
+/****************************************************************************
+ * Frame cache
+ ****************************************************************************/
+
+void RGBImage::setFrameCacheLimit(qint64 bytes)
+{
+    QMutexLocker locker(&m_mutex);
+    m_frameCacheLimit = bytes;
+    invalidateFrameCache();
+}
+
+qint64 RGBImage::frameCacheLimit() const
+{
+    return m_frameCacheLimit;
+}
+
+void RGBImage::invalidateFrameCache()
+{
+    m_frameCache.clear();
+    m_frameSize = QSize();
+    m_framesCount = 0;
+    m_frameCacheValid = false;
+
+    m_decoder.reset();
+    m_animationPixels.clear();
+}
+
+bool RGBImage::updateFrameCache()
+{
+    // a static image is scrolled at its own size, so
+    // it doesn't depend on the map size at all
+    if (m_frameCacheValid)
+        return m_framesCount > 0;
+
+    m_frameCacheValid = true;
+    if (m_image.width() == 0 || m_image.height() == 0)
+        return false;
+
+    m_frameSize = m_image.size();
+    m_frameCache.resize(m_frameSize.width() * m_frameSize.height());
+    m_framesCount = 1;
+    storeFrame(m_image, 0);
+    return true;
+}
+
+void RGBImage::storeFrame(const QImage& image, int index)
+{
+    QImage frame = image.convertToFormat(QImage::Format_ARGB32);
+    int width = m_frameSize.width();
+    int height = qMin(m_frameSize.height(), frame.height());
+    QRgb *dst = m_frameCache.data() + index * width * m_frameSize.height();
+
+    if (frame.width() < width || height < m_frameSize.height())
+        memset(dst, 0, width * m_frameSize.height() * sizeof(QRgb));
+
+    for (int y = 0; y < height; y++)
+    {
+        const QRgb *line = reinterpret_cast<const QRgb *>(frame.constScanLine(y));
+        QRgb *row = dst + y * width;
+        int count = qMin(width, frame.width());
+
+        for (int x = 0; x < count; x++)
+            row[x] = qAlpha(line[x]) == 0 ? 0 : line[x];
+    }
+}
+
 /****************************************************************************
  * RGBAlgorithm
  ****************************************************************************/
@@ -226,18 +521,23 @@ int RGBImage::rgbMapStepCount(const QSize& size)
 {
     QMutexLocker locker(&m_mutex);
 
+    // the frames of an animated source are scaled to the map
+    // by m_decoder, so they are scrolled at the map size
+    QSize frameSize = m_animatedSource ? size : m_image.size();
+
     switch (animationStyle())
     {
         default:
         case Static:
             return 1;
         case Horizontal:
-            return m_image.width();
+            return MAX(1, frameSize.width());
         case Vertical:
-            return m_image.height();
+            return MAX(1, frameSize.height());
         case Animation:
-            qDebug() << m_image.width() << " " << size.width() << " " << (m_image.width() / size.width());
-            return MAX(1, m_image.width() / size.width());
+            if (size.width() <= 0)
+                return 1;
+            return MAX(1, frameSize.width() / size.width());
     }
 }
 
@@ -257,8 +557,34 @@ void RGBImage::rgbMap(const QSize& size, uint rgb, int step, RGBMap &map)
 
     QMutexLocker locker(&m_mutex);
 
-    if (m_animatedSource == false && (m_image.width() == 0 || m_image.height() == 0))
-        return;
+    const QRgb *frame;
+    int frameWidth;
+    int frameHeight;
+
+    if (m_animatedSource)
+    {
+        if (size.width() <= 0 || size.height() <= 0)
+            return;
+
+        // the frames are decoded by m_decoder and never on this thread.
+        // Until the first one is ready the map is left untouched
+        m_decoder.request(m_filename, size, m_frameCacheLimit);
+        if (m_decoder.takeFrame(m_animationPixels) == false)
+            return;
+
+        frame = m_animationPixels.constData();
+        frameWidth = size.width();
+        frameHeight = size.height();
+    }
+    else
+    {
+        if (updateFrameCache() == false)
+            return;
+
+        frame = m_frameCache.constData();
+        frameWidth = m_frameSize.width();
+        frameHeight = m_frameSize.height();
+    }
 
     int xOffs = xOffset();
     int yOffs = yOffset();
@@ -279,24 +605,25 @@ void RGBImage::rgbMap(const QSize& size, uint rgb, int step, RGBMap &map)
         break;
     }
 
-    if (m_animatedSource)
-    {
-        m_animatedPlayer.jumpToNextFrame();
-        m_image = m_animatedPlayer.currentImage().scaled(size);
-    }
+    // wrap the offsets once, so that each row is at most two copies
+    xOffs = ((xOffs % frameWidth) + frameWidth) % frameWidth;
+    yOffs = ((yOffs % frameHeight) + frameHeight) % frameHeight;
 
     map.resize(size.height());
     for (int y = 0; y < size.height(); y++)
     {
         map[y].resize(size.width());
-        for (int x = 0; x < size.width(); x++)
-        {
-            int x1 = (x + xOffs) % m_image.width();
-            int y1 = (y + yOffs) % m_image.height();
 
-            map[y][x] = m_image.pixel(x1,y1);
-            if (qAlpha(map[y][x]) == 0)
-                map[y][x] = 0;
+        const QRgb *line = frame + ((y + yOffs) % frameHeight) * frameWidth;
+        uint *row = map[y].data();
+        int x1 = xOffs;
+
+        for (int x = 0; x < size.width();)
+        {
+            int count = qMin(size.width() - x, frameWidth - x1);
+            memcpy(row + x, line + x1, count * sizeof(QRgb));
+            x += count;
+            x1 = 0;
         }
     }
 }
@@ -22,8 +22,11 @@
 #ifndef RGBIMAGE_H
 #define RGBIMAGE_H
 
+#include <QWaitCondition>
 #include <QMutexLocker>
 #include <QString>
+#include <QThread>
+#include <QVector>
 #include <QMovie>
 #include <QImage>
 
@@ -35,6 +38,88 @@
 
 #define KXMLQLCRGBImage QStringLiteral("Image")
 
+/** Default maximum size in bytes of the decoded animation frames */
+#define RGBIMAGE_FRAME_CACHE_LIMIT  (32 * 1024 * 1024)
+
+/**
+ * RGBImageDecoder decodes the frames of an animated image on its own
+ * thread, scaled to the size of the map, so that the MasterTimer thread
+ * rendering the matrix never waits for an image to be decoded.
+ *
+ * An animation fitting the cache limit is decoded completely, once.
+ * Otherwise only one frame is kept: each time it is taken, the decoder
+ * starts decoding the following one. A step coming before that is
+ * done gets the previous frame again.
+ */
+class RGBImageDecoder final : public QThread
+{
+public:
+    RGBImageDecoder();
+    ~RGBImageDecoder();
+
+    /** Request the frames of the animation $filename scaled to $size.
+     *  Nothing is done if they are already decoded or being decoded.
+     *  Thread safe */
+    void request(const QString& filename, const QSize& size, qint64 cacheLimit);
+
+    /** Drop the decoded frames, so that the next request
+     *  decodes the animation again. Thread safe */
+    void reset();
+
+    /** Restart the animation from its first frame. Thread safe */
+    void rewind();
+
+    /**
+     * Get the next frame of the requested animation. Frames are
+     * implicitly shared, so no pixel is copied. Thread safe.
+     *
+     * @return false if no frame is decoded yet
+     */
+    bool takeFrame(QVector<QRgb>& pixels);
+
+    /** Get the number of frames kept in memory */
+    int framesCount() const;
+
+    /** Return true if the animation doesn't fit the cache limit
+     *  and its frames are decoded one at a time, while playing */
+    bool isStreaming() const;
+
+    /** Get the number of frames decoded since the last request */
+    quint32 decodedCount() const;
+
+protected:
+    /** @reimp */
+    void run() override;
+
+private:
+    /** Scale $image to $size, clearing the pixels that are fully transparent */
+    static QVector<QRgb> scaleFrame(const QImage& image, const QSize& size);
+
+private:
+    /** Guards everything below, shared with the thread rendering the matrix */
+    mutable QMutex m_mutex;
+    QWaitCondition m_condition;
+    bool m_quit;
+
+    /** The last request. Each new request increases m_request,
+     *  so the frames of an older one are discarded */
+    QString m_filename;
+    QSize m_size;
+    qint64 m_cacheLimit;
+    quint32 m_request;
+    bool m_requestPending;
+
+    QVector<QVector<QRgb> > m_frames;
+    bool m_streaming;
+    int m_nextFrame;
+    quint32 m_decodedCount;
+
+    /** Flags raised when a streamed frame has been taken and the next
+     *  one has to be decoded, or when it has to be the first one */
+    bool m_decodeNext;
+    bool m_rewind;
+};
+
 class RGBImage final : public RGBAlgorithm
 {
 public:
@@ -98,6 +183,40 @@ private:
     int m_xOffset;
     int m_yOffset;
 
+    /************************************************************************
+     * Frame cache
+     ************************************************************************/
+public:
+    /** Set the maximum amount of memory, in bytes, used to keep the frames
+     *  of an animated source decoded. Animations that don't fit are decoded
+     *  one frame at a time while playing */
+    void setFrameCacheLimit(qint64 bytes);
+    qint64 frameCacheLimit() const;
+
+private:
+    /** Drop the decoded frames. Must be called with m_mutex locked */
+    void invalidateFrameCache();
+
+    /** Make sure the static image is cached. Must be called with m_mutex locked */
+    bool updateFrameCache();
+
+    /** Copy $image in the cached frame at $index, clearing the pixels
+     *  that are fully transparent */
+    void storeFrame(const QImage& image, int index);
+
+private:
+    /** The static image, kept at its own size to be scrolled */
+    QVector<QRgb> m_frameCache;
+    QSize m_frameSize;
+    int m_framesCount;
+    bool m_frameCacheValid;
+    qint64 m_frameCacheLimit;
+
+    /** The frames of an animated source, decoded on their own thread */
+    RGBImageDecoder m_decoder;
+    /** The animation frame being rendered, shared with m_decoder */
+    QVector<QRgb> m_animationPixels;
+
     /************************************************************************
      * RGBAlgorithm
      ************************************************************************/
@@ -33,6 +33,7 @@
 #include "fadechannel.h"
 #include "rgbmatrix.h"
 #include "rgbimage.h"
+#include "rgbvideo.h"
 #include "doc.h"
 
 #define KXMLQLCRGBMatrixStartColor      QStringLiteral("MonoColor")
@@ -73,6 +74,9 @@ RGBMatrix::RGBMatrix(Doc *doc)
     , m_stepHandler(new RGBMatrixStep())
     , m_stepsCount(0)
     , m_stepBeatDuration(0)
+    , m_runTime(0)
+    , m_directOutput(false)
+    , m_pixelMapUpToDate(false)
     , m_controlMode(RGBMatrix::ControlModeRgb)
 {
     setName(tr("New RGB Matrix"));
@@ -82,6 +86,12 @@ RGBMatrix::RGBMatrix(Doc *doc)
     setColor(0, Qt::red);
 
     setAlgorithm(RGBAlgorithm::algorithm(doc, "Stripes"));
+
+    // the pixel map follows the heads and the channels of the group
+    connect(doc, SIGNAL(fixtureGroupChanged(quint32)),
+            this, SLOT(slotFixtureGroupChanged(quint32)));
+    connect(doc, SIGNAL(fixtureChanged(quint32)),
+            this, SLOT(slotFixtureChanged(quint32)));
 }
 
 RGBMatrix::~RGBMatrix()
@@ -130,6 +140,7 @@ quint32 RGBMatrix::totalDuration()
 void RGBMatrix::setDimmerControl(bool dimmerControl)
 {
     m_dimmerControl = dimmerControl;
+    m_pixelMapUpToDate = false;
 }
 
 bool RGBMatrix::dimmerControl() const
@@ -200,6 +211,7 @@ void RGBMatrix::setFixtureGroup(quint32 id)
         m_group = doc()->fixtureGroup(m_fixtureGroupID);
     }
     m_stepsCount = algorithmStepsCount();
+    m_pixelMapUpToDate = false;
 }
 
 QList<quint32> RGBMatrix::components()
@@ -210,6 +222,24 @@ QList<quint32> RGBMatrix::components()
     return QList<quint32>();
 }
 
+void RGBMatrix::slotFixtureGroupChanged(quint32 id)
+{
+    if (id != m_fixtureGroupID)
+        return;
+
+    QMutexLocker algorithmLocker(&m_algorithmMutex);
+    m_pixelMapUpToDate = false;
+}
+
+void RGBMatrix::slotFixtureChanged(quint32 id)
+{
+    QMutexLocker algorithmLocker(&m_algorithmMutex);
+
+    // a fixture moved to another address or mode
+    if (m_group != NULL && m_group->fixtureList().contains(id))
+        m_pixelMapUpToDate = false;
+}
+
 /****************************************************************************
  * Algorithm
  ****************************************************************************/
@@ -300,7 +330,7 @@ void RGBMatrix::previewMap(int step, RGBMatrixStep *handler)
     if (m_group != NULL)
     {
         setMapColors(m_algorithm);
-        m_algorithm->rgbMap(m_group->size(), handler->stepColor().rgb(), step, handler->m_map);
+        m_algorithm->rgbMapPreview(m_group->size(), handler->stepColor().rgb(), step, handler->m_map);
     }
 }
 
@@ -631,6 +661,9 @@ void RGBMatrix::preRun(MasterTimer *timer)
     }
 
     m_roundTime.restart();
+    m_runTime = 0;
+    m_directOutput = false;
+    m_pixelMapUpToDate = false;
 
     Function::preRun(timer);
 }
@@ -661,16 +694,40 @@ void RGBMatrix::write(MasterTimer *timer, QList<Universe *> universes)
 
         if (isPaused() == false)
         {
-            // Get a new map every time elapsed is reset to zero
-            if (elapsed() < MasterTimer::tick())
+            bool newStep = elapsed() < MasterTimer::tick();
+
+            // Get a new map every time elapsed is reset to zero,
+            // or on every tick for a video following the running time
+            if (newStep || m_runAlgorithm->type() == RGBAlgorithm::Video)
             {
-                if (tempoType() == Beats)
+                if (newStep && tempoType() == Beats)
                     m_stepBeatDuration = beatsToTime(duration(), timer->beatTimeDuration());
 
+                if (m_runAlgorithm->type() == RGBAlgorithm::Video)
+                    static_cast<RGBVideo*> (m_runAlgorithm)->setPlaybackTime(m_runTime);
+
                 //qDebug() << "RGBMatrix step" << m_stepHandler->currentStepIndex() << ", color:" << QString::number(m_stepHandler->stepColor().rgb(), 16);
                 m_runAlgorithm->rgbMap(m_group->size(), m_stepHandler->stepColor().rgb(),
                                        m_stepHandler->currentStepIndex(), m_stepHandler->m_map);
-                updateMapChannels(m_stepHandler->m_map, m_group, universes);
+
+                // Switching between FadeChannels and the pixel map: the
+                // values written by the other way must not linger
+                bool direct = canWriteDirect();
+                if (direct != m_directOutput)
+                {
+                    foreach (QSharedPointer<GenericFader> fader, m_fadersMap)
+                    {
+                        if (!fader.isNull())
+                            fader->removeAll();
+                    }
+                    m_directOutput = direct;
+                    m_pixelMapUpToDate = false;
+                }
+
+                if (m_directOutput)
+                    updatePixelLayers(m_stepHandler->m_map, universes);
+                else
+                    updateMapChannels(m_stepHandler->m_map, m_group, universes);
             }
         }
     }
@@ -679,17 +736,17 @@ void RGBMatrix::write(MasterTimer *timer, QList<Universe *> universes)
     {
         // Increment the ms elapsed time
         incrementElapsed();
+        m_runTime += MasterTimer::tick();
 
         /* Check if we need to change direction, stop completely or go to next step
          * The cases are:
          * 1- time tempo type: act normally, on ms elapsed time
-         * 2- beat tempo type, beat occurred: check if the elapsed beats is a multiple of
-         *    the step beat duration. If so, proceed to the next step
-         * 3- beat tempo type, not beat: if the ms elapsed time reached the step beat
-         *    duration in ms, and the ms time to the next beat is not less than 1/16 of
-         *    the step beat duration in ms, then proceed to the next step. If the ms time to the
-         *    next beat is less than 1/16 of the step beat duration in ms, then defer the step
-         *    change to case #2, to resync the matrix to the next beat
+         * 2- beat tempo type: the elapsed beats follow the position of the beat
+         *    clock, so proceed to the next step when they reach the step duration.
+         *    The step boundaries stay locked to the beats, even between beats
+         * 3- beat tempo type, no beat source: nothing drives the beat clock, so
+         *    proceed to the next step when the ms elapsed time reached the step
+         *    beat duration in ms
          */
         if (tempoType() == Time && elapsed() >= duration())
         {
@@ -697,19 +754,17 @@ void RGBMatrix::write(MasterTimer *timer, QList<Universe *> universes)
         }
         else if (tempoType() == Beats)
         {
-            if (timer->isBeat())
+            updateElapsedBeats(timer);
+            if (elapsedBeats() >= duration())
             {
-                incrementElapsedBeats();
-                qDebug() << "Elapsed beats:" << elapsedBeats() << ", time elapsed:" << elapsed() << ", step time:" << m_stepBeatDuration;
-                if (elapsedBeats() % duration() == 0)
-                {
-                    roundCheck();
-                    resetElapsed();
-                }
+                roundCheck();
+                // keep the beats exceeding the step, so the
+                // next one stays locked to the beat clock
+                roundElapsed(0);
+                roundElapsedBeats(duration());
             }
-            else if (elapsed() >= m_stepBeatDuration && (uint)timer->timeToNextBeat() > m_stepBeatDuration / 16)
+            else if (timer->beatSourceType() == MasterTimer::None && elapsed() >= m_stepBeatDuration)
             {
-                qDebug() << "Elapsed exceeded";
                 roundCheck();
             }
         }
@@ -740,6 +795,10 @@ void RGBMatrix::postRun(MasterTimer *timer, QList<Universe *> universes)
     }
 
     m_fadersMap.clear();
+    m_pixelMap.clear();
+    m_pixelLayers.clear();
+    m_pixelLayerUniverses.clear();
+    m_pixelMapUpToDate = false;
 
     {
         QMutexLocker algorithmLocker(&m_algorithmMutex);
@@ -768,12 +827,9 @@ void RGBMatrix::roundCheck()
         roundElapsed(duration());
 }
 
-FadeChannel *RGBMatrix::getFader(Universe *universe, quint32 fixtureID, quint32 channel)
+QSharedPointer<GenericFader> RGBMatrix::getUniverseFader(Universe *universe)
 {
-    // get the universe Fader first. If doesn't exist, create it
-    if (universe == NULL)
-        return NULL;
-
+    // get the universe Fader. If doesn't exist, create it
     QSharedPointer<GenericFader> fader = m_fadersMap.value(universe->id(), QSharedPointer<GenericFader>());
     if (fader.isNull())
     {
@@ -785,7 +841,15 @@ FadeChannel *RGBMatrix::getFader(Universe *universe, quint32 fixtureID, quint32
         m_fadersMap[universe->id()] = fader;
     }
 
-    return fader->getChannelFader(doc(), universe, fixtureID, channel);
+    return fader;
+}
+
+FadeChannel *RGBMatrix::getFader(Universe *universe, quint32 fixtureID, quint32 channel)
+{
+    if (universe == NULL)
+        return NULL;
+
+    return getUniverseFader(universe)->getChannelFader(doc(), universe, fixtureID, channel);
 }
 
 void RGBMatrix::updateFaderValues(FadeChannel *fc, uchar value, uint fadeTime)
@@ -816,109 +880,228 @@ void RGBMatrix::updateMapChannels(const RGBMap& map, const FixtureGroup *grp, QL
         if (fxi == NULL)
             continue;
 
-        QLCFixtureHead head = fxi->head(grpHead.head);
-
         if (pt.y() >= map.count() || pt.x() >= map[pt.y()].count())
             continue;
 
         uint col = map[pt.y()][pt.x()];
-        QVector<quint32> channelList;
-        QVector<uchar> valueList;
+        QVector<QPair<quint32, PixelComponent> > channels = headChannels(fxi, fxi->head(grpHead.head));
+        quint32 absAddress = fxi->universeAddress();
 
-        if (m_controlMode == ControlModeRgb)
+        for (int i = 0; i < channels.count(); i++)
         {
-            channelList = head.rgbChannels();
+            quint32 channel = channels.at(i).first;
+            if (channel == QLCChannel::invalid())
+                continue;
 
-            if (channelList.size() == 3)
-            {
-                valueList.append(qRed(col));
-                valueList.append(qGreen(col));
-                valueList.append(qBlue(col));
-            }
-            else
-            {
-                channelList = head.cmyChannels();
+            quint32 universeIndex = floor((absAddress + channel) / 512);
 
-                if (channelList.size() == 3)
-                {
-                    // CMY color mixing
-                    QColor cmyCol(col);
-                    valueList.append(cmyCol.cyan());
-                    valueList.append(cmyCol.magenta());
-                    valueList.append(cmyCol.yellow());
-                }
-            }
+            FadeChannel *fc = getFader(universes.at(universeIndex), grpHead.fxi, channel);
+            updateFaderValues(fc, pixelComponentValue(col, channels.at(i).second), fadeTime);
         }
-        else if (m_controlMode == ControlModeShutter)
-        {
-            channelList = head.shutterChannels();
+    }
+}
 
-            if (channelList.size())
-            {
-                // make sure only one channel is in the list
-                channelList.resize(1);
-                valueList.append(rgbToGrey(col));
-            }
+QVector<QPair<quint32, RGBMatrix::PixelComponent> > RGBMatrix::headChannels(const Fixture *fxi, const QLCFixtureHead &head) const
+{
+    QVector<QPair<quint32, PixelComponent> > channels;
+
+    if (m_controlMode == ControlModeRgb)
+    {
+        QVector<quint32> rgb = head.rgbChannels();
+
+        if (rgb.size() == 3)
+        {
+            channels.append(qMakePair(rgb.at(0), PixelRed));
+            channels.append(qMakePair(rgb.at(1), PixelGreen));
+            channels.append(qMakePair(rgb.at(2), PixelBlue));
         }
-        else if (m_controlMode == ControlModeDimmer || m_dimmerControl)
+        else
         {
-            // Collect all dimmers that affect current head:
-            // They are the master dimmer (affects whole fixture)
-            // and per-head dimmer.
-            //
-            // If there are no RGB or CMY channels, the least important* dimmer channel
-            // is used to create grayscale image.
-            //
-            // The rest of the dimmer channels are set to full if dimmer control is
-            // enabled and target color is > 0 (see
-            // https://www.qlcplus.org/forum/viewtopic.php?f=29&t=11090)
-            //
-            // Note: If there is only one head, and only one dimmer channel,
-            // make it a master dimmer in fixture definition.
-            //
-            // *least important - per head dimmer if present,
-            // otherwise per fixture dimmer if present
-
-            quint32 masterDim = fxi->masterIntensityChannel();
-            quint32 headDim = head.channelNumber(QLCChannel::Intensity, QLCChannel::MSB);
-
-            if (masterDim != QLCChannel::invalid())
-            {
-                channelList.append(masterDim);
-                valueList.append(rgbToGrey(col));
-            }
+            QVector<quint32> cmy = head.cmyChannels();
 
-            if (headDim != QLCChannel::invalid() && headDim != masterDim)
+            if (cmy.size() == 3)
             {
-                channelList.append(headDim);
-                valueList.append(rgbToGrey(col) == 0 ? 0 : 255);
+                // CMY color mixing
+                channels.append(qMakePair(cmy.at(0), PixelCyan));
+                channels.append(qMakePair(cmy.at(1), PixelMagenta));
+                channels.append(qMakePair(cmy.at(2), PixelYellow));
             }
         }
-        else
-        {
-            if (m_controlMode == ControlModeWhite)
-                channelList.append(head.channelNumber(QLCChannel::White, QLCChannel::MSB));
-            else if (m_controlMode == ControlModeAmber)
-                channelList.append(head.channelNumber(QLCChannel::Amber, QLCChannel::MSB));
-            else if (m_controlMode == ControlModeUV)
-                channelList.append(head.channelNumber(QLCChannel::UV, QLCChannel::MSB));
-
-            valueList.append(rgbToGrey(col));
-        }
+    }
+    else if (m_controlMode == ControlModeShutter)
+    {
+        QVector<quint32> shutters = head.shutterChannels();
+
+        // make sure only one channel is used
+        if (shutters.size())
+            channels.append(qMakePair(shutters.first(), PixelGrey));
+    }
+    else if (m_controlMode == ControlModeDimmer || m_dimmerControl)
+    {
+        // Collect all dimmers that affect current head:
+        // They are the master dimmer (affects whole fixture)
+        // and per-head dimmer.
+        //
+        // If there are no RGB or CMY channels, the least important* dimmer channel
+        // is used to create grayscale image.
+        //
+        // The rest of the dimmer channels are set to full if dimmer control is
+        // enabled and target color is > 0 (see
+        // https://www.qlcplus.org/forum/viewtopic.php?f=29&t=11090)
+        //
+        // Note: If there is only one head, and only one dimmer channel,
+        // make it a master dimmer in fixture definition.
+        //
+        // *least important - per head dimmer if present,
+        // otherwise per fixture dimmer if present
+
+        quint32 masterDim = fxi->masterIntensityChannel();
+        quint32 headDim = head.channelNumber(QLCChannel::Intensity, QLCChannel::MSB);
+
+        if (masterDim != QLCChannel::invalid())
+            channels.append(qMakePair(masterDim, PixelGrey));
+
+        if (headDim != QLCChannel::invalid() && headDim != masterDim)
+            channels.append(qMakePair(headDim, PixelGreyFull));
+    }
+    else
+    {
+        if (m_controlMode == ControlModeWhite)
+            channels.append(qMakePair(head.channelNumber(QLCChannel::White, QLCChannel::MSB), PixelGrey));
+        else if (m_controlMode == ControlModeAmber)
+            channels.append(qMakePair(head.channelNumber(QLCChannel::Amber, QLCChannel::MSB), PixelGrey));
+        else if (m_controlMode == ControlModeUV)
+            channels.append(qMakePair(head.channelNumber(QLCChannel::UV, QLCChannel::MSB), PixelGrey));
+    }
+
+    return channels;
+}
+
+uchar RGBMatrix::pixelComponentValue(uint col, PixelComponent component)
+{
+    switch (component)
+    {
+        case PixelRed: return qRed(col);
+        case PixelGreen: return qGreen(col);
+        case PixelBlue: return qBlue(col);
+        case PixelCyan: return QColor(col).cyan();
+        case PixelMagenta: return QColor(col).magenta();
+        case PixelYellow: return QColor(col).yellow();
+        case PixelGreyFull: return rgbToGrey(col) == 0 ? 0 : 255;
+        case PixelGrey:
+        default:
+            return rgbToGrey(col);
+    }
+}
+
+bool RGBMatrix::canWriteDirect() const
+{
+    uint fadeIn = (overrideFadeInSpeed() == defaultSpeed()) ? fadeInSpeed() : overrideFadeInSpeed();
+    uint fadeOut = (overrideFadeOutSpeed() == defaultSpeed()) ? fadeOutSpeed() : overrideFadeOutSpeed();
+
+    // channels going to zero fade with fadeOutSpeed() while running
+    return fadeIn == 0 && fadeOut == 0 && fadeOutSpeed() == 0 &&
+           blendMode() == Universe::NormalBlend;
+}
+
+void RGBMatrix::updatePixelMap(const FixtureGroup *grp, QList<Universe *> universes)
+{
+    // the heads may have moved to other universes
+    foreach (QSharedPointer<GenericFader> fader, m_fadersMap)
+    {
+        if (!fader.isNull())
+            fader->setLayerMask(QByteArray(), QByteArray());
+    }
+
+    m_pixelMap.clear();
+    m_pixelLayers.clear();
+    m_pixelLayerUniverses.clear();
+
+    QVector<QByteArray> masks;
+    QVector<QByteArray> intensityMasks;
+
+    QMapIterator<QLCPoint, GroupHead> it(grp->headsMap());
+    while (it.hasNext())
+    {
+        it.next();
+        QLCPoint pt = it.key();
+        GroupHead grpHead = it.value();
+        Fixture *fxi = doc()->fixture(grpHead.fxi);
+        if (fxi == NULL)
+            continue;
 
+        QVector<QPair<quint32, PixelComponent> > channels = headChannels(fxi, fxi->head(grpHead.head));
         quint32 absAddress = fxi->universeAddress();
 
-        for (int i = 0; i < channelList.count(); i++)
+        for (int i = 0; i < channels.count(); i++)
         {
-            if (channelList.at(i) == QLCChannel::invalid())
+            quint32 channel = channels.at(i).first;
+            if (channel == QLCChannel::invalid())
                 continue;
 
-            quint32 universeIndex = floor((absAddress + channelList.at(i)) / 512);
+            quint32 universe = (absAddress + channel) / UNIVERSE_SIZE;
+            if (universe >= quint32(universes.count()))
+                continue;
 
-            FadeChannel *fc = getFader(universes.at(universeIndex), grpHead.fxi, channelList.at(i));
-            updateFaderValues(fc, valueList.at(i), fadeTime);
+            int layer = m_pixelLayerUniverses.indexOf(universe);
+            if (layer == -1)
+            {
+                layer = m_pixelLayerUniverses.count();
+                m_pixelLayerUniverses.append(universe);
+                m_pixelLayers.append(QByteArray(UNIVERSE_SIZE, char(0)));
+                masks.append(QByteArray(UNIVERSE_SIZE, char(0)));
+                intensityMasks.append(QByteArray(UNIVERSE_SIZE, char(0)));
+            }
+
+            PixelChannel pc;
+            pc.x = pt.x();
+            pc.y = pt.y();
+            pc.layer = layer;
+            pc.address = (absAddress + channel) % UNIVERSE_SIZE;
+            pc.component = channels.at(i).second;
+            m_pixelMap.append(pc);
+
+            // the fader intensity applies as it would to a FadeChannel
+            FadeChannel fc(doc(), grpHead.fxi, channel);
+            masks[layer][pc.address] = char(0xFF);
+            if ((fc.flags() & FadeChannel::Intensity) && (fc.flags() & FadeChannel::CanFade))
+                intensityMasks[layer][pc.address] = char(0xFF);
         }
     }
+
+    for (int i = 0; i < m_pixelLayerUniverses.count(); i++)
+    {
+        QSharedPointer<GenericFader> fader = getUniverseFader(universes.at(m_pixelLayerUniverses.at(i)));
+        fader->setLayerMask(masks.at(i), intensityMasks.at(i));
+    }
+
+    m_pixelMapUpToDate = true;
+}
+
+void RGBMatrix::updatePixelLayers(const RGBMap &map, QList<Universe *> universes)
+{
+    if (m_pixelMapUpToDate == false)
+        updatePixelMap(m_group, universes);
+
+    QVector<uchar *> layers(m_pixelLayers.count());
+    for (int i = 0; i < m_pixelLayers.count(); i++)
+        layers[i] = reinterpret_cast<uchar *>(m_pixelLayers[i].data());
+
+    // pixels missing from the map keep their previous value
+    for (int i = 0; i < m_pixelMap.count(); i++)
+    {
+        const PixelChannel &pc = m_pixelMap.at(i);
+        if (pc.y >= map.count() || pc.x >= map[pc.y].count())
+            continue;
+
+        layers[pc.layer][pc.address] = pixelComponentValue(map[pc.y][pc.x], pc.component);
+    }
+
+    for (int i = 0; i < m_pixelLayers.count(); i++)
+    {
+        QSharedPointer<GenericFader> fader = getUniverseFader(universes.at(m_pixelLayerUniverses.at(i)));
+        fader->setLayerValues(m_pixelLayers.at(i));
+    }
 }
 
 uchar RGBMatrix::rgbToGrey(uint col)
@@ -979,6 +1162,7 @@ RGBMatrix::ControlMode RGBMatrix::controlMode() const
 void RGBMatrix::setControlMode(RGBMatrix::ControlMode mode)
 {
     m_controlMode = mode;
+    m_pixelMapUpToDate = false;
     emit changed(id());
 }
 
@@ -37,6 +37,8 @@
 #endif
 #include "function.h"
 
+class QLCFixtureHead;
+class Fixture;
 class FixtureGroup;
 class GenericFader;
 class FadeChannel;
@@ -148,6 +150,13 @@ public:
     /** @reimp */
     QList<quint32> components() override;
 
+protected slots:
+    /** Slot that captures Doc::fixtureGroupChanged signals */
+    void slotFixtureGroupChanged(quint32 id);
+
+    /** Slot that captures Doc::fixtureChanged signals */
+    void slotFixtureChanged(quint32 id);
+
 private:
     quint32 m_fixtureGroupID;
     FixtureGroup *m_group;
@@ -252,12 +261,44 @@ private:
     /** Check if the engine needs to be re-created */
     void checkEngineCreation();
 
+    QSharedPointer<GenericFader> getUniverseFader(Universe *universe);
     FadeChannel *getFader(Universe *universe, quint32 fixtureID, quint32 channel);
     void updateFaderValues(FadeChannel *fc, uchar value, uint fadeTime);
 
     /** Update FadeChannels when $map has changed since last time */
     void updateMapChannels(const RGBMap& map, const FixtureGroup* grp, QList<Universe *> universes);
 
+    /** How the value of a channel is obtained from the color of a pixel */
+    enum PixelComponent
+    {
+        PixelRed = 0,
+        PixelGreen,
+        PixelBlue,
+        PixelCyan,
+        PixelMagenta,
+        PixelYellow,
+        PixelGrey,
+        PixelGreyFull
+    };
+
+    /** Get the channels of $head controlled in the current control mode,
+     *  each one with the color component it takes from the pixel */
+    QVector<QPair<quint32, PixelComponent> > headChannels(const Fixture *fxi, const QLCFixtureHead &head) const;
+
+    /** Get the value of $component for the pixel color $col */
+    static uchar pixelComponentValue(uint col, PixelComponent component);
+
+    /** Return true if the matrix can write its pixels directly to the
+     *  universes: no fade at all and normal blending */
+    bool canWriteDirect() const;
+
+    /** Build the pixel map for the heads of $grp and set the
+     *  byte layer masks of the faders on the involved universes */
+    void updatePixelMap(const FixtureGroup* grp, QList<Universe *> universes);
+
+    /** Render $map through the pixel map into the faders byte layers */
+    void updatePixelLayers(const RGBMap& map, QList<Universe *> universes);
+
 public:
     /** Convert color values to fader value */
     static uchar rgbToGrey(uint col);
@@ -272,6 +313,32 @@ private:
     /** The duration of a step based on the current BPM (Beats tempo only) */
     uint m_stepBeatDuration;
 
+    /** The time in ms the matrix has been running, not paused,
+     *  since it has been started */
+    quint32 m_runTime;
+
+    /** A channel written directly to a universe: the pixel it
+     *  takes its color from, where it goes and which component */
+    typedef struct
+    {
+        int x, y;
+        int layer;
+        quint32 address;
+        PixelComponent component;
+    } PixelChannel;
+
+    /** Flag telling if the pixel map is used instead of FadeChannels */
+    bool m_directOutput;
+
+    /** Flag telling if the pixel map must be built again */
+    bool m_pixelMapUpToDate;
+
+    /** The precomputed pixel map, and one byte layer for each
+     *  universe involved, with the universe it belongs to */
+    QVector<PixelChannel> m_pixelMap;
+    QVector<QByteArray> m_pixelLayers;
+    QVector<quint32> m_pixelLayerUniverses;
+
     /*********************************************************************
      * Attributes
      *********************************************************************/
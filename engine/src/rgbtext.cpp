@@ -24,6 +24,8 @@
 #include <QImage>
 #include <QDebug>
 
+#include <string.h>
+
 #include "rgbtext.h"
 
 #define KXMLQLCRGBTextContent        QStringLiteral("Content")
@@ -39,6 +41,7 @@ RGBText::RGBText(Doc * doc)
     , m_animationStyle(Horizontal)
     , m_xOffset(0)
     , m_yOffset(0)
+    , m_cacheValid(false)
 {
 }
 
@@ -49,6 +52,7 @@ RGBText::RGBText(const RGBText& t)
     , m_animationStyle(t.animationStyle())
     , m_xOffset(t.xOffset())
     , m_yOffset(t.yOffset())
+    , m_cacheValid(false)
 {
 }
 
@@ -69,6 +73,7 @@ RGBAlgorithm* RGBText::clone() const
 void RGBText::setText(const QString& str)
 {
     m_text = str;
+    invalidateCache();
 }
 
 QString RGBText::text() const
@@ -79,6 +84,7 @@ QString RGBText::text() const
 void RGBText::setFont(const QFont& font)
 {
     m_font = font;
+    invalidateCache();
 }
 
 QFont RGBText::font() const
@@ -96,6 +102,7 @@ void RGBText::setAnimationStyle(RGBText::AnimationStyle ani)
         m_animationStyle = ani;
     else
         m_animationStyle = StaticLetters;
+    invalidateCache();
 }
 
 RGBText::AnimationStyle RGBText::animationStyle() const
@@ -139,6 +146,7 @@ QStringList RGBText::animationStyles()
 void RGBText::setXOffset(int offset)
 {
     m_xOffset = offset;
+    invalidateCache();
 }
 
 int RGBText::xOffset() const
@@ -149,6 +157,7 @@ int RGBText::xOffset() const
 void RGBText::setYOffset(int offset)
 {
     m_yOffset = offset;
+    invalidateCache();
 }
 
 int RGBText::yOffset() const
@@ -156,6 +165,10 @@ int RGBText::yOffset() const
     return m_yOffset;
 }
 
+/****************************************************************************
+ * Rendering
+ ****************************************************************************/
+
 int RGBText::scrollingTextStepCount() const
 {
     QFontMetrics fm(m_font);
@@ -170,8 +183,69 @@ int RGBText::scrollingTextStepCount() const
     }
 }
 
-void RGBText::renderScrollingText(const QSize& size, uint rgb, int step, RGBMap &map) const
+void RGBText::renderScrollingText(const QSize& size, uint rgb, int step, RGBMap &map)
+{
+    updateScrollingCache(size);
+
+    int stripWidth = m_coverageSize.width();
+    int stripHeight = m_coverageSize.height();
+
+    // Treat the RGBMap as a "window" on top of the fully-drawn text and pick the
+    // correct pixels according to $step. Pixels past the end of the text are 0.
+    map.resize(size.height());
+    for (int y = 0; y < size.height(); y++)
+    {
+        map[y].resize(size.width());
+        uint *row = map[y].data();
+
+        int sy = animationStyle() == Horizontal ? y : step + y;
+        if (step < 0 || sy >= stripHeight)
+        {
+            memset(row, 0, size.width() * sizeof(uint));
+            continue;
+        }
+
+        int sx = animationStyle() == Horizontal ? step : 0;
+        const uchar *line = m_coverage.constData() + sy * stripWidth;
+
+        for (int x = 0; x < size.width(); x++)
+            row[x] = sx + x < stripWidth ? shade(rgb, line[sx + x]) : 0;
+    }
+}
+
+void RGBText::renderStaticLetters(const QSize& size, uint rgb, int step, RGBMap &map)
+{
+    updateLettersCache(size);
+
+    int cellLength = size.width() * size.height();
+    const uchar *cell = NULL;
+    if (step >= 0 && step < m_text.length())
+        cell = m_coverage.constData() + step * cellLength;
+
+    map.resize(size.height());
+    for (int y = 0; y < size.height(); y++)
+    {
+        map[y].resize(size.width());
+        uint *row = map[y].data();
+
+        for (int x = 0; x < size.width(); x++)
+            row[x] = shade(rgb, cell == NULL ? 0 : cell[y * size.width() + x]);
+    }
+}
+
+void RGBText::invalidateCache()
+{
+    m_cacheValid = false;
+}
+
+void RGBText::updateScrollingCache(const QSize& size)
 {
+    // the strip depends on the map height when scrolling horizontally,
+    // and on its width when scrolling vertically
+    QSize mapSize = animationStyle() == Horizontal ? QSize(0, size.height()) : QSize(size.width(), 0);
+    if (m_cacheValid && m_cacheMapSize == mapSize)
+        return;
+
     QImage image;
     if (animationStyle() == Horizontal)
         image = QImage(scrollingTextStepCount(), size.height(), QImage::Format_RGB32);
@@ -179,11 +253,21 @@ void RGBText::renderScrollingText(const QSize& size, uint rgb, int step, RGBMap
         image = QImage(size.width(), scrollingTextStepCount(), QImage::Format_RGB32);
     image.fill(QRgb(0));
 
+    m_coverageSize = image.size();
+    m_coverage.resize(image.width() * image.height());
+    m_cacheMapSize = mapSize;
+    m_cacheValid = true;
+
+    // nothing to draw
+    if (image.isNull())
+        return;
+
+    // Draw the coverage in white, colors are applied on each step
     QPainter p(&image);
     p.setRenderHint(QPainter::TextAntialiasing, false);
     p.setRenderHint(QPainter::Antialiasing, false);
     p.setFont(m_font);
-    p.setPen(QColor(rgb));
+    p.setPen(Qt::white);
 
     if (animationStyle() == Vertical)
     {
@@ -200,57 +284,69 @@ void RGBText::renderScrollingText(const QSize& size, uint rgb, int step, RGBMap
     }
     else
     {
-        // Draw the whole text each time
         QRect rect(xOffset(), yOffset(), image.width(), image.height());
         p.drawText(rect, Qt::AlignLeft | Qt::AlignVCenter, m_text);
     }
+
     p.end();
 
-    // Treat the RGBMap as a "window" on top of the fully-drawn text and pick the
-    // correct pixels according to $step.
-    map.resize(size.height());
-    for (int y = 0; y < size.height(); y++)
+    for (int y = 0; y < image.height(); y++)
     {
-        map[y].resize(size.width());
-        for (int x = 0; x < size.width(); x++)
-        {
-            if (animationStyle() == Horizontal)
-            {
-                if (step + x < image.width())
-                    map[y][x] = image.pixel(step + x, y);
-            }
-            else
-            {
-                if (step + y < image.height())
-                    map[y][x] = image.pixel(x, step + y);
-            }
-        }
+        const QRgb *line = reinterpret_cast<const QRgb *>(image.constScanLine(y));
+        uchar *dst = m_coverage.data() + y * image.width();
+        for (int x = 0; x < image.width(); x++)
+            dst[x] = uchar(qGray(line[x]));
     }
 }
 
-void RGBText::renderStaticLetters(const QSize& size, uint rgb, int step, RGBMap &map) const
+void RGBText::updateLettersCache(const QSize& size)
 {
-    QImage image(size, QImage::Format_RGB32);
-    image.fill(QRgb(0));
+    if (m_cacheValid && m_cacheMapSize == size)
+        return;
 
-    QPainter p(&image);
-    p.setRenderHint(QPainter::TextAntialiasing, false);
-    p.setRenderHint(QPainter::Antialiasing, false);
-    p.setFont(m_font);
-    p.setPen(QColor(rgb));
+    int cellLength = size.width() * size.height();
+    m_coverageSize = size;
+    m_coverage.resize(m_text.length() * cellLength);
 
-    // Draw one letter at a time
-    QRect rect(xOffset(), yOffset(), size.width(), size.height());
-    p.drawText(rect, Qt::AlignCenter, m_text.mid(step, 1));
-    p.end();
+    QImage image(size, QImage::Format_RGB32);
 
-    map.resize(size.height());
-    for (int y = 0; y < size.height(); y++)
+    for (int i = 0; i < m_text.length(); i++)
     {
-        map[y].resize(size.width());
-        for (int x = 0; x < size.width(); x++)
-            map[y][x] = image.pixel(x, y);
+        image.fill(QRgb(0));
+
+        QPainter p(&image);
+        p.setRenderHint(QPainter::TextAntialiasing, false);
+        p.setRenderHint(QPainter::Antialiasing, false);
+        p.setFont(m_font);
+        p.setPen(Qt::white);
+
+        // Draw one letter at a time
+        QRect rect(xOffset(), yOffset(), size.width(), size.height());
+        p.drawText(rect, Qt::AlignCenter, m_text.mid(i, 1));
+        p.end();
+
+        uchar *cell = m_coverage.data() + i * cellLength;
+        for (int y = 0; y < size.height(); y++)
+        {
+            const QRgb *line = reinterpret_cast<const QRgb *>(image.constScanLine(y));
+            for (int x = 0; x < size.width(); x++)
+                cell[y * size.width() + x] = uchar(qGray(line[x]));
+        }
     }
+
+    m_cacheMapSize = size;
+    m_cacheValid = true;
+}
+
+uint RGBText::shade(uint rgb, uchar coverage)
+{
+    // the same values the text drawn with a $rgb pen would have
+    if (coverage == 0)
+        return 0xFF000000;
+    if (coverage == 255)
+        return 0xFF000000 | rgb;
+
+    return qRgb(qRed(rgb) * coverage / 255, qGreen(rgb) * coverage / 255, qBlue(rgb) * coverage / 255);
 }
 
 /****************************************************************************
@@ -21,8 +21,10 @@
 #ifndef RGBTEXT_H
 #define RGBTEXT_H
 
+#include <QVector>
 #include <QString>
 #include <QFont>
+#include <QSize>
 
 #include "rgbalgorithm.h"
 
@@ -81,16 +83,42 @@ public:
     void setYOffset(int offset);
     int yOffset() const;
 
-private:
-    int scrollingTextStepCount() const;
-    void renderScrollingText(const QSize& size, uint rgb, int step, RGBMap &map) const;
-    void renderStaticLetters(const QSize& size, uint rgb, int step, RGBMap &map) const;
-
 private:
     AnimationStyle m_animationStyle;
     int m_xOffset;
     int m_yOffset;
 
+    /************************************************************************
+     * Rendering
+     ************************************************************************/
+private:
+    int scrollingTextStepCount() const;
+    void renderScrollingText(const QSize& size, uint rgb, int step, RGBMap &map);
+    void renderStaticLetters(const QSize& size, uint rgb, int step, RGBMap &map);
+
+    /** Drop the rendered text, so that it is rendered again on the next step */
+    void invalidateCache();
+
+    /** Render the whole text once, in a strip scrolled by the steps */
+    void updateScrollingCache(const QSize& size);
+
+    /** Render each letter once, in a cell as large as the map */
+    void updateLettersCache(const QSize& size);
+
+    /** Get the map value of a pixel with the given text coverage */
+    static uint shade(uint rgb, uchar coverage);
+
+private:
+    /** The text coverage (0-255) of the scrolling strip, or of
+     *  the letter cells one after the other. It doesn't depend on
+     *  the step color, which is applied when the map is filled */
+    QVector<uchar> m_coverage;
+    /** Size of the strip, or of a single letter cell */
+    QSize m_coverageSize;
+    /** Map size the coverage has been rendered for */
+    QSize m_cacheMapSize;
+    bool m_cacheValid;
+
     /************************************************************************
      * RGBAlgorithm
      ************************************************************************/
@@ -0,0 +1,601 @@
+/*
+  Q Light Controller Plus
+  rgbvideo.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+#include <QMediaPlayer>
+#include <QVideoFrame>
+#include <QThread>
+#include <QDebug>
+#include <QUrl>
+
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+ #include <QVideoSink>
+#else
+ #include <QAbstractVideoSurface>
+#endif
+
+#include <string.h>
+
+#include "rgbvideo.h"
+#include "doc.h"
+
+#define KXMLQLCRGBVideoFilename QStringLiteral("Filename")
+
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+/**
+ * Qt 5 delivers the decoded frames to a video surface.
+ * This one just hands them over to the decoder.
+ */
+class RGBVideoSurface : public QAbstractVideoSurface
+{
+public:
+    RGBVideoSurface(RGBVideoDecoder *decoder, QMediaPlayer *player)
+        : QAbstractVideoSurface(decoder)
+        , m_decoder(decoder)
+        , m_player(player)
+    {
+    }
+
+    QList<QVideoFrame::PixelFormat> supportedPixelFormats(
+            QAbstractVideoBuffer::HandleType handleType = QAbstractVideoBuffer::NoHandle) const override
+    {
+        if (handleType != QAbstractVideoBuffer::NoHandle)
+            return QList<QVideoFrame::PixelFormat>();
+
+        return QList<QVideoFrame::PixelFormat>()
+                << QVideoFrame::Format_ARGB32
+                << QVideoFrame::Format_RGB32
+                << QVideoFrame::Format_RGB24
+                << QVideoFrame::Format_RGB565;
+    }
+
+    bool present(const QVideoFrame &frame) override
+    {
+        QVideoFrame mapped(frame);
+        if (mapped.map(QAbstractVideoBuffer::ReadOnly) == false)
+            return false;
+
+        QImage::Format format = QVideoFrame::imageFormatFromPixelFormat(mapped.pixelFormat());
+        if (format != QImage::Format_Invalid)
+        {
+            QImage image(mapped.bits(), mapped.width(), mapped.height(), mapped.bytesPerLine(), format);
+            qint64 time = mapped.startTime() >= 0 ? mapped.startTime() / 1000 : m_player->position();
+            m_decoder->presentFrame(image, time);
+        }
+
+        mapped.unmap();
+        return true;
+    }
+
+private:
+    RGBVideoDecoder *m_decoder;
+    QMediaPlayer *m_player;
+};
+#endif
+
+/****************************************************************************
+ * RGBVideoDecoder
+ ****************************************************************************/
+
+RGBVideoDecoder::RGBVideoDecoder(QObject *parent)
+    : QObject(parent)
+    , m_player(NULL)
+    , m_videoOutput(NULL)
+    , m_firstFrame(0)
+    , m_framesCount(0)
+    , m_lastFrameTime(-1)
+    , m_duration(0)
+    , m_droppedFrames(0)
+{
+}
+
+RGBVideoDecoder::~RGBVideoDecoder()
+{
+    close();
+}
+
+void RGBVideoDecoder::setFrameSize(const QSize &size)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_frameSize == size)
+        return;
+
+    m_frameSize = size;
+    clearFrames();
+}
+
+bool RGBVideoDecoder::takeFrame(qint64 time, QVector<QRgb> &pixels, QSize &size)
+{
+    QMutexLocker locker(&m_mutex);
+    int found = -1;
+
+    while (m_framesCount > 0)
+    {
+        Frame &frame = m_frames[m_firstFrame];
+
+        if (frame.time > time + RGBVIDEO_RESYNC_THRESHOLD)
+        {
+            // left over from before a loop or a seek
+            m_droppedFrames++;
+        }
+        else if (frame.time > time)
+        {
+            // not due yet
+            break;
+        }
+        else
+        {
+            if (found != -1)
+                m_droppedFrames++;
+            found = m_firstFrame;
+        }
+
+        m_firstFrame = (m_firstFrame + 1) % RGBVIDEO_RING_SIZE;
+        m_framesCount--;
+    }
+
+    if (found == -1)
+        return false;
+
+    // copy rather than share, or the decoder would reallocate
+    // the slot when it writes into it again
+    const QVector<QRgb> &src = m_frames[found].pixels;
+    pixels.resize(src.size());
+    memcpy(pixels.data(), src.constData(), src.size() * sizeof(QRgb));
+    size = m_frameSize;
+
+    return true;
+}
+
+qint64 RGBVideoDecoder::lastFrameTime() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_lastFrameTime;
+}
+
+qint64 RGBVideoDecoder::duration() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_duration;
+}
+
+quint32 RGBVideoDecoder::droppedFrames() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_droppedFrames;
+}
+
+void RGBVideoDecoder::presentFrame(const QImage &image, qint64 time)
+{
+    QSize size;
+    {
+        QMutexLocker locker(&m_mutex);
+        size = m_frameSize;
+    }
+
+    if (image.isNull() || size.isEmpty())
+        return;
+
+    // scale out of the lock, this is the expensive part
+    QImage scaled = image.scaled(size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation)
+                         .convertToFormat(QImage::Format_ARGB32);
+
+    QMutexLocker locker(&m_mutex);
+
+    // the group size changed while scaling
+    if (size != m_frameSize)
+        return;
+
+    if (m_framesCount == RGBVIDEO_RING_SIZE)
+    {
+        m_firstFrame = (m_firstFrame + 1) % RGBVIDEO_RING_SIZE;
+        m_framesCount--;
+        m_droppedFrames++;
+    }
+
+    Frame &frame = m_frames[(m_firstFrame + m_framesCount) % RGBVIDEO_RING_SIZE];
+    frame.time = time;
+    frame.pixels.resize(size.width() * size.height());
+
+    for (int y = 0; y < size.height(); y++)
+        memcpy(frame.pixels.data() + y * size.width(), scaled.constScanLine(y), size.width() * sizeof(QRgb));
+
+    m_framesCount++;
+    m_lastFrameTime = time;
+}
+
+void RGBVideoDecoder::open(const QString &filename)
+{
+    close();
+
+    m_player = new QMediaPlayer(this);
+
+    connect(m_player, SIGNAL(mediaStatusChanged(QMediaPlayer::MediaStatus)),
+            this, SLOT(slotMediaStatusChanged()));
+    connect(m_player, SIGNAL(durationChanged(qint64)),
+            this, SLOT(slotDurationChanged(qint64)));
+
+    QUrl url = filename.contains("://") ? QUrl(filename) : QUrl::fromLocalFile(filename);
+
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+    RGBVideoSurface *surface = new RGBVideoSurface(this, m_player);
+    m_videoOutput = surface;
+    m_player->setVideoOutput(surface);
+    m_player->setMuted(true);
+    m_player->setMedia(url);
+#else
+    // with no audio output set, the player stays silent
+    QVideoSink *sink = new QVideoSink(this);
+    m_videoOutput = sink;
+    connect(sink, &QVideoSink::videoFrameChanged,
+            this, &RGBVideoDecoder::slotVideoFrameChanged);
+    m_player->setVideoSink(sink);
+    m_player->setSource(url);
+#endif
+
+    m_player->play();
+}
+
+void RGBVideoDecoder::seek(qint64 time)
+{
+    if (m_player == NULL)
+        return;
+
+    {
+        QMutexLocker locker(&m_mutex);
+        clearFrames();
+    }
+
+    m_player->setPosition(time);
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+    if (m_player->state() != QMediaPlayer::PlayingState)
+#else
+    if (m_player->playbackState() != QMediaPlayer::PlayingState)
+#endif
+        m_player->play();
+}
+
+void RGBVideoDecoder::close()
+{
+    if (m_player != NULL)
+    {
+        m_player->stop();
+        delete m_player;
+        m_player = NULL;
+    }
+
+    delete m_videoOutput;
+    m_videoOutput = NULL;
+
+    QMutexLocker locker(&m_mutex);
+    clearFrames();
+    m_duration = 0;
+}
+
+void RGBVideoDecoder::slotMediaStatusChanged()
+{
+    if (m_player == NULL)
+        return;
+
+    switch (m_player->mediaStatus())
+    {
+        case QMediaPlayer::EndOfMedia:
+            // loop, the matrix keeps running past the end of the clip
+            m_player->setPosition(0);
+            m_player->play();
+        break;
+        case QMediaPlayer::InvalidMedia:
+            qWarning() << "[RGBVideo] Cannot play video:" << m_player->errorString();
+        break;
+        default:
+        break;
+    }
+}
+
+void RGBVideoDecoder::slotDurationChanged(qint64 duration)
+{
+    QMutexLocker locker(&m_mutex);
+    m_duration = duration;
+}
+
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+void RGBVideoDecoder::slotVideoFrameChanged(const QVideoFrame &frame)
+{
+    if (frame.isValid() == false || m_player == NULL)
+        return;
+
+    qint64 time = frame.startTime() >= 0 ? frame.startTime() / 1000 : m_player->position();
+    presentFrame(frame.toImage(), time);
+}
+#endif
+
+void RGBVideoDecoder::clearFrames()
+{
+    m_firstFrame = 0;
+    m_framesCount = 0;
+    m_lastFrameTime = -1;
+}
+
+/****************************************************************************
+ * RGBVideo
+ ****************************************************************************/
+
+RGBVideo::RGBVideo(Doc * doc)
+    : RGBAlgorithm(doc)
+    , m_filename("")
+    , m_decoderThread(NULL)
+    , m_decoder(NULL)
+    , m_playbackTime(0)
+    , m_seekTime(-1)
+{
+}
+
+RGBVideo::RGBVideo(const RGBVideo& v)
+    : RGBAlgorithm(v.doc())
+    , m_filename(v.filename())
+    , m_decoderThread(NULL)
+    , m_decoder(NULL)
+    , m_playbackTime(0)
+    , m_seekTime(-1)
+{
+}
+
+RGBVideo::~RGBVideo()
+{
+    stopDecoder();
+}
+
+RGBAlgorithm* RGBVideo::clone() const
+{
+    RGBVideo* video = new RGBVideo(*this);
+    return static_cast<RGBAlgorithm*> (video);
+}
+
+/****************************************************************************
+ * Video file
+ ****************************************************************************/
+
+void RGBVideo::setFilename(const QString& filename)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (filename == m_filename)
+        return;
+
+    m_filename = filename;
+
+    // restarted on the next rgbMap() with the new file
+    stopDecoder();
+}
+
+QString RGBVideo::filename() const
+{
+    return m_filename;
+}
+
+void RGBVideo::setPlaybackTime(quint32 time)
+{
+    QMutexLocker locker(&m_mutex);
+    m_playbackTime = time;
+}
+
+quint32 RGBVideo::droppedFrames() const
+{
+    if (m_decoder == NULL)
+        return 0;
+
+    return m_decoder->droppedFrames();
+}
+
+void RGBVideo::startDecoder()
+{
+    if (m_decoder != NULL || m_filename.isEmpty())
+        return;
+
+    qDebug() << "[RGBVideo] Start decoding" << m_filename;
+
+    m_decoderThread = new QThread();
+    m_decoder = new RGBVideoDecoder();
+    m_decoder->moveToThread(m_decoderThread);
+    m_decoderThread->start();
+
+    m_seekTime = -1;
+    m_frame.clear();
+    m_frameSize = QSize();
+
+    QMetaObject::invokeMethod(m_decoder, "open", Qt::QueuedConnection,
+                              Q_ARG(QString, m_filename));
+}
+
+void RGBVideo::stopDecoder()
+{
+    if (m_decoder == NULL)
+        return;
+
+    qDebug() << "[RGBVideo] Stop decoding" << m_filename;
+
+    // the media player must be released on the thread that created it
+    QMetaObject::invokeMethod(m_decoder, "close", Qt::BlockingQueuedConnection);
+    m_decoderThread->quit();
+    m_decoderThread->wait();
+
+    delete m_decoder;
+    m_decoder = NULL;
+    delete m_decoderThread;
+    m_decoderThread = NULL;
+}
+
+void RGBVideo::copyFrame(const QSize& size, RGBMap &map) const
+{
+    map.resize(size.height());
+    for (int y = 0; y < size.height(); y++)
+    {
+        map[y].resize(size.width());
+
+        if (m_frameSize != size)
+            map[y].fill(0);
+        else
+            memcpy(map[y].data(), m_frame.constData() + y * size.width(), size.width() * sizeof(QRgb));
+    }
+}
+
+/****************************************************************************
+ * RGBAlgorithm
+ ****************************************************************************/
+
+int RGBVideo::rgbMapStepCount(const QSize& size)
+{
+    Q_UNUSED(size);
+    return 1;
+}
+
+void RGBVideo::rgbMapSetColors(const QVector<uint> &colors)
+{
+    Q_UNUSED(colors);
+}
+
+QVector<uint> RGBVideo::rgbMapGetColors()
+{
+    return QVector<uint>();
+}
+
+void RGBVideo::rgbMap(const QSize& size, uint rgb, int step, RGBMap &map)
+{
+    Q_UNUSED(rgb);
+    Q_UNUSED(step);
+
+    QMutexLocker locker(&m_mutex);
+
+    if (m_filename.isEmpty() || size.isEmpty())
+        return;
+
+    startDecoder();
+    m_decoder->setFrameSize(size);
+
+    qint64 time = m_playbackTime;
+    qint64 duration = m_decoder->duration();
+    if (duration > 0)
+        time %= duration;
+
+    m_decoder->takeFrame(time, m_frame, m_frameSize);
+
+    // reposition the decoder when it drifted away from the playback
+    // time, but give it time to deliver after a seek request
+    qint64 lastFrameTime = m_decoder->lastFrameTime();
+    if (lastFrameTime >= 0 && qAbs(time - lastFrameTime) > RGBVIDEO_RESYNC_THRESHOLD &&
+        (m_seekTime < 0 || qAbs(time - m_seekTime) > RGBVIDEO_RESYNC_THRESHOLD))
+    {
+        QMetaObject::invokeMethod(m_decoder, "seek", Qt::QueuedConnection,
+                                  Q_ARG(qint64, time));
+        m_seekTime = time;
+    }
+
+    copyFrame(size, map);
+}
+
+void RGBVideo::rgbMapPreview(const QSize& size, uint rgb, int step, RGBMap &map)
+{
+    Q_UNUSED(rgb);
+    Q_UNUSED(step);
+
+    QMutexLocker locker(&m_mutex);
+
+    if (size.isEmpty())
+        return;
+
+    copyFrame(size, map);
+}
+
+void RGBVideo::postRun()
+{
+    QMutexLocker locker(&m_mutex);
+    stopDecoder();
+    m_playbackTime = 0;
+}
+
+QString RGBVideo::name() const
+{
+    return QString("Video");
+}
+
+QString RGBVideo::author() const
+{
+    return QString("Massimo Callegari");
+}
+
+int RGBVideo::apiVersion() const
+{
+    return 1;
+}
+
+RGBAlgorithm::Type RGBVideo::type() const
+{
+    return RGBAlgorithm::Video;
+}
+
+int RGBVideo::acceptColors() const
+{
+    return 0;
+}
+
+bool RGBVideo::loadXML(QXmlStreamReader &root)
+{
+    if (root.name() != KXMLQLCRGBAlgorithm)
+    {
+        qWarning() << Q_FUNC_INFO << "RGB Algorithm node not found";
+        return false;
+    }
+
+    if (root.attributes().value(KXMLQLCRGBAlgorithmType).toString() != KXMLQLCRGBVideo)
+    {
+        qWarning() << Q_FUNC_INFO << "RGB Algorithm is not Video";
+        return false;
+    }
+
+    while (root.readNextStartElement())
+    {
+        if (root.name() == KXMLQLCRGBVideoFilename)
+        {
+            setFilename(doc()->denormalizeComponentPath(root.readElementText()));
+        }
+        else
+        {
+            qWarning() << Q_FUNC_INFO << "Unknown RGBVideo tag:" << root.name();
+            root.skipCurrentElement();
+        }
+    }
+
+    return true;
+}
+
+bool RGBVideo::saveXML(QXmlStreamWriter *doc) const
+{
+    Q_ASSERT(doc != NULL);
+
+    doc->writeStartElement(KXMLQLCRGBAlgorithm);
+    doc->writeAttribute(KXMLQLCRGBAlgorithmType, KXMLQLCRGBVideo);
+
+    doc->writeTextElement(KXMLQLCRGBVideoFilename, this->doc()->normalizeComponentPath(m_filename));
+
+    /* End the <Algorithm> tag */
+    doc->writeEndElement();
+
+    return true;
+}
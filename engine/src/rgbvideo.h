@@ -0,0 +1,227 @@
+/*
+  Q Light Controller Plus
+  rgbvideo.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef RGBVIDEO_H
+#define RGBVIDEO_H
+
+#include <QObject>
+#include <QVector>
+#include <QString>
+#include <QMutex>
+#include <QImage>
+#include <QSize>
+
+#include "rgbalgorithm.h"
+
+/** @addtogroup engine_functions Functions
+ * @{
+ */
+
+#define KXMLQLCRGBVideo QStringLiteral("Video")
+
+/** Number of decoded frames waiting to be rendered */
+#define RGBVIDEO_RING_SIZE          4
+
+/** Distance in ms between the decoder and the playback
+ *  time, after which the decoder is repositioned */
+#define RGBVIDEO_RESYNC_THRESHOLD   250
+
+class QMediaPlayer;
+class QVideoFrame;
+class QThread;
+
+/**
+ * RGBVideoDecoder plays a video file with Qt Multimedia on the thread it
+ * lives in. Every decoded frame is scaled to the fixture group size and
+ * queued in a small ring, where the matrix picks the one to render.
+ * When the ring is full the oldest frame is overwritten, so a slow
+ * consumer skips frames instead of slowing down the decoder.
+ */
+class RGBVideoDecoder final : public QObject
+{
+    Q_OBJECT
+
+public:
+    RGBVideoDecoder(QObject *parent = 0);
+    ~RGBVideoDecoder();
+
+    /** Set the size decoded frames are scaled to. Thread safe */
+    void setFrameSize(const QSize& size);
+
+    /**
+     * Get the newest decoded frame due at $time (ms), dropping the ones
+     * before it. Frames too far in the future are stale (the playback
+     * looped or was repositioned) and are dropped as well. Thread safe.
+     *
+     * @return true if a frame has been copied into $pixels
+     */
+    bool takeFrame(qint64 time, QVector<QRgb>& pixels, QSize& size);
+
+    /** Get the time (ms) of the last frame decoded, or -1 if none */
+    qint64 lastFrameTime() const;
+
+    /** Get the duration (ms) of the video, or 0 if not known yet */
+    qint64 duration() const;
+
+    /** Get the number of decoded frames that have never been rendered */
+    quint32 droppedFrames() const;
+
+    /** Scale $image and queue it as the frame at $time (ms). Thread safe */
+    void presentFrame(const QImage& image, qint64 time);
+
+public slots:
+    /** Start playing $filename from the beginning */
+    void open(const QString& filename);
+
+    /** Move the playback to $time (ms) */
+    void seek(qint64 time);
+
+    /** Stop playing and release the media player */
+    void close();
+
+private slots:
+    void slotMediaStatusChanged();
+    void slotDurationChanged(qint64 duration);
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    void slotVideoFrameChanged(const QVideoFrame& frame);
+#endif
+
+private:
+    void clearFrames();
+
+private:
+    typedef struct
+    {
+        qint64 time;
+        QVector<QRgb> pixels;
+    } Frame;
+
+    QMediaPlayer *m_player;
+    QObject *m_videoOutput;
+
+    /** Guards everything below, shared with the thread rendering the matrix */
+    mutable QMutex m_mutex;
+    QSize m_frameSize;
+    Frame m_frames[RGBVIDEO_RING_SIZE];
+    int m_firstFrame;
+    int m_framesCount;
+    qint64 m_lastFrameTime;
+    qint64 m_duration;
+    quint32 m_droppedFrames;
+};
+
+class RGBVideo final : public RGBAlgorithm
+{
+public:
+    RGBVideo(Doc * doc);
+    RGBVideo(const RGBVideo& v);
+    ~RGBVideo();
+
+    /** @reimp */
+    RGBAlgorithm* clone() const override;
+
+    /************************************************************************
+     * Video file
+     ************************************************************************/
+public:
+    /** Set filename of the video */
+    void setFilename(const QString& fileName);
+
+    /** Get filename of the video */
+    QString filename() const;
+
+    /** Set the time (ms) rendered by the next rgbMap(). This is the
+     *  running time of the matrix, looped over the video duration */
+    void setPlaybackTime(quint32 time);
+
+    /** Get the number of decoded frames that have been skipped */
+    quint32 droppedFrames() const;
+
+private:
+    void startDecoder();
+    void stopDecoder();
+
+    /** Copy the frame being rendered into $map, or blank it when
+     *  no frame of the requested size is available */
+    void copyFrame(const QSize& size, RGBMap &map) const;
+
+private:
+    QString m_filename;
+    QMutex m_mutex;
+
+    QThread *m_decoderThread;
+    RGBVideoDecoder *m_decoder;
+
+    quint32 m_playbackTime;
+    qint64 m_seekTime;
+
+    /** The frame being rendered */
+    QVector<QRgb> m_frame;
+    QSize m_frameSize;
+
+    /************************************************************************
+     * RGBAlgorithm
+     ************************************************************************/
+public:
+    /** @reimp */
+    int rgbMapStepCount(const QSize& size) override;
+
+    /** @reimp */
+    void rgbMapSetColors(const QVector<uint> &colors) override;
+
+    /** @reimp */
+    QVector<uint> rgbMapGetColors() override;
+
+    /** @reimp */
+    void rgbMap(const QSize& size, uint rgb, int step, RGBMap &map) override;
+
+    /** @reimp
+     *  The preview shows the last frame rendered by rgbMap() and never
+     *  starts or repositions the decoder, which belongs to the running
+     *  matrix */
+    void rgbMapPreview(const QSize& size, uint rgb, int step, RGBMap &map) override;
+
+    /** @reimp */
+    void postRun() override;
+
+    /** @reimp */
+    QString name() const override;
+
+    /** @reimp */
+    QString author() const override;
+
+    /** @reimp */
+    int apiVersion() const override;
+
+    /** @reimp */
+    RGBAlgorithm::Type type() const override;
+
+    /** @reimp */
+    int acceptColors() const override;
+
+    /** @reimp */
+    bool loadXML(QXmlStreamReader &root) override;
+
+    /** @reimp */
+    bool saveXML(QXmlStreamWriter *doc) const override;
+};
+
+/** @} */
+
+#endif
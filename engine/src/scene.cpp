@@ -42,12 +42,18 @@
 Scene::Scene(Doc* doc)
     : Function(doc, Function::SceneType)
     , m_legacyFadeBus(Bus::invalid())
+    , m_resolvedValuesValid(false)
     , m_flashOverrides(false)
     , m_flashForceLTP(false)
     , m_blendFunctionID(Function::invalidId())
 {
     setName(tr("New Scene"));
     registerAttribute(tr("ParentIntensity"), Multiply | Single);
+
+    connect(doc, SIGNAL(fixtureAdded(quint32)),
+            this, SLOT(slotFixturesChanged()));
+    connect(doc, SIGNAL(fixtureChanged(quint32)),
+            this, SLOT(slotFixturesChanged()));
 }
 
 Scene::~Scene()
@@ -93,8 +99,12 @@ bool Scene::copyFrom(const Function* function)
     if (scene == NULL)
         return false;
 
-    m_values.clear();
-    m_values = scene->m_values;
+    {
+        QMutexLocker locker(&m_valueListMutex);
+        m_values.clear();
+        m_values = scene->m_values;
+        invalidateResolvedValues();
+    }
     m_fixtures.clear();
     m_fixtures = scene->m_fixtures;
     m_channelGroups.clear();
@@ -139,6 +149,9 @@ void Scene::setValue(const SceneValue& scv, bool blind, bool checkHTP)
             valChanged = true;
         }
 
+        if (valChanged)
+            invalidateResolvedValues();
+
         // if the scene is running, we must
         // update/add the changed channel
         if (blind == false && m_fadersMap.isEmpty() == false)
@@ -182,7 +195,8 @@ void Scene::unsetValue(quint32 fxi, quint32 ch)
 
     {
         QMutexLocker locker(&m_valueListMutex);
-        m_values.remove(SceneValue(fxi, ch, 0));
+        if (m_values.remove(SceneValue(fxi, ch, 0)))
+            invalidateResolvedValues();
     }
 
     emit changed(this->id());
@@ -289,12 +303,64 @@ QColor Scene::colorValue(quint32 fxi)
 
 void Scene::clear()
 {
-    m_values.clear();
+    {
+        QMutexLocker locker(&m_valueListMutex);
+        m_values.clear();
+        invalidateResolvedValues();
+    }
     m_fixtures.clear();
     m_fixtureGroups.clear();
     m_palettes.clear();
 }
 
+/*********************************************************************
+ * Resolved values
+ *********************************************************************/
+
+void Scene::prepareValues()
+{
+    QMutexLocker locker(&m_valueListMutex);
+    resolveValues();
+}
+
+void Scene::resolveValues()
+{
+    if (m_resolvedValuesValid)
+        return;
+
+    m_resolvedValues.clear();
+    m_resolvedValues.reserve(m_values.count());
+
+    QMap <SceneValue, uchar>::const_iterator it = m_values.constBegin();
+    for (; it != m_values.constEnd(); it++)
+    {
+        const SceneValue &scv = it.key();
+        Fixture *fixture = doc()->fixture(scv.fxi);
+        if (fixture == NULL)
+            continue;
+
+        ResolvedValue rv;
+        rv.value = scv;
+        rv.universe = (fixture->universeAddress() + scv.channel) / UNIVERSE_SIZE;
+        rv.channel = FadeChannel(doc(), scv.fxi, scv.channel);
+        rv.channel.setTarget(scv.value);
+        m_resolvedValues.append(rv);
+    }
+
+    m_resolvedValuesValid = true;
+}
+
+void Scene::invalidateResolvedValues()
+{
+    m_resolvedValuesValid = false;
+}
+
+void Scene::slotFixturesChanged()
+{
+    QMutexLocker locker(&m_valueListMutex);
+    invalidateResolvedValues();
+}
+
 /*********************************************************************
  * Channel Groups
  *********************************************************************/
@@ -343,15 +409,19 @@ void Scene::slotFixtureRemoved(quint32 fxi_id)
 {
     bool hasChanged = false;
 
-    QMutableMapIterator <SceneValue, uchar> it(m_values);
-    while (it.hasNext() == true)
     {
-        SceneValue value(it.next().key());
-        if (value.fxi == fxi_id)
+        QMutexLocker locker(&m_valueListMutex);
+        QMutableMapIterator <SceneValue, uchar> it(m_values);
+        while (it.hasNext() == true)
         {
-            it.remove();
-            hasChanged = true;
+            SceneValue value(it.next().key());
+            if (value.fxi == fxi_id)
+            {
+                it.remove();
+                hasChanged = true;
+            }
         }
+        invalidateResolvedValues();
     }
 
     if (removeFixture(fxi_id))
@@ -641,6 +711,9 @@ void Scene::postLoad()
         if (fxi == NULL || fxi->channel(value.channel) == NULL)
             it.remove();
     }
+
+    QMutexLocker locker(&m_valueListMutex);
+    invalidateResolvedValues();
 }
 
 /****************************************************************************
@@ -679,14 +752,13 @@ void Scene::writeDMX(MasterTimer *timer, QList<Universe *> ua)
         {
             // Keep HTP and LTP channels up. Flash is more or less a forceful intervention
             // so enforce all values that the user has chosen to flash.
-            QMap <SceneValue, uchar>::iterator it = m_values.begin();
-            for (; it != m_values.end(); it++)
-            {
-                const SceneValue& sv = it.key();
+            QMutexLocker locker(&m_valueListMutex);
+            resolveValues();
 
-                FadeChannel fc(doc(), sv.fxi, sv.channel);
-                quint32 universe = fc.universe();
-                if (universe == Universe::invalid())
+            foreach (const ResolvedValue &rv, m_resolvedValues)
+            {
+                quint32 universe = rv.channel.universe();
+                if (universe == Universe::invalid() || int(universe) >= ua.count())
                     continue;
 
                 QSharedPointer<GenericFader> fader = m_fadersMap.value(universe, QSharedPointer<GenericFader>());
@@ -701,9 +773,9 @@ void Scene::writeDMX(MasterTimer *timer, QList<Universe *> ua)
                     m_fadersMap[universe] = fader;
                 }
 
+                FadeChannel fc(rv.channel);
                 if (m_flashForceLTP)
                     fc.addFlag(FadeChannel::ForceLTP);
-                fc.setTarget(sv.value);
                 fc.addFlag(FadeChannel::Flashing);
                 fader->add(fc);
             }
@@ -720,19 +792,8 @@ void Scene::writeDMX(MasterTimer *timer, QList<Universe *> ua)
  * Running
  ****************************************************************************/
 
-void Scene::processValue(MasterTimer *timer, QList<Universe*> ua, uint fadeIn, SceneValue &scv)
+QSharedPointer<GenericFader> Scene::universeFader(Universe *universe)
 {
-    Fixture *fixture = doc()->fixture(scv.fxi);
-
-    if (fixture == NULL)
-        return;
-
-    int universeIndex = floor((fixture->universeAddress() + scv.channel) / 512);
-    if (universeIndex >= ua.count())
-        return;
-
-    Universe *universe = ua.at(universeIndex);
-
     QSharedPointer<GenericFader> fader = m_fadersMap.value(universe->id(), QSharedPointer<GenericFader>());
     if (fader.isNull())
     {
@@ -746,52 +807,50 @@ void Scene::processValue(MasterTimer *timer, QList<Universe*> ua, uint fadeIn, S
         m_fadersMap[universe->id()] = fader;
     }
 
-    FadeChannel *fc = fader->getChannelFader(doc(), universe, scv.fxi, scv.channel);
+    return fader;
+}
+
+void Scene::processValue(QList<Universe*> ua, uint fadeIn, Scene *blendScene, SceneValue &scv)
+{
+    Fixture *fixture = doc()->fixture(scv.fxi);
+
+    if (fixture == NULL)
+        return;
+
+    int universeIndex = floor((fixture->universeAddress() + scv.channel) / 512);
+    if (universeIndex >= ua.count())
+        return;
+
+    Universe *universe = ua.at(universeIndex);
+    FadeChannel *fc = universeFader(universe)->getChannelFader(doc(), universe, scv.fxi, scv.channel);
+
+    processChannel(fc, fadeIn, blendScene, scv);
+}
+
+void Scene::processChannel(FadeChannel *fc, uint fadeIn, Scene *blendScene, const SceneValue &scv)
+{
     int chIndex = fc->channelIndex(scv.channel);
 
     /** If a blend Function has been set, check if this channel needs to
      *  be blended from a previous value. If so, mark it for crossfade
      *  and set its current value */
-    if (blendFunctionID() != Function::invalidId())
-    {
-        Scene *blendScene = qobject_cast<Scene *>(doc()->function(blendFunctionID()));
-        if (blendScene != NULL && blendScene->checkValue(scv))
-        {
-            fc->addFlag(FadeChannel::CrossFade);
-            fc->setCurrent(blendScene->value(scv.fxi, scv.channel), chIndex);
-            qDebug() << "----- BLEND from Scene" << blendScene->name()
-                     << ", fixture:" << scv.fxi << ", channel:" << scv.channel << ", value:" << fc->current();
-        }
-    }
-    else
+    if (blendScene != NULL && blendScene->checkValue(scv))
     {
-        //qDebug() << "Scene" << name() << "add channel" << scv.channel << "from" << fc->current(chIndex) << "to" << scv.value;
+        fc->addFlag(FadeChannel::CrossFade);
+        fc->setCurrent(blendScene->value(scv.fxi, scv.channel), chIndex);
+        qDebug() << "----- BLEND from Scene" << blendScene->name()
+                 << ", fixture:" << scv.fxi << ", channel:" << scv.channel << ", value:" << fc->current();
     }
 
+    //qDebug() << "Scene" << name() << "add channel" << scv.channel << "from" << fc->current(chIndex) << "to" << scv.value;
+
     fc->setStart(fc->current(chIndex), chIndex);
     fc->setTarget(scv.value, chIndex);
 
     if (fc->canFade() == false)
-    {
         fc->setFadeTime(0);
-    }
     else
-    {
-        if (tempoType() == Beats)
-        {
-            int fadeInTime = beatsToTime(fadeIn, timer->beatTimeDuration());
-            int beatOffset = timer->nextBeatTimeOffset();
-
-            if (fadeInTime - beatOffset > 0)
-                fc->setFadeTime(fadeInTime - beatOffset);
-            else
-                fc->setFadeTime(fadeInTime);
-        }
-        else
-        {
-            fc->setFadeTime(fadeIn);
-        }
-    }
+        fc->setFadeTime(fadeIn);
 }
 
 void Scene::handleFadersEnd(MasterTimer *timer)
@@ -837,6 +896,22 @@ void Scene::write(MasterTimer *timer, QList<Universe*> ua)
     {
         uint fadeIn = overrideFadeInSpeed() == defaultSpeed() ? fadeInSpeed() : overrideFadeInSpeed();
 
+        // the fade in time is the same for every channel, so compute it just once
+        if (tempoType() == Beats)
+        {
+            int fadeInTime = beatsToTime(fadeIn, timer->beatTimeDuration());
+            int beatOffset = timer->nextBeatTimeOffset();
+
+            if (fadeInTime - beatOffset > 0)
+                fadeIn = fadeInTime - beatOffset;
+            else
+                fadeIn = fadeInTime;
+        }
+
+        Scene *blendScene = NULL;
+        if (blendFunctionID() != Function::invalidId())
+            blendScene = qobject_cast<Scene *>(doc()->function(blendFunctionID()));
+
         foreach (quint32 paletteID, palettes())
         {
             QLCPalette *palette = doc()->palette(paletteID);
@@ -844,26 +919,41 @@ void Scene::write(MasterTimer *timer, QList<Universe*> ua)
                 continue;
 
             foreach (SceneValue scv, palette->valuesFromFixtureGroups(doc(), fixtureGroups()))
-                processValue(timer, ua, fadeIn, scv);
+                processValue(ua, fadeIn, blendScene, scv);
 
             foreach (SceneValue scv, palette->valuesFromFixtures(doc(), fixtures()))
-                processValue(timer, ua, fadeIn, scv);
+                processValue(ua, fadeIn, blendScene, scv);
         }
 
         QMutexLocker locker(&m_valueListMutex);
-        QMapIterator <SceneValue, uchar> it(m_values);
-        while (it.hasNext() == true)
+        resolveValues();
+
+        // values are sorted by fixture, so consecutive values
+        // will most likely share the same universe fader
+        int faderUniverse = -1;
+        QSharedPointer<GenericFader> fader;
+
+        foreach (const ResolvedValue &rv, m_resolvedValues)
         {
-            SceneValue scv(it.next().key());
-            processValue(timer, ua, fadeIn, scv);
+            if (rv.universe >= ua.count())
+                continue;
+
+            Universe *universe = ua.at(rv.universe);
+            if (rv.universe != faderUniverse)
+            {
+                fader = universeFader(universe);
+                faderUniverse = rv.universe;
+            }
+
+            processChannel(fader->getChannelFader(universe, rv.channel), fadeIn, blendScene, rv.value);
         }
     }
 
     if (isPaused() == false)
     {
         incrementElapsed();
-        if (timer->isBeat() && tempoType() == Beats)
-            incrementElapsedBeats();
+        if (tempoType() == Beats)
+            updateElapsedBeats(timer);
     }
 }
 
@@ -21,6 +21,7 @@
 #ifndef SCENE_H
 #define SCENE_H
 
+#include <QVector>
 #include <QMutex>
 #include <QList>
 
@@ -155,6 +156,45 @@ protected:
     QMap <SceneValue, uchar> m_values;
     QMutex m_valueListMutex;
 
+    /*********************************************************************
+     * Resolved values
+     *********************************************************************/
+public:
+    /** Resolve the Scene values against the current fixtures setup
+     *  ahead of a start, so that the first write doesn't have to.
+     *  Chasers call this while the step before this Scene is running */
+    void prepareValues();
+
+private:
+    /** A Scene value resolved against the current fixtures setup.
+     *  The FadeChannel is a template that already carries the
+     *  channel absolute address and its detected flags */
+    typedef struct
+    {
+        SceneValue value;
+        int universe;
+        FadeChannel channel;
+    } ResolvedValue;
+
+    /** Build m_resolvedValues from m_values, if they're outdated.
+     *  Must be called with m_valueListMutex locked */
+    void resolveValues();
+
+    /** Mark m_resolvedValues as outdated. They will be resolved again
+     *  on the next start or flash of this Scene.
+     *  Must be called with m_valueListMutex locked */
+    void invalidateResolvedValues();
+
+protected slots:
+    /** Slot that captures Doc::fixtureAdded/fixtureChanged signals */
+    void slotFixturesChanged();
+
+private:
+    /** A flat copy of m_values, in the same order, that can be
+     *  processed in a single pass without any Doc lookup */
+    QVector<ResolvedValue> m_resolvedValues;
+    bool m_resolvedValuesValid;
+
     /*********************************************************************
      * Channel Groups
      *********************************************************************/
@@ -271,8 +311,15 @@ public:
     void setPause(bool enable) override;
 
 private:
+    /** Get the fader of this Scene for the given universe.
+     *  If not yet present, a new one is requested to the universe */
+    QSharedPointer<GenericFader> universeFader(Universe *universe);
+
+    /** Resolve a Palette value and process it */
+    void processValue(QList<Universe*> ua, uint fadeIn, Scene *blendScene, SceneValue &scv);
+
     /** Internal helper method to abtract Scene value processing */
-    void processValue(MasterTimer *timer, QList<Universe*> ua, uint fadeIn, SceneValue &scv);
+    void processChannel(FadeChannel *fc, uint fadeIn, Scene *blendScene, const SceneValue &scv);
 
     /** Check whether a fade out is needed and cleanup faders */
     void handleFadersEnd(MasterTimer* timer);
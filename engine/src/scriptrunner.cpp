@@ -20,6 +20,7 @@
 #include <QQmlEngine>
 #include <QJSEngine>
 #include <QJSValue>
+#include <QJSValueIterator>
 #include <QRandomGenerator>
 #if !defined(Q_OS_IOS)
 #include <QProcess>
@@ -38,6 +39,10 @@ ScriptRunner::ScriptRunner(Doc *doc, QString &content, QObject *parent)
     , m_content(content)
     , m_running(false)
     , m_engine(NULL)
+    , m_contentChanged(true)
+    , m_executeRequested(false)
+    , m_busy(false)
+    , m_quit(false)
     , m_stopOnExit(true)
     , m_waitCount(0)
     , m_waitFunctionId(Function::invalidId())
@@ -47,6 +52,36 @@ ScriptRunner::ScriptRunner(Doc *doc, QString &content, QObject *parent)
 ScriptRunner::~ScriptRunner()
 {
     stop();
+    shutdown();
+}
+
+void ScriptRunner::prepare()
+{
+    QMutexLocker locker(&m_mutex);
+    m_quit = false;
+
+    if (isRunning() == false)
+        start();
+}
+
+bool ScriptRunner::isReady() const
+{
+    QMutexLocker locker(&m_mutex);
+    return isRunning() && m_engine != NULL && m_contentChanged == false && m_busy == false;
+}
+
+void ScriptRunner::setContent(const QString &content)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (content == m_content)
+        return;
+
+    m_content = content;
+    m_contentChanged = true;
+
+    // let an idle runner compile the new code in advance
+    m_requestCondition.wakeOne();
 }
 
 void ScriptRunner::execute()
@@ -54,9 +89,26 @@ void ScriptRunner::execute()
     if (m_running)
         return;
 
+    // reset the state left by a previous execution
+    m_waitCount = 0;
+    m_stopOnExit = true;
+    m_functionQueue.clear();
+    m_fixtureValueQueue.clear();
+    m_startedFunctions.clear();
+    if (m_waitFunctionId != Function::invalidId())
+    {
+        disconnect(m_doc->masterTimer(), SIGNAL(functionStarted(quint32)), this, SLOT(slotWaitFunctionStarted(quint32)));
+        disconnect(m_doc->masterTimer(), SIGNAL(functionStopped(quint32)), this, SLOT(slotWaitFunctionStopped(quint32)));
+        m_waitFunctionId = Function::invalidId();
+    }
+
     m_running = true;
 
-    start();
+    prepare();
+
+    QMutexLocker locker(&m_mutex);
+    m_executeRequested = true;
+    m_requestCondition.wakeOne();
 }
 
 void ScriptRunner::stop()
@@ -64,11 +116,20 @@ void ScriptRunner::stop()
     if (m_running == false)
         return;
 
-    if (m_engine)
     {
-        m_engine->setInterrupted(true);
-        m_engine->deleteLater();
-        m_engine = NULL;
+        QMutexLocker locker(&m_mutex);
+
+        m_running = false;
+        m_executeRequested = false;
+
+        // abort the JS code and wait for the runner thread to be idle again
+        if (m_busy && m_engine)
+            m_engine->setInterrupted(true);
+
+        m_requestCondition.wakeOne();
+
+        while (m_busy)
+            m_idleCondition.wait(&m_mutex);
     }
 
     // Stop all functions started by this script
@@ -89,8 +150,20 @@ void ScriptRunner::stop()
             fader->requestDelete();
     }
     m_fadersMap.clear();
+}
 
-    m_running = false;
+void ScriptRunner::shutdown()
+{
+    if (isRunning() == false)
+        return;
+
+    {
+        QMutexLocker locker(&m_mutex);
+        m_quit = true;
+        m_requestCondition.wakeOne();
+    }
+
+    wait();
 }
 
 QStringList ScriptRunner::collectScriptData()
@@ -205,7 +278,8 @@ bool ScriptRunner::write(MasterTimer *timer, QList<Universe *> universes)
                 {
                     // the function is not running, so we we wait and we stop dequeuing
                     m_waitFunctionId = fID;
-                    connect(m_doc->masterTimer(), SIGNAL(functionStarted(quint32)), SLOT(slotWaitFunctionStarted(quint32)));
+                    connect(m_doc->masterTimer(), SIGNAL(functionStarted(quint32)),
+                            this, SLOT(slotWaitFunctionStarted(quint32)), Qt::DirectConnection);
                     break;
                 }
             }
@@ -215,7 +289,8 @@ bool ScriptRunner::write(MasterTimer *timer, QList<Universe *> universes)
                 {
                     // the function has to start or is still running, so we wait and we stop dequeuing
                     m_waitFunctionId = fID;
-                    connect(m_doc->masterTimer(), SIGNAL(functionStopped(quint32)), SLOT(slotWaitFunctionStopped(quint32)));
+                    connect(m_doc->masterTimer(), SIGNAL(functionStopped(quint32)),
+                            this, SLOT(slotWaitFunctionStopped(quint32)), Qt::DirectConnection);
                     break;
                 }
             }
@@ -251,38 +326,88 @@ void ScriptRunner::slotWaitFunctionStopped(quint32 fid)
     }
 }
 
+void ScriptRunner::compileScript()
+{
+    m_compiledScript = m_engine->evaluate("(function run() { " + m_content + " })");
+    m_contentChanged = false;
+
+    if (m_compiledScript.isCallable() == false)
+        qDebug() << "ERROR. No function method found.";
+}
+
+QStringList ScriptRunner::globalNames() const
+{
+    QStringList names;
+    QJSValueIterator it(m_engine->globalObject());
+    while (it.hasNext())
+    {
+        it.next();
+        names.append(it.name());
+    }
+    return names;
+}
+
 void ScriptRunner::run()
 {
-    m_waitCount = 0;
+    QMutexLocker locker(&m_mutex);
 
+    // create the engine once and keep it for the whole life of this runner
     m_engine = new QJSEngine();
     QJSValue objectValue = m_engine->newQObject(this);
     m_engine->globalObject().setProperty("Engine", objectValue);
     QQmlEngine::setObjectOwnership(this, QQmlEngine::CppOwnership);
+    QStringList initialGlobals = globalNames();
 
-    QJSValue script = m_engine->evaluate("(function run() { " + m_content + " })");
-
-    if (script.isCallable() == false)
+    while (m_quit == false)
     {
-        qDebug() << "ERROR. No function method found.";
-        return;
-    }
-    else
-    {
-        QJSValue ret = script.call(QJSValueList());
-        if (ret.isError())
+        if (m_contentChanged)
+            compileScript();
+
+        if (m_executeRequested == false)
         {
-            QString msg("Uncaught exception at line %2. Error: %3");
-            qWarning() << msg.arg(ret.property("lineNumber").toInt())
-                             .arg(ret.toString());
+            m_requestCondition.wait(&m_mutex);
+            continue;
         }
-    }
 
-    qDebug() << "[ScriptRunner] Code executed";
+        m_executeRequested = false;
+        m_busy = true;
+        m_engine->setInterrupted(false);
+        locker.unlock();
+
+        // forget the globals left by a previous execution, so
+        // every run starts as it would with a new engine
+        foreach (QString name, globalNames())
+        {
+            if (initialGlobals.contains(name) == false)
+                m_engine->globalObject().deleteProperty(name);
+        }
+
+        if (m_compiledScript.isCallable())
+        {
+            QJSValue ret = m_compiledScript.call(QJSValueList());
+            if (ret.isError() && m_engine->isInterrupted() == false)
+            {
+                QString msg("Uncaught exception at line %2. Error: %3");
+                qWarning() << msg.arg(ret.property("lineNumber").toInt())
+                                 .arg(ret.toString());
+            }
+        }
+
+        qDebug() << "[ScriptRunner] Code executed";
+
+        locker.relock();
+
+        // the code is done. Wait for the calling Script to stop
+        while (m_running && m_quit == false)
+            m_requestCondition.wait(&m_mutex);
 
-    // this thread is done. Wait for the calling Script to stop
-    while (m_running)
-        msleep(50);
+        m_busy = false;
+        m_idleCondition.wakeAll();
+    }
+
+    m_compiledScript = QJSValue();
+    delete m_engine;
+    m_engine = NULL;
 }
 
 /************************************************************************
@@ -294,15 +419,13 @@ int ScriptRunner::getChannelValue(int universe, int channel)
     if (m_running == false)
         return false;
 
-    QList<Universe*> uniList = m_doc->inputOutputMap()->claimUniverses();
+    // read the published snapshot, to avoid competing with
+    // the MasterTimer for the universes mutex
+    QList<Universe*> uniList = m_doc->inputOutputMap()->universes();
     uchar dmxValue = 0;
 
     if (universe >= 0 && universe < uniList.count())
-    {
-        Universe *uni = uniList.at(universe);
-        dmxValue = uni->preGMValue(channel);
-    }
-    m_doc->inputOutputMap()->releaseUniverses(false);
+        dmxValue = uniList.at(universe)->snapshotPreGMValue(channel);
 
     return dmxValue;
 }
@@ -20,8 +20,11 @@
 #ifndef SCRIPTRUNNER_H
 #define SCRIPTRUNNER_H
 
+#include <QWaitCondition>
+#include <QJSValue>
 #include <QThread>
 #include <QQueue>
+#include <QMutex>
 #include <QPair>
 #include <QMap>
 #include "function.h"
@@ -29,7 +32,6 @@
 class GenericFader;
 class MasterTimer;
 class QJSEngine;
-class QJSValue;
 class Universe;
 class Doc;
 
@@ -42,6 +44,16 @@ typedef struct
     uint m_fadeTime;
 } FixtureValue;
 
+/**
+ * ScriptRunner executes the JavaScript code of a Script function.
+ *
+ * A runner is meant to be reused across multiple executions: its thread
+ * and its QJSEngine (with the "Engine" API already bound) are created once
+ * by prepare() and then sit idle, waiting for an execution request.
+ * The script body is compiled by the idle runner thread each time the
+ * content changes, so starting a Script only needs to wake up the thread.
+ * The globals created by an execution are removed before the next one.
+ */
 class ScriptRunner final : public QThread
 {
     Q_OBJECT
@@ -53,9 +65,23 @@ public:
     ScriptRunner(Doc *doc, QString &content, QObject *parent = 0);
     ~ScriptRunner();
 
+    /** Start the runner thread, if not running already, and create
+     *  the JS engine and the compiled script in advance */
+    void prepare();
+
+    /** Return true if the runner thread is idle, with its JS engine
+     *  created and the current content compiled */
+    bool isReady() const;
+
+    /** Set the JavaScript code to be run. The code will be
+     *  compiled again by the runner thread when idle */
+    void setContent(const QString &content);
+
     /** Start the thread execution and therefore the JavaScript code */
     void execute();
 
+    /** Stop the JavaScript code execution and wait for the
+     *  runner thread to go back to idle */
     void stop();
 
     QStringList collectScriptData();
@@ -252,12 +278,36 @@ private:
     /** Common code to enqueue function */
     bool enqueueFunction(quint32 fID, FunctionOperation operation);
 
+    /** Stop the runner thread and destroy the JS engine */
+    void shutdown();
+
+    /** Compile the script body into a callable JS function */
+    void compileScript();
+
+    /** Get the names of the enumerable properties of the JS global object */
+    QStringList globalNames() const;
+
 private:
     Doc *m_doc;
     QString m_content;
     bool m_running;
 
     QJSEngine *m_engine;
+    // The script body compiled as a JS function, owned by m_engine
+    QJSValue m_compiledScript;
+    // Flag raised when m_content changes and must be compiled again
+    bool m_contentChanged;
+
+    // Mutex and wait conditions to exchange requests with the runner thread
+    mutable QMutex m_mutex;
+    QWaitCondition m_requestCondition;
+    QWaitCondition m_idleCondition;
+    // Flag raised to request the execution of the script
+    bool m_executeRequested;
+    // Flag raised while the runner thread is executing the script
+    bool m_busy;
+    // Flag raised to terminate the runner thread
+    bool m_quit;
     // Queue holding the Function IDs to start/stop
     QQueue<QPair<quint32, FunctionOperation>> m_functionQueue;
     // Queue holding Fixture values to send to Universes
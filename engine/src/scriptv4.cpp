@@ -70,6 +70,7 @@ Script::Script(Doc* doc) : Function(doc, Function::ScriptType)
 
 Script::~Script()
 {
+    delete m_runner;
 }
 
 QIcon Script::getIcon() const
@@ -81,10 +82,9 @@ quint32 Script::totalDuration()
 {
     quint32 totalDuration = 0;
 
-    ScriptRunner *runner = new ScriptRunner(doc(), m_data);
-    runner->collectScriptData();
-    totalDuration = runner->currentWaitTime();
-    //runner->deleteLater();
+    ScriptRunner runner(doc(), m_data);
+    runner.collectScriptData();
+    totalDuration = runner.currentWaitTime();
 
     qDebug() << "Script total duration:" << totalDuration;
 
@@ -132,6 +132,9 @@ bool Script::setData(const QString& str)
 
     m_data = str;
 
+    // compile the new code now, rather than when the Script starts
+    prepareRunner();
+
     Doc* doc = qobject_cast<Doc*> (parent());
     Q_ASSERT(doc != NULL);
     doc->setModified();
@@ -144,6 +147,9 @@ bool Script::appendData(const QString &str)
     //m_data.append(str + QString("\n"));
     m_data.append(convertLine(str + QString("\n")));
 
+    if (m_runner != NULL)
+        m_runner->setContent(m_data);
+
     return true;
 }
 
@@ -224,11 +230,8 @@ QList<quint32> Script::fixtureList() const
 
 QStringList Script::syntaxErrorsLines()
 {
-    ScriptRunner *runner = new ScriptRunner(doc(), m_data);
-    QStringList errorList = runner->collectScriptData();
-    //runner->deleteLater();
-
-    return errorList;
+    ScriptRunner runner(doc(), m_data);
+    return runner.collectScriptData();
 }
 
 /****************************************************************************
@@ -323,14 +326,41 @@ bool Script::saveXML(QXmlStreamWriter *doc)
     return true;
 }
 
+void Script::postLoad()
+{
+    // the loaded code is compiled now, rather than when the Script starts
+    prepareRunner();
+}
+
 /****************************************************************************
  * Running
  ****************************************************************************/
 
+void Script::prepareRunner()
+{
+    if (m_runner == NULL)
+        m_runner = new ScriptRunner(doc(), m_data);
+    else
+        m_runner->setContent(m_data);
+
+    m_runner->prepare();
+}
+
 void Script::preRun(MasterTimer* timer)
 {
-    m_runner = new ScriptRunner(doc(), m_data);
-    connect(m_runner, SIGNAL(finished()), this, SLOT(slotRunnerFinished()));
+    // the runner has been prepared when the code was loaded or changed,
+    // off the MasterTimer thread. Starting it only wakes its thread up
+    if (m_runner == NULL)
+    {
+        qDebug() << "[Script]" << name() << "started without a prepared runner";
+        prepareRunner();
+    }
+    else
+    {
+        // nothing is compiled unless the code changed unnoticed
+        m_runner->setContent(m_data);
+    }
+
     m_runner->execute();
 
     Function::preRun(timer);
@@ -353,21 +383,11 @@ void Script::write(MasterTimer *timer, QList<Universe *> universes)
 void Script::postRun(MasterTimer* timer, QList<Universe *> universes)
 {
     if (m_runner)
-    {
         m_runner->stop();
-        m_runner->exit();
-        m_runner->wait();
-    }
 
     Function::postRun(timer, universes);
 }
 
-void Script::slotRunnerFinished()
-{
-    delete m_runner;
-    m_runner = NULL;
-}
-
 quint32 Script::getValueFromString(QString str, bool *ok)
 {
     if (str.startsWith("random") == false)
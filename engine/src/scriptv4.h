@@ -130,6 +130,9 @@ public:
     /** @reimp */
     bool saveXML(QXmlStreamWriter *doc) override;
 
+    /** @reimp */
+    void postLoad() override;
+
     /************************************************************************
      * Running
      ************************************************************************/
@@ -143,10 +146,11 @@ public:
     /** @reimp */
     void postRun(MasterTimer *timer, QList<Universe*> universes) override;
 
-protected slots:
-    void slotRunnerFinished();
-
 private:
+    /** Create the runner, if needed, and let it set up its JS engine and
+     *  compile the current code on its own thread, ahead of the start */
+    void prepareRunner();
+
     /**
      * Parse a string in the form "random(min,max)" and returns
      * a randomized value between min and max
@@ -168,6 +172,9 @@ private:
     static QString convertLegacyMethod(QString method);
 
 private:
+    /** The runner executing this Script. It is prepared when the code
+     *  is loaded or changed, and reused, to avoid setting up a JS engine
+     *  and compiling the code on the MasterTimer thread */
     ScriptRunner *m_runner;
     QList <int> m_syntaxErrorLines;
 };
@@ -32,6 +32,8 @@
 #define KXMLQLCShowTimeDivision QStringLiteral("TimeDivision")
 #define KXMLQLCShowTimeType     QStringLiteral("Type")
 #define KXMLQLCShowTimeBPM      QStringLiteral("BPM")
+#define KXMLQLCShowTimecode     QStringLiteral("Timecode")
+#define KXMLQLCShowTimecodeOffset QStringLiteral("Offset")
 
 /*****************************************************************************
  * Initialization
@@ -40,6 +42,8 @@
 Show::Show(Doc* doc) : Function(doc, Function::ShowType)
     , m_timeDivisionType(Time)
     , m_timeDivisionBPM(120)
+    , m_timecodeSync(false)
+    , m_timecodeOffset(0)
     , m_latestTrackId(0)
     , m_latestShowFunctionID(0)
     , m_runner(NULL)
@@ -108,6 +112,8 @@ bool Show::copyFrom(const Function* function)
 
     m_timeDivisionType = show->m_timeDivisionType;
     m_timeDivisionBPM = show->m_timeDivisionBPM;
+    m_timecodeSync = show->m_timecodeSync;
+    m_timecodeOffset = show->m_timecodeOffset;
     m_latestTrackId = show->m_latestTrackId;
 
     // create a copy of each track
@@ -213,6 +219,30 @@ Show::TimeDivision Show::stringToTempo(QString tempo)
         return Invalid;
 }
 
+/*****************************************************************************
+ * Time code
+ *****************************************************************************/
+
+void Show::setTimecodeSync(bool enable)
+{
+    m_timecodeSync = enable;
+}
+
+bool Show::timecodeSync() const
+{
+    return m_timecodeSync;
+}
+
+void Show::setTimecodeOffset(quint32 offset)
+{
+    m_timecodeOffset = offset;
+}
+
+quint32 Show::timecodeOffset() const
+{
+    return m_timecodeOffset;
+}
+
 /*****************************************************************************
  * Tracks
  *****************************************************************************/
@@ -374,6 +404,13 @@ bool Show::saveXML(QXmlStreamWriter *doc)
     doc->writeAttribute(KXMLQLCShowTimeBPM, QString::number(m_timeDivisionBPM));
     doc->writeEndElement();
 
+    if (m_timecodeSync)
+    {
+        doc->writeStartElement(KXMLQLCShowTimecode);
+        doc->writeAttribute(KXMLQLCShowTimecodeOffset, QString::number(m_timecodeOffset));
+        doc->writeEndElement();
+    }
+
     foreach (Track *track, m_tracks)
         track->saveXML(doc);
 
@@ -407,6 +444,12 @@ bool Show::loadXML(QXmlStreamReader &root)
             setTimeDivision(stringToTempo(type), bpm);
             root.skipCurrentElement();
         }
+        else if (root.name() == KXMLQLCShowTimecode)
+        {
+            setTimecodeSync(true);
+            setTimecodeOffset(root.attributes().value(KXMLQLCShowTimecodeOffset).toString().toUInt());
+            root.skipCurrentElement();
+        }
         else if (root.name() == KXMLQLCTrack)
         {
             Track *trk = new Track(Function::invalidId(), this);
@@ -511,6 +554,12 @@ void Show::postRun(MasterTimer* timer, QList<Universe *> universes)
     Function::postRun(timer, universes);
 }
 
+void Show::seek(quint32 time)
+{
+    if (m_runner != NULL)
+        m_runner->seek(time);
+}
+
 void Show::slotChildStopped(quint32 fid)
 {
     Q_UNUSED(fid);
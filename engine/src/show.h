@@ -93,6 +93,24 @@ private:
     TimeDivision m_timeDivisionType;
     int m_timeDivisionBPM;
 
+    /*********************************************************************
+     * Time code
+     *********************************************************************/
+public:
+    /** Set if the Show follows the time code received from the inputs.
+     *  This applies only to a Show with a Time tempo. While no valid
+     *  time code is received, the Show holds its position */
+    void setTimecodeSync(bool enable);
+    bool timecodeSync() const;
+
+    /** Set the time code position where the Show starts, in milliseconds */
+    void setTimecodeOffset(quint32 offset);
+    quint32 timecodeOffset() const;
+
+private:
+    bool m_timecodeSync;
+    quint32 m_timecodeOffset;
+
     /*********************************************************************
      * Tracks
      *********************************************************************/
@@ -194,6 +212,10 @@ public:
     /** @reimp */
     void postRun(MasterTimer* timer, QList<Universe*> universes) override;
 
+    /** Move the playback of a running Show to the given time
+     *  in milliseconds. Nothing happens if the Show is not running */
+    void seek(quint32 time);
+
 protected slots:
     /** Called whenever one of this function's child functions stops */
     void slotChildStopped(quint32 fid);
@@ -19,6 +19,7 @@
 
 #include <QMutex>
 #include <QDebug>
+#include <qmath.h>
 
 #include "showrunner.h"
 #include "function.h"
@@ -27,12 +28,9 @@
 
 #define TIMER_INTERVAL 50
 
-static bool compareShowFunctions(const ShowFunction *sf1, const ShowFunction *sf2)
-{
-    if (sf1->startTime() < sf2->startTime())
-        return true;
-    return false;
-}
+/** A time code further than this from the Show position, in ms,
+ *  is a locate of the source: the Show seeks to it */
+#define TIMECODE_LOCATE_THRESHOLD 250
 
 ShowRunner::ShowRunner(const Doc* doc, quint32 showID, quint32 startTime)
     : QObject(NULL)
@@ -41,8 +39,13 @@ ShowRunner::ShowRunner(const Doc* doc, quint32 showID, quint32 startTime)
     , m_elapsedTime(startTime)
     , m_currentBeatFunctionIndex(0)
     , m_elapsedBeats(0)
+    , m_beatStartPosition(-1)
+    , m_beatStartElapsed(0)
     , beatSynced(false)
     , m_totalRunTime(0)
+    , m_seekPending(true)
+    , m_seekTime(startTime)
+    , m_timecodeHold(false)
 {
     Q_ASSERT(m_doc != NULL);
     Q_ASSERT(showID != Show::invalidId());
@@ -61,40 +64,46 @@ ShowRunner::ShowRunner(const Doc* doc, quint32 showID, quint32 startTime)
         if (track->isMute())
             continue;
 
-        // get all the functions of the track and append them to the runner queue
+        // get all the functions of the track and add them to the timelines.
+        // Items ended before startTime are kept too, to seek back to them
         foreach (ShowFunction *sfunc, track->showFunctions())
         {
-            if (sfunc->startTime() + sfunc->duration(m_doc) <= startTime)
-                continue;
-
             Function *f = m_doc->function(sfunc->functionID());
             if (f == NULL)
                 continue;
 
+            ShowTimeline::Item item;
+            item.showFunction = sfunc;
+            item.function = f;
+            item.trackId = track->id();
+            item.startTime = sfunc->startTime();
+            item.stopTime = sfunc->startTime() + sfunc->duration(m_doc);
+
             if (f->tempoType() == Function::Time)
-                m_timeFunctions.append(sfunc);
+                m_timeFunctions.append(item);
             else
-                m_beatFunctions.append(sfunc);
-
-            if (sfunc->startTime() + sfunc->duration(m_doc) > m_totalRunTime)
-                m_totalRunTime = sfunc->startTime() + sfunc->duration(m_doc);
+                m_beatFunctions.append(item);
         }
 
         // Initialize the intensity map
         m_intensityMap[track->id()] = 1.0;
     }
 
-    std::sort(m_timeFunctions.begin(), m_timeFunctions.end(), compareShowFunctions);
-    std::sort(m_beatFunctions.begin(), m_beatFunctions.end(), compareShowFunctions);
+    m_timeFunctions.build();
+    m_beatFunctions.build();
+
+    m_totalRunTime = qMax(m_timeFunctions.stopTime(), m_beatFunctions.stopTime());
 
 #if 1
     qDebug() << "Ordered list of ShowFunctions (time):";
-    foreach (ShowFunction *sfunc, m_timeFunctions)
-        qDebug() << "[Show] Function ID:" << sfunc->functionID() << "start time:" << sfunc->startTime() << "duration:" << sfunc->duration(m_doc);
+    for (int i = 0; i < m_timeFunctions.count(); i++)
+        qDebug() << "[Show] Function ID:" << m_timeFunctions.at(i).function->id() << "start time:" << m_timeFunctions.at(i).startTime
+                 << "duration:" << m_timeFunctions.at(i).stopTime - m_timeFunctions.at(i).startTime;
 
     qDebug() << "Ordered list of ShowFunctions (beats):";
-    foreach (ShowFunction *sfunc, m_beatFunctions)
-        qDebug() << "[Show] Function ID:" << sfunc->functionID() << "start time:" << sfunc->startTime() << "duration:" << sfunc->duration(m_doc);
+    for (int i = 0; i < m_beatFunctions.count(); i++)
+        qDebug() << "[Show] Function ID:" << m_beatFunctions.at(i).function->id() << "start time:" << m_beatFunctions.at(i).startTime
+                 << "duration:" << m_beatFunctions.at(i).stopTime - m_beatFunctions.at(i).startTime;
 #endif
     m_runningQueue.clear();
 
@@ -112,15 +121,29 @@ void ShowRunner::start()
 
 void ShowRunner::setPause(bool enable)
 {
+    // the Functions resume when the time code comes back
+    if (enable == false && m_timecodeHold)
+        return;
+
     for (int i = 0; i < m_runningQueue.count(); i++)
     {
         Function *f = m_runningQueue.at(i).first;
         f->setPause(enable);
     }
+
+    // the beats elapsed while paused are not counted
+    if (enable == false)
+        m_beatStartPosition = -1;
 }
 
 void ShowRunner::stop()
 {
+    {
+        QMutexLocker locker(&m_seekMutex);
+        m_seekPending = false;
+    }
+
+    m_deferredItems.clear();
     m_elapsedTime = 0;
     m_elapsedBeats = 0;
     m_currentTimeFunctionIndex = 0;
@@ -145,107 +168,118 @@ void ShowRunner::write(MasterTimer *timer)
 {
     //qDebug() << Q_FUNC_INFO << "elapsed:" << m_elapsedTime << ", total:" << m_totalRunTime;
 
-    // Phase 1. Check all the Functions that need to be started
-    // m_timeFunctions is ordered by startup time, so when we found an entry
-    // with start time greater than m_elapsed, this phase is over
-    bool startFunctionsDone = false;
+    bool timecodeSync = m_show->tempoType() == Function::Time && m_show->timecodeSync();
 
-    // check synchronization to beats (if show is beat-based)
-    if (m_show->tempoType() == Function::Beats)
+    // without a time code, a Show following it holds where it is
+    // rather than running on its own clock away from the source.
+    // Nothing is started or seeked until the time code comes back
+    if (timecodeSync && timer->timecodeValid() == false)
     {
-        //qDebug() << Q_FUNC_INFO << "isBeat:" << timer->isBeat() << ", elapsed beats:" << m_elapsedBeats;
+        if (m_timecodeHold == false)
+            qDebug() << "[ShowRunner] time code lost, holding at" << m_elapsedTime;
+
+        // a Function started by the last write may be running only now
+        setPause(true);
+        m_timecodeHold = true;
+        return;
+    }
+
+    if (m_timecodeHold)
+    {
+        qDebug() << "[ShowRunner] time code back, resuming";
+        m_timecodeHold = false;
+        setPause(false);
+    }
 
-        if (timer->isBeat())
+    {
+        QMutexLocker locker(&m_seekMutex);
+        if (m_seekPending)
         {
-            if (beatSynced == false)
-            {
-                beatSynced = true;
-                qDebug() << "Beat synced";
-            }
-            else
-                m_elapsedBeats += 1000;
+            m_seekPending = false;
+            applySeek(timer, m_seekTime);
         }
+    }
 
-        if (beatSynced == false)
-            return;
+    // a Show following the time code takes its position from it
+    bool timecodeLocked = false;
+    if (timecodeSync)
+    {
+        qint64 position = qMax(qint64(0), timer->timecodePosition() - m_show->timecodeOffset());
+        position = qMin(position, qint64(UINT_MAX));
+
+        if (qAbs(position - qint64(m_elapsedTime)) > TIMECODE_LOCATE_THRESHOLD)
+            applySeek(timer, quint32(position));
+        else
+            m_elapsedTime = quint32(position);
+
+        timecodeLocked = true;
     }
 
-    // check if there are time-based functions to start
-    while (startFunctionsDone == false)
+    // Phase 1. Check all the Functions that need to be started
+    // the timelines are ordered by startup time, so when we found an entry
+    // with start time greater than the elapsed time, this phase is over
+
+    // check synchronization to beats (if show is beat-based)
+    if (m_show->tempoType() == Function::Beats)
     {
-        if (m_currentTimeFunctionIndex == m_timeFunctions.count())
-            break;
+        //qDebug() << Q_FUNC_INFO << "isBeat:" << timer->isBeat() << ", elapsed beats:" << m_elapsedBeats;
 
-        ShowFunction *sf = m_timeFunctions.at(m_currentTimeFunctionIndex);
-        quint32 funcStartTime = sf->startTime();
-        quint32 functionTimeOffset = 0;
-        Function *f = m_doc->function(sf->functionID());
+        double position = timer->beatPosition();
 
-        // this should happen only when a Show is not started from 0
-        if (m_elapsedTime > funcStartTime)
+        if (beatSynced == false && timer->isBeat())
         {
-            functionTimeOffset = m_elapsedTime - funcStartTime;
-            funcStartTime = m_elapsedTime;
+            beatSynced = true;
+            // count from the beat just happened
+            m_beatStartPosition = qFloor(position);
+            m_beatStartElapsed = m_elapsedBeats;
+            qDebug() << "Beat synced";
         }
-        if (m_elapsedTime >= funcStartTime)
+
+        // follow the beat clock, so the beats elapse
+        // continuously and not just on beat ticks
+        if (beatSynced)
         {
-            foreach (Track *track, m_show->tracks())
+            if (m_beatStartPosition < 0)
             {
-                if (track->showFunctions().contains(sf))
-                {
-                    int intOverrideId = f->requestAttributeOverride(Function::Intensity, m_intensityMap[track->id()]);
-                    //f->adjustAttribute(m_intensityMap[track->id()], Function::Intensity);
-                    sf->setIntensityOverrideId(intOverrideId);
-                    break;
-                }
+                m_beatStartPosition = position;
+                m_beatStartElapsed = m_elapsedBeats;
             }
 
-            f->start(m_doc->masterTimer(), functionParent(), functionTimeOffset);
-            m_runningQueue.append(QPair<Function *, quint32>(f, sf->startTime() + sf->duration(m_doc)));
-            m_currentTimeFunctionIndex++;
+            // measured from the start position on every tick,
+            // so that the rounding errors don't add up
+            double elapsed = m_beatStartElapsed + (position - m_beatStartPosition) * 1000.0;
+            m_elapsedBeats = elapsed < UINT_MAX ? quint32(qRound64(qMax(0.0, elapsed))) : UINT_MAX;
         }
-        else
-            startFunctionsDone = true;
+
+        if (beatSynced == false)
+            return;
     }
 
-    startFunctionsDone = false;
+    if (m_deferredItems.isEmpty() == false)
+        startDeferredItems();
 
-    // check if there are beat-based functions to start
-    while (startFunctionsDone == false)
+    // check if there are time-based functions to start.
+    // When the start time has been passed in between two ticks,
+    // the Function is started from the time it is late
+    while (m_currentTimeFunctionIndex < m_timeFunctions.count())
     {
-        if (m_currentBeatFunctionIndex == m_beatFunctions.count())
+        const ShowTimeline::Item &item = m_timeFunctions.at(m_currentTimeFunctionIndex);
+        if (item.startTime > m_elapsedTime)
             break;
 
-        ShowFunction *sf = m_beatFunctions.at(m_currentBeatFunctionIndex);
-        quint32 funcStartTime = sf->startTime();
-        quint32 functionTimeOffset = 0;
-        Function *f = m_doc->function(sf->functionID());
+        startItem(item, m_elapsedTime - item.startTime);
+        m_currentTimeFunctionIndex++;
+    }
 
-        // this should happen only when a Show is not started from 0
-        if (m_elapsedBeats > funcStartTime)
-        {
-            functionTimeOffset = m_elapsedBeats - funcStartTime;
-            funcStartTime = m_elapsedBeats;
-        }
-        if (m_elapsedBeats >= funcStartTime)
-        {
-            foreach (Track *track, m_show->tracks())
-            {
-                if (track->showFunctions().contains(sf))
-                {
-                    int intOverrideId = f->requestAttributeOverride(Function::Intensity, m_intensityMap[track->id()]);
-                    //f->adjustAttribute(m_intensityMap[track->id()], Function::Intensity);
-                    sf->setIntensityOverrideId(intOverrideId);
-                    break;
-                }
-            }
+    // check if there are beat-based functions to start
+    while (m_currentBeatFunctionIndex < m_beatFunctions.count())
+    {
+        const ShowTimeline::Item &item = m_beatFunctions.at(m_currentBeatFunctionIndex);
+        if (item.startTime > m_elapsedBeats)
+            break;
 
-            f->start(m_doc->masterTimer(), functionParent(), functionTimeOffset);
-            m_runningQueue.append(QPair<Function *, quint32>(f, sf->startTime() + sf->duration(m_doc)));
-            m_currentBeatFunctionIndex++;
-        }
-        else
-            startFunctionsDone = true;
+        startItem(item, m_elapsedBeats - item.startTime);
+        m_currentBeatFunctionIndex++;
     }
 
     // Phase 2. Check if we need to stop some running Functions
@@ -277,10 +311,85 @@ void ShowRunner::write(MasterTimer *timer)
         return;
     }
 
-    m_elapsedTime += MasterTimer::tick();
+    if (timecodeLocked == false)
+        m_elapsedTime += MasterTimer::tick();
     emit timeChanged(m_elapsedTime);
 }
 
+void ShowRunner::seek(quint32 time)
+{
+    QMutexLocker locker(&m_seekMutex);
+    m_seekTime = time;
+    m_seekPending = true;
+}
+
+void ShowRunner::applySeek(MasterTimer *timer, quint32 time)
+{
+    qDebug() << "[ShowRunner] seek to" << time;
+
+    // everything is restarted, since the running Functions
+    // would be at the wrong offset otherwise
+    for (int i = 0; i < m_runningQueue.count(); i++)
+    {
+        Function *f = m_runningQueue.at(i).first;
+        f->stop(functionParent());
+    }
+    m_runningQueue.clear();
+    m_deferredItems.clear();
+
+    m_elapsedTime = time;
+    m_elapsedBeats = 0;
+    m_beatStartPosition = -1;
+    if (m_show->tempoType() == Function::Beats)
+        m_elapsedBeats = Function::timeToBeats(time, timer->beatTimeDuration());
+
+    // items starting exactly at the seek time are left to write()
+    m_timeFunctions.activeAt(m_elapsedTime, m_activeItems);
+    foreach (int index, m_activeItems)
+        m_deferredItems.append(m_timeFunctions.at(index));
+    m_currentTimeFunctionIndex = m_timeFunctions.lowerBound(m_elapsedTime);
+
+    m_beatFunctions.activeAt(m_elapsedBeats, m_activeItems);
+    foreach (int index, m_activeItems)
+        m_deferredItems.append(m_beatFunctions.at(index));
+    m_currentBeatFunctionIndex = m_beatFunctions.lowerBound(m_elapsedBeats);
+
+    // the Functions that were not running are started right away
+    startDeferredItems();
+
+    emit timeChanged(m_elapsedTime);
+}
+
+void ShowRunner::startDeferredItems()
+{
+    for (int i = 0; i < m_deferredItems.count();)
+    {
+        const ShowTimeline::Item &item = m_deferredItems.at(i);
+
+        // the MasterTimer has not processed the stop of the Function yet
+        if (item.function->stopped() && item.function->isRunning())
+        {
+            i++;
+            continue;
+        }
+
+        quint32 currTime = item.function->tempoType() == Function::Time ? m_elapsedTime : m_elapsedBeats;
+        if (currTime >= item.startTime && currTime < item.stopTime)
+            startItem(item, currTime - item.startTime);
+
+        m_deferredItems.removeAt(i);
+    }
+}
+
+void ShowRunner::startItem(const ShowTimeline::Item &item, quint32 offset)
+{
+    int intOverrideId = item.function->requestAttributeOverride(Function::Intensity, m_intensityMap[item.trackId]);
+    item.showFunction->setIntensityOverrideId(intOverrideId);
+
+    item.function->start(m_doc->masterTimer(), functionParent(), offset);
+    m_runningQueue.append(QPair<Function *, quint32>(item.function, item.stopTime));
+}
+
 /************************************************************************
  * Intensity
  ************************************************************************/
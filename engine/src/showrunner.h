@@ -26,6 +26,8 @@
 
 #include <function.h>
 
+#include "showtimeline.h"
+
 class ShowFunction;
 class Function;
 class Track;
@@ -55,14 +57,36 @@ public:
 
     void write(MasterTimer *timer);
 
+    /**
+     * Move the playback to the given time position. The Functions
+     * running at that time are (re)started from the right offset and
+     * the others are stopped. This is applied on the next write(),
+     * so it can be called from any thread. A Function that was running
+     * is restarted once the MasterTimer has processed its stop.
+     *
+     * @param time the position in milliseconds from the Show start
+     */
+    void seek(quint32 time);
+
+private:
+    /** Apply a seek requested with seek() */
+    void applySeek(MasterTimer *timer, quint32 time);
+
+    /** Start the Function of a timeline item from the given offset */
+    void startItem(const ShowTimeline::Item& item, quint32 offset);
+
+    /** Start the items deferred by a seek, whose Function stop
+     *  has been processed by the MasterTimer */
+    void startDeferredItems();
+
 private:
     const Doc *m_doc;
 
     /** The reference of the show to play */
     Show* m_show;
 
-    /** The list of time-based Functions the Show needs to play */
-    QList <ShowFunction *> m_timeFunctions;
+    /** The time-based Functions the Show needs to play */
+    ShowTimeline m_timeFunctions;
 
     /** Index of the item in m_timeFunctions to be considered for playback */
     int m_currentTimeFunctionIndex;
@@ -70,8 +94,8 @@ private:
     /** Elapsed time since runner start. Used also to move the cursor in the track view */
     quint32 m_elapsedTime;
 
-    /** The list of beat-based Functions the Show needs to play */
-    QList <ShowFunction *> m_beatFunctions;
+    /** The beat-based Functions the Show needs to play */
+    ShowTimeline m_beatFunctions;
 
     /** Index of the item in m_beatFunctions to be considered for playback */
     int m_currentBeatFunctionIndex;
@@ -79,6 +103,12 @@ private:
     /** Elapsed beats since runner start */
     quint32 m_elapsedBeats;
 
+    /** The beat position the elapsed beats are counted from, -1 if none */
+    double m_beatStartPosition;
+
+    /** The elapsed beats at m_beatStartPosition */
+    quint32 m_beatStartElapsed;
+
     /** Flag used to sinchronize playback to beats */
     bool beatSynced;
 
@@ -88,6 +118,24 @@ private:
     /** List of the currently running Functions and their stop time */
     QList < QPair<Function *, quint32> > m_runningQueue;
 
+    /** A seek requested and not applied yet. The runner always
+     *  starts with a seek to its start time */
+    QMutex m_seekMutex;
+    bool m_seekPending;
+    quint32 m_seekTime;
+
+    /** The timeline items found by a seek. Reused to avoid allocations */
+    QVector<int> m_activeItems;
+
+    /** The items to restart after a seek, once the MasterTimer has
+     *  stopped their Function. Restarting it in the same tick would let
+     *  its postRun reset the elapsed offset and the intensity override */
+    QList<ShowTimeline::Item> m_deferredItems;
+
+    /** Flag raised while a Show following the time code holds,
+     *  because no valid time code is received */
+    bool m_timecodeHold;
+
 private:
     FunctionParent functionParent() const;
 
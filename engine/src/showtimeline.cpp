@@ -0,0 +1,136 @@
+/*
+  Q Light Controller Plus
+  showtimeline.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <algorithm>
+
+#include "showtimeline.h"
+
+static bool compareItems(const ShowTimeline::Item &item1, const ShowTimeline::Item &item2)
+{
+    return item1.startTime < item2.startTime;
+}
+
+ShowTimeline::ShowTimeline()
+{
+}
+
+ShowTimeline::~ShowTimeline()
+{
+}
+
+void ShowTimeline::append(const Item &item)
+{
+    m_items.append(item);
+}
+
+void ShowTimeline::build()
+{
+    // stable, so that items starting together keep the Show order
+    std::stable_sort(m_items.begin(), m_items.end(), compareItems);
+
+    m_maxStopTime.resize(m_items.count());
+    buildNode(0, m_items.count());
+}
+
+void ShowTimeline::clear()
+{
+    m_items.clear();
+    m_maxStopTime.clear();
+}
+
+int ShowTimeline::count() const
+{
+    return m_items.count();
+}
+
+const ShowTimeline::Item &ShowTimeline::at(int index) const
+{
+    return m_items.at(index);
+}
+
+int ShowTimeline::lowerBound(quint32 time) const
+{
+    int lo = 0;
+    int hi = m_items.count();
+
+    while (lo < hi)
+    {
+        int mid = (lo + hi) / 2;
+        if (m_items.at(mid).startTime < time)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return lo;
+}
+
+void ShowTimeline::activeAt(quint32 time, QVector<int> &indices) const
+{
+    indices.clear();
+    activeAt(0, m_items.count(), time, indices);
+}
+
+quint32 ShowTimeline::stopTime() const
+{
+    if (m_items.isEmpty())
+        return 0;
+
+    return m_maxStopTime.at((m_items.count() - 1) / 2);
+}
+
+quint32 ShowTimeline::buildNode(int lo, int hi)
+{
+    if (lo >= hi)
+        return 0;
+
+    int mid = (lo + hi - 1) / 2;
+    quint32 maxStop = m_items.at(mid).stopTime;
+
+    maxStop = qMax(maxStop, buildNode(lo, mid));
+    maxStop = qMax(maxStop, buildNode(mid + 1, hi));
+
+    m_maxStopTime[mid] = maxStop;
+    return maxStop;
+}
+
+void ShowTimeline::activeAt(int lo, int hi, quint32 time, QVector<int> &indices) const
+{
+    if (lo >= hi)
+        return;
+
+    int mid = (lo + hi - 1) / 2;
+
+    // nothing in this subtree is still running at the given time
+    if (m_maxStopTime.at(mid) <= time)
+        return;
+
+    activeAt(lo, mid, time, indices);
+
+    // items are sorted by start time, so nothing on the right
+    // can be started if this one is not
+    const Item &item = m_items.at(mid);
+    if (item.startTime >= time)
+        return;
+
+    if (item.stopTime > time)
+        indices.append(mid);
+
+    activeAt(mid + 1, hi, time, indices);
+}
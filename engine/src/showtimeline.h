@@ -0,0 +1,103 @@
+/*
+  Q Light Controller Plus
+  showtimeline.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef SHOWTIMELINE_H
+#define SHOWTIMELINE_H
+
+#include <QVector>
+
+class ShowFunction;
+class Function;
+
+/** @addtogroup engine_functions Functions
+ * @{
+ */
+
+/**
+ * ShowTimeline indexes the items of a Show by their time interval.
+ *
+ * Items are kept sorted by start time, so playback can move forward
+ * with a cursor. On top of that, the sorted items are seen as a balanced
+ * binary tree where each node knows the latest stop time of its subtree.
+ * This is what makes it possible to find the items running at any given
+ * time in O(log n + k), without scanning the whole Show.
+ */
+class ShowTimeline
+{
+public:
+    typedef struct
+    {
+        ShowFunction *showFunction;
+        Function *function;
+        quint32 trackId;
+        quint32 startTime;
+        quint32 stopTime;
+    } Item;
+
+    ShowTimeline();
+    ~ShowTimeline();
+
+    /** Add an item to the timeline. build() must be called
+     *  before querying the timeline again */
+    void append(const Item& item);
+
+    /** Sort the items and build the index */
+    void build();
+
+    /** Remove all the items */
+    void clear();
+
+    /** Get the number of items */
+    int count() const;
+
+    /** Get the item at the given index, in start time order */
+    const Item& at(int index) const;
+
+    /** Get the index of the first item starting at or after $time,
+     *  or count() if there is none */
+    int lowerBound(quint32 time) const;
+
+    /**
+     * Get the indices of the items started before $time and not yet
+     * stopped at $time, in start time order.
+     *
+     * @param time the time position to look at
+     * @param indices filled with the result. Reused to avoid allocations
+     */
+    void activeAt(quint32 time, QVector<int>& indices) const;
+
+    /** Get the latest stop time of all the items */
+    quint32 stopTime() const;
+
+private:
+    /** Compute the latest stop time of the subtree in [lo, hi) */
+    quint32 buildNode(int lo, int hi);
+
+    void activeAt(int lo, int hi, quint32 time, QVector<int>& indices) const;
+
+private:
+    QVector<Item> m_items;
+
+    /** The latest stop time of the subtree rooted at each item */
+    QVector<quint32> m_maxStopTime;
+};
+
+/** @} */
+
+#endif
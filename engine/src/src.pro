@@ -60,7 +60,8 @@ HEADERS += avolitesd4parser.h \
            utils.h
 
 # Engine
-HEADERS += bus.h \
+HEADERS += beatclock.h \
+           bus.h \
            channelsgroup.h \
            channelmodifier.h \
            chaser.h \
@@ -86,6 +87,7 @@ HEADERS += bus.h \
            grouphead.h \
            inputoutputmap.h \
            inputpatch.h \
+           latencytracer.h \
            ioplugincache.h \
            keypadparser.h \
            mastertimer.h \
@@ -101,6 +103,7 @@ HEADERS += bus.h \
            rgbscriptproperty.h \
            rgbscriptscache.h \
            rgbtext.h \
+           rgbvideo.h \
            scene.h \
            scenevalue.h \
            scriptwrapper.h \
@@ -108,6 +111,7 @@ HEADERS += bus.h \
            show.h \
            showfunction.h \
            showrunner.h \
+           showtimeline.h \
            track.h \
            universe.h \
            video.h
@@ -140,7 +144,8 @@ SOURCES += avolitesd4parser.cpp \
            qlcphysical.cpp
 
 # Engine
-SOURCES += bus.cpp \
+SOURCES += beatclock.cpp \
+           bus.cpp \
            channelsgroup.cpp \
            channelmodifier.cpp \
            chaser.cpp \
@@ -164,6 +169,7 @@ SOURCES += bus.cpp \
            grouphead.cpp \
            inputoutputmap.cpp \
            inputpatch.cpp \
+           latencytracer.cpp \
            ioplugincache.cpp \
            keypadparser.cpp \
            mastertimer.cpp \
@@ -178,12 +184,14 @@ SOURCES += bus.cpp \
            rgbplain.cpp \
            rgbscriptscache.cpp \
            rgbtext.cpp \
+           rgbvideo.cpp \
            scene.cpp \
            scenevalue.cpp \
            sequence.cpp \
            show.cpp \
            showfunction.cpp \
            showrunner.cpp \
+           showtimeline.cpp \
            track.cpp \
            universe.cpp \
            video.cpp
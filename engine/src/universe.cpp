@@ -20,6 +20,7 @@
 #include <QXmlStreamReader>
 #include <QXmlStreamWriter>
 #include <QDebug>
+#include <atomic>
 #include <math.h>
 
 #include "channelmodifier.h"
@@ -29,6 +30,7 @@
 #include "outputpatch.h"
 #include "grandmaster.h"
 #include "mastertimer.h"
+#include "latencytracer.h"
 #include "inputpatch.h"
 #include "qlcmacros.h"
 #include "universe.h"
@@ -50,8 +52,10 @@ Universe::Universe(quint32 id, GrandMaster *gm, QObject *parent)
     , m_grandMaster(gm)
     , m_passthrough(false)
     , m_monitor(false)
+    , m_highPrecision(false)
     , m_inputPatch(NULL)
     , m_fbPatch(NULL)
+    , m_latencyTracer(NULL)
     , m_channelsMask(new QByteArray(UNIVERSE_SIZE, char(0)))
     , m_modifiedZeroValues(new QByteArray(UNIVERSE_SIZE, char(0)))
     , m_running(false)
@@ -67,8 +71,13 @@ Universe::Universe(quint32 id, GrandMaster *gm, QObject *parent)
     , m_lastPostGMValues(new QByteArray(UNIVERSE_SIZE, char(0)))
     , m_blackoutValues(new QByteArray(UNIVERSE_SIZE, char(0)))
     , m_passthroughValues()
+    , m_preGMFractions(new QByteArray(UNIVERSE_SIZE, char(0)))
+    , m_snapshotSequence(0)
 {
     m_modifiers.fill(NULL, UNIVERSE_SIZE);
+    m_fineChannels.fill(-1, UNIVERSE_SIZE);
+    m_coarseChannels.fill(-1, UNIVERSE_SIZE);
+    memset(m_snapshot, 0, sizeof(m_snapshot));
 
     m_name = QString("Universe %1").arg(id + 1);
 
@@ -174,6 +183,27 @@ bool Universe::passthrough() const
     return m_passthrough;
 }
 
+void Universe::setHighPrecision(bool enable)
+{
+    if (enable == m_highPrecision)
+        return;
+
+    qDebug() << "Set universe" << id() << "high precision to" << enable;
+
+    m_preGMFractions->fill(0);
+    m_highPrecision = enable;
+
+    for (int i = 0; i < m_usedChannels; i++)
+        updatePostGMValue(i);
+
+    emit highPrecisionChanged();
+}
+
+bool Universe::highPrecision() const
+{
+    return m_highPrecision;
+}
+
 void Universe::setMonitor(bool enable)
 {
     m_monitor = enable;
@@ -211,7 +241,8 @@ void Universe::slotGMValueChanged()
 QSharedPointer<GenericFader> Universe::requestFader(Universe::FaderPriority priority)
 {
     int insertPos = 0;
-    QSharedPointer<GenericFader> fader = QSharedPointer<GenericFader>(new GenericFader());
+    // object and reference count share a single allocation
+    QSharedPointer<GenericFader> fader = QSharedPointer<GenericFader>::create();
     fader->setPriority(priority);
 
     {
@@ -341,12 +372,16 @@ void Universe::processFaders()
         }
     }
 
+    publishSnapshot();
+
     bool dataChanged = hasChanged();
-    const QByteArray postGM = m_postGMValues->mid(0, m_usedChannels);
-    dumpOutput(postGM, dataChanged);
+    if (m_outputValues.size() != m_usedChannels)
+        m_outputValues.resize(m_usedChannels);
+    memcpy(m_outputValues.data(), m_postGMValues->constData(), m_usedChannels);
+    dumpOutput(m_outputValues, dataChanged);
 
     if (dataChanged)
-        emit universeWritten(id(), postGM);
+        emit universeWritten(id(), m_outputValues);
 }
 
 void Universe::run()
@@ -380,6 +415,7 @@ void Universe::run()
 void Universe::reset()
 {
     m_preGMValues->fill(0);
+    m_preGMFractions->fill(0);
     m_blackoutValues->fill(0);
 
     if (m_passthrough)
@@ -400,6 +436,7 @@ void Universe::reset(int address, int range)
        range = UNIVERSE_SIZE - address;
 
     memset(m_preGMValues->data() + address, 0, range * sizeof(*m_preGMValues->data()));
+    memset(m_preGMFractions->data() + address, 0, range * sizeof(*m_preGMFractions->data()));
     memset(m_blackoutValues->data() + address, 0, range * sizeof(*m_blackoutValues->data()));
     memcpy(m_postGMValues->data() + address, m_modifiedZeroValues->data() + address, range * sizeof(*m_postGMValues->data()));
 
@@ -504,6 +541,76 @@ uchar Universe::preGMValue(int address) const
     return static_cast<uchar>(m_preGMValues->at(address));
 }
 
+/************************************************************************
+ * Snapshot
+ ************************************************************************/
+
+void Universe::publishSnapshot()
+{
+    // there is only one writer, so a plain increment is enough to
+    // tell the readers that the snapshot is being modified
+    m_snapshotSequence.fetchAndAddRelaxed(1);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    memcpy(m_snapshot, m_preGMValues->constData(), UNIVERSE_SIZE);
+    memcpy(m_snapshot + UNIVERSE_SIZE, m_postGMValues->constData(), UNIVERSE_SIZE);
+
+    m_snapshotSequence.fetchAndAddRelease(1);
+}
+
+void Universe::readSnapshot(int offset, int count, char *dest) const
+{
+    int sequence;
+
+    do
+    {
+        sequence = m_snapshotSequence.loadAcquire();
+        if (sequence & 1)
+        {
+            // the writer is in the middle of a copy, which takes
+            // well under a microsecond. Just try again
+            continue;
+        }
+
+        memcpy(dest, m_snapshot + offset, count);
+        std::atomic_thread_fence(std::memory_order_acquire);
+    } while ((sequence & 1) || sequence != m_snapshotSequence.loadAcquire());
+}
+
+uchar Universe::snapshotPreGMValue(int address) const
+{
+    if (address < 0 || address >= UNIVERSE_SIZE)
+        return 0;
+
+    char value;
+    readSnapshot(address, 1, &value);
+    return uchar(value);
+}
+
+uchar Universe::snapshotPostGMValue(int address) const
+{
+    if (address < 0 || address >= UNIVERSE_SIZE)
+        return 0;
+
+    char value;
+    readSnapshot(UNIVERSE_SIZE + address, 1, &value);
+    return uchar(value);
+}
+
+QByteArray Universe::snapshotPreGMValues() const
+{
+    QByteArray values(UNIVERSE_SIZE, char(0));
+    readSnapshot(0, UNIVERSE_SIZE, values.data());
+    return values;
+}
+
+QByteArray Universe::snapshotPostGMValues() const
+{
+    QByteArray values(UNIVERSE_SIZE, char(0));
+    readSnapshot(UNIVERSE_SIZE, UNIVERSE_SIZE, values.data());
+    return values;
+}
+
 uchar Universe::applyGM(int channel, uchar value)
 {
     if ((m_grandMaster->channelMode() == GrandMaster::Intensity && m_channelsMask->at(channel) & Intensity) ||
@@ -541,6 +648,14 @@ uchar Universe::applyPassthrough(int channel, uchar value)
 }
 
 void Universe::updatePostGMValue(int channel)
+{
+    if (m_highPrecision)
+        updatePostGMValue16(channel);
+    else
+        updatePostGMValue8(channel);
+}
+
+void Universe::updatePostGMValue8(int channel)
 {
     uchar value = preGMValue(channel);
 
@@ -553,6 +668,59 @@ void Universe::updatePostGMValue(int channel)
     (*m_postGMValues)[channel] = static_cast<char>(value);
 }
 
+quint32 Universe::applyGM16(int channel, quint32 value)
+{
+    if ((m_grandMaster->channelMode() == GrandMaster::Intensity && m_channelsMask->at(channel) & Intensity) ||
+        (m_grandMaster->channelMode() == GrandMaster::AllChannels))
+    {
+        if (m_grandMaster->valueMode() == GrandMaster::Limit)
+            value = MIN(value, quint32(m_grandMaster->value()) * 0x0101);
+        else
+            value = quint32(floor((double(value) * m_grandMaster->fraction()) + 0.5));
+    }
+
+    return value;
+}
+
+void Universe::updatePostGMValue16(int channel)
+{
+    int coarse = m_coarseChannels.at(channel) == -1 ? channel : m_coarseChannels.at(channel);
+    int fine = m_fineChannels.at(coarse);
+    uchar fraction = uchar(m_preGMFractions->at(coarse));
+
+    // modified channels can only be processed with 8 bit precision
+    if (m_modifiers.at(coarse) != NULL || (fine != -1 && m_modifiers.at(fine) != NULL))
+    {
+        updatePostGMValue8(coarse);
+        if (fine != -1)
+            updatePostGMValue8(fine);
+        return;
+    }
+
+    // The fractional part of a high precision write goes to the fine channel.
+    // Otherwise the fine channel value is used, as written by a Function
+    quint32 value = quint32(uchar(m_preGMValues->at(coarse))) << 8;
+    if (fraction == 0 && fine != -1)
+        value |= uchar(m_preGMValues->at(fine));
+    else
+        value |= fraction;
+
+    if (value != 0)
+        value = applyGM16(coarse, value);
+
+    if (fine == -1)
+    {
+        // no fine channel to output to. Just round the value
+        value = MIN(quint32(UCHAR_MAX), (value + 0x80) >> 8);
+        (*m_postGMValues)[coarse] = static_cast<char>(applyPassthrough(coarse, uchar(value)));
+    }
+    else
+    {
+        (*m_postGMValues)[coarse] = static_cast<char>(applyPassthrough(coarse, uchar(value >> 8)));
+        (*m_postGMValues)[fine] = static_cast<char>(applyPassthrough(fine, uchar(value & 0xFF)));
+    }
+}
+
 /************************************************************************
  * Patches
  ************************************************************************/
@@ -576,6 +744,7 @@ bool Universe::setInputPatch(QLCIOPlugin *plugin,
             return true;
 
         m_inputPatch = new InputPatch(m_id, this);
+        m_inputPatch->setLatencyTracer(m_latencyTracer);
         connectInputPatch();
     }
     else
@@ -715,6 +884,9 @@ void Universe::dumpOutput(const QByteArray &data, bool dataChanged)
             op->dump(m_id, data, dataChanged);
     }
     m_totalChannelsChanged = false;
+
+    if (m_latencyTracer != NULL)
+        m_latencyTracer->outputWritten(m_id, data);
 }
 
 void Universe::flushInput()
@@ -725,6 +897,14 @@ void Universe::flushInput()
     m_inputPatch->flush(m_id);
 }
 
+void Universe::setLatencyTracer(LatencyTracer *tracer)
+{
+    m_latencyTracer = tracer;
+
+    if (m_inputPatch != NULL)
+        m_inputPatch->setLatencyTracer(tracer);
+}
+
 void Universe::slotInputValueChanged(quint32 universe, quint32 channel, uchar value, const QString &key)
 {
     if (m_passthrough)
@@ -787,6 +967,13 @@ void Universe::setChannelCapability(ushort channel, QLCChannel::Group group, Cha
         m_intensityChannelsChanged = true;
     Utils::vectorRemove(m_nonIntensityChannels, channel);
 
+    // forget any previous coarse/fine pair, the
+    // channel might now belong to another fixture
+    if (m_coarseChannels.at(channel) != -1)
+        setChannelFine(m_coarseChannels.at(channel), -1);
+    if (m_fineChannels.at(channel) != -1)
+        setChannelFine(channel, -1);
+
     if (forcedType != Undefined)
     {
         (*m_channelsMask)[channel] = char(forcedType);
@@ -887,6 +1074,22 @@ ChannelModifier *Universe::channelModifier(ushort channel)
     return m_modifiers.at(channel);
 }
 
+void Universe::setChannelFine(ushort channel, int fine)
+{
+    if (channel >= (ushort)m_fineChannels.count() || fine >= m_fineChannels.count())
+        return;
+
+    int previous = m_fineChannels.at(channel);
+    if (previous != -1)
+        m_coarseChannels[previous] = -1;
+
+    m_fineChannels[channel] = short(fine);
+    if (fine != -1)
+        m_coarseChannels[fine] = short(channel);
+
+    updatePostGMValue(channel);
+}
+
 void Universe::updateIntensityChannelsRanges()
 {
     if (!m_intensityChannelsChanged)
@@ -945,6 +1148,7 @@ bool Universe::write(int address, uchar value, bool forceLTP)
     }
 
     (*m_preGMValues)[address] = char(value);
+    (*m_preGMFractions)[address] = 0;
 
     updatePostGMValue(address);
 
@@ -962,6 +1166,7 @@ bool Universe::writeMultiple(int address, quint32 value, int channelCount)
             (*m_blackoutValues)[address + i] = ((uchar *)&value)[channelCount - 1 - i];
 
         (*m_preGMValues)[address + i] = ((uchar *)&value)[channelCount - 1 - i];
+        (*m_preGMFractions)[address + i] = 0;
 
         updatePostGMValue(address + i);
     }
@@ -984,6 +1189,7 @@ bool Universe::writeRelative(int address, quint32 value, int channelCount)
         newVal += short(value) - RELATIVE_ZERO_8BIT;
         (*m_preGMValues)[address] = char(CLAMP(newVal, 0, UCHAR_MAX));
         (*m_blackoutValues)[address] = char(CLAMP(newVal, 0, UCHAR_MAX));
+        (*m_preGMFractions)[address] = 0;
         updatePostGMValue(address);
     }
     else
@@ -998,6 +1204,7 @@ bool Universe::writeRelative(int address, quint32 value, int channelCount)
         {
             (*m_preGMValues)[address + i] = ((uchar *)&currentValue)[channelCount - 1 - i];
             (*m_blackoutValues)[address + i] = ((uchar *)&currentValue)[channelCount - 1 - i];
+            (*m_preGMFractions)[address + i] = 0;
             updatePostGMValue(address + i);
         }
     }
@@ -1014,6 +1221,79 @@ bool Universe::writeBlended(int address, quint32 value, int channelCount, Univer
     for (int i = 0; i < channelCount; i++)
         currentValue = (currentValue << 8) + uchar(m_preGMValues->at(address + i));
 
+    if (blendValue(address, currentValue, value, pow(255.0, channelCount), blend) == false)
+        return false;
+
+    writeMultiple(address, value, channelCount);
+
+    return true;
+}
+
+bool Universe::writeBlendedHighPrecision(int address, quint32 value, Universe::BlendMode blend)
+{
+    if (m_highPrecision == false)
+        return writeBlended(address, MIN(quint32(UCHAR_MAX), (value + 0x80) >> 8), 1, blend);
+
+    if (address + 1 >= m_usedChannels)
+        m_usedChannels = address + 1;
+
+    quint32 currentValue = (quint32(uchar(m_preGMValues->at(address))) << 8) + uchar(m_preGMFractions->at(address));
+
+    if (blendValue(address, currentValue, value, 0xFF00, blend) == false)
+        return false;
+
+    value = MIN(value, quint32(0xFF00));
+
+    // preserve non HTP channels for blackout
+    if ((m_channelsMask->at(address) & HTP) == 0)
+        (*m_blackoutValues)[address] = char(value >> 8);
+
+    (*m_preGMValues)[address] = char(value >> 8);
+    (*m_preGMFractions)[address] = char(value & 0xFF);
+
+    updatePostGMValue(address);
+
+    return true;
+}
+
+void Universe::writeLayer(int address, const uchar *values, const uchar *mask, int count)
+{
+    if (address < 0 || count <= 0 || address + count > UNIVERSE_SIZE)
+        return;
+
+    if (address + count > m_usedChannels)
+        m_usedChannels = address + count;
+
+    uchar *preGM = reinterpret_cast<uchar *>(m_preGMValues->data()) + address;
+    uchar *fractions = reinterpret_cast<uchar *>(m_preGMFractions->data()) + address;
+    uchar *blackout = reinterpret_cast<uchar *>(m_blackoutValues->data()) + address;
+    const uchar *channelsMask = reinterpret_cast<const uchar *>(m_channelsMask->constData()) + address;
+
+    // Merge the layer without branches, so the compiler can vectorize it:
+    // HTP channels keep the highest value, LTP channels take the layer value,
+    // which is also preserved for blackout
+    for (int i = 0; i < count; i++)
+    {
+        uchar htp = (channelsMask[i] & HTP) ? 0xFF : 0x00;
+        uchar current = preGM[i];
+        uchar value = values[i];
+        uchar written = mask[i] & (~htp | (value >= current ? 0xFF : 0x00));
+        uchar ltp = mask[i] & ~htp;
+
+        preGM[i] = (value & written) | (current & ~written);
+        fractions[i] &= ~written;
+        blackout[i] = (value & ltp) | (blackout[i] & ~ltp);
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        if (mask[i])
+            updatePostGMValue(address + i);
+    }
+}
+
+bool Universe::blendValue(int address, quint32 currentValue, quint32 &value, quint32 maxValue, Universe::BlendMode blend)
+{
     switch (blend)
     {
         case NormalBlend:
@@ -1031,7 +1311,7 @@ bool Universe::writeBlended(int address, quint32 value, int channelCount, Univer
             {
                 qDebug() << "Current value" << currentValue << "value" << value;
                 if (currentValue)
-                    value = float(currentValue) * (float(value) / pow(255.0, channelCount));
+                    value = float(currentValue) * (float(value) / double(maxValue));
                 else
                     value = 0;
             }
@@ -1040,7 +1320,7 @@ bool Universe::writeBlended(int address, quint32 value, int channelCount, Univer
         case AdditiveBlend:
         {
             //qDebug() << "Universe write additive channel" << channel << ", value:" << currVal << "+" << value;
-            value = fmin(float(currentValue + value), pow(255.0, channelCount));
+            value = fmin(float(currentValue + value), double(maxValue));
         }
         break;
         case SubtractiveBlend:
@@ -1057,8 +1337,6 @@ bool Universe::writeBlended(int address, quint32 value, int channelCount, Univer
         break;
     }
 
-    writeMultiple(address, value, channelCount);
-
     return true;
 }
 
@@ -1094,6 +1372,19 @@ bool Universe::loadXML(QXmlStreamReader &root, int index, InputOutputMap *ioMap)
         setPassthrough(false);
     }
 
+    if (attrs.hasAttribute(KXMLQLCUniverseHighPrecision))
+    {
+        if (attrs.value(KXMLQLCUniverseHighPrecision).toString() == KXMLQLCTrue ||
+            attrs.value(KXMLQLCUniverseHighPrecision).toString() == "1")
+            setHighPrecision(true);
+        else
+            setHighPrecision(false);
+    }
+    else
+    {
+        setHighPrecision(false);
+    }
+
     while (root.readNextStartElement())
     {
         QXmlStreamAttributes pAttrs = root.attributes();
@@ -1244,6 +1535,9 @@ bool Universe::saveXML(QXmlStreamWriter *doc) const
     if (passthrough() == true)
         doc->writeAttribute(KXMLQLCUniversePassthrough, KXMLQLCTrue);
 
+    if (highPrecision() == true)
+        doc->writeAttribute(KXMLQLCUniverseHighPrecision, KXMLQLCTrue);
+
     if (inputPatch() != NULL)
     {
         savePatchXML(doc, KXMLQLCUniverseInputPatch, inputPatch()->pluginName(), inputPatch()->inputName(),
@@ -24,6 +24,7 @@
 #include <QScopedPointer>
 #include <QSemaphore>
 #include <QByteArray>
+#include <QAtomicInt>
 #include <QThread>
 #include <QSet>
 
@@ -37,6 +38,7 @@ class InputOutputMap;
 class GenericFader;
 class QLCIOPlugin;
 class GrandMaster;
+class LatencyTracer;
 class OutputPatch;
 class InputPatch;
 class Doc;
@@ -51,6 +53,7 @@ class Doc;
 #define KXMLQLCUniverseName         QStringLiteral("Name")
 #define KXMLQLCUniverseID           QStringLiteral("ID")
 #define KXMLQLCUniversePassthrough  QStringLiteral("Passthrough")
+#define KXMLQLCUniverseHighPrecision QStringLiteral("HighPrecision")
 
 #define KXMLQLCUniverseInputPatch    QStringLiteral("Input")
 #define KXMLQLCUniverseOutputPatch   QStringLiteral("Output")
@@ -72,6 +75,7 @@ class Universe : public QThread
     Q_PROPERTY(QString name READ name WRITE setName NOTIFY nameChanged)
     Q_PROPERTY(quint32 id READ id CONSTANT)
     Q_PROPERTY(bool passthrough READ passthrough WRITE setPassthrough NOTIFY passthroughChanged)
+    Q_PROPERTY(bool highPrecision READ highPrecision WRITE setHighPrecision NOTIFY highPrecisionChanged)
     Q_PROPERTY(InputPatch *inputPatch READ inputPatch NOTIFY inputPatchChanged)
     Q_PROPERTY(int outputPatchesCount READ outputPatchesCount NOTIFY outputPatchesCountChanged)
     Q_PROPERTY(bool hasFeedback READ hasFeedback NOTIFY hasFeedbackChanged)
@@ -154,6 +158,20 @@ public:
 
     uchar applyPassthrough(int channel, uchar value);
 
+    /**
+     * Enable or disable the high precision mode for this universe.
+     * In this mode, fading channels are mixed with 8 extra bits of
+     * precision and the Grand Master is applied to coarse/fine channel
+     * pairs as a whole. The extra precision is quantised to the fine
+     * channel of a pair only at output.
+     */
+    void setHighPrecision(bool enable);
+
+    /**
+     * Returns if the universe is in high precision mode
+     */
+    bool highPrecision() const;
+
 protected slots:
     /**
      * Called every time the Grand Master changed value
@@ -174,9 +192,20 @@ protected:
     uchar applyModifiers(int channel, uchar value);
     void updatePostGMValue(int channel);
 
+    /** 8 bit version of updatePostGMValue(), processing a single channel */
+    void updatePostGMValue8(int channel);
+
+    /** Apply Grand Master to a 16 bit value of a coarse/fine pair */
+    quint32 applyGM16(int channel, quint32 value);
+
+    /** High precision version of updatePostGMValue(), that processes
+     *  the coarse/fine pair the given channel belongs to */
+    void updatePostGMValue16(int channel);
+
 signals:
     void nameChanged();
     void passthroughChanged();
+    void highPrecisionChanged();
 
 protected:
     /** The universe ID */
@@ -189,6 +218,8 @@ protected:
     bool m_passthrough;
     /** Flag to monitor the universe changes */
     bool m_monitor;
+    /** Variable that determine if a universe is in high precision mode */
+    bool m_highPrecision;
 
     /************************************************************************
      * Patches
@@ -240,6 +271,10 @@ public:
 
     void flushInput();
 
+    /** Set the tracer used to measure the latency from the
+     *  input patch to the output patches (NULL for none) */
+    void setLatencyTracer(LatencyTracer *tracer);
+
 protected slots:
     /** Slot called every time an input patch sends data */
     void slotInputValueChanged(quint32 universe, quint32 channel, uchar value, const QString& key = 0);
@@ -270,6 +305,9 @@ private:
     /** Reference to the feedback patch associated to this universe. */
     OutputPatch *m_fbPatch;
 
+    /** Reference to the latency tracer shared by all the universes */
+    LatencyTracer *m_latencyTracer;
+
 private:
     // Connect to inputPatch's valueChanged signal
     void connectInputPatch();
@@ -311,6 +349,11 @@ public:
       * or NULL if none or not valid */
     ChannelModifier *channelModifier(ushort channel);
 
+    /** Inform the universe that $fine is the fine (LSB) channel of
+     *  the coarse (MSB) $channel. Use -1 to remove the association.
+     *  This is used only in high precision mode */
+    void setChannelFine(ushort channel, int fine);
+
 protected:
     /** An array of each channel's capabilities. This helps to optimize HTP/LTP/Relative checks */
     QScopedPointer<QByteArray> m_channelsMask;
@@ -323,6 +366,12 @@ protected:
      *  This is used for ranged initialization operations. */
     QScopedPointer<QByteArray> m_modifiedZeroValues;
 
+    /** For each channel, the index of its fine channel, or -1 */
+    QVector<short> m_fineChannels;
+
+    /** For each fine channel, the index of its coarse channel, or -1 */
+    QVector<short> m_coarseChannels;
+
     /************************************************************************
      * Faders
      ************************************************************************/
@@ -450,6 +499,50 @@ public:
 protected:
     void applyPassthroughValues(int address, int range);
 
+    /************************************************************************
+     * Snapshot
+     ************************************************************************/
+public:
+    /**
+     * Publish a read-only copy of the current pre and post Grand Master
+     * values. This is called by the universe writer once per tick, after
+     * all the faders have been processed.
+     */
+    void publishSnapshot();
+
+    /**
+     * Get the pre-Grand-Master value at the specified address, as it was
+     * at the end of the last tick. Unlike preGMValue(), this can be safely
+     * called from any thread, without claiming the universes and without
+     * blocking the universe writer.
+     */
+    uchar snapshotPreGMValue(int address) const;
+
+    /** Get the post-Grand-Master value at the specified address, as it was
+     *  at the end of the last tick. See snapshotPreGMValue() */
+    uchar snapshotPostGMValue(int address) const;
+
+    /** Get a copy of all the pre-Grand-Master values published
+     *  at the end of the last tick. See snapshotPreGMValue() */
+    QByteArray snapshotPreGMValues() const;
+
+    /** Get a copy of all the post-Grand-Master values published
+     *  at the end of the last tick. See snapshotPreGMValue() */
+    QByteArray snapshotPostGMValues() const;
+
+private:
+    /** Read $count bytes of the snapshot starting at $offset, retrying
+     *  if the writer is publishing a new snapshot at the same time */
+    void readSnapshot(int offset, int count, char *dest) const;
+
+private:
+    /** Sequence counter of the snapshot (seqlock). It is odd while the
+     *  writer is updating m_snapshot, even when the snapshot is stable */
+    QAtomicInt m_snapshotSequence;
+
+    /** Pre-GM values followed by the post-GM values of the last tick */
+    char m_snapshot[UNIVERSE_SIZE * 2];
+
 protected:
     /**
      * Number of channels used in this universe to optimize the dump to plugins.
@@ -491,10 +584,19 @@ protected:
     QScopedPointer<QByteArray> m_lastPostGMValues;
     /** Array of non-intensity only values */
     QScopedPointer<QByteArray> m_blackoutValues;
+    /** The used part of the postGM values handed over to the output patches.
+     *  It is reused on every tick, so it is reallocated only if a plugin
+     *  (or a queued universeWritten signal) still holds the previous frame */
+    QByteArray m_outputValues;
 
     /** Array of values from input line, when passtrhough is enabled */
     QScopedPointer<QByteArray> m_passthroughValues;
 
+    /** Array of the fractional part of the values BEFORE the Grand Master
+     *  changes. Together with m_preGMValues, this forms an array of 8.8
+     *  fixed point values, used only in high precision mode */
+    QScopedPointer<QByteArray> m_preGMFractions;
+
     /* impl speedup */
     void updateIntensityChannelsRanges();
 
@@ -568,6 +670,46 @@ public:
      */
     bool writeBlended(int address, quint32 value, int channelCount, BlendMode blend);
 
+    /**
+     * Write a single channel value with 8 bits of extra precision,
+     * with the given blend mode. When the universe is not in high
+     * precision mode, the value is rounded and written with writeBlended.
+     *
+     * @param address The DMX address to write to
+     * @param value The 8.8 fixed point value to write: the DMX value
+     *              in the upper byte and its fractional part in the lower
+     * @param blend The blend mode to be used on $value
+     *
+     * @return true if successful, otherwise false
+     */
+    bool writeBlendedHighPrecision(int address, quint32 value, BlendMode blend);
+
+    /**
+     * Write a layer of DMX values in one pass, with normal blending.
+     * Only the channels whose $mask byte is 0xFF are written, and the
+     * HTP checks are performed as in the generic write method.
+     *
+     * @param address The DMX start address of the layer
+     * @param values The values to write, one per channel
+     * @param mask 0xFF for the channels to write, 0x00 for the others
+     * @param count The number of channels of the layer
+     */
+    void writeLayer(int address, const uchar *values, const uchar *mask, int count);
+
+protected:
+    /**
+     * Blend $value over $currentValue with the given blend mode.
+     *
+     * @param address The DMX address $value belongs to, for HTP checks
+     * @param currentValue The value currently in the universe
+     * @param value The value to blend. On success, it holds the blended result
+     * @param maxValue The maximum value that $value can represent
+     * @param blend The blend mode to be used
+     *
+     * @return false if $value should not be written, otherwise true
+     */
+    bool blendValue(int address, quint32 currentValue, quint32 &value, quint32 maxValue, BlendMode blend);
+
     /*********************************************************************
      * Load & Save
      *********************************************************************/
@@ -0,0 +1,15 @@
+include(../../../variables.pri)
+include(../../../coverage.pri)
+TEMPLATE = app
+LANGUAGE = C++
+TARGET   = audiopreprocessor_test
+
+QT      += testlib
+CONFIG  -= app_bundle
+
+DEPENDPATH   += ../../audio/src
+INCLUDEPATH  += ../../audio/src
+LIBS         += -L../../audio/src -lqlcplusaudio
+
+SOURCES += audiopreprocessor_test.cpp
+HEADERS += audiopreprocessor_test.h
@@ -0,0 +1,317 @@
+/*
+  Q Light Controller Plus - Unit test
+  audiopreprocessor_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QtTest>
+#include <qmath.h>
+#include <string.h>
+
+#define private public
+#include "audiopreprocessor_test.h"
+#include "audiopreprocessor.h"
+#undef private
+
+#define EPSILON     1e-9
+
+static bool fuzzyEqual(double a, double b, double epsilon = EPSILON)
+{
+    return qAbs(a - b) < epsilon;
+}
+
+void AudioPreprocessor_Test::initial()
+{
+    AudioPreprocessor pre;
+    double output[4];
+
+    QCOMPARE(pre.frameSize(), 0);
+    QCOMPARE(pre.channels(), 1);
+    QCOMPARE(pre.hopSize(), 0);
+    QCOMPARE(pre.windowType(), AudioPreprocessor::HannWindow);
+
+    /* No format, nothing to do */
+    int16_t buffer[4] = { 1, 2, 3, 4 };
+    pre.push(buffer, 4);
+    QCOMPARE(pre.process(output), 0.0);
+}
+
+void AudioPreprocessor_Test::format()
+{
+    AudioPreprocessor pre;
+
+    /* Bounded to sane values */
+    pre.setFormat(0, 0, 0);
+    QCOMPARE(pre.frameSize(), 1);
+    QCOMPARE(pre.channels(), 1);
+    QCOMPARE(pre.hopSize(), 1);
+
+    /* The hop can't exceed the frame */
+    pre.setFormat(8, 2, 16);
+    QCOMPARE(pre.frameSize(), 8);
+    QCOMPARE(pre.channels(), 2);
+    QCOMPARE(pre.hopSize(), 8);
+
+    /* The analysis frame starts from silence */
+    int16_t buffer[4] = { 16384, 16384, 16384, 16384 };
+    pre.push(buffer, 2);
+    pre.setFormat(2048, 1, 1024);
+    QCOMPARE(pre.frameSize(), 2048);
+    QCOMPARE(pre.hopSize(), 1024);
+    QCOMPARE(pre.m_samples.size(), 2048);
+    for (int i = 0; i < 2048; i++)
+        QCOMPARE(pre.samples()[i], 0.0);
+}
+
+void AudioPreprocessor_Test::windowTypes()
+{
+    QStringList list = AudioPreprocessor::windowTypes();
+    QCOMPARE(list.size(), 4);
+    QCOMPARE(list.at(0), QString("Rectangular"));
+    QCOMPARE(list.at(1), QString("Hann"));
+    QCOMPARE(list.at(2), QString("Hamming"));
+    QCOMPARE(list.at(3), QString("Blackman"));
+
+    for (int t = AudioPreprocessor::RectangularWindow; t <= AudioPreprocessor::BlackmanWindow; t++)
+    {
+        AudioPreprocessor::WindowType type = AudioPreprocessor::WindowType(t);
+        QCOMPARE(AudioPreprocessor::stringToWindowType(AudioPreprocessor::windowTypeToString(type)), type);
+    }
+
+    /* Unknown types fall back to Hann */
+    QCOMPARE(AudioPreprocessor::stringToWindowType("Foo"), AudioPreprocessor::HannWindow);
+}
+
+void AudioPreprocessor_Test::windows()
+{
+    AudioPreprocessor pre;
+    pre.setFormat(5, 1, 5);
+
+    /* Symmetric windows, sampled at 0, 1/4, 1/2, 3/4 and 1 of their span */
+    const double rectangular[5] = { 1.0, 1.0, 1.0, 1.0, 1.0 };
+    const double hann[5] = { 0.0, 0.5, 1.0, 0.5, 0.0 };
+    const double hamming[5] = { 0.08, 0.54, 1.0, 0.54, 0.08 };
+    const double blackman[5] = { 0.0, 0.34, 1.0, 0.34, 0.0 };
+
+    pre.setWindowType(AudioPreprocessor::RectangularWindow);
+    QCOMPARE(pre.m_window.size(), 5);
+    for (int i = 0; i < 5; i++)
+        QVERIFY(fuzzyEqual(pre.m_window[i], rectangular[i]));
+
+    pre.setWindowType(AudioPreprocessor::HannWindow);
+    for (int i = 0; i < 5; i++)
+        QVERIFY(fuzzyEqual(pre.m_window[i], hann[i]));
+
+    pre.setWindowType(AudioPreprocessor::HammingWindow);
+    for (int i = 0; i < 5; i++)
+        QVERIFY(fuzzyEqual(pre.m_window[i], hamming[i]));
+
+    pre.setWindowType(AudioPreprocessor::BlackmanWindow);
+    for (int i = 0; i < 5; i++)
+        QVERIFY(fuzzyEqual(pre.m_window[i], blackman[i]));
+}
+
+void AudioPreprocessor_Test::windowPrecomputed()
+{
+    AudioPreprocessor pre;
+
+    /* Chosen before the format: nothing to compute yet */
+    pre.setWindowType(AudioPreprocessor::HammingWindow);
+    QCOMPARE(pre.windowType(), AudioPreprocessor::HammingWindow);
+    QCOMPARE(pre.m_window.size(), 0);
+
+    /* Computed for the frame size, keeping the type */
+    pre.setFormat(16, 1, 8);
+    QCOMPARE(pre.m_window.size(), 16);
+    QVERIFY(fuzzyEqual(pre.m_window[0], 0.08));
+    QVERIFY(fuzzyEqual(pre.m_window[15], 0.08));
+
+    pre.setFormat(32, 1, 8);
+    QCOMPARE(pre.m_window.size(), 32);
+    QVERIFY(fuzzyEqual(pre.m_window[31], 0.08));
+
+    /* Processing doesn't touch the table */
+    const double *window = pre.m_window.constData();
+    double output[32];
+    pre.process(output);
+    pre.process(output);
+    QVERIFY(pre.m_window.constData() == window);
+}
+
+void AudioPreprocessor_Test::mixdown()
+{
+    AudioPreprocessor pre;
+
+    /* Mono: normalized only */
+    pre.setFormat(4, 1, 4);
+    int16_t mono[4] = { 16384, -16384, 32767, 0 };
+    pre.push(mono, 4);
+    QCOMPARE(pre.samples()[0], 0.5);
+    QCOMPARE(pre.samples()[1], -0.5);
+    QCOMPARE(pre.samples()[2], 32767.0 / 32768.0);
+    QCOMPARE(pre.samples()[3], 0.0);
+
+    /* Stereo: average of the two channels */
+    pre.setFormat(4, 2, 4);
+    int16_t stereo[8] = { 16384, 16384, 16384, -16384, -32768, -32768, 8192, 0 };
+    pre.push(stereo, 4);
+    QCOMPARE(pre.samples()[0], 0.5);
+    QCOMPARE(pre.samples()[1], 0.0);
+    QCOMPARE(pre.samples()[2], -1.0);
+    QCOMPARE(pre.samples()[3], 0.125);
+
+    /* Any other number of channels */
+    pre.setFormat(2, 3, 2);
+    int16_t surround[6] = { -3000, 6000, 9000, 300, 300, 300 };
+    pre.push(surround, 2);
+    QVERIFY(fuzzyEqual(pre.samples()[0], 12000.0 / (3 * 32768.0)));
+    QVERIFY(fuzzyEqual(pre.samples()[1], 900.0 / (3 * 32768.0)));
+}
+
+void AudioPreprocessor_Test::overlappingFrames()
+{
+    AudioPreprocessor pre;
+    pre.setFormat(8, 1, 4);
+
+    /* Each hop is appended, dropping the oldest samples:
+     * consecutive frames share frameSize - hopSize samples */
+    int16_t hop[4];
+    for (int h = 0; h < 3; h++)
+    {
+        for (int i = 0; i < 4; i++)
+            hop[i] = (h * 4 + i + 1) * 1024;
+        pre.push(hop, 4);
+    }
+
+    /* Samples 5 to 12, the oldest first */
+    for (int i = 0; i < 8; i++)
+        QCOMPARE(pre.samples()[i], (i + 5) / 32.0);
+
+    /* A shorter block shifts the frame by its size only */
+    int16_t shortBlock[2] = { 13 * 1024, 14 * 1024 };
+    pre.push(shortBlock, 2);
+    for (int i = 0; i < 8; i++)
+        QCOMPARE(pre.samples()[i], (i + 7) / 32.0);
+
+    /* Nothing happens without data */
+    pre.push(NULL, 4);
+    pre.push(shortBlock, 0);
+    QCOMPARE(pre.samples()[0], 7 / 32.0);
+}
+
+void AudioPreprocessor_Test::longBlock()
+{
+    AudioPreprocessor pre;
+    pre.setFormat(4, 2, 4);
+
+    /* Only the most recent frames fit in the analysis frame */
+    int16_t block[12];
+    for (int i = 0; i < 6; i++)
+        block[i * 2] = block[i * 2 + 1] = (i + 1) * 1024;
+    pre.push(block, 6);
+
+    for (int i = 0; i < 4; i++)
+        QCOMPARE(pre.samples()[i], (i + 3) / 32.0);
+}
+
+void AudioPreprocessor_Test::process()
+{
+    AudioPreprocessor pre;
+    double output[10];
+
+    /* Rectangular window: only the DC offset is removed */
+    pre.setFormat(8, 1, 8);
+    pre.setWindowType(AudioPreprocessor::RectangularWindow);
+
+    int16_t square[8];
+    for (int i = 0; i < 8; i++)
+        square[i] = (i % 2) ? 4096 : 12288; // 0.25 +/- 0.125
+    pre.push(square, 8);
+
+    QCOMPARE(pre.process(output), 0.125);
+    for (int i = 0; i < 8; i++)
+        QCOMPARE(output[i], (i % 2) ? -0.125 : 0.125);
+
+    /* The input is left untouched */
+    QCOMPARE(pre.samples()[0], 0.375);
+
+    /* A size that is not a multiple of the accumulators,
+     * compared with a straightforward implementation */
+    pre.setFormat(10, 1, 10);
+    pre.setWindowType(AudioPreprocessor::HannWindow);
+
+    int16_t signal[10];
+    for (int i = 0; i < 10; i++)
+        signal[i] = ((i * i * 37) % 2000 - 1000) * 16;
+    pre.push(signal, 10);
+
+    double mean = 0, meanSq = 0;
+    for (int i = 0; i < 10; i++)
+    {
+        double x = signal[i] / 32768.0;
+        mean += x / 10;
+        meanSq += x * x / 10;
+    }
+
+    QVERIFY(fuzzyEqual(pre.process(output), qSqrt(meanSq - mean * mean)));
+    for (int i = 0; i < 10; i++)
+    {
+        double window = 0.5 * (1.0 - qCos(2 * M_PI * i / 9));
+        QVERIFY(fuzzyEqual(output[i], (signal[i] / 32768.0 - mean) * window));
+    }
+
+    QCOMPARE(pre.process(NULL), 0.0);
+}
+
+void AudioPreprocessor_Test::processSine()
+{
+    const int frameSize = 64;
+    const int hopSize = 16;
+    AudioPreprocessor pre;
+    pre.setFormat(frameSize, 1, hopSize);
+
+    /* A 0.5 amplitude sine over a 0.1 DC offset, with a
+     * period of one hop, so every full frame is the same */
+    int16_t hop[hopSize];
+    for (int i = 0; i < hopSize; i++)
+        hop[i] = qRound((0.1 + 0.5 * qSin(2 * M_PI * i / hopSize)) * 32768.0);
+
+    for (int h = 0; h < frameSize / hopSize; h++)
+        pre.push(hop, hopSize);
+
+    QVector<double> previous(frameSize);
+    double output[frameSize];
+
+    for (int f = 0; f < 4; f++)
+    {
+        memcpy(previous.data(), pre.samples(), frameSize * sizeof(double));
+
+        /* DC removed, RMS of the sine only */
+        double rms = pre.process(output);
+        QVERIFY(fuzzyEqual(rms, 0.5 / qSqrt(2.0), 1e-4));
+        for (int i = 0; i < frameSize; i++)
+            QVERIFY(fuzzyEqual(output[i], (pre.samples()[i] - 0.1) * pre.m_window[i], 1e-4));
+
+        /* The next frame overlaps the previous one by frameSize - hopSize */
+        pre.push(hop, hopSize);
+        for (int i = 0; i < frameSize - hopSize; i++)
+            QCOMPARE(pre.samples()[i], previous[i + hopSize]);
+        for (int i = 0; i < hopSize; i++)
+            QCOMPARE(pre.samples()[frameSize - hopSize + i], hop[i] / 32768.0);
+    }
+}
+
+QTEST_APPLESS_MAIN(AudioPreprocessor_Test)
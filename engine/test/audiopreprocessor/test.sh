@@ -0,0 +1,2 @@
+#!/bin/bash
+./audiopreprocessor_test
@@ -0,0 +1,26 @@
+include(../../../variables.pri)
+include(../../../coverage.pri)
+TEMPLATE = app
+LANGUAGE = C++
+TARGET   = audiospectrumbus_test
+
+QT      += testlib
+CONFIG  -= app_bundle
+
+DEPENDPATH   += ../../audio/src
+INCLUDEPATH  += ../../../plugins/interfaces
+INCLUDEPATH  += ../../audio/src
+INCLUDEPATH  += ../../src
+LIBS         += -L../../audio/src -lqlcplusaudio
+
+!android:!ios {
+  system(pkg-config --exists fftw3) {
+    DEFINES += HAS_FFTW3
+    CONFIG += link_pkgconfig
+    PKGCONFIG += fftw3
+    macx:LIBS += -lfftw3
+  }
+}
+
+SOURCES += audiospectrumbus_test.cpp
+HEADERS += audiospectrumbus_test.h
@@ -0,0 +1,419 @@
+/*
+  Q Light Controller Plus - Unit test
+  audiospectrumbus_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QtTest>
+#include <qmath.h>
+
+#define private public
+#include "audiospectrumbus_test.h"
+#include "audiospectrumbus.h"
+#include "audiocapture.h"
+#undef private
+
+#define M_2PI       6.28318530718           /* 2*pi */
+
+/****************************************************************************
+ * AudioCapture stub, capturing a generated sine wave
+ ****************************************************************************/
+
+class AudioCaptureStub final : public AudioCapture
+{
+public:
+    /** Generate a sine of $amplitude (full scale is 1.0), centered
+     *  on the FFT bin $bin, on all the captured channels */
+    AudioCaptureStub(int bin, double amplitude)
+        : AudioCapture()
+        , m_amplitude(amplitude)
+        , m_sampleIndex(0)
+    {
+        m_frequency = double(bin) * m_sampleRate / m_bufferSize;
+    }
+
+    ~AudioCaptureStub()
+    {
+        stop();
+    }
+
+    int busConsumers() const
+    {
+        return m_busConsumers;
+    }
+
+    void setVolume(qreal volume) override
+    {
+        Q_UNUSED(volume);
+    }
+
+    QAtomicInt m_initialized;
+    QAtomicInt m_uninitialized;
+
+protected:
+    bool initialize() override
+    {
+        m_initialized.ref();
+        return true;
+    }
+
+    void uninitialize() override
+    {
+        m_uninitialized.ref();
+    }
+
+    void suspend() override { }
+    void resume() override { }
+
+    qint64 latency() override
+    {
+        return 0;
+    }
+
+    bool readAudio(int maxSize) override
+    {
+        int frames = maxSize / m_channels;
+
+        for (int i = 0; i < frames; i++, m_sampleIndex++)
+        {
+            double phase = (M_2PI * m_frequency * m_sampleIndex) / m_sampleRate;
+            int16_t value = qRound(m_amplitude * 32767.0 * qSin(phase));
+            for (unsigned int c = 0; c < m_channels; c++)
+                m_audioBuffer[i * m_channels + c] = value;
+        }
+
+        // pace the capture like a sound card would do
+        QThread::msleep(2);
+        return true;
+    }
+
+private:
+    double m_frequency;
+    double m_amplitude;
+    qint64 m_sampleIndex;
+};
+
+/****************************************************************************
+ * Writer thread filling every frame with a single value
+ ****************************************************************************/
+
+class BusWriter final : public QThread
+{
+public:
+    BusWriter(AudioSpectrumBus *bus, int frames)
+        : m_bus(bus)
+        , m_frames(frames)
+    {
+    }
+
+protected:
+    void run() override
+    {
+        for (int f = 1; f <= m_frames; f++)
+        {
+            AudioSpectrumFrame *frame = m_bus->beginWrite();
+            frame->rms = f;
+            frame->binsCount = AUDIO_SPECTRUM_MAX_BINS;
+            for (int i = 0; i < AUDIO_SPECTRUM_MAX_BINS; i++)
+                frame->magnitudes[i] = f;
+            m_bus->endWrite();
+        }
+    }
+
+private:
+    AudioSpectrumBus *m_bus;
+    int m_frames;
+};
+
+/****************************************************************************
+ * AudioSpectrumBus
+ ****************************************************************************/
+
+void AudioSpectrumBus_Test::initial()
+{
+    AudioSpectrumBus bus;
+    AudioSpectrumFrame frame;
+
+    QCOMPARE(bus.latestSequence(), quint32(0));
+    QVERIFY(bus.read(frame) == false);
+}
+
+void AudioSpectrumBus_Test::readWrite()
+{
+    AudioSpectrumBus bus;
+    AudioSpectrumFrame frame;
+
+    AudioSpectrumFrame *written = bus.beginWrite();
+    QVERIFY(written != NULL);
+    written->timestamp = 1234;
+    written->rms = 0.25;
+    written->beat = true;
+    written->binsCount = 4;
+    for (int i = 0; i < 4; i++)
+        written->magnitudes[i] = i + 1;
+
+    /* Nothing is visible until the frame is published */
+    QCOMPARE(bus.latestSequence(), quint32(0));
+    QVERIFY(bus.read(frame) == false);
+
+    bus.endWrite();
+    QCOMPARE(bus.latestSequence(), quint32(1));
+
+    QVERIFY(bus.read(frame) == true);
+    QCOMPARE(frame.sequence, quint32(1));
+    QCOMPARE(frame.timestamp, qint64(1234));
+    QCOMPARE(frame.rms, 0.25);
+    QCOMPARE(frame.beat, true);
+    QCOMPARE(frame.binsCount, 4);
+    for (int i = 0; i < 4; i++)
+        QCOMPARE(frame.magnitudes[i], double(i + 1));
+}
+
+void AudioSpectrumBus_Test::latestFrame()
+{
+    AudioSpectrumBus bus;
+    AudioSpectrumFrame frame;
+
+    for (int f = 1; f <= 5; f++)
+    {
+        AudioSpectrumFrame *written = bus.beginWrite();
+        written->rms = f;
+        written->binsCount = 0;
+        bus.endWrite();
+    }
+
+    QCOMPARE(bus.latestSequence(), quint32(5));
+    QVERIFY(bus.read(frame) == true);
+    QCOMPARE(frame.sequence, quint32(5));
+    QCOMPARE(frame.rms, 5.0);
+
+    /* The frame being written is never the published one,
+     * so readers keep getting the previous frame meanwhile */
+    AudioSpectrumFrame *written = bus.beginWrite();
+    QVERIFY(written != &bus.m_frames[bus.m_latest.loadAcquire()]);
+    written->rms = 6;
+    written->binsCount = 0;
+
+    QVERIFY(bus.read(frame) == true);
+    QCOMPARE(frame.sequence, quint32(5));
+    QCOMPARE(frame.rms, 5.0);
+
+    bus.endWrite();
+    QVERIFY(bus.read(frame) == true);
+    QCOMPARE(frame.sequence, quint32(6));
+    QCOMPARE(frame.rms, 6.0);
+}
+
+void AudioSpectrumBus_Test::binsCountBound()
+{
+    AudioSpectrumBus bus;
+    AudioSpectrumFrame frame;
+
+    AudioSpectrumFrame *written = bus.beginWrite();
+    written->binsCount = AUDIO_SPECTRUM_MAX_BINS + 10;
+    bus.endWrite();
+
+    QVERIFY(bus.read(frame) == true);
+    QCOMPARE(frame.binsCount, AUDIO_SPECTRUM_MAX_BINS);
+
+    written = bus.beginWrite();
+    written->binsCount = -1;
+    bus.endWrite();
+
+    QVERIFY(bus.read(frame) == true);
+    QCOMPARE(frame.binsCount, 0);
+}
+
+void AudioSpectrumBus_Test::concurrentRead()
+{
+    AudioSpectrumBus bus;
+    AudioSpectrumFrame frame;
+    BusWriter writer(&bus, 20000);
+    quint32 lastSequence = 0;
+
+    writer.start();
+
+    /* A frame is never read while half written */
+    while (writer.isRunning() || lastSequence < bus.latestSequence())
+    {
+        if (bus.read(frame) == false)
+            continue;
+
+        QVERIFY(frame.sequence >= lastSequence);
+        QCOMPARE(frame.binsCount, AUDIO_SPECTRUM_MAX_BINS);
+        QCOMPARE(frame.rms, double(frame.sequence));
+        for (int i = 0; i < frame.binsCount; i++)
+            QCOMPARE(frame.magnitudes[i], frame.rms);
+
+        lastSequence = frame.sequence;
+    }
+
+    writer.wait();
+    QCOMPARE(lastSequence, quint32(20000));
+}
+
+void AudioSpectrumBus_Test::bands()
+{
+    AudioSpectrumFrame frame;
+    double bands[4];
+
+    frame.binsCount = 8;
+    for (int i = 0; i < 8; i++)
+        frame.magnitudes[i] = M_2PI * (i < 2 ? 2 : 1);
+
+    /* Two bins per band, averaged and scaled by 2*pi */
+    QCOMPARE(AudioSpectrumBus::bands(frame, 4, bands), 2.0);
+    QCOMPARE(bands[0], 2.0);
+    QCOMPARE(bands[1], 1.0);
+    QCOMPARE(bands[2], 1.0);
+    QCOMPARE(bands[3], 1.0);
+
+    QCOMPARE(AudioSpectrumBus::power(bands, 4), quint32(32768 * 5.0 * qSqrt(M_2PI) / 4.0));
+
+    /* Invalid numbers of bands */
+    QCOMPARE(AudioSpectrumBus::bands(frame, 0, bands), 0.0);
+    QCOMPARE(AudioSpectrumBus::power(bands, 0), quint32(0));
+
+    /* More bands than bins: empty bands */
+    double many[16];
+    QCOMPARE(AudioSpectrumBus::bands(frame, 16, many), 0.0);
+    for (int b = 0; b < 16; b++)
+        QCOMPARE(many[b], 0.0);
+}
+
+/****************************************************************************
+ * Consumers
+ ****************************************************************************/
+
+void AudioSpectrumBus_Test::registerConsumer()
+{
+    AudioCaptureStub capture(32, 0.5);
+
+    QVERIFY(capture.isRunning() == false);
+    QCOMPARE(capture.busConsumers(), 0);
+    QCOMPARE(capture.spectrumBus()->latestSequence(), quint32(0));
+
+    /* The first consumer starts the capture */
+    capture.registerBusConsumer();
+    QCOMPARE(capture.busConsumers(), 1);
+    QVERIFY(capture.isRunning() == true);
+    QTRY_VERIFY(capture.spectrumBus()->latestSequence() > 0);
+    QCOMPARE(capture.m_initialized.loadAcquire(), 1);
+
+    /* Another consumer shares the same capture */
+    capture.registerBusConsumer();
+    QCOMPARE(capture.busConsumers(), 2);
+    QCOMPARE(capture.m_initialized.loadAcquire(), 1);
+
+    capture.unregisterBusConsumer();
+    QCOMPARE(capture.busConsumers(), 1);
+    QVERIFY(capture.isRunning() == true);
+    QCOMPARE(capture.m_uninitialized.loadAcquire(), 0);
+
+    /* The last one stops it, and nothing is published anymore */
+    capture.unregisterBusConsumer();
+    QCOMPARE(capture.busConsumers(), 0);
+    QVERIFY(capture.isRunning() == false);
+    QCOMPARE(capture.m_uninitialized.loadAcquire(), 1);
+
+    quint32 sequence = capture.spectrumBus()->latestSequence();
+    QTest::qWait(50);
+    QCOMPARE(capture.spectrumBus()->latestSequence(), sequence);
+
+    /* Unbalanced calls are ignored */
+    capture.unregisterBusConsumer();
+    QCOMPARE(capture.busConsumers(), 0);
+
+    /* The bus keeps counting when capture starts again */
+    capture.registerBusConsumer();
+    QTRY_VERIFY(capture.spectrumBus()->latestSequence() > sequence);
+    QCOMPARE(capture.m_initialized.loadAcquire(), 2);
+    capture.unregisterBusConsumer();
+    QVERIFY(capture.isRunning() == false);
+}
+
+void AudioSpectrumBus_Test::consumerAndBands()
+{
+    AudioCaptureStub capture(32, 0.5);
+
+    capture.registerBandsNumber(16);
+    QVERIFY(capture.isRunning() == true);
+
+    /* Capture was started by the bands, not again by the consumer */
+    capture.registerBusConsumer();
+    QCOMPARE(capture.busConsumers(), 1);
+    QTRY_COMPARE(capture.m_initialized.loadAcquire(), 1);
+
+    /* Bands are still registered */
+    capture.unregisterBusConsumer();
+    QCOMPARE(capture.busConsumers(), 0);
+    QVERIFY(capture.isRunning() == true);
+
+    capture.registerBusConsumer();
+    capture.unregisterBandsNumber(16);
+    QVERIFY(capture.isRunning() == true);
+
+    capture.unregisterBusConsumer();
+    QVERIFY(capture.isRunning() == false);
+    QCOMPARE(capture.m_initialized.loadAcquire(), 1);
+    QCOMPARE(capture.m_uninitialized.loadAcquire(), 1);
+}
+
+void AudioSpectrumBus_Test::knownSignal()
+{
+    AudioCaptureStub capture(32, 0.5);
+    AudioSpectrumFrame frame;
+
+    capture.registerBusConsumer();
+
+    /* Wait for the analysis frame to be filled with the sine */
+    int hops = capture.m_bufferSize / capture.m_hopSize;
+    QTRY_VERIFY(capture.spectrumBus()->latestSequence() > quint32(hops));
+
+    QVERIFY(capture.spectrumBus()->read(frame) == true);
+    QVERIFY(frame.sequence > quint32(hops));
+    QVERIFY(frame.timestamp > 0);
+
+    /* RMS of a sine is its amplitude / sqrt(2) */
+    QVERIFY(qAbs(frame.rms - 0.5 / qSqrt(2.0)) < 0.005);
+
+#ifdef HAS_FFTW3
+    int binsCount = (capture.m_bufferSize * AudioCapture::maxFrequency()) / capture.m_sampleRate;
+    QCOMPARE(frame.binsCount, qMin(binsCount, qMin(int(capture.m_bufferSize) - 1, AUDIO_SPECTRUM_MAX_BINS)));
+
+    /* The peak is on bin 32, published from the first bin above DC */
+    int peak = 0;
+    for (int i = 1; i < frame.binsCount; i++)
+    {
+        if (frame.magnitudes[i] > frame.magnitudes[peak])
+            peak = i;
+    }
+    QCOMPARE(peak, 31);
+
+    /* The same frame gives any number of bands */
+    double bands[8];
+    int subBandWidth = frame.binsCount / 8;
+    double maxMagnitude = AudioSpectrumBus::bands(frame, 8, bands);
+    QCOMPARE(maxMagnitude, bands[31 / subBandWidth]);
+    QVERIFY(AudioSpectrumBus::power(bands, 8) > 0);
+#else
+    QCOMPARE(frame.binsCount, 0);
+#endif
+
+    capture.unregisterBusConsumer();
+}
+
+QTEST_MAIN(AudioSpectrumBus_Test)
@@ -0,0 +1,313 @@
+/*
+  Q Light Controller Plus - Test Unit
+  beatclock_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QtTest>
+
+#define private public
+#include "beatclock.h"
+#undef private
+
+#include "beatclock_test.h"
+
+/* 120 BPM */
+#define PERIOD  qint64(500000000)
+
+void BeatClock_Test::initial()
+{
+    BeatClock clock;
+    QCOMPARE(clock.bpm(), 0.0);
+    QCOMPARE(clock.position(0), 0.0);
+    QCOMPARE(clock.position(10 * PERIOD), 0.0);
+    QCOMPARE(clock.confidence(0), 0.0);
+    QCOMPARE(clock.beatsPerBar(), 4);
+    QVERIFY(clock.now() >= 0);
+}
+
+void BeatClock_Test::tempo()
+{
+    BeatClock clock;
+    clock.setTempo(120, 0);
+
+    QCOMPARE(clock.bpm(), 120.0);
+    QCOMPARE(clock.confidence(0), 1.0);
+    QCOMPARE(clock.position(0), 0.0);
+    QCOMPARE(clock.position(PERIOD / 2), 0.5);
+    QCOMPARE(clock.position(PERIOD), 1.0);
+    QCOMPARE(clock.position(10 * PERIOD), 10.0);
+
+    // an internal tempo doesn't lose confidence
+    QCOMPARE(clock.confidence(100 * PERIOD), 1.0);
+
+    clock.setTempo(0, 10 * PERIOD);
+    QCOMPARE(clock.bpm(), 0.0);
+    QCOMPARE(clock.position(20 * PERIOD), 10.0);
+}
+
+void BeatClock_Test::tempoKeepsPhase()
+{
+    BeatClock clock;
+    clock.setTempo(120, 0);
+
+    // halve the tempo in the middle of the third beat
+    clock.setTempo(60, PERIOD * 5 / 2);
+    QCOMPARE(clock.position(PERIOD * 5 / 2), 2.5);
+    QCOMPARE(clock.position(PERIOD * 7 / 2), 3.0);
+    QCOMPARE(clock.position(PERIOD * 11 / 2), 4.0);
+}
+
+void BeatClock_Test::lock()
+{
+    BeatClock clock;
+
+    // the first beat moves to the next beat and waits there
+    clock.beatReceived(PERIOD);
+    QCOMPARE(clock.bpm(), 0.0);
+    QCOMPARE(clock.m_rate, 0.0);
+    QCOMPARE(clock.position(PERIOD), 1.0);
+    QCOMPARE(clock.position(PERIOD * 3 / 2), 1.0);
+
+    // the second one gives the tempo and starts the clock
+    clock.beatReceived(2 * PERIOD);
+    QCOMPARE(clock.bpm(), 120.0);
+    QCOMPARE(clock.position(2 * PERIOD), 2.0);
+    QCOMPARE(clock.position(PERIOD * 5 / 2), 2.5);
+    QCOMPARE(clock.position(3 * PERIOD), 3.0);
+
+    // beats on time don't change anything
+    for (int i = 3; i < 10; i++)
+        clock.beatReceived(i * PERIOD);
+
+    QCOMPARE(clock.bpm(), 120.0);
+    QCOMPARE(clock.position(10 * PERIOD), 10.0);
+    QVERIFY(clock.confidence(10 * PERIOD) > 0.8);
+}
+
+void BeatClock_Test::phaseConvergence()
+{
+    BeatClock clock;
+    clock.setTempo(120, 0);
+
+    // an external source with the same tempo, but 100ms late
+    qint64 offset = PERIOD / 5;
+    double lastError = 1.0;
+
+    for (int i = 1; i < 12; i++)
+    {
+        qint64 time = i * PERIOD + offset;
+        double position = clock.position(time);
+        double error = qAbs(position - qRound(position));
+
+        // the error decreases at each beat, without the position jumping
+        QVERIFY(error < lastError || error < 0.001);
+        lastError = error;
+
+        clock.beatReceived(time);
+        QCOMPARE(clock.position(time), position);
+    }
+
+    QVERIFY(lastError < 0.01);
+    QVERIFY(qAbs(clock.bpm() - 120.0) < 0.1);
+}
+
+void BeatClock_Test::jitter()
+{
+    BeatClock clock;
+
+    // beats at 120 BPM with a +/-10ms jitter
+    const qint64 jitter[] = { 10, -7, 3, -10, 8, -2, 6, -9, 1, 5, -4, 9, -6, 2, -8, 7 };
+    const int count = sizeof(jitter) / sizeof(jitter[0]);
+
+    for (int i = 0; i < count; i++)
+        clock.beatReceived(i * PERIOD + jitter[i] * 1000000);
+
+    QVERIFY(qAbs(clock.bpm() - 120.0) < 2.0);
+
+    // the beats predicted by the clock are closer to the real
+    // beats than the beats received
+    qint64 time = count * PERIOD;
+    double position = clock.position(time);
+    QVERIFY(qAbs(position - qRound(position)) < 0.02);
+}
+
+void BeatClock_Test::flywheel()
+{
+    BeatClock clock;
+
+    for (int i = 1; i <= 8; i++)
+        clock.beatReceived(i * PERIOD);
+
+    double confidence = clock.confidence(8 * PERIOD);
+    QVERIFY(confidence > 0.5);
+
+    // the source stops: the clock keeps running at the last tempo
+    QCOMPARE(clock.position(12 * PERIOD), 12.0);
+    QCOMPARE(clock.position(PERIOD * 25 / 2), 12.5);
+
+    // missing a couple of beats is fine, then the confidence decreases
+    QCOMPARE(clock.confidence(10 * PERIOD), confidence);
+    QVERIFY(qAbs(clock.confidence(11 * PERIOD) - confidence / 2) < 0.0001);
+    QVERIFY(clock.confidence(20 * PERIOD) < 0.001);
+}
+
+void BeatClock_Test::relock()
+{
+    BeatClock clock;
+
+    for (int i = 1; i <= 8; i++)
+        clock.beatReceived(i * PERIOD);
+    QCOMPARE(clock.bpm(), 120.0);
+
+    // a single interval far from the tempo is a missed beat
+    qint64 time = 10 * PERIOD;
+    clock.beatReceived(time);
+    QCOMPARE(clock.bpm(), 120.0);
+    QVERIFY(clock.m_pendingInterval > 0);
+
+    // a beat back on tempo cancels the pending interval
+    time += PERIOD;
+    clock.beatReceived(time);
+    QCOMPARE(clock.bpm(), 120.0);
+    QCOMPARE(clock.m_pendingInterval, qint64(0));
+
+    // the source switches to 90 BPM: two intervals confirm it
+    qint64 period = 60000000000LL / 90;
+    time += period;
+    clock.beatReceived(time);
+    QCOMPARE(clock.bpm(), 120.0);
+
+    time += period;
+    clock.beatReceived(time);
+    QVERIFY(qAbs(clock.bpm() - 90.0) < 0.01);
+}
+
+void BeatClock_Test::outOfRange()
+{
+    BeatClock clock;
+
+    // intervals out of the tempo range never give a tempo
+    clock.beatReceived(0);
+    clock.beatReceived(PERIOD / 100);
+    QCOMPARE(clock.bpm(), 0.0);
+
+    clock.beatReceived(PERIOD * 100);
+    QCOMPARE(clock.bpm(), 0.0);
+
+    // but the beats are still counted
+    QCOMPARE(clock.position(PERIOD * 100), 3.0);
+}
+
+void BeatClock_Test::externalTempo()
+{
+    BeatClock clock;
+
+    // tempos out of range are ignored
+    clock.tempoReceived(10, 0);
+    QCOMPARE(clock.bpm(), 0.0);
+
+    // a tempo alone doesn't start the clock
+    clock.tempoReceived(120, 0);
+    QCOMPARE(clock.bpm(), 120.0);
+    QCOMPARE(clock.position(PERIOD), 0.0);
+
+    // the first beat does, from the next integer
+    clock.beatReceived(PERIOD);
+    QCOMPARE(clock.position(PERIOD), 1.0);
+    QCOMPARE(clock.position(2 * PERIOD), 2.0);
+
+    // a new tempo keeps the position
+    clock.tempoReceived(60, PERIOD * 5 / 2);
+    QCOMPARE(clock.bpm(), 60.0);
+    QCOMPARE(clock.position(PERIOD * 5 / 2), 2.5);
+    QCOMPARE(clock.position(PERIOD * 7 / 2), 3.0);
+}
+
+void BeatClock_Test::reset()
+{
+    BeatClock clock;
+
+    for (int i = 1; i <= 4; i++)
+        clock.beatReceived(i * PERIOD);
+
+    clock.reset(PERIOD * 9 / 2);
+    QCOMPARE(clock.bpm(), 0.0);
+    QCOMPARE(clock.confidence(PERIOD * 9 / 2), 0.0);
+
+    // the position is kept, and doesn't move anymore
+    QCOMPARE(clock.position(PERIOD * 9 / 2), 4.5);
+    QCOMPARE(clock.position(10 * PERIOD), 4.5);
+
+    // the next beat starts from the next integer
+    clock.beatReceived(10 * PERIOD);
+    QCOMPARE(clock.position(10 * PERIOD), 5.0);
+}
+
+void BeatClock_Test::bar()
+{
+    BeatClock clock;
+    QCOMPARE(clock.barPosition(0), 0.0);
+    QCOMPARE(clock.barPosition(2.5), 2.5);
+    QCOMPARE(clock.barPosition(4.0), 0.0);
+    QCOMPARE(clock.barPosition(9.25), 1.25);
+
+    clock.setBeatsPerBar(3);
+    QCOMPARE(clock.beatsPerBar(), 3);
+    QCOMPARE(clock.barPosition(9.25), 0.25);
+
+    clock.setBeatsPerBar(0);
+    QCOMPARE(clock.beatsPerBar(), 1);
+    QCOMPARE(clock.barPosition(9.25), 0.25);
+}
+
+void BeatClock_Test::barAlignment()
+{
+    BeatClock clock;
+
+    for (int i = 1; i <= 4; i++)
+        clock.beatReceived(i * PERIOD);
+
+    // the source restarts its transport in the middle of a beat
+    clock.reset(PERIOD * 9 / 2);
+    clock.tempoReceived(120, PERIOD * 9 / 2);
+
+    // its beat 0 starts a bar, whatever the position
+    clock.beatReceived(10 * PERIOD);
+    clock.alignBar(0, 10 * PERIOD);
+    QCOMPARE(clock.position(10 * PERIOD), 5.0);
+    QCOMPARE(clock.barPosition(5.0), 0.0);
+    QCOMPARE(clock.barPosition(6.5), 1.5);
+    QCOMPARE(clock.barPosition(9.0), 0.0);
+
+    // the following beats agree with it
+    clock.beatReceived(11 * PERIOD);
+    clock.alignBar(1, 11 * PERIOD);
+    QCOMPARE(clock.barPosition(6.0), 1.0);
+
+    // a jump of the source moves the bars, not the position
+    clock.beatReceived(12 * PERIOD);
+    clock.alignBar(10, 12 * PERIOD);
+    QCOMPARE(clock.position(12 * PERIOD), 7.0);
+    QCOMPARE(clock.barPosition(7.0), 2.0);
+    QCOMPARE(clock.barPosition(9.0), 0.0);
+
+    // a beat without a number doesn't
+    clock.alignBar(-1, 13 * PERIOD);
+    QCOMPARE(clock.barPosition(9.0), 0.0);
+}
+
+QTEST_APPLESS_MAIN(BeatClock_Test)
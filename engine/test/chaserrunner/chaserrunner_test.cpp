@@ -1308,6 +1308,103 @@ void ChaserRunner_Test::writeNoAutoStep()
     }
 }
 
+void ChaserRunner_Test::writePreparedStep()
+{
+    m_chaser->setDirection(Function::Forward);
+    m_chaser->setRunOrder(Function::Loop);
+
+    uint dur = MasterTimer::tick() * 5;
+    m_chaser->setDuration(dur);
+
+    ChaserRunner cr(m_doc, m_chaser);
+    MasterTimer timer(m_doc);
+
+    // Nothing is prepared in the same tick a step starts
+    QVERIFY(cr.write(&timer, QList<Universe*>()) == true);
+    timer.timerTick();
+    QVERIFY(cr.m_preparedStep == NULL);
+    QCOMPARE(m_scene2->m_resolvedValuesValid, false);
+
+    // The next step is prepared while the current one is running
+    QVERIFY(cr.write(&timer, QList<Universe*>()) == true);
+    timer.timerTick();
+    QVERIFY(cr.m_preparedStep != NULL);
+    QCOMPARE(cr.m_preparedStep->m_index, 1);
+    QCOMPARE(cr.m_preparedStep->m_function, m_scene2);
+    QCOMPARE(m_scene2->m_resolvedValuesValid, true);
+
+    ChaserRunnerStep *prepared = cr.m_preparedStep;
+
+    for (uint i = 2 * MasterTimer::tick(); i < dur; i += MasterTimer::tick())
+    {
+        QVERIFY(cr.write(&timer, QList<Universe*>()) == true);
+        timer.timerTick();
+        QCOMPARE(timer.m_functionList[0], m_scene1);
+        QCOMPARE(cr.m_preparedStep, prepared);
+    }
+
+    // The prepared step is the one started
+    QVERIFY(cr.write(&timer, QList<Universe*>()) == true);
+    timer.timerTick();
+    QCOMPARE(timer.m_functionList.size(), 1);
+    QCOMPARE(timer.m_functionList[0], m_scene2);
+    QCOMPARE(cr.currentRunningStep(), prepared);
+    QCOMPARE(cr.currentRunningStep()->m_duration, dur);
+    QVERIFY(cr.m_preparedStep == NULL);
+
+    QVERIFY(cr.write(&timer, QList<Universe*>()) == true);
+    timer.timerTick();
+    QVERIFY(cr.m_preparedStep != NULL);
+    QCOMPARE(cr.m_preparedStep->m_function, m_scene3);
+
+    // Editing the Chaser discards the prepared step
+    cr.slotChaserChanged();
+    QVERIFY(cr.m_preparedStep == NULL);
+
+    QVERIFY(cr.write(&timer, QList<Universe*>()) == true);
+    timer.timerTick();
+    QVERIFY(cr.m_preparedStep != NULL);
+    QCOMPARE(cr.m_preparedStep->m_function, m_scene3);
+}
+
+void ChaserRunner_Test::writeBeatsLocked()
+{
+    m_chaser->setDirection(Function::Forward);
+    m_chaser->setRunOrder(Function::Loop);
+    m_chaser->setTempoType(Function::Beats);
+    m_chaser->setDuration(1000); // 1 beat
+
+    ChaserRunner cr(m_doc, m_chaser);
+    MasterTimer timer(m_doc);
+    Scene *scenes[3] = { m_scene1, m_scene2, m_scene3 };
+
+    // At 128 BPM a tick is not a whole number of beat thousandths,
+    // so any rounding carried from tick to tick would move the steps
+    const quint64 bpm = 128;
+    quint64 beat = 0;
+
+    for (quint64 t = 0; beat < 200; t++)
+    {
+        // the beat position is t * tick * bpm / 60000
+        quint64 position = t * MasterTimer::tick() * bpm;
+        timer.m_beatPosition = double(position) / 60000.0;
+
+        QVERIFY(cr.write(&timer, QList<Universe*>()) == true);
+        timer.timerTick();
+
+        // a step starts on the first tick at or after its beat
+        if (position / 60000 != beat)
+        {
+            beat = position / 60000;
+            QCOMPARE(cr.currentRunningStep()->m_beatStart, double(beat));
+        }
+
+        QCOMPARE(cr.currentRunningStep()->m_index, int(beat % 3));
+        QCOMPARE(timer.m_functionList.size(), 1);
+        QCOMPARE(timer.m_functionList[0], scenes[beat % 3]);
+    }
+}
+
 void ChaserRunner_Test::adjustIntensity()
 {
     m_chaser->setDirection(Function::Forward);
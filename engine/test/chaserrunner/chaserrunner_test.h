@@ -65,6 +65,8 @@ private slots:
     void writeForwardPingPongFive();
     void writeBackwardPingPongFive();
     void writeNoAutoStep();
+    void writePreparedStep();
+    void writeBeatsLocked();
 
     void adjustIntensity();
 
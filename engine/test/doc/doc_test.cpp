@@ -35,6 +35,7 @@
 #include "collection.h"
 #include "qlcchannel.h"
 #include "sequence.h"
+#include "universe.h"
 #include "qlcfile.h"
 #include "fixture.h"
 #include "chaser.h"
@@ -447,6 +448,104 @@ void Doc_Test::fixture()
     QVERIFY(f4->forcedLTPChannels().count() == 1);
 }
 
+void Doc_Test::fixturesInUniverse()
+{
+    Fixture *f1 = new Fixture(m_doc);
+    f1->setChannels(5);
+    f1->setAddress(20);
+    f1->setUniverse(0);
+    m_doc->addFixture(f1);
+
+    Fixture *f2 = new Fixture(m_doc);
+    f2->setChannels(5);
+    f2->setAddress(0);
+    f2->setUniverse(0);
+    m_doc->addFixture(f2);
+
+    Fixture *f3 = new Fixture(m_doc);
+    f3->setChannels(5);
+    f3->setAddress(0);
+    f3->setUniverse(1);
+    m_doc->addFixture(f3);
+
+    /* Ordered by address */
+    QCOMPARE(m_doc->fixturesInUniverse(0).count(), 2);
+    QVERIFY(m_doc->fixturesInUniverse(0).at(0) == f2);
+    QVERIFY(m_doc->fixturesInUniverse(0).at(1) == f1);
+    QCOMPARE(m_doc->fixturesInUniverse(1).count(), 1);
+    QVERIFY(m_doc->fixturesInUniverse(1).at(0) == f3);
+    QCOMPARE(m_doc->fixturesInUniverse(2).count(), 0);
+
+    /* Moving a fixture updates the index */
+    f2->setUniverse(1);
+    QCOMPARE(m_doc->fixturesInUniverse(0).count(), 1);
+    QVERIFY(m_doc->fixturesInUniverse(0).at(0) == f1);
+    QCOMPARE(m_doc->fixturesInUniverse(1).count(), 2);
+
+    /* Deleting a fixture updates the index */
+    QVERIFY(m_doc->deleteFixture(f1->id()) == true);
+    QCOMPARE(m_doc->fixturesInUniverse(0).count(), 0);
+}
+
+void Doc_Test::fineChannels()
+{
+    /* Pan, Tilt, Pan Fine, Tilt Fine */
+    QLCFixtureDef *def = new QLCFixtureDef();
+    def->setManufacturer("Test");
+    def->setModel("Non adjacent fine channels");
+
+    QLCChannel::Group groups[] = { QLCChannel::Pan, QLCChannel::Tilt, QLCChannel::Pan, QLCChannel::Tilt };
+    QLCChannel::ControlByte bytes[] = { QLCChannel::MSB, QLCChannel::MSB, QLCChannel::LSB, QLCChannel::LSB };
+
+    QLCFixtureMode *mode = new QLCFixtureMode(def);
+    for (int i = 0; i < 4; i++)
+    {
+        QLCChannel *ch = new QLCChannel();
+        ch->setName(QString("Channel %1").arg(i));
+        ch->setGroup(groups[i]);
+        ch->setControlByte(bytes[i]);
+        def->addChannel(ch);
+        mode->insertChannel(ch, i);
+    }
+    def->addMode(mode);
+
+    /* The first fixture is in the middle of a universe, the second one
+     * has Tilt and Tilt Fine split across two universes */
+    Fixture *f1 = new Fixture(m_doc);
+    f1->setFixtureDefinition(def, mode);
+    mode->cacheHeads();
+    f1->setAddress(10);
+    f1->setUniverse(0);
+    QVERIFY(m_doc->addFixture(f1) == true);
+
+    Fixture *f2 = new Fixture(m_doc);
+    f2->setFixtureDefinition(def, mode);
+    f2->setAddress(509);
+    f2->setUniverse(0);
+    QVERIFY(m_doc->addFixture(f2, Fixture::invalidId(), true) == true);
+
+    QList<Universe*> ua = m_doc->inputOutputMap()->universes();
+    QCOMPARE(int(ua.at(0)->m_fineChannels.at(10)), 12);
+    QCOMPARE(int(ua.at(0)->m_fineChannels.at(11)), 13);
+    QCOMPARE(int(ua.at(0)->m_coarseChannels.at(12)), 10);
+    QCOMPARE(int(ua.at(0)->m_coarseChannels.at(13)), 11);
+
+    /* Pan at 509 and Pan Fine at 511 are paired, Tilt at 510
+     * and Tilt Fine at 512 (next universe) can't be */
+    QCOMPARE(int(ua.at(0)->m_fineChannels.at(509)), 511);
+    QCOMPARE(int(ua.at(0)->m_fineChannels.at(510)), -1);
+    QCOMPARE(int(ua.at(1)->m_coarseChannels.at(0)), -1);
+
+    /* Updating the channels capabilities keeps the pairs */
+    QVERIFY(m_doc->updateFixtureChannelCapabilities(f1->id(), QList<int>(), QList<int>()) == true);
+    QCOMPARE(int(ua.at(0)->m_fineChannels.at(10)), 12);
+    QCOMPARE(int(ua.at(0)->m_fineChannels.at(11)), 13);
+
+    QVERIFY(m_doc->deleteFixture(f1->id()) == true);
+    QVERIFY(m_doc->deleteFixture(f2->id()) == true);
+    delete def;
+}
+
 void Doc_Test::totalPowerConsumption()
 {
     int fuzzy = 0;
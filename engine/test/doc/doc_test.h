@@ -46,6 +46,8 @@ private slots:
     void deleteFixture();
     void replaceFixtures();
     void fixture();
+    void fixturesInUniverse();
+    void fineChannels();
     void totalPowerConsumption();
 
     void addFixtureGroup();
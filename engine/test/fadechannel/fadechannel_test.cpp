@@ -80,6 +80,45 @@ void FadeChannel_Test::comparison()
     QVERIFY((ch1 == ch3) == true);
 }
 
+void FadeChannel_Test::channels()
+{
+    Doc doc(this);
+
+    FadeChannel fc;
+    QCOMPARE(fc.channelCount(), 1);
+    QCOMPARE(fc.channel(), QLCChannel::invalid());
+
+    FadeChannel fc1(&doc, 0, 5);
+    QCOMPARE(fc1.channelCount(), 1);
+    QCOMPARE(fc1.channel(), quint32(5));
+
+    fc1.setCurrent(0x12);
+    fc1.addChannel(6);
+    QCOMPARE(fc1.channelCount(), 2);
+    QCOMPARE(fc1.channel(), quint32(5));
+    QCOMPARE(fc1.channelIndex(6), 1);
+    QCOMPARE(fc1.channelIndex(99), 0);
+    QCOMPARE(fc1.current(), quint32(0x1200));
+
+    // copies carry all the channels
+    FadeChannel fc2(fc1);
+    QCOMPARE(fc2.channelCount(), 2);
+    QCOMPARE(fc2.channelIndex(6), 1);
+
+    FadeChannel fc3;
+    fc3 = fc1;
+    QCOMPARE(fc3.channelCount(), 2);
+    QCOMPARE(fc3.channelIndex(6), 1);
+
+    // a value packs one byte per channel, no more channels can be added
+    fc1.addChannel(7);
+    fc1.addChannel(8);
+    QCOMPARE(fc1.channelCount(), FADECHANNEL_MAX_CHANNELS);
+    fc1.addChannel(9);
+    QCOMPARE(fc1.channelCount(), FADECHANNEL_MAX_CHANNELS);
+    QCOMPARE(fc1.channelIndex(9), 0);
+}
+
 void FadeChannel_Test::type()
 {
     Doc doc(this);
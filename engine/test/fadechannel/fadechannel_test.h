@@ -30,6 +30,7 @@ private slots:
     void address();
     void addressInUniverse();
     void comparison();
+    void channels();
     void type();
     void start();
     void target();
@@ -205,4 +205,57 @@ void GenericFader_Test::adjustIntensity()
     }
 }
 
+void GenericFader_Test::writeLayer()
+{
+    QList<Universe*> ua = m_doc->inputOutputMap()->universes();
+    QSharedPointer<GenericFader> fader = ua[0]->requestFader();
+
+    QByteArray mask(UNIVERSE_SIZE, char(0));
+    QByteArray intensityMask(UNIVERSE_SIZE, char(0));
+    QByteArray values(UNIVERSE_SIZE, char(0));
+
+    mask[100] = char(0xFF);
+    mask[101] = char(0xFF);
+    mask[103] = char(0xFF);
+    intensityMask[100] = char(0xFF);
+
+    values[100] = char(200);
+    values[101] = char(100);
+    values[102] = char(50);
+    values[103] = char(10);
+
+    // values without a mask are refused
+    fader->setLayerValues(values);
+    QVERIFY(fader->hasLayer() == false);
+    QCOMPARE(fader->m_layerValues.size(), 0);
+
+    fader->setLayerMask(mask, intensityMask);
+    QVERIFY(fader->hasLayer() == true);
+    QCOMPARE(fader->m_layerFirst, 100);
+    QCOMPARE(fader->m_layerCount, 4);
+
+    fader->setLayerValues(values);
+    fader->write(ua[0]);
+    QCOMPARE(uchar(ua[0]->preGMValues()[100]), uchar(200));
+    QCOMPARE(uchar(ua[0]->preGMValues()[101]), uchar(100));
+    QCOMPARE(uchar(ua[0]->preGMValues()[102]), uchar(0));
+    QCOMPARE(uchar(ua[0]->preGMValues()[103]), uchar(10));
+
+    // intensity applies only to the channels of the intensity mask
+    fader->adjustIntensity(0.5);
+    fader->write(ua[0]);
+    QCOMPARE(uchar(ua[0]->preGMValues()[100]), uchar(100));
+    QCOMPARE(uchar(ua[0]->preGMValues()[101]), uchar(100));
+
+    // the layer is removed when the fade out is complete
+    fader->adjustIntensity(1.0);
+    fader->setFadeOut(true, MasterTimer::tick() * 2);
+    fader->write(ua[0]);
+    QCOMPARE(uchar(ua[0]->preGMValues()[100]), uchar(100));
+    QVERIFY(fader->hasLayer() == true);
+    fader->write(ua[0]);
+    QVERIFY(fader->hasLayer() == false);
+    QVERIFY(fader->deleteRequested() == true);
+}
+
 QTEST_APPLESS_MAIN(GenericFader_Test)
@@ -0,0 +1,235 @@
+/*
+  Q Light Controller Plus - Test Unit
+  latencytracer_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QtTest>
+
+#define private public
+#include "latencytracer.h"
+#undef private
+
+#include "latencytracer_test.h"
+
+void LatencyTracer_Test::initial()
+{
+    LatencyTracer tracer;
+    QCOMPARE(tracer.isEnabled(), false);
+    QCOMPARE(tracer.probeUniverse(), UINT_MAX);
+    QCOMPARE(tracer.probeChannel(), UINT_MAX);
+    QCOMPARE(tracer.droppedCount(), quint32(0));
+    QVERIFY(tracer.timestamp() > 0);
+
+    for (int i = 0; i < LatencyTracer::StagesCount; i++)
+    {
+        LatencyTracer::Stage stage = LatencyTracer::Stage(i);
+        QCOMPARE(tracer.samplesCount(stage), quint32(0));
+        QCOMPARE(tracer.minimum(stage), qint64(0));
+        QCOMPARE(tracer.maximum(stage), qint64(0));
+        QCOMPARE(tracer.mean(stage), qint64(0));
+        QCOMPARE(tracer.percentile(stage, 0.99), qint64(0));
+        QCOMPARE(tracer.histogram(stage).count(), LATENCYTRACER_BUCKETS);
+    }
+}
+
+void LatencyTracer_Test::disabled()
+{
+    LatencyTracer tracer;
+    tracer.setProbe(0, 0);
+    QByteArray data(4, 0);
+
+    tracer.inputFlushed(tracer.timestamp());
+    data[0] = 1;
+    tracer.outputWritten(0, data);
+
+    QCOMPARE(tracer.m_pendingCount, 0);
+    QCOMPARE(tracer.samplesCount(LatencyTracer::InputQueue), quint32(0));
+    QCOMPARE(tracer.samplesCount(LatencyTracer::EndToEnd), quint32(0));
+}
+
+void LatencyTracer_Test::trace()
+{
+    LatencyTracer tracer;
+    tracer.setEnabled(true);
+    QCOMPARE(tracer.isEnabled(), true);
+    tracer.setProbe(0, 2);
+
+    QByteArray data(4, 0);
+
+    // values not traced are ignored
+    tracer.inputFlushed(0);
+    QCOMPARE(tracer.samplesCount(LatencyTracer::InputQueue), quint32(0));
+
+    qint64 received = tracer.timestamp();
+    tracer.inputFlushed(received);
+    tracer.inputFlushed(received);
+    QCOMPARE(tracer.samplesCount(LatencyTracer::InputQueue), quint32(2));
+    QCOMPARE(tracer.m_pendingCount, 2);
+
+    // a frame where the probe didn't change doesn't show the input effect
+    tracer.outputWritten(0, data);
+    QCOMPARE(tracer.samplesCount(LatencyTracer::EndToEnd), quint32(0));
+    QCOMPARE(tracer.m_pendingCount, 2);
+
+    QTest::qSleep(5);
+
+    qint64 before = tracer.timestamp();
+    data[2] = 100;
+    tracer.outputWritten(0, data);
+    QCOMPARE(tracer.m_pendingCount, 0);
+    QCOMPARE(tracer.samplesCount(LatencyTracer::Output), quint32(2));
+    QCOMPARE(tracer.samplesCount(LatencyTracer::EndToEnd), quint32(2));
+    QVERIFY(tracer.minimum(LatencyTracer::EndToEnd) >= before - received);
+    QVERIFY(tracer.maximum(LatencyTracer::EndToEnd) >= tracer.maximum(LatencyTracer::Output));
+    QVERIFY(tracer.mean(LatencyTracer::EndToEnd) >= 5000000);
+
+    // each event is accounted once
+    data[2] = 50;
+    tracer.outputWritten(0, data);
+    QCOMPARE(tracer.samplesCount(LatencyTracer::EndToEnd), quint32(2));
+
+    // enabling again starts from scratch
+    tracer.setEnabled(true);
+    QCOMPARE(tracer.samplesCount(LatencyTracer::InputQueue), quint32(0));
+    QCOMPARE(tracer.samplesCount(LatencyTracer::EndToEnd), quint32(0));
+
+    tracer.setEnabled(false);
+    QCOMPARE(tracer.isEnabled(), false);
+}
+
+void LatencyTracer_Test::noProbe()
+{
+    LatencyTracer tracer;
+    tracer.setEnabled(true);
+
+    QByteArray data(4, 0);
+
+    // without a probe only the input queue is measured
+    tracer.inputFlushed(tracer.timestamp());
+    QCOMPARE(tracer.samplesCount(LatencyTracer::InputQueue), quint32(1));
+    QCOMPARE(tracer.m_pendingCount, 0);
+
+    data[0] = 100;
+    tracer.outputWritten(0, data);
+    QCOMPARE(tracer.samplesCount(LatencyTracer::Output), quint32(0));
+    QCOMPARE(tracer.samplesCount(LatencyTracer::EndToEnd), quint32(0));
+
+    // a universe alone is not a probe
+    tracer.setProbe(1, UINT_MAX);
+    QCOMPARE(tracer.probeUniverse(), quint32(1));
+    QCOMPARE(tracer.probeChannel(), UINT_MAX);
+
+    tracer.inputFlushed(tracer.timestamp());
+    QCOMPARE(tracer.m_pendingCount, 0);
+    data[0] = 50;
+    tracer.outputWritten(1, data);
+    QCOMPARE(tracer.samplesCount(LatencyTracer::EndToEnd), quint32(0));
+}
+
+void LatencyTracer_Test::probeChannel()
+{
+    LatencyTracer tracer;
+    tracer.setEnabled(true);
+    tracer.setProbe(0, 2);
+    QCOMPARE(tracer.probeUniverse(), quint32(0));
+    QCOMPARE(tracer.probeChannel(), quint32(2));
+
+    QByteArray data(4, 0);
+    data[2] = 10;
+
+    // the probe value is followed with nothing pending too
+    tracer.outputWritten(0, data);
+    QCOMPARE(tracer.m_probeValue, uchar(10));
+
+    tracer.inputFlushed(tracer.timestamp());
+
+    // another channel changing is not enough
+    data[1] = 100;
+    tracer.outputWritten(0, data);
+    QCOMPARE(tracer.samplesCount(LatencyTracer::EndToEnd), quint32(0));
+
+    // nor the probe channel of another universe
+    data[2] = 20;
+    tracer.outputWritten(1, data);
+    QCOMPARE(tracer.samplesCount(LatencyTracer::EndToEnd), quint32(0));
+
+    tracer.outputWritten(0, data);
+    QCOMPARE(tracer.samplesCount(LatencyTracer::EndToEnd), quint32(1));
+
+    // a channel beyond the frame size reads as 0
+    tracer.setProbe(0, 10);
+    tracer.inputFlushed(tracer.timestamp());
+    tracer.outputWritten(0, data);
+    QCOMPARE(tracer.samplesCount(LatencyTracer::EndToEnd), quint32(1));
+}
+
+void LatencyTracer_Test::dropped()
+{
+    LatencyTracer tracer;
+    tracer.setEnabled(true);
+    tracer.setProbe(0, 0);
+
+    qint64 received = tracer.timestamp();
+    for (int i = 0; i < LATENCYTRACER_MAX_PENDING + 10; i++)
+        tracer.inputFlushed(received);
+
+    QCOMPARE(tracer.m_pendingCount, LATENCYTRACER_MAX_PENDING);
+    QCOMPARE(tracer.droppedCount(), quint32(10));
+    QCOMPARE(tracer.samplesCount(LatencyTracer::InputQueue), quint32(LATENCYTRACER_MAX_PENDING + 10));
+
+    tracer.reset();
+    QCOMPARE(tracer.m_pendingCount, 0);
+    QCOMPARE(tracer.droppedCount(), quint32(0));
+}
+
+void LatencyTracer_Test::histogram()
+{
+    LatencyTracer tracer;
+
+    QCOMPARE(LatencyTracer::bucketUpperBound(0), qint64(1000));
+    QCOMPARE(LatencyTracer::bucketUpperBound(1), qint64(2000));
+    QCOMPARE(LatencyTracer::bucketUpperBound(10), qint64(1024000));
+
+    tracer.addSample(LatencyTracer::EndToEnd, 500);       // < 1us
+    tracer.addSample(LatencyTracer::EndToEnd, 1500);      // [1, 2) us
+    tracer.addSample(LatencyTracer::EndToEnd, 3000);      // [2, 4) us
+    tracer.addSample(LatencyTracer::EndToEnd, 3999);      // [2, 4) us
+    tracer.addSample(LatencyTracer::EndToEnd, -10);       // clock skew, counted as 0
+
+    QVector<quint32> buckets = tracer.histogram(LatencyTracer::EndToEnd);
+    QCOMPARE(buckets.at(0), quint32(2));
+    QCOMPARE(buckets.at(1), quint32(1));
+    QCOMPARE(buckets.at(2), quint32(2));
+    QCOMPARE(buckets.at(3), quint32(0));
+
+    QCOMPARE(tracer.samplesCount(LatencyTracer::EndToEnd), quint32(5));
+    QCOMPARE(tracer.minimum(LatencyTracer::EndToEnd), qint64(0));
+    QCOMPARE(tracer.maximum(LatencyTracer::EndToEnd), qint64(3999));
+    QCOMPARE(tracer.mean(LatencyTracer::EndToEnd), qint64((500 + 1500 + 3000 + 3999) / 5));
+
+    QCOMPARE(tracer.percentile(LatencyTracer::EndToEnd, 0.0), qint64(1000));
+    QCOMPARE(tracer.percentile(LatencyTracer::EndToEnd, 0.4), qint64(1000));
+    QCOMPARE(tracer.percentile(LatencyTracer::EndToEnd, 0.6), qint64(2000));
+    // capped to the maximum value seen
+    QCOMPARE(tracer.percentile(LatencyTracer::EndToEnd, 1.0), qint64(3999));
+
+    // the last bucket holds everything above
+    tracer.addSample(LatencyTracer::Output, Q_INT64_C(1) << 50);
+    QCOMPARE(tracer.histogram(LatencyTracer::Output).at(LATENCYTRACER_BUCKETS - 1), quint32(1));
+}
+
+QTEST_APPLESS_MAIN(LatencyTracer_Test)
@@ -367,4 +367,27 @@ void MasterTimer_Test::restart()
     mt->stopAllFunctions();
 }
 
+void MasterTimer_Test::timecode()
+{
+    MasterTimer* mt = m_doc->masterTimer();
+    QVERIFY(mt->timecodeValid() == false);
+    QCOMPARE(mt->timecodePosition(), qint64(-1));
+
+    // a position received 50ms ago has run on by 50ms
+    qint64 now = mt->m_beatClock.now();
+    mt->setTimecode(10000, now - 50000000);
+    QVERIFY(mt->timecodeValid() == true);
+    QVERIFY(mt->timecodePosition() >= 10050);
+    QVERIFY(mt->timecodePosition() < 10100);
+
+    // a position received 500ms ago has stopped after a few frames
+    mt->setTimecode(10000, now - 500000000);
+    QVERIFY(mt->timecodeValid() == true);
+    QCOMPARE(mt->timecodePosition(), qint64(10100));
+
+    // and after a while it is lost
+    mt->setTimecode(10000, now - 5000000000LL);
+    QVERIFY(mt->timecodeValid() == false);
+}
+
 QTEST_MAIN(MasterTimer_Test)
@@ -43,6 +43,7 @@ private slots:
     void stopAllFunctions();
     void stop();
     void restart();
+    void timecode();
 
 private:
     Doc* m_doc;
@@ -451,6 +451,78 @@ void QLCFixtureMode_Test::intensityChannels()
     QCOMPARE(mode.heads()[1].channelNumber(QLCChannel::Intensity, QLCChannel::MSB), 2U);
 }
 
+void QLCFixtureMode_Test::secondaryChannels()
+{
+    QLCFixtureDef def;
+    QList<QLCChannel *> channels;
+
+    QLCChannel::Group groups[] = { QLCChannel::Pan, QLCChannel::Tilt, QLCChannel::Pan,
+                                   QLCChannel::Tilt, QLCChannel::Intensity, QLCChannel::Intensity };
+    QLCChannel::ControlByte bytes[] = { QLCChannel::MSB, QLCChannel::MSB, QLCChannel::LSB,
+                                        QLCChannel::LSB, QLCChannel::MSB, QLCChannel::LSB };
+
+    QLCFixtureMode mode(&def);
+    for (int i = 0; i < 6; i++)
+    {
+        QLCChannel *ch = new QLCChannel();
+        ch->setName(QString("Channel %1").arg(i));
+        ch->setGroup(groups[i]);
+        ch->setControlByte(bytes[i]);
+        def.addChannel(ch);
+        mode.insertChannel(ch, i);
+    }
+
+    mode.cacheHeads();
+
+    /* Pan, Tilt, Pan Fine, Tilt Fine: the primary channels are not adjacent */
+    QCOMPARE(mode.primaryChannel(0), QLCChannel::invalid());
+    QCOMPARE(mode.primaryChannel(1), QLCChannel::invalid());
+    QCOMPARE(mode.primaryChannel(2), 0U);
+    QCOMPARE(mode.primaryChannel(3), 1U);
+
+    /* Dimmer, Dimmer Fine */
+    QCOMPARE(mode.primaryChannel(4), QLCChannel::invalid());
+    QCOMPARE(mode.primaryChannel(5), 4U);
+}
+
+void QLCFixtureMode_Test::secondaryChannelsAdjacent()
+{
+    QLCFixtureDef def;
+
+    /* Red, Intensity Fine, Red Fine, Tilt, Tilt Fine, Tilt Fine */
+    QLCChannel::Group groups[] = { QLCChannel::Intensity, QLCChannel::Intensity, QLCChannel::Intensity,
+                                   QLCChannel::Tilt, QLCChannel::Tilt, QLCChannel::Tilt };
+    QLCChannel::ControlByte bytes[] = { QLCChannel::MSB, QLCChannel::LSB, QLCChannel::LSB,
+                                        QLCChannel::MSB, QLCChannel::LSB, QLCChannel::LSB };
+    QLCChannel::PrimaryColour colours[] = { QLCChannel::Red, QLCChannel::NoColour, QLCChannel::Red,
+                                            QLCChannel::NoColour, QLCChannel::NoColour, QLCChannel::NoColour };
+
+    QLCFixtureMode mode(&def);
+    for (int i = 0; i < 6; i++)
+    {
+        QLCChannel *ch = new QLCChannel();
+        ch->setName(QString("Channel %1").arg(i));
+        ch->setGroup(groups[i]);
+        ch->setControlByte(bytes[i]);
+        ch->setColour(colours[i]);
+        def.addChannel(ch);
+        mode.insertChannel(ch, i);
+    }
+
+    mode.cacheHeads();
+
+    /* A secondary channel right after a primary channel of the same
+     * group is still its secondary channel, whatever its colour */
+    QCOMPARE(mode.primaryChannel(1), 0U);
+
+    /* The primary channel has been taken already */
+    QCOMPARE(mode.primaryChannel(2), QLCChannel::invalid());
+
+    /* Only the first secondary channel goes with a primary channel */
+    QCOMPARE(mode.primaryChannel(4), 3U);
+    QCOMPARE(mode.primaryChannel(5), QLCChannel::invalid());
+}
+
 void QLCFixtureMode_Test::load()
 {
     QBuffer buffer;
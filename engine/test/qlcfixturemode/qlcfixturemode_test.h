@@ -44,6 +44,8 @@ private slots:
     void heads();
     void copy();
     void intensityChannels();
+    void secondaryChannels();
+    void secondaryChannelsAdjacent();
 
     void load();
     void loadWrongRoot();
@@ -0,0 +1,313 @@
+/*
+  Q Light Controller Plus - Unit tests
+  rgbimage_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QtTest>
+
+#define private public
+#include "rgbimage_test.h"
+#include "rgbimage.h"
+#undef private
+
+#include "doc.h"
+
+/* A 4x2 image where each pixel has a different color */
+static QByteArray testImageData(uchar base)
+{
+    QByteArray data;
+    for (int i = 0; i < 8; i++)
+        data.append(char(base + i)).append(char(i * 16)).append(char(255 - i));
+    return data;
+}
+
+static uint testPixel(uchar base, int x, int y)
+{
+    int i = y * 4 + x;
+    return qRgb(base + i, i * 16, 255 - i);
+}
+
+/* A 4x2 GIF of 3 frames, using a palette of red, green, blue and white.
+ * The pixel at (x, y) of frame k is the color (x + y + k) % 4 */
+static const char testAnimation[] =
+    "\x47\x49\x46\x38\x39\x61\x04\x00\x02\x00\x91\x00\x00\xff\x00\x00"
+    "\x00\xff\x00\x00\x00\xff\xff\xff\xff\x21\xff\x0b\x4e\x45\x54\x53"
+    "\x43\x41\x50\x45\x32\x2e\x30\x03\x01\x00\x00\x00\x21\xf9\x04\x04"
+    "\x0a\x00\x00\x00\x2c\x00\x00\x00\x00\x04\x00\x02\x00\x00\x02\x05"
+    "\x44\xa8\x31\xe2\x50\x00\x21\xf9\x04\x04\x0a\x00\x00\x00\x2c\x00"
+    "\x00\x00\x00\x04\x00\x02\x00\x00\x02\x05\x8c\x38\x50\x23\x52\x00"
+    "\x21\xf9\x04\x04\x0a\x00\x00\x00\x2c\x00\x00\x00\x00\x04\x00\x02"
+    "\x00\x00\x02\x05\xd4\x88\x70\x60\x54\x00\x3b";
+
+static uint animationPixel(int frame, int x, int y)
+{
+    static const uint palette[] = { qRgb(255, 0, 0), qRgb(0, 255, 0), qRgb(0, 0, 255), qRgb(255, 255, 255) };
+    return palette[(x + y + frame) % 4];
+}
+
+static void writeTestAnimation(const QString& path)
+{
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(testAnimation, sizeof(testAnimation) - 1);
+    file.close();
+}
+
+static void verifyAnimationFrame(const RGBMap& map, int frame)
+{
+    QCOMPARE(map.size(), 2);
+    for (int y = 0; y < 2; y++)
+    {
+        QCOMPARE(map[y].size(), 4);
+        for (int x = 0; x < 4; x++)
+            QCOMPARE(map[y][x], animationPixel(frame, x, y));
+    }
+}
+
+void RGBImage_Test::initTestCase()
+{
+    m_doc = new Doc(this);
+}
+
+void RGBImage_Test::cleanupTestCase()
+{
+    delete m_doc;
+}
+
+void RGBImage_Test::initial()
+{
+    RGBImage image(m_doc);
+    QCOMPARE(image.animationStyle(), RGBImage::Static);
+    QCOMPARE(image.animatedSource(), false);
+    QCOMPARE(image.xOffset(), 0);
+    QCOMPARE(image.yOffset(), 0);
+    QCOMPARE(image.frameCacheLimit(), qint64(RGBIMAGE_FRAME_CACHE_LIMIT));
+    QCOMPARE(image.m_frameCacheValid, false);
+    QCOMPARE(image.type(), RGBAlgorithm::Image);
+}
+
+void RGBImage_Test::emptyImage()
+{
+    RGBImage image(m_doc);
+    RGBMap map;
+    image.rgbMap(QSize(5, 5), 0, 0, map);
+    QVERIFY(map.isEmpty());
+}
+
+void RGBImage_Test::staticImage()
+{
+    RGBImage image(m_doc);
+    image.setImageData(4, 2, testImageData(10));
+
+    RGBMap map;
+    image.rgbMap(QSize(6, 3), 0, 0, map);
+    QCOMPARE(image.m_frameCacheValid, true);
+    QCOMPARE(image.m_framesCount, 1);
+    QCOMPARE(image.m_frameSize, QSize(4, 2));
+
+    QCOMPARE(map.size(), 3);
+    for (int y = 0; y < 3; y++)
+    {
+        QCOMPARE(map[y].size(), 6);
+        for (int x = 0; x < 6; x++)
+            QCOMPARE(map[y][x], testPixel(10, x % 4, y % 2));
+    }
+}
+
+void RGBImage_Test::horizontalScroll()
+{
+    RGBImage image(m_doc);
+    image.setImageData(4, 2, testImageData(10));
+    image.setAnimationStyle(RGBImage::Horizontal);
+    image.setXOffset(1);
+    image.setYOffset(1);
+
+    QCOMPARE(image.rgbMapStepCount(QSize(3, 2)), 4);
+
+    for (int step = 0; step < 4; step++)
+    {
+        RGBMap map;
+        image.rgbMap(QSize(3, 2), 0, step, map);
+        for (int y = 0; y < 2; y++)
+        {
+            for (int x = 0; x < 3; x++)
+                QCOMPARE(map[y][x], testPixel(10, (x + 1 + step) % 4, (y + 1) % 2));
+        }
+    }
+}
+
+void RGBImage_Test::negativeOffset()
+{
+    RGBImage image(m_doc);
+    image.setImageData(4, 2, testImageData(10));
+    image.setXOffset(-1);
+    image.setYOffset(-3);
+
+    RGBMap map;
+    image.rgbMap(QSize(4, 2), 0, 0, map);
+    for (int y = 0; y < 2; y++)
+    {
+        for (int x = 0; x < 4; x++)
+            QCOMPARE(map[y][x], testPixel(10, (x + 3) % 4, (y + 1) % 2));
+    }
+}
+
+void RGBImage_Test::imageDataInvalidatesCache()
+{
+    RGBImage image(m_doc);
+    image.setImageData(4, 2, testImageData(10));
+
+    RGBMap map;
+    image.rgbMap(QSize(4, 2), 0, 0, map);
+    QCOMPARE(map[1][2], testPixel(10, 2, 1));
+
+    image.setImageData(4, 2, testImageData(50));
+    QCOMPARE(image.m_frameCacheValid, false);
+
+    image.rgbMap(QSize(4, 2), 0, 0, map);
+    QCOMPARE(map[1][2], testPixel(50, 2, 1));
+}
+
+void RGBImage_Test::frameCacheLimit()
+{
+    RGBImage image(m_doc);
+    image.setImageData(4, 2, testImageData(10));
+
+    RGBMap map;
+    image.rgbMap(QSize(4, 2), 0, 0, map);
+    QCOMPARE(image.m_frameCacheValid, true);
+
+    image.setFrameCacheLimit(1024);
+    QCOMPARE(image.frameCacheLimit(), qint64(1024));
+    QCOMPARE(image.m_frameCacheValid, false);
+
+    RGBImage *clone = static_cast<RGBImage *>(image.clone());
+    QCOMPARE(clone->frameCacheLimit(), qint64(1024));
+    delete clone;
+}
+
+void RGBImage_Test::animationCached()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QString path = dir.filePath("animation.gif");
+    writeTestAnimation(path);
+
+    RGBImage image(m_doc);
+    image.setFilename(path);
+    QCOMPARE(image.animatedSource(), true);
+
+    // request the frames as the first step would, then wait for them
+    image.m_decoder.request(path, QSize(4, 2), image.frameCacheLimit());
+    QTRY_COMPARE(image.m_decoder.framesCount(), 3);
+    QCOMPARE(image.m_decoder.isStreaming(), false);
+    QCOMPARE(image.m_decoder.decodedCount(), quint32(3));
+
+    // then the cached frames are played in a loop
+    RGBMap map;
+    for (int i = 0; i < 7; i++)
+    {
+        image.rgbMap(QSize(4, 2), 0, 0, map);
+        verifyAnimationFrame(map, i % 3);
+    }
+
+    // nothing is decoded again while the map size doesn't change
+    QCOMPARE(image.m_decoder.decodedCount(), quint32(3));
+
+    // a different map size decodes the frames again
+    image.rgbMap(QSize(2, 2), 0, 0, map);
+    QTRY_COMPARE(image.m_decoder.framesCount(), 3);
+    image.rgbMap(QSize(2, 2), 0, 0, map);
+    QCOMPARE(map.size(), 2);
+    QCOMPARE(map[0].size(), 2);
+}
+
+void RGBImage_Test::animationOverBudget()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QString path = dir.filePath("animation.gif");
+    writeTestAnimation(path);
+
+    // 3 frames of 4x2 pixels take 96 bytes
+    RGBImage image(m_doc);
+    image.setFrameCacheLimit(64);
+    image.setFilename(path);
+    QCOMPARE(image.animatedSource(), true);
+
+    image.m_decoder.request(path, QSize(4, 2), image.frameCacheLimit());
+    QTRY_COMPARE(image.m_decoder.framesCount(), 1);
+    QCOMPARE(image.m_decoder.isStreaming(), true);
+    QCOMPARE(image.m_decoder.decodedCount(), quint32(1));
+
+    // each frame taken makes the decoder thread decode the next one
+    RGBMap map;
+    for (int i = 0; i < 5; i++)
+    {
+        image.rgbMap(QSize(4, 2), 0, 0, map);
+        verifyAnimationFrame(map, i % 3);
+        QTRY_COMPARE(image.m_decoder.decodedCount(), quint32(i + 2));
+    }
+
+    // rewinding goes back to the first frame
+    image.rewindAnimation();
+    QTRY_COMPARE(image.m_decoder.decodedCount(), quint32(7));
+    image.rgbMap(QSize(4, 2), 0, 0, map);
+    verifyAnimationFrame(map, 0);
+}
+
+void RGBImage_Test::animationStepCount()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QString path = dir.filePath("animation.gif");
+    writeTestAnimation(path);
+
+    RGBImage image(m_doc);
+    image.setFilename(path);
+    QCOMPARE(image.animatedSource(), true);
+
+    // the frames are scaled to the map, so they scroll at its size,
+    // even before the first one is decoded
+    image.setAnimationStyle(RGBImage::Static);
+    QCOMPARE(image.rgbMapStepCount(QSize(4, 2)), 1);
+    image.setAnimationStyle(RGBImage::Horizontal);
+    QCOMPARE(image.rgbMapStepCount(QSize(4, 2)), 4);
+    QCOMPARE(image.rgbMapStepCount(QSize(6, 3)), 6);
+    image.setAnimationStyle(RGBImage::Vertical);
+    QCOMPARE(image.rgbMapStepCount(QSize(4, 2)), 2);
+    QCOMPARE(image.rgbMapStepCount(QSize(6, 3)), 3);
+    image.setAnimationStyle(RGBImage::Animation);
+    QCOMPARE(image.rgbMapStepCount(QSize(4, 2)), 1);
+    QCOMPARE(image.rgbMapStepCount(QSize(0, 0)), 1);
+
+    // each step scrolls the current frame by one pixel
+    image.setAnimationStyle(RGBImage::Horizontal);
+    image.m_decoder.request(path, QSize(4, 2), image.frameCacheLimit());
+    QTRY_COMPARE(image.m_decoder.framesCount(), 3);
+
+    RGBMap map;
+    image.rgbMap(QSize(4, 2), 0, 1, map);
+    QCOMPARE(map.size(), 2);
+    for (int y = 0; y < 2; y++)
+    {
+        for (int x = 0; x < 4; x++)
+            QCOMPARE(map[y][x], animationPixel(0, (x + 1) % 4, y));
+    }
+}
+
+QTEST_MAIN(RGBImage_Test)
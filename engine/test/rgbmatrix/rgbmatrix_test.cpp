@@ -29,6 +29,7 @@
 #include "qlcfixturemode.h"
 #include "qlcfixturedef.h"
 #include "fixturegroup.h"
+#include "genericfader.h"
 #include "mastertimer.h"
 #include "rgbmatrix.h"
 #include "fixture.h"
@@ -200,6 +201,91 @@ void RGBMatrix_Test::property()
     QCOMPARE(mtx.property("orientation"), QString("Vertical"));
 }
 
+void RGBMatrix_Test::pixelMap()
+{
+    RGBMatrix mtx(m_doc);
+    mtx.setFixtureGroup(0);
+
+    // only a matrix without fades and with normal blending writes directly
+    QVERIFY(mtx.canWriteDirect() == true);
+    mtx.setFadeInSpeed(100);
+    QVERIFY(mtx.canWriteDirect() == false);
+    mtx.setFadeInSpeed(0);
+    mtx.setFadeOutSpeed(100);
+    QVERIFY(mtx.canWriteDirect() == false);
+    mtx.setFadeOutSpeed(0);
+    mtx.setBlendMode(Universe::AdditiveBlend);
+    QVERIFY(mtx.canWriteDirect() == false);
+    mtx.setBlendMode(Universe::NormalBlend);
+    QVERIFY(mtx.canWriteDirect() == true);
+
+    QList<Universe*> ua = m_doc->inputOutputMap()->universes();
+    mtx.updatePixelMap(mtx.m_group, ua);
+    QVERIFY(mtx.m_pixelMapUpToDate == true);
+
+    // the RGB channels of 25 heads, all on the first universe
+    QCOMPARE(mtx.m_pixelMap.count(), 75);
+    QCOMPARE(mtx.m_pixelLayerUniverses.count(), 1);
+    QCOMPARE(mtx.m_pixelLayerUniverses.at(0), quint32(0));
+    QCOMPARE(mtx.m_fadersMap.count(), 1);
+    QVERIFY(mtx.m_fadersMap[0]->hasLayer() == true);
+
+    RGBMap map(5, QVector<uint>(5, qRgb(255, 0, 0)));
+    map[0][0] = qRgb(10, 20, 30);
+    mtx.updatePixelLayers(map, ua);
+
+    // the first channel of each fixture is not a color
+    QByteArray layer = mtx.m_pixelLayers.at(0);
+    QCOMPARE(uchar(layer.at(0)), uchar(0));
+    QCOMPARE(uchar(layer.at(1)), uchar(10));
+    QCOMPARE(uchar(layer.at(2)), uchar(20));
+    QCOMPARE(uchar(layer.at(3)), uchar(30));
+    QCOMPARE(uchar(layer.at(6)), uchar(255));
+    QCOMPARE(uchar(layer.at(7)), uchar(0));
+
+    mtx.m_fadersMap[0]->write(ua[0]);
+    QCOMPARE(uchar(ua[0]->preGMValues().at(1)), uchar(10));
+    QCOMPARE(uchar(ua[0]->preGMValues().at(6)), uchar(255));
+
+    // a different control mode needs a new map
+    mtx.setControlMode(RGBMatrix::ControlModeShutter);
+    QVERIFY(mtx.m_pixelMapUpToDate == false);
+
+    mtx.dismissAllFaders();
+    ua[0]->reset();
+}
+
+void RGBMatrix_Test::pixelMapChanges()
+{
+    RGBMatrix mtx(m_doc);
+    mtx.setFixtureGroup(0);
+
+    QList<Universe*> ua = m_doc->inputOutputMap()->universes();
+    mtx.updatePixelMap(mtx.m_group, ua);
+    QVERIFY(mtx.m_pixelMapUpToDate == true);
+
+    // another group doesn't matter
+    emit m_doc->fixtureGroupChanged(1);
+    QVERIFY(mtx.m_pixelMapUpToDate == true);
+
+    // the heads of the group have changed
+    emit m_doc->fixtureGroupChanged(0);
+    QVERIFY(mtx.m_pixelMapUpToDate == false);
+
+    mtx.updatePixelMap(mtx.m_group, ua);
+    QVERIFY(mtx.m_pixelMapUpToDate == true);
+
+    // a fixture out of the group doesn't matter
+    emit m_doc->fixtureChanged(100);
+    QVERIFY(mtx.m_pixelMapUpToDate == true);
+
+    // a fixture of the group has changed address or mode
+    emit m_doc->fixtureChanged(mtx.m_group->fixtureList().first());
+    QVERIFY(mtx.m_pixelMapUpToDate == false);
+
+    mtx.dismissAllFaders();
+}
+
 void RGBMatrix_Test::loadSave()
 {
     RGBMatrix* mtx = new RGBMatrix(m_doc);
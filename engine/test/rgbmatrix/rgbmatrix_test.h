@@ -43,6 +43,8 @@ private slots:
     void copy();
     void previewMaps();
     void property();
+    void pixelMap();
+    void pixelMapChanges();
     void loadSave();
 
 private:
@@ -441,6 +441,52 @@ void RGBText_Test::verticalScroll()
     }
 }
 
+void RGBText_Test::renderCache()
+{
+    RGBText text(m_doc);
+    text.setText("QLC");
+    text.setAnimationStyle(RGBText::Horizontal);
+    QCOMPARE(text.m_cacheValid, false);
+
+    RGBMap map1, map2;
+    text.rgbMap(QSize(10, 10), QRgb(0xFFFFFFFF), 0, map1);
+    QCOMPARE(text.m_cacheValid, true);
+    QCOMPARE(text.m_coverageSize, QSize(text.rgbMapStepCount(QSize()), 10));
+
+    // The next step is the same window moved by one pixel
+    text.rgbMap(QSize(10, 10), QRgb(0xFFFFFFFF), 1, map2);
+    for (int y = 0; y < 10; y++)
+    {
+        for (int x = 1; x < 10; x++)
+            QCOMPARE(map2[y][x - 1], map1[y][x]);
+    }
+
+    // Colors are applied on the same rendering
+    text.rgbMap(QSize(10, 10), QRgb(0xFF00FF00), 0, map2);
+    for (int y = 0; y < 10; y++)
+    {
+        for (int x = 0; x < 10; x++)
+            QCOMPARE(map2[y][x], map1[y][x] & 0xFF00FF00);
+    }
+
+    // Any change renders the text again
+    text.setText("Q");
+    QCOMPARE(text.m_cacheValid, false);
+    text.rgbMap(QSize(10, 10), QRgb(0xFFFFFFFF), 0, map1);
+    QCOMPARE(text.m_cacheValid, true);
+    QCOMPARE(text.m_coverageSize, QSize(text.rgbMapStepCount(QSize()), 10));
+
+    text.setAnimationStyle(RGBText::StaticLetters);
+    QCOMPARE(text.m_cacheValid, false);
+    text.rgbMap(QSize(8, 6), QRgb(0xFFFFFFFF), 0, map1);
+    QCOMPARE(text.m_coverageSize, QSize(8, 6));
+    QCOMPARE(text.m_coverage.size(), 8 * 6);
+
+    // A new map size renders the letters again
+    text.rgbMap(QSize(10, 10), QRgb(0xFFFFFFFF), 0, map1);
+    QCOMPARE(text.m_coverageSize, QSize(10, 10));
+}
+
 void RGBText_Test::unused()
 {
     RGBText text(m_doc);
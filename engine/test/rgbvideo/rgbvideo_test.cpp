@@ -0,0 +1,255 @@
+/*
+  Q Light Controller Plus - Unit tests
+  rgbvideo_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QtTest>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+
+#define private public
+#include "rgbvideo_test.h"
+#include "rgbvideo.h"
+#undef private
+
+#include "doc.h"
+
+static QImage solidImage(QRgb color)
+{
+    QImage image(16, 8, QImage::Format_ARGB32);
+    image.fill(color);
+    return image;
+}
+
+void RGBVideo_Test::initTestCase()
+{
+    m_doc = new Doc(this);
+}
+
+void RGBVideo_Test::cleanupTestCase()
+{
+    delete m_doc;
+}
+
+void RGBVideo_Test::initial()
+{
+    RGBVideo video(m_doc);
+    QCOMPARE(video.filename(), QString());
+    QCOMPARE(video.name(), QString("Video"));
+    QCOMPARE(video.type(), RGBAlgorithm::Video);
+    QCOMPARE(video.apiVersion(), 1);
+    QCOMPARE(video.acceptColors(), 0);
+    QCOMPARE(video.rgbMapStepCount(QSize(10, 10)), 1);
+    QCOMPARE(video.droppedFrames(), quint32(0));
+    QVERIFY(video.m_decoder == NULL);
+}
+
+void RGBVideo_Test::filename()
+{
+    RGBVideo video(m_doc);
+    video.setFilename("/tmp/clip.mp4");
+    QCOMPARE(video.filename(), QString("/tmp/clip.mp4"));
+
+    RGBVideo *clone = static_cast<RGBVideo*> (video.clone());
+    QCOMPARE(clone->filename(), QString("/tmp/clip.mp4"));
+    QVERIFY(clone->m_decoder == NULL);
+    delete clone;
+
+    QVERIFY(RGBAlgorithm::algorithms(m_doc).contains("Video"));
+    RGBAlgorithm *algo = RGBAlgorithm::algorithm(m_doc, "Video");
+    QVERIFY(algo != NULL);
+    QCOMPARE(algo->type(), RGBAlgorithm::Video);
+    delete algo;
+}
+
+void RGBVideo_Test::saveLoad()
+{
+    RGBVideo video(m_doc);
+    video.setFilename("/tmp/clip.mp4");
+
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly | QIODevice::Text);
+    QXmlStreamWriter xmlWriter(&buffer);
+
+    QVERIFY(video.saveXML(&xmlWriter) == true);
+
+    xmlWriter.setDevice(NULL);
+    buffer.close();
+
+    buffer.open(QIODevice::ReadOnly | QIODevice::Text);
+    QXmlStreamReader xmlReader(&buffer);
+    xmlReader.readNextStartElement();
+
+    QCOMPARE(xmlReader.name().toString(), QString("Algorithm"));
+    QCOMPARE(xmlReader.attributes().value("Type").toString(), QString("Video"));
+
+    RGBAlgorithm *algo = RGBAlgorithm::loader(m_doc, xmlReader);
+    QVERIFY(algo != NULL);
+    QCOMPARE(algo->type(), RGBAlgorithm::Video);
+    QCOMPARE(static_cast<RGBVideo*> (algo)->filename(), QString("/tmp/clip.mp4"));
+    delete algo;
+}
+
+void RGBVideo_Test::noFile()
+{
+    RGBVideo video(m_doc);
+    RGBMap map;
+
+    video.setPlaybackTime(1000);
+    video.rgbMap(QSize(10, 10), 0, 0, map);
+    QVERIFY(map.isEmpty());
+    QVERIFY(video.m_decoder == NULL);
+
+    video.postRun();
+    QCOMPARE(video.m_playbackTime, quint32(0));
+}
+
+void RGBVideo_Test::preview()
+{
+    RGBVideo video(m_doc);
+    video.setFilename("/tmp/clip.mp4");
+    RGBMap map;
+
+    /* Nothing rendered yet: blank map and no decoder started */
+    video.rgbMapPreview(QSize(4, 2), 0, 0, map);
+    QVERIFY(video.m_decoder == NULL);
+    QCOMPARE(map.size(), 2);
+    for (int y = 0; y < map.size(); y++)
+    {
+        QCOMPARE(map[y].size(), 4);
+        foreach (uint pixel, map[y])
+            QCOMPARE(pixel, uint(0));
+    }
+
+    /* The last frame rendered by the running matrix is shown */
+    video.m_frame.fill(qRgb(0, 0, 255), 8);
+    video.m_frameSize = QSize(4, 2);
+    video.rgbMapPreview(QSize(4, 2), 0, 0, map);
+    QVERIFY(video.m_decoder == NULL);
+    for (int y = 0; y < map.size(); y++)
+    {
+        foreach (uint pixel, map[y])
+            QCOMPARE(pixel, uint(qRgb(0, 0, 255)));
+    }
+
+    /* A different size can't be served from that frame */
+    video.rgbMapPreview(QSize(2, 2), 0, 0, map);
+    QCOMPARE(map.size(), 2);
+    QCOMPARE(map[0].size(), 2);
+    QCOMPARE(map[0][0], uint(0));
+    QVERIFY(video.m_decoder == NULL);
+}
+
+void RGBVideo_Test::decoderFrameTiming()
+{
+    RGBVideoDecoder decoder;
+    decoder.setFrameSize(QSize(4, 2));
+
+    decoder.presentFrame(solidImage(qRgb(255, 0, 0)), 0);
+    decoder.presentFrame(solidImage(qRgb(0, 255, 0)), 40);
+    decoder.presentFrame(solidImage(qRgb(0, 0, 255)), 80);
+    QCOMPARE(decoder.lastFrameTime(), qint64(80));
+
+    QVector<QRgb> pixels;
+    QSize size;
+
+    /* The newest frame due is taken, the older one is skipped */
+    QVERIFY(decoder.takeFrame(50, pixels, size) == true);
+    QCOMPARE(size, QSize(4, 2));
+    QCOMPARE(pixels.size(), 8);
+    foreach (QRgb pixel, pixels)
+        QCOMPARE(pixel, qRgb(0, 255, 0));
+    QCOMPARE(decoder.droppedFrames(), quint32(1));
+
+    /* The last frame is not due yet */
+    QVERIFY(decoder.takeFrame(60, pixels, size) == false);
+    QCOMPARE(pixels.at(0), qRgb(0, 255, 0));
+
+    QVERIFY(decoder.takeFrame(80, pixels, size) == true);
+    QCOMPARE(pixels.at(7), qRgb(0, 0, 255));
+    QCOMPARE(decoder.droppedFrames(), quint32(1));
+
+    /* Nothing left */
+    QVERIFY(decoder.takeFrame(200, pixels, size) == false);
+}
+
+void RGBVideo_Test::decoderRingOverflow()
+{
+    RGBVideoDecoder decoder;
+    decoder.setFrameSize(QSize(2, 2));
+
+    for (int i = 0; i < RGBVIDEO_RING_SIZE + 2; i++)
+        decoder.presentFrame(solidImage(qRgb(i, i, i)), i * 40);
+
+    /* A consumer not keeping up makes the decoder overwrite the oldest frames */
+    QCOMPARE(decoder.m_framesCount, RGBVIDEO_RING_SIZE);
+    QCOMPARE(decoder.droppedFrames(), quint32(2));
+
+    QVector<QRgb> pixels;
+    QSize size;
+    QVERIFY(decoder.takeFrame(10000, pixels, size) == true);
+    QCOMPARE(pixels.at(0), qRgb(RGBVIDEO_RING_SIZE + 1, RGBVIDEO_RING_SIZE + 1, RGBVIDEO_RING_SIZE + 1));
+    QCOMPARE(decoder.droppedFrames(), quint32(RGBVIDEO_RING_SIZE + 1));
+
+    decoder.presentFrame(solidImage(qRgb(100, 100, 100)), 1000);
+    QVERIFY(decoder.takeFrame(1000, pixels, size) == true);
+    QCOMPARE(pixels.at(0), qRgb(100, 100, 100));
+}
+
+void RGBVideo_Test::decoderStaleFrames()
+{
+    RGBVideoDecoder decoder;
+    decoder.setFrameSize(QSize(2, 2));
+
+    /* Frames far ahead of the playback time are left over
+     * from before a loop and are discarded */
+    decoder.presentFrame(solidImage(qRgb(1, 1, 1)), 5000);
+    decoder.presentFrame(solidImage(qRgb(2, 2, 2)), 10);
+
+    QVector<QRgb> pixels;
+    QSize size;
+    QVERIFY(decoder.takeFrame(20, pixels, size) == true);
+    QCOMPARE(pixels.at(0), qRgb(2, 2, 2));
+    QCOMPARE(decoder.droppedFrames(), quint32(1));
+}
+
+void RGBVideo_Test::decoderFrameSize()
+{
+    RGBVideoDecoder decoder;
+    QVector<QRgb> pixels;
+    QSize size;
+
+    /* No size, no frames */
+    decoder.presentFrame(solidImage(qRgb(1, 1, 1)), 0);
+    QVERIFY(decoder.takeFrame(0, pixels, size) == false);
+
+    decoder.setFrameSize(QSize(3, 3));
+    decoder.presentFrame(solidImage(qRgb(1, 1, 1)), 0);
+    QCOMPARE(decoder.m_framesCount, 1);
+
+    /* A new group size drops the frames scaled for the old one */
+    decoder.setFrameSize(QSize(5, 1));
+    QCOMPARE(decoder.m_framesCount, 0);
+    QCOMPARE(decoder.lastFrameTime(), qint64(-1));
+
+    decoder.presentFrame(solidImage(qRgb(1, 1, 1)), 0);
+    QVERIFY(decoder.takeFrame(0, pixels, size) == true);
+    QCOMPARE(size, QSize(5, 1));
+    QCOMPARE(pixels.size(), 5);
+}
+
+QTEST_MAIN(RGBVideo_Test)
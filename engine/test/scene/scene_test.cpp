@@ -665,6 +665,53 @@ void Scene_Test::flashUnflash()
     QVERIFY(timer.m_dmxSourceList.size() == 0);
 }
 
+void Scene_Test::flashFixtureMoved()
+{
+    Doc *doc = new Doc(this);
+    QList<Universe*> ua;
+    MasterTimer timer(doc);
+
+    Fixture *fxi = new Fixture(doc);
+    fxi->setAddress(0);
+    fxi->setUniverse(0);
+    fxi->setChannels(10);
+    doc->addFixture(fxi);
+
+    Scene *s1 = new Scene(doc);
+    s1->setValue(fxi->id(), 0, 123);
+    s1->setValue(fxi->id(), 1, 45);
+    doc->addFunction(s1);
+
+    s1->flash(&timer, false, false);
+    ua = doc->inputOutputMap()->claimUniverses();
+    s1->writeDMX(&timer, ua);
+    ua[0]->processFaders();
+    QVERIFY(ua[0]->preGMValues()[0] == char(123));
+    QVERIFY(ua[0]->preGMValues()[1] == char(45));
+    doc->inputOutputMap()->releaseUniverses(false);
+
+    s1->unFlash(&timer);
+    ua = doc->inputOutputMap()->claimUniverses();
+    s1->writeDMX(&timer, ua);
+    ua[0]->processFaders();
+    doc->inputOutputMap()->releaseUniverses(false);
+
+    /* Moving the fixture must invalidate the resolved addresses */
+    fxi->setAddress(20);
+
+    s1->flash(&timer, false, false);
+    ua = doc->inputOutputMap()->claimUniverses();
+    s1->writeDMX(&timer, ua);
+    ua[0]->processFaders();
+    QVERIFY(ua[0]->preGMValues()[0] == char(0));
+    QVERIFY(ua[0]->preGMValues()[1] == char(0));
+    QVERIFY(ua[0]->preGMValues()[20] == char(123));
+    QVERIFY(ua[0]->preGMValues()[21] == char(45));
+    doc->inputOutputMap()->releaseUniverses(false);
+
+    s1->unFlash(&timer);
+}
+
 void Scene_Test::writeHTPZeroTicks()
 {
     Doc* doc = new Doc(this);
@@ -48,6 +48,7 @@ private slots:
     void preRunPostRun();
 
     void flashUnflash();
+    void flashFixtureMoved();
 
     void writeHTPZeroTicks();
     void writeHTPTwoTicks();
@@ -24,9 +24,12 @@
 #include "qlcfixturedefcache.h"
 #include "mastertimer.h"
 #include "script_test.h"
+#include "scriptwrapper.h"
 #include "universe.h"
-#include "script.h"
 #include "doc.h"
+#ifdef QMLUI
+#include "scriptrunner.h"
+#endif
 
 #undef private
 
@@ -69,4 +72,45 @@ void Script_Test::initial()
     scr.postRun(doc.masterTimer(), ua);
 }
 
+void Script_Test::preparedRunner()
+{
+#ifdef QMLUI
+    Doc doc(this);
+    QList<Universe*> ua;
+
+    Script scr(&doc);
+    QVERIFY(scr.m_runner == NULL);
+
+    // a loaded Script prepares its runner right away
+    scr.m_data = "var a = 1;";
+    scr.postLoad();
+    QVERIFY(scr.m_runner != NULL);
+    QTRY_VERIFY(scr.m_runner->isReady());
+
+    ScriptRunner *runner = scr.m_runner;
+    QJSEngine *engine = runner->m_engine;
+    QVERIFY(engine != NULL);
+
+    // starting the Script picks up the ready runner without compiling
+    scr.preRun(doc.masterTimer());
+    QVERIFY(scr.m_runner == runner);
+    QVERIFY(runner->m_engine == engine);
+    QVERIFY(runner->m_contentChanged == false);
+    scr.postRun(doc.masterTimer(), ua);
+
+    // changed code is compiled by the idle runner, before the next start
+    scr.setData("var b = 2;");
+    QVERIFY(scr.m_runner == runner);
+    QTRY_VERIFY(runner->isReady());
+    QCOMPARE(runner->m_content, QString("var b = 2;"));
+
+    scr.preRun(doc.masterTimer());
+    QVERIFY(runner->m_engine == engine);
+    QVERIFY(runner->m_contentChanged == false);
+    scr.postRun(doc.masterTimer(), ua);
+#else
+    QSKIP("Script runners are used by the QML UI only");
+#endif
+}
+
 QTEST_MAIN(Script_Test)
@@ -29,6 +29,7 @@ class Script_Test final : public QObject
 private slots:
     void initTestCase();
     void initial();
+    void preparedRunner();
 };
 
 #endif
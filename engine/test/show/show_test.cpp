@@ -127,6 +127,46 @@ void Show_Test::timeDivision()
     QCOMPARE(s.tempoToString(Show::BPM_2_4), "BPM_2_4");
 }
 
+void Show_Test::timecode()
+{
+    Show show(m_doc);
+    QVERIFY(show.timecodeSync() == false);
+    QCOMPARE(show.timecodeOffset(), 0U);
+
+    // the time code is not saved when not followed
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly | QIODevice::Text);
+    QXmlStreamWriter xmlWriter(&buffer);
+    QVERIFY(show.saveXML(&xmlWriter) == true);
+    xmlWriter.setDevice(NULL);
+    buffer.close();
+    QVERIFY(buffer.data().contains("Timecode") == false);
+
+    show.setTimecodeSync(true);
+    show.setTimecodeOffset(3600000);
+
+    buffer.setData(QByteArray());
+    buffer.open(QIODevice::WriteOnly | QIODevice::Text);
+    xmlWriter.setDevice(&buffer);
+    QVERIFY(show.saveXML(&xmlWriter) == true);
+    xmlWriter.setDevice(NULL);
+    buffer.close();
+
+    buffer.open(QIODevice::ReadOnly | QIODevice::Text);
+    QXmlStreamReader xmlReader(&buffer);
+    xmlReader.readNextStartElement();
+
+    Show loaded(m_doc);
+    QVERIFY(loaded.loadXML(xmlReader) == true);
+    QVERIFY(loaded.timecodeSync() == true);
+    QCOMPARE(loaded.timecodeOffset(), 3600000U);
+
+    Show copy(m_doc);
+    copy.copyFrom(&loaded);
+    QVERIFY(copy.timecodeSync() == true);
+    QCOMPARE(copy.timecodeOffset(), 3600000U);
+}
+
 void Show_Test::tracks()
 {
     Show s(m_doc);
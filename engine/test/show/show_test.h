@@ -34,6 +34,7 @@ private slots:
     void defaults();
     void copy();
     void timeDivision();
+    void timecode();
     void tracks();
     void duration();
     void load();
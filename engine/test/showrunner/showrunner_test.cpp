@@ -20,6 +20,7 @@
 #include <QtTest>
 #define private public
 #include "showrunner.h"
+#include "mastertimer.h"
 #undef private
 #include "show.h"
 #include "track.h"
@@ -72,4 +73,156 @@ void ShowRunner_Test::stopRunner()
     QCOMPARE(runner.m_runningQueue.count(), 0);
 }
 
+void ShowRunner_Test::seek()
+{
+    MasterTimer *timer = m_doc->masterTimer();
+
+    // a runner created at an offset seeks there on its first write
+    ShowRunner runner(m_doc, m_show->id(), 500);
+    QCOMPARE(runner.m_seekPending, true);
+    QCOMPARE(runner.m_timeFunctions.count(), 1);
+
+    runner.write(timer);
+    QCOMPARE(runner.m_seekPending, false);
+    QCOMPARE(runner.m_currentTimeFunctionIndex, 1);
+    QCOMPARE(runner.m_runningQueue.count(), 1);
+    QCOMPARE(runner.m_runningQueue.at(0).first, m_scene);
+    QCOMPARE(runner.m_runningQueue.at(0).second, quint32(1000));
+    QCOMPARE(m_scene->elapsed(), quint32(500));
+    QCOMPARE(runner.m_elapsedTime, quint32(500 + MasterTimer::tick()));
+
+    // seek back: the Scene is restarted from the new offset
+    runner.seek(200);
+    runner.write(timer);
+    QCOMPARE(runner.m_currentTimeFunctionIndex, 1);
+    QCOMPARE(runner.m_runningQueue.count(), 1);
+    QCOMPARE(m_scene->elapsed(), quint32(200));
+    QCOMPARE(runner.m_elapsedTime, quint32(200 + MasterTimer::tick()));
+
+    // seek to the start: the Scene is started by the cursor
+    runner.seek(0);
+    runner.write(timer);
+    QCOMPARE(runner.m_currentTimeFunctionIndex, 1);
+    QCOMPARE(runner.m_runningQueue.count(), 1);
+    QCOMPARE(m_scene->elapsed(), quint32(0));
+
+    // seek past the end: nothing is running anymore
+    runner.seek(1500);
+    runner.write(timer);
+    QCOMPARE(runner.m_currentTimeFunctionIndex, 1);
+    QCOMPARE(runner.m_runningQueue.count(), 0);
+    QVERIFY(m_scene->stopped() == true);
+
+    runner.stop();
+}
+
+void ShowRunner_Test::seekRunning()
+{
+    MasterTimer *timer = m_doc->masterTimer();
+
+    // a Scene without values stops by itself
+    m_scene->setValue(SceneValue(0, 0, 255));
+
+    ShowRunner runner(m_doc, m_show->id());
+    runner.adjustIntensity(0.5, m_track);
+
+    // the Scene is started by the cursor and run by the MasterTimer
+    runner.write(timer);
+    timer->timerTick();
+    QVERIFY(m_scene->isRunning() == true);
+    QCOMPARE(m_scene->elapsed(), MasterTimer::tick());
+    QCOMPARE(m_scene->getAttributeValue(Function::Intensity), 0.5);
+
+    // the Scene is stopped, but not restarted until
+    // the MasterTimer has processed the stop
+    runner.seek(600);
+    runner.write(timer);
+    QCOMPARE(runner.m_runningQueue.count(), 0);
+    QCOMPARE(runner.m_deferredItems.count(), 1);
+    QVERIFY(m_scene->stopped() == true);
+
+    timer->timerTick();
+    QVERIFY(m_scene->isRunning() == false);
+    QCOMPARE(m_scene->getAttributeValue(Function::Intensity), 1.0);
+
+    // the Scene is restarted from the current Show position,
+    // with the intensity of its track
+    runner.write(timer);
+    QCOMPARE(runner.m_deferredItems.count(), 0);
+    QCOMPARE(runner.m_runningQueue.count(), 1);
+    timer->timerTick();
+    QVERIFY(m_scene->isRunning() == true);
+    QCOMPARE(m_scene->elapsed(), quint32(600 + 2 * MasterTimer::tick()));
+    QCOMPARE(m_scene->getAttributeValue(Function::Intensity), 0.5);
+
+    // the Scene keeps running from there
+    runner.write(timer);
+    timer->timerTick();
+    QCOMPARE(m_scene->elapsed(), quint32(600 + 3 * MasterTimer::tick()));
+    QCOMPARE(runner.m_elapsedTime, quint32(600 + 3 * MasterTimer::tick()));
+
+    runner.stop();
+    timer->timerTick();
+    QVERIFY(m_scene->isRunning() == false);
+    m_scene->clear();
+}
+
+void ShowRunner_Test::timecodeHold()
+{
+    MasterTimer *timer = m_doc->masterTimer();
+
+    m_scene->setValue(SceneValue(0, 0, 255));
+    m_show->setTimecodeSync(true);
+
+    // without a time code, the Show doesn't start anything
+    ShowRunner runner(m_doc, m_show->id(), 400);
+    runner.write(timer);
+    QVERIFY(runner.m_timecodeHold == true);
+    QCOMPARE(runner.m_seekPending, true);
+    QCOMPARE(runner.m_runningQueue.count(), 0);
+
+    // the Show follows the time code
+    timer->setTimecode(400, timer->m_beatClock.now());
+    runner.write(timer);
+    timer->timerTick();
+    QVERIFY(runner.m_timecodeHold == false);
+    QCOMPARE(runner.m_runningQueue.count(), 1);
+    QVERIFY(m_scene->isRunning() == true);
+    QVERIFY(m_scene->isPaused() == false);
+    QVERIFY(runner.m_elapsedTime >= 400 && runner.m_elapsedTime <= 500);
+    quint32 elapsed = runner.m_elapsedTime;
+
+    // the time code is lost: the Show holds where it is
+    timer->setTimecode(600, timer->m_beatClock.now() - qint64(5000) * 1000000);
+    runner.write(timer);
+    timer->timerTick();
+    QVERIFY(runner.m_timecodeHold == true);
+    QVERIFY(m_scene->isPaused() == true);
+    QCOMPARE(runner.m_elapsedTime, elapsed);
+
+    runner.write(timer);
+    timer->timerTick();
+    QCOMPARE(runner.m_elapsedTime, elapsed);
+    QCOMPARE(runner.m_runningQueue.count(), 1);
+
+    // resuming the Show doesn't resume its Functions before the time code
+    runner.setPause(false);
+    QVERIFY(m_scene->isPaused() == true);
+
+    // the time code is back: the Show resumes from it
+    timer->setTimecode(500, timer->m_beatClock.now());
+    runner.write(timer);
+    QVERIFY(runner.m_timecodeHold == false);
+    QVERIFY(m_scene->isPaused() == false);
+    QVERIFY(runner.m_elapsedTime >= 500 && runner.m_elapsedTime <= 600);
+    QCOMPARE(runner.m_runningQueue.count(), 1);
+
+    runner.stop();
+    timer->timerTick();
+    QVERIFY(m_scene->isRunning() == false);
+    timer->setTimecode(-1, 0);
+    m_show->setTimecodeSync(false);
+    m_scene->clear();
+}
+
 QTEST_APPLESS_MAIN(ShowRunner_Test)
@@ -37,6 +37,9 @@ private slots:
     void initRunner();
     void intensity();
     void stopRunner();
+    void seek();
+    void seekRunning();
+    void timecodeHold();
 
 private:
     Doc *m_doc;
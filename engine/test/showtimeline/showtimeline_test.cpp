@@ -0,0 +1,158 @@
+/*
+  Q Light Controller Plus - Test Unit
+  showtimeline_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QtTest>
+
+#include "showtimeline.h"
+#include "showtimeline_test.h"
+
+static ShowTimeline::Item makeItem(quint32 trackId, quint32 startTime, quint32 stopTime)
+{
+    ShowTimeline::Item item;
+    item.showFunction = NULL;
+    item.function = NULL;
+    item.trackId = trackId;
+    item.startTime = startTime;
+    item.stopTime = stopTime;
+    return item;
+}
+
+void ShowTimeline_Test::empty()
+{
+    ShowTimeline tl;
+    tl.build();
+
+    QCOMPARE(tl.count(), 0);
+    QCOMPARE(tl.stopTime(), quint32(0));
+    QCOMPARE(tl.lowerBound(1000), 0);
+
+    QVector<int> indices;
+    indices.append(42);
+    tl.activeAt(1000, indices);
+    QCOMPARE(indices.count(), 0);
+}
+
+void ShowTimeline_Test::order()
+{
+    ShowTimeline tl;
+    tl.append(makeItem(0, 3000, 4000));
+    tl.append(makeItem(1, 0, 500));
+    tl.append(makeItem(2, 1000, 9000));
+    tl.append(makeItem(3, 1000, 2000));
+    tl.build();
+
+    QCOMPARE(tl.count(), 4);
+    QCOMPARE(tl.at(0).trackId, quint32(1));
+    QCOMPARE(tl.at(1).trackId, quint32(2));
+    QCOMPARE(tl.at(2).trackId, quint32(3));
+    QCOMPARE(tl.at(3).trackId, quint32(0));
+    QCOMPARE(tl.stopTime(), quint32(9000));
+
+    tl.clear();
+    QCOMPARE(tl.count(), 0);
+    QCOMPARE(tl.stopTime(), quint32(0));
+}
+
+void ShowTimeline_Test::lowerBound()
+{
+    ShowTimeline tl;
+    tl.append(makeItem(0, 0, 500));
+    tl.append(makeItem(1, 1000, 2000));
+    tl.append(makeItem(2, 1000, 1500));
+    tl.append(makeItem(3, 3000, 4000));
+    tl.build();
+
+    QCOMPARE(tl.lowerBound(0), 0);
+    QCOMPARE(tl.lowerBound(1), 1);
+    QCOMPARE(tl.lowerBound(1000), 1);
+    QCOMPARE(tl.lowerBound(1001), 3);
+    QCOMPARE(tl.lowerBound(3000), 3);
+    QCOMPARE(tl.lowerBound(5000), 4);
+}
+
+void ShowTimeline_Test::activeAt()
+{
+    ShowTimeline tl;
+    tl.append(makeItem(0, 0, 10000));
+    tl.append(makeItem(1, 1000, 2000));
+    tl.append(makeItem(2, 1500, 3000));
+    tl.append(makeItem(3, 5000, 6000));
+    tl.build();
+
+    QVector<int> indices;
+
+    // items starting exactly at the given time are not active yet
+    tl.activeAt(0, indices);
+    QCOMPARE(indices.count(), 0);
+
+    tl.activeAt(1000, indices);
+    QCOMPARE(indices.count(), 1);
+    QCOMPARE(indices.at(0), 0);
+
+    tl.activeAt(1800, indices);
+    QCOMPARE(indices.count(), 3);
+    QCOMPARE(indices.at(0), 0);
+    QCOMPARE(indices.at(1), 1);
+    QCOMPARE(indices.at(2), 2);
+
+    // items stopping exactly at the given time are not active anymore
+    tl.activeAt(2000, indices);
+    QCOMPARE(indices.count(), 2);
+    QCOMPARE(indices.at(0), 0);
+    QCOMPARE(indices.at(1), 2);
+
+    tl.activeAt(5500, indices);
+    QCOMPARE(indices.count(), 2);
+    QCOMPARE(indices.at(0), 0);
+    QCOMPARE(indices.at(1), 3);
+
+    tl.activeAt(10000, indices);
+    QCOMPARE(indices.count(), 0);
+}
+
+void ShowTimeline_Test::activeAtMany()
+{
+    ShowTimeline tl;
+
+    // 5000 items of a 2 hours show, overlapping in different ways
+    for (quint32 i = 0; i < 5000; i++)
+    {
+        quint32 start = (i * 7919) % 7200000;
+        tl.append(makeItem(i % 16, start, start + 1000 + (i % 13) * 10000));
+    }
+    tl.build();
+
+    QVector<int> indices;
+
+    for (quint32 time = 0; time < 7400000; time += 123457)
+    {
+        tl.activeAt(time, indices);
+
+        QVector<int> expected;
+        for (int i = 0; i < tl.count(); i++)
+        {
+            if (tl.at(i).startTime < time && tl.at(i).stopTime > time)
+                expected.append(i);
+        }
+
+        QCOMPARE(indices, expected);
+    }
+}
+
+QTEST_APPLESS_MAIN(ShowTimeline_Test)
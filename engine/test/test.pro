@@ -1,4 +1,7 @@
 TEMPLATE = subdirs
+SUBDIRS += audiopreprocessor
+SUBDIRS += audiospectrumbus
+SUBDIRS += beatclock
 SUBDIRS += bus
 SUBDIRS += channelsgroup
 SUBDIRS += channelmodifier
@@ -22,6 +25,7 @@ SUBDIRS += grandmaster
 SUBDIRS += inputoutputmap
 SUBDIRS += inputpatch
 SUBDIRS += keypadparser
+SUBDIRS += latencytracer
 SUBDIRS += mastertimer
 SUBDIRS += monitorproperties
 SUBDIRS += outputpatch
@@ -42,10 +46,12 @@ SUBDIRS += qlcpalette
 SUBDIRS += qlcphysical
 SUBDIRS += qlcpoint
 SUBDIRS += rgbalgorithm
+SUBDIRS += rgbimage
 SUBDIRS += rgbmatrix
 SUBDIRS += rgbplain
 SUBDIRS += rgbscript
 SUBDIRS += rgbtext
+SUBDIRS += rgbvideo
 SUBDIRS += scene
 SUBDIRS += scenevalue
 SUBDIRS += script
@@ -53,6 +59,7 @@ SUBDIRS += sequence
 SUBDIRS += show
 SUBDIRS += showfunction
 SUBDIRS += showrunner
+SUBDIRS += showtimeline
 SUBDIRS += track
 SUBDIRS += universe
 SUBDIRS += video
@@ -335,6 +335,35 @@ void Universe_Test::write()
     QCOMPARE(quint8(m_uni->postGMValues()->at(0)), quint8(127));
 }
 
+void Universe_Test::writeLayer()
+{
+    m_uni->setChannelCapability(10, QLCChannel::Intensity);
+
+    QVERIFY(m_uni->write(10, 100) == true);
+
+    uchar values[] = { 50, 60, 70 };
+    uchar mask[] = { 0xFF, 0xFF, 0x00 };
+
+    // HTP channel keeps the highest value, masked out channels are not touched
+    m_uni->writeLayer(10, values, mask, 3);
+    QCOMPARE(quint8(m_uni->preGMValues().at(10)), quint8(100));
+    QCOMPARE(quint8(m_uni->preGMValues().at(11)), quint8(60));
+    QCOMPARE(quint8(m_uni->preGMValues().at(12)), quint8(0));
+    QCOMPARE(quint8(m_uni->postGMValues()->at(11)), quint8(60));
+
+    values[0] = 150;
+    values[1] = 10;
+    m_uni->writeLayer(10, values, mask, 3);
+    QCOMPARE(quint8(m_uni->preGMValues().at(10)), quint8(150));
+    QCOMPARE(quint8(m_uni->preGMValues().at(11)), quint8(10));
+    QCOMPARE(quint8(m_uni->preGMValues().at(12)), quint8(0));
+
+    // Grand Master is applied as with any other write
+    m_gm->setValue(127);
+    m_uni->writeLayer(10, values, mask, 3);
+    QCOMPARE(quint8(m_uni->postGMValues()->at(10)), quint8(75));
+}
+
 void Universe_Test::writeRelative()
 {
     // 127 == 0
@@ -456,6 +485,89 @@ void Universe_Test::reset()
         QCOMPARE((int)m_uni->postGMValues()->at(i), 0);
 }
 
+void Universe_Test::snapshot()
+{
+    m_uni->setChannelCapability(0, QLCChannel::Intensity);
+    m_uni->setChannelCapability(1, QLCChannel::Pan);
+
+    // nothing published yet
+    QCOMPARE(m_uni->snapshotPreGMValue(0), uchar(0));
+    QCOMPARE(m_uni->snapshotPostGMValue(0), uchar(0));
+
+    m_gm->setValue(127);
+    m_uni->write(0, 200);
+    m_uni->write(1, 100);
+
+    // values are not visible until the snapshot is published
+    QCOMPARE(m_uni->snapshotPreGMValue(0), uchar(0));
+    QCOMPARE(m_uni->snapshotPreGMValue(1), uchar(0));
+
+    m_uni->publishSnapshot();
+    QCOMPARE(m_uni->snapshotPreGMValue(0), uchar(200));
+    QCOMPARE(m_uni->snapshotPreGMValue(1), uchar(100));
+    QCOMPARE(m_uni->snapshotPostGMValue(0), m_uni->postGMValue(0));
+    QCOMPARE(m_uni->snapshotPostGMValue(1), uchar(100));
+
+    QByteArray preGM = m_uni->snapshotPreGMValues();
+    QCOMPARE(preGM.length(), UNIVERSE_SIZE);
+    QCOMPARE(preGM, m_uni->preGMValues());
+    QCOMPARE(m_uni->snapshotPostGMValues(), *m_uni->postGMValues());
+
+    // out of range addresses
+    QCOMPARE(m_uni->snapshotPreGMValue(-1), uchar(0));
+    QCOMPARE(m_uni->snapshotPostGMValue(UNIVERSE_SIZE), uchar(0));
+}
+
+void Universe_Test::highPrecision()
+{
+    m_uni->setChannelCapability(0, QLCChannel::Intensity);
+    m_uni->setChannelCapability(1, QLCChannel::Intensity);
+    m_uni->setChannelCapability(2, QLCChannel::Intensity);
+    m_uni->setChannelFine(0, 1);
+
+    // without high precision, values are rounded to 8 bit
+    QVERIFY(m_uni->highPrecision() == false);
+    QVERIFY(m_uni->writeBlendedHighPrecision(0, 0x1080, Universe::NormalBlend) == true);
+    QCOMPARE(m_uni->postGMValue(0), uchar(0x11));
+    QCOMPARE(m_uni->postGMValue(1), uchar(0));
+
+    m_uni->reset();
+    m_uni->setHighPrecision(true);
+    QVERIFY(m_uni->highPrecision() == true);
+
+    // the fractional part is output on the fine channel
+    QVERIFY(m_uni->writeBlendedHighPrecision(0, 0x8040, Universe::NormalBlend) == true);
+    QCOMPARE(m_uni->preGMValue(0), uchar(0x80));
+    QCOMPARE(m_uni->postGMValue(0), uchar(0x80));
+    QCOMPARE(m_uni->postGMValue(1), uchar(0x40));
+
+    // HTP is checked with the extra precision
+    QVERIFY(m_uni->writeBlendedHighPrecision(0, 0x8020, Universe::NormalBlend) == false);
+    QVERIFY(m_uni->writeBlendedHighPrecision(0, 0x8060, Universe::NormalBlend) == true);
+    QCOMPARE(m_uni->postGMValue(1), uchar(0x60));
+
+    // Grand Master is applied to the coarse/fine pair as a whole
+    m_gm->setValueMode(GrandMaster::Limit);
+    m_gm->setValue(0x40);
+    QCOMPARE(m_uni->postGMValue(0), uchar(0x40));
+    QCOMPARE(m_uni->postGMValue(1), uchar(0x40));
+    m_gm->setValue(255);
+    QCOMPARE(m_uni->postGMValue(0), uchar(0x80));
+    QCOMPARE(m_uni->postGMValue(1), uchar(0x60));
+
+    // a plain write on the fine channel is used as is
+    m_uni->reset();
+    m_uni->write(0, 0x20);
+    m_uni->write(1, 0x30);
+    QCOMPARE(m_uni->postGMValue(0), uchar(0x20));
+    QCOMPARE(m_uni->postGMValue(1), uchar(0x30));
+
+    // a channel without fine channel gets a rounded value
+    QVERIFY(m_uni->writeBlendedHighPrecision(2, 0x1080, Universe::NormalBlend) == true);
+    QCOMPARE(m_uni->preGMValue(2), uchar(0x10));
+    QCOMPARE(m_uni->postGMValue(2), uchar(0x11));
+}
+
 void Universe_Test::loadEmpty()
 {
     QBuffer buffer;
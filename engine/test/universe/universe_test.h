@@ -43,8 +43,11 @@ private slots:
     void grandMasterAllChannelsLimit();
     void applyGM();
     void write();
+    void writeLayer();
     void writeRelative();
     void reset();
+    void snapshot();
+    void highPrecision();
 
     void loadEmpty();
     void loadPassthroughTrue();
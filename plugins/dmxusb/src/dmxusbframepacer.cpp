@@ -0,0 +1,239 @@
+/*
+  Q Light Controller Plus
+  dmxusbframepacer.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QElapsedTimer>
+#include <QCoreApplication>
+#include <QSettings>
+#include <QThread>
+#include <QDebug>
+
+#if defined(Q_OS_UNIX)
+  #include <pthread.h>
+  #include <sched.h>
+  #include <errno.h>
+  #include <string.h>
+  #include <time.h>
+#endif
+
+#include "dmxusbframepacer.h"
+
+/* Weight of a new sample in the smoothed statistics */
+#define STATS_SMOOTHING     0.0625
+
+#if defined(Q_OS_UNIX) && !defined(Q_OS_MACOS) && !defined(Q_OS_IOS)
+  #define USE_CLOCK_NANOSLEEP
+#endif
+
+#define NSEC_PER_SEC    1000000000LL
+
+DMXUSBFramePacer::DMXUSBFramePacer()
+    : m_frameTimeNs(0)
+    , m_deadline(0)
+    , m_lastWakeUp(0)
+    , m_avgPeriodNs(0)
+    , m_avgJitterNs(0)
+    , m_rateMilliHz(0)
+    , m_jitterUs(0)
+    , m_framesCount(0)
+    , m_lateFramesCount(0)
+{
+}
+
+DMXUSBFramePacer::~DMXUSBFramePacer()
+{
+}
+
+void DMXUSBFramePacer::setFrameTime(int frameTimeUs)
+{
+    m_frameTimeNs = qint64(frameTimeUs) * 1000;
+}
+
+int DMXUSBFramePacer::frameTime() const
+{
+    return int(m_frameTimeNs / 1000);
+}
+
+void DMXUSBFramePacer::start()
+{
+    m_deadline = now();
+    m_lastWakeUp = m_deadline;
+    m_avgPeriodNs = double(m_frameTimeNs);
+    m_avgJitterNs = 0;
+
+    m_rateMilliHz.storeRelease(0);
+    m_jitterUs.storeRelease(0);
+    m_framesCount.storeRelease(0);
+    m_lateFramesCount.storeRelease(0);
+}
+
+bool DMXUSBFramePacer::waitNextFrame()
+{
+    bool onTime = true;
+
+    m_deadline += m_frameTimeNs;
+
+    qint64 current = now();
+    if (current > m_deadline)
+    {
+        // The frame took longer than expected. If it took more than a whole
+        // frame, realign to the current time instead of sending a burst of
+        // frames to catch up.
+        if (current - m_deadline > m_frameTimeNs)
+            m_deadline = current;
+        m_lateFramesCount.ref();
+        onTime = false;
+    }
+    else
+    {
+        sleepUntil(m_deadline);
+        current = now();
+    }
+
+    qint64 period = current - m_lastWakeUp;
+    m_lastWakeUp = current;
+
+    m_avgPeriodNs += (double(period) - m_avgPeriodNs) * STATS_SMOOTHING;
+    m_avgJitterNs += (qAbs(double(period - m_frameTimeNs)) - m_avgJitterNs) * STATS_SMOOTHING;
+
+    if (m_avgPeriodNs > 0)
+        m_rateMilliHz.storeRelease(int((NSEC_PER_SEC * 1000.0) / m_avgPeriodNs));
+    m_jitterUs.storeRelease(int(m_avgJitterNs / 1000.0));
+    m_framesCount.ref();
+
+    return onTime;
+}
+
+void DMXUSBFramePacer::sleepFor(int usecs)
+{
+    if (usecs <= 0)
+        return;
+
+#if defined(USE_CLOCK_NANOSLEEP)
+    sleepUntil(now() + qint64(usecs) * 1000);
+#else
+    QThread::usleep(usecs);
+#endif
+}
+
+bool DMXUSBFramePacer::setRealtimeScheduling()
+{
+#if defined(Q_OS_UNIX)
+    struct sched_param param;
+    memset(&param, 0, sizeof(param));
+    // stay below the kernel threads and the audio servers
+    param.sched_priority = qMax(sched_get_priority_min(SCHED_FIFO),
+                                sched_get_priority_max(SCHED_FIFO) / 2);
+
+    int ret = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if (ret != 0)
+    {
+        qWarning() << "[DMXUSB] Unable to set real time scheduling:" << strerror(ret);
+        return false;
+    }
+
+    qDebug() << "[DMXUSB] Real time scheduling enabled with priority" << param.sched_priority;
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool DMXUSBFramePacer::realtimeSchedulingEnabled()
+{
+    QSettings settings;
+    QVariant var = settings.value(SETTINGS_REALTIME_SCHEDULING);
+    if (var.isValid())
+        return var.toBool();
+
+    return false;
+}
+
+qint64 DMXUSBFramePacer::now()
+{
+#if defined(USE_CLOCK_NANOSLEEP)
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return qint64(ts.tv_sec) * NSEC_PER_SEC + ts.tv_nsec;
+#else
+    static QElapsedTimer clock;
+    if (clock.isValid() == false)
+        clock.start();
+    return clock.nsecsElapsed();
+#endif
+}
+
+void DMXUSBFramePacer::sleepUntil(qint64 deadline)
+{
+#if defined(USE_CLOCK_NANOSLEEP)
+    struct timespec ts;
+    ts.tv_sec = deadline / NSEC_PER_SEC;
+    ts.tv_nsec = deadline % NSEC_PER_SEC;
+
+    // an absolute sleep can simply be restarted when interrupted by a signal
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {}
+#else
+    qint64 remaining = deadline - now();
+    if (remaining > 0)
+        QThread::usleep((remaining + 500) / 1000);
+#endif
+}
+
+/*********************************************************************
+ * Statistics
+ *********************************************************************/
+
+double DMXUSBFramePacer::refreshRate() const
+{
+    return double(m_rateMilliHz.loadAcquire()) / 1000.0;
+}
+
+int DMXUSBFramePacer::jitter() const
+{
+    return m_jitterUs.loadAcquire();
+}
+
+int DMXUSBFramePacer::framesCount() const
+{
+    return m_framesCount.loadAcquire();
+}
+
+int DMXUSBFramePacer::lateFramesCount() const
+{
+    return m_lateFramesCount.loadAcquire();
+}
+
+QString DMXUSBFramePacer::statisticsInfo() const
+{
+    QString info;
+
+    if (framesCount() == 0)
+        return info;
+
+    info += QString("<BR>");
+    info += QString("<B>%1:</B> %2Hz").arg(QCoreApplication::translate("DMXUSBFramePacer", "Measured Frame Frequency"))
+                                      .arg(refreshRate(), 0, 'f', 1);
+    info += QString("<BR>");
+    info += QString("<B>%1:</B> %2us").arg(QCoreApplication::translate("DMXUSBFramePacer", "Frame Jitter"))
+                                      .arg(jitter());
+    info += QString("<BR>");
+    info += QString("<B>%1:</B> %2/%3").arg(QCoreApplication::translate("DMXUSBFramePacer", "Late Frames"))
+                                       .arg(lateFramesCount()).arg(framesCount());
+
+    return info;
+}
@@ -0,0 +1,135 @@
+/*
+  Q Light Controller Plus
+  dmxusbframepacer.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef DMXUSBFRAMEPACER_H
+#define DMXUSBFRAMEPACER_H
+
+#include <QAtomicInt>
+#include <QString>
+
+#define SETTINGS_REALTIME_SCHEDULING "dmxusb/realtimescheduling"
+
+/**
+ * DMXUSBFramePacer paces the output loop of a DMX USB widget thread.
+ *
+ * Frames are scheduled against absolute deadlines on a monotonic clock,
+ * so the time spent writing a frame never accumulates as drift and the
+ * thread sleeps (instead of spinning) between frames. Where the OS allows
+ * it, sleeps are performed with clock_nanosleep(TIMER_ABSTIME).
+ *
+ * The pacer also keeps track of the achieved refresh rate and of the
+ * frame period jitter, which are meant to be read from other threads to
+ * display them in the plugin information.
+ */
+class DMXUSBFramePacer
+{
+public:
+    DMXUSBFramePacer();
+    ~DMXUSBFramePacer();
+
+    /** Set the duration of a DMX frame in microseconds */
+    void setFrameTime(int frameTimeUs);
+
+    /** Get the duration of a DMX frame in microseconds */
+    int frameTime() const;
+
+    /**
+     * Reset the frame deadline to the current time and clear the statistics.
+     * This must be called by the paced thread before the first frame.
+     */
+    void start();
+
+    /**
+     * Sleep until the deadline of the next frame and update the statistics.
+     * If the current frame took more than a whole frame time, the deadline
+     * is realigned to the current time instead of trying to catch up.
+     *
+     * @return false if the frame was late, otherwise true
+     */
+    bool waitNextFrame();
+
+    /** Sleep for the given amount of microseconds, with sub-millisecond
+     *  accuracy where the OS allows it. Used for DMX BREAK and MAB. */
+    static void sleepFor(int usecs);
+
+    /**
+     * Switch the calling thread to the SCHED_FIFO real time policy,
+     * if the OS supports it and the user has enough privileges.
+     *
+     * @return true on success, otherwise false
+     */
+    static bool setRealtimeScheduling();
+
+    /** Return true if the user enabled real time scheduling in the settings */
+    static bool realtimeSchedulingEnabled();
+
+private:
+    /** Return the current monotonic time in nanoseconds */
+    static qint64 now();
+
+    /** Sleep until the given monotonic time in nanoseconds */
+    static void sleepUntil(qint64 deadline);
+
+private:
+    /** The frame time in nanoseconds */
+    qint64 m_frameTimeNs;
+
+    /** The absolute time when the next frame should start */
+    qint64 m_deadline;
+
+    /** The time the last frame actually started */
+    qint64 m_lastWakeUp;
+
+    /** Smoothed frame period and period deviation, in nanoseconds.
+     *  Accessed by the paced thread only */
+    double m_avgPeriodNs;
+    double m_avgJitterNs;
+
+    /*********************************************************************
+     * Statistics
+     *********************************************************************/
+public:
+    /** Get the achieved refresh rate in Hertz */
+    double refreshRate() const;
+
+    /** Get the average deviation of the frame period in microseconds */
+    int jitter() const;
+
+    /** Get the number of frames sent since start() */
+    int framesCount() const;
+
+    /** Get the number of frames that missed their deadline since start() */
+    int lateFramesCount() const;
+
+    /** Return the statistics formatted for the plugin additional info,
+     *  or an empty string if no frame has been sent yet */
+    QString statisticsInfo() const;
+
+private:
+    /** Achieved refresh rate in mHz, smoothed */
+    QAtomicInt m_rateMilliHz;
+
+    /** Frame period jitter in microseconds, smoothed */
+    QAtomicInt m_jitterUs;
+
+    QAtomicInt m_framesCount;
+    QAtomicInt m_lateFramesCount;
+};
+
+#endif
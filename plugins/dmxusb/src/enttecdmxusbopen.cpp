@@ -131,6 +131,7 @@ QString EnttecDMXUSBOpen::additionalInfo() const
     else
         gran = tr("Patch this widget to a universe to find out.");
     info += QString("<B>%1:</B> %2").arg(tr("System Timer Accuracy")).arg(gran);
+    info += m_pacer.statisticsInfo();
     info += QString("</P>");
 
     return info;
@@ -187,32 +188,36 @@ void EnttecDMXUSBOpen::run()
         }
     }
 
+    if (DMXUSBFramePacer::realtimeSchedulingEnabled())
+        DMXUSBFramePacer::setRealtimeScheduling();
+
+    m_pacer.setFrameTime(m_frameTimeUs);
+    m_pacer.start();
+
     m_running = true;
     while (m_running == true)
     {
-        // Measure how much time passes during these calls
-        time.restart();
+        // the output frequency might have been changed in the meantime
+        m_pacer.setFrameTime(m_frameTimeUs);
 
         if (iface()->setBreak(true) == false)
             goto framesleep;
 
         if (m_granularity == Good)
-            usleep(DMX_BREAK);
+            DMXUSBFramePacer::sleepFor(DMX_BREAK);
 
         if (iface()->setBreak(false) == false)
             goto framesleep;
 
         if (m_granularity == Good)
-            usleep(DMX_MAB);
+            DMXUSBFramePacer::sleepFor(DMX_MAB);
 
         if (iface()->write(m_portsInfo[0].m_universeData) == false)
             goto framesleep;
 
 framesleep:
-        // Sleep for the remainder of the DMX frame time
-        if (m_granularity == Good)
-            while (time.elapsed() < (m_frameTimeUs / 1000)) { usleep(1000); }
-        else
-            while (time.elapsed() < (m_frameTimeUs / 1000)) { /* Busy sleep */ }
+        // Sleep until the start of the next DMX frame. Deadlines are
+        // absolute, so the time spent above does not accumulate as drift
+        m_pacer.waitNextFrame();
     }
 }
@@ -24,6 +24,7 @@
 #include <QByteArray>
 #include <QThread>
 
+#include "dmxusbframepacer.h"
 #include "dmxusbwidget.h"
 
 class EnttecDMXUSBOpen final : public QThread, public DMXUSBWidget
@@ -88,6 +89,9 @@ protected:
 protected:
     bool m_running;
     TimerGranularity m_granularity;
+
+    /** Paces the DMX frames and measures the achieved refresh rate */
+    DMXUSBFramePacer m_pacer;
 };
 
 #endif
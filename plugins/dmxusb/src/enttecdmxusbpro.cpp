@@ -319,6 +319,7 @@ QString EnttecDMXUSBPro::additionalInfo() const
     info += QString("<B>%1:</B> %2").arg(tr("Manufacturer")).arg(vendor());
     info += QString("<BR>");
     info += QString("<B>%1:</B> %2").arg(tr("Serial number")).arg(m_proSerial);
+    info += m_pacer.statisticsInfo();
     info += QString("</P>");
 
     return info;
@@ -678,17 +679,23 @@ bool EnttecDMXUSBPro::writeUniverse(quint32 universe, quint32 output, const QByt
 void EnttecDMXUSBPro::run()
 {
     qDebug() << "ENTTEC PRO: INPUT/OUTPUT thread started";
-    QElapsedTimer timer;
 
     /** Flag that indicates if the IO thread
      *  should read input data as well */
     bool readInput = false;
 
+    if (DMXUSBFramePacer::realtimeSchedulingEnabled())
+        DMXUSBFramePacer::setRealtimeScheduling();
+
+    m_pacer.setFrameTime(m_frameTimeUs);
+    m_pacer.start();
+
     m_isThreadRunning = true;
 
     while (m_isThreadRunning == true)
     {
-        timer.restart();
+        // the output frequency might have been changed in the meantime
+        m_pacer.setFrameTime(m_frameTimeUs);
 
         /* **************************************************************
          *                       CHECK PENDING ACTIONS
@@ -1020,11 +1027,8 @@ void EnttecDMXUSBPro::run()
         }
 
 framesleep:
-        int timetoSleep = m_frameTimeUs - (timer.nsecsElapsed() / 1000);
-        if (timetoSleep < 0)
-            qWarning() << "DMX output is running late!";
-        else
-            usleep(timetoSleep);
+        if (m_pacer.waitNextFrame() == false)
+            qDebug() << "DMX output is running late!";
     }
 
     qDebug() << "INPUT/OUTPUT thread terminated";
@@ -24,6 +24,7 @@
 #include <QVariant>
 #include <QThread>
 
+#include "dmxusbframepacer.h"
 #include "dmxusbwidget.h"
 
 #define ULTRADMX_PRO_DEV_ID      0x02
@@ -163,6 +164,9 @@ private:
      *  operations and guarantee thread safety */
     QList<InterfaceAction> m_actionsQueue;
 
+    /** Paces the output frames and measures the achieved refresh rate */
+    DMXUSBFramePacer m_pacer;
+
     /********************************************************************
      * RDM
      ********************************************************************/
@@ -105,6 +105,7 @@ HEADERS += ../../interfaces/qlcioplugin.h
            ../../interfaces/rdmprotocol.h
 
 HEADERS += dmxusb.h \
+           dmxusbframepacer.h \
            dmxusbwidget.h \
            dmxusbconfig.h \
            enttecdmxusbpro.h \
@@ -122,6 +123,7 @@ SOURCES += ../../interfaces/qlcioplugin.cpp \
 
 SOURCES += dmxinterface.cpp \
            dmxusb.cpp \
+           dmxusbframepacer.cpp \
            dmxusbwidget.cpp \
            dmxusbconfig.cpp \
            enttecdmxusbpro.cpp \
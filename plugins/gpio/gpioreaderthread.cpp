@@ -19,18 +19,29 @@
 
 #include <QDebug>
 
-#include <gpiod.hpp>
+#include <chrono>
+#include <vector>
 
 #include "gpioreaderthread.h"
 #include "gpioplugin.h"
 
+/** Number of polling passes a new value must be read before being accepted */
 #define HYSTERESIS_THRESHOLD  3
 
+/** Polling period, and the maximum time an edge events wait can block */
+#define POLL_INTERVAL_MS      50
+
+/** Edges following an accepted edge within this time are bounces */
+#define DEBOUNCE_TIME_NS      10000000LL
+
 ReadThread::ReadThread(GPIOPlugin *plugin, QObject *parent)
     : QThread(parent)
     , m_plugin(plugin)
     , m_running(false)
     , m_paused(false)
+    , m_eventMode(true)
+    , m_linesChanged(true)
+    , m_linesReleased(true)
 {
     start();
 }
@@ -55,6 +66,12 @@ void ReadThread::pause(bool paused)
     qDebug() << Q_FUNC_INFO << paused;
     QMutexLocker locker(&m_mutex);
     m_paused = paused;
+    m_linesChanged = true;
+
+    // lines might be about to be requested as outputs,
+    // so wait for the thread to release them
+    if (paused && m_linesReleased == false && isRunning())
+        m_releasedCondition.wait(&m_mutex, POLL_INTERVAL_MS * 4);
 }
 
 void ReadThread::run()
@@ -62,47 +79,220 @@ void ReadThread::run()
     qDebug() << "[GPIO] Reader thread created";
     m_running = true;
 
-    ::gpiod::chip gChip(m_plugin->chipName());
+    m_chip = ::gpiod::chip(m_plugin->chipName());
+    m_clock.start();
 
     while (m_running == true)
     {
-        if (m_paused == true)
         {
-            usleep(50000);
-            continue;
-        }
+            QMutexLocker locker(&m_mutex);
+            if (m_paused == true)
+            {
+                releaseLines();
+                locker.unlock();
+                msleep(POLL_INTERVAL_MS);
+                continue;
+            }
 
-        QMutexLocker locker(&m_mutex);
+            if (m_eventMode && m_linesChanged)
+            {
+                m_linesChanged = false;
+                releaseLines();
+                m_eventMode = requestLines();
+            }
+        }
 
-        foreach (GPIOLineInfo *gpio, m_plugin->gpioList())
+        if (m_eventMode)
         {
-            if (gpio->m_direction != GPIOPlugin::InputDirection)
-                continue;
+            waitEvents();
+        }
+        else
+        {
+            pollLines();
+            msleep(POLL_INTERVAL_MS);
+        }
+    }
 
-            ::gpiod::line gLine = gChip.get_line(gpio->m_line);
-            gLine.request({"get_value", gpiod::line_request::DIRECTION_INPUT, 0}, 0);
-            int newVal = gLine.get_value();
-            gLine.release();
+    QMutexLocker locker(&m_mutex);
+    releaseLines();
+}
 
-            if (newVal != gpio->m_value)
-            {
-                gpio->m_count++;
-                if (gpio->m_count > HYSTERESIS_THRESHOLD)
-                {
-                    qDebug() << "Value read: GPIO:" << gpio->m_line << "val:" <<  newVal;
-                    gpio->m_value = newVal ? UCHAR_MAX : 0;
-                    gpio->m_count = 0;
-                    emit valueChanged(gpio->m_line, gpio->m_value);
-                }
-            }
-            else
+void ReadThread::setLineLevel(GPIOLineInfo *gpio, int level)
+{
+    uchar value = level ? UCHAR_MAX : 0;
+    if (value == gpio->m_value)
+        return;
+
+    qDebug() << "Value read: GPIO:" << gpio->m_line << "val:" << level;
+    gpio->m_value = value;
+    emit valueChanged(gpio->m_line, gpio->m_value);
+}
+
+/*********************************************************************
+ * Polling
+ *********************************************************************/
+
+void ReadThread::pollLines()
+{
+    QMutexLocker locker(&m_mutex);
+
+    foreach (GPIOLineInfo *gpio, m_plugin->gpioList())
+    {
+        if (gpio->m_direction != GPIOPlugin::InputDirection)
+            continue;
+
+        ::gpiod::line gLine = m_chip.get_line(gpio->m_line);
+        gLine.request({"get_value", gpiod::line_request::DIRECTION_INPUT, 0}, 0);
+        int newVal = gLine.get_value();
+        gLine.release();
+
+        if ((newVal ? UCHAR_MAX : 0) != gpio->m_value)
+        {
+            gpio->m_count++;
+            if (gpio->m_count > HYSTERESIS_THRESHOLD)
             {
                 gpio->m_count = 0;
+                setLineLevel(gpio, newVal);
             }
         }
-        locker.unlock();
+        else
+        {
+            gpio->m_count = 0;
+        }
+    }
+}
+
+/*********************************************************************
+ * Edge events
+ *********************************************************************/
+
+bool ReadThread::requestLines()
+{
+    std::vector<unsigned int> offsets;
+
+    foreach (GPIOLineInfo *gpio, m_plugin->gpioList())
+    {
+        if (gpio->m_direction == GPIOPlugin::InputDirection)
+            offsets.push_back(gpio->m_line);
+    }
+
+    if (offsets.empty())
+        return true;
+
+    try
+    {
+        m_lines = m_chip.get_lines(offsets);
+        m_lines.request({"qlcplus", ::gpiod::line_request::EVENT_BOTH_EDGES, 0});
+    }
+    catch (const std::exception &e)
+    {
+        qWarning() << "[GPIO] Edge events not available, falling back to polling:" << e.what();
+        m_lines = ::gpiod::line_bulk();
+        return false;
+    }
+
+    m_linesReleased = false;
+
+    // the initial levels are not reported as events
+    std::vector<int> levels = m_lines.get_values();
 
-        usleep(50000);
+    for (unsigned int i = 0; i < m_lines.size(); i++)
+    {
+        GPIOLineInfo *gpio = m_plugin->gpioList().at(m_lines[i].offset());
+
+        LineDebounce db;
+        db.m_index = i;
+        db.m_lastEdge = -1;
+        db.m_bouncing = false;
+        db.m_settleTime = 0;
+        m_debounce[gpio->m_line] = db;
+
+        setLineLevel(gpio, levels.at(i));
     }
+
+    qDebug() << "[GPIO] Requested" << m_lines.size() << "input lines for edge events";
+
+    return true;
 }
 
+void ReadThread::releaseLines()
+{
+    if (m_lines.empty() == false)
+        m_lines.release();
+
+    m_lines = ::gpiod::line_bulk();
+    m_debounce.clear();
+
+    m_linesReleased = true;
+    m_releasedCondition.wakeAll();
+}
+
+void ReadThread::waitEvents()
+{
+    if (m_lines.empty())
+    {
+        msleep(POLL_INTERVAL_MS);
+        return;
+    }
+
+    // never block longer than the next bouncing line check
+    qint64 now = m_clock.nsecsElapsed();
+    qint64 timeout = POLL_INTERVAL_MS * 1000000LL;
+
+    foreach (const LineDebounce &db, m_debounce)
+    {
+        if (db.m_bouncing)
+            timeout = qMax(0LL, qMin(timeout, db.m_settleTime - now));
+    }
+
+    // the mutex is not held here, so pause() can get in
+    ::gpiod::line_bulk events = m_lines.event_wait(std::chrono::nanoseconds(timeout));
+
+    QMutexLocker locker(&m_mutex);
+
+    if (m_paused || m_linesChanged)
+        return;
+
+    for (unsigned int i = 0; i < events.size(); i++)
+    {
+        ::gpiod::line_event event = events[i].event_read();
+        int level = (event.event_type == ::gpiod::line_event::RISING_EDGE) ? 1 : 0;
+        handleEdge(events[i].offset(), level, event.timestamp.count());
+    }
+
+    // read the settled level of the lines that were bouncing
+    now = m_clock.nsecsElapsed();
+
+    QMutableHashIterator<int, LineDebounce> it(m_debounce);
+    while (it.hasNext())
+    {
+        it.next();
+        LineDebounce &db = it.value();
+        if (db.m_bouncing == false || db.m_settleTime > now)
+            continue;
+
+        db.m_bouncing = false;
+        setLineLevel(m_plugin->gpioList().at(it.key()), m_lines[db.m_index].get_value());
+    }
+}
+
+void ReadThread::handleEdge(int offset, int level, qint64 timestamp)
+{
+    if (m_debounce.contains(offset) == false)
+        return;
+
+    LineDebounce &db = m_debounce[offset];
+
+    if (db.m_lastEdge >= 0 && timestamp - db.m_lastEdge < DEBOUNCE_TIME_NS)
+    {
+        // a bounce: ignore it, but check the level again once the line
+        // has been quiet for the debounce time
+        db.m_bouncing = true;
+        db.m_settleTime = m_clock.nsecsElapsed() + DEBOUNCE_TIME_NS;
+        return;
+    }
+
+    // the first edge is accepted right away, for the lowest latency
+    db.m_lastEdge = timestamp;
+    setLineLevel(m_plugin->gpioList().at(offset), level);
+}
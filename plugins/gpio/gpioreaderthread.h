@@ -20,8 +20,13 @@
 #ifndef GPIOREADERTHREAD_H
 #define GPIOREADERTHREAD_H
 
-#include <QThread>
+#include <QElapsedTimer>
+#include <QWaitCondition>
 #include <QMutexLocker>
+#include <QThread>
+#include <QHash>
+
+#include <gpiod.hpp>
 
 #include "gpioplugin.h"
 
@@ -44,11 +49,73 @@ protected:
 signals:
     void valueChanged(quint32 channel, uchar value);
 
+private:
+    /** Update the value of an input line and emit valueChanged if needed */
+    void setLineLevel(GPIOLineInfo *gpio, int level);
+
 private:
     GPIOPlugin *m_plugin;
     bool m_running;
     bool m_paused;
     QMutex m_mutex;
+
+    ::gpiod::chip m_chip;
+
+    /*********************************************************************
+     * Polling
+     *********************************************************************/
+private:
+    /** Read all the input lines once, debouncing by counting passes.
+     *  Used when the GPIO chip doesn't support edge events */
+    void pollLines();
+
+    /*********************************************************************
+     * Edge events
+     *********************************************************************/
+private:
+    /** Request all the input lines with a single edge events request.
+     *  Return false if the GPIO chip doesn't support it */
+    bool requestLines();
+
+    /** Release the lines previously requested */
+    void releaseLines();
+
+    /** Block until an edge is reported on the requested lines,
+     *  or until a line bouncing has to be checked again */
+    void waitEvents();
+
+    /** Debounce an edge of the line with the given offset,
+     *  using its kernel timestamp (in nanoseconds) */
+    void handleEdge(int offset, int level, qint64 timestamp);
+
+private:
+    typedef struct
+    {
+        /** Index of the line in m_lines */
+        int m_index;
+        /** Kernel timestamp of the last edge accepted */
+        qint64 m_lastEdge;
+        /** True if edges have been ignored, so the line level
+         *  has to be read again once it settled */
+        bool m_bouncing;
+        /** m_clock time when the line level has to be read again */
+        qint64 m_settleTime;
+    } LineDebounce;
+
+    /** True if the input lines are requested with edge events,
+     *  false if they must be polled */
+    bool m_eventMode;
+
+    /** Set when the input lines have to be requested again */
+    bool m_linesChanged;
+
+    /** Set by the thread once the lines are released on pause */
+    bool m_linesReleased;
+    QWaitCondition m_releasedCondition;
+
+    ::gpiod::line_bulk m_lines;
+    QHash<int, LineDebounce> m_debounce;
+    QElapsedTimer m_clock;
 };
 
 #endif
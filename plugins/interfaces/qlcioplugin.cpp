@@ -19,6 +19,7 @@
 */
 
 #include "qlcioplugin.h"
+#include <QDeadlineTimer>
 #include <QDebug>
 
 /*************************************************************************
@@ -95,6 +96,15 @@ void QLCIOPlugin::sendFeedBack(quint32 universe, quint32 inputLine,
     Q_UNUSED(params)
 }
 
+/*************************************************************************
+ * Clock
+ *************************************************************************/
+
+qint64 QLCIOPlugin::clockTimestamp()
+{
+    return QDeadlineTimer::current(Qt::PreciseTimer).deadlineNSecs();
+}
+
 /*************************************************************************
  * Configure
  *************************************************************************/
@@ -284,6 +284,45 @@ signals:
      */
     void valueChanged(quint32 universe, quint32 input, quint32 channel, uchar value, const QString& key = 0);
 
+    /*************************************************************************
+     * Clock
+     *************************************************************************/
+public:
+    /** Timing events that an input line can receive from a clock source */
+    enum ClockEvent
+    {
+        ClockBeat = 0,  //!< A beat. The value is its number since the transport start
+        ClockTempo,     //!< The tempo of the source. The value is in 1/1000 BPM
+        ClockStart,     //!< The transport started from the beginning
+        ClockContinue,  //!< The transport continued from its position
+        ClockStop,      //!< The transport stopped
+        ClockTimecode   //!< A time code position. The value is in milliseconds
+    };
+
+    /**
+     * Get the time base of the clock events timestamps: nanoseconds of a
+     * monotonic clock, shared with the engine. Plugins should take the
+     * timestamp as soon as an event is received.
+     */
+    static qint64 clockTimestamp();
+
+signals:
+    /**
+     * Tells that a timing event has been received on an input line.
+     * Unlike valueChanged(), clock events are not buffered and carry the
+     * time when they have been received, so the engine can follow an
+     * external clock regardless of the latency of their delivery.
+     *
+     * @param universe The universe ID detected from the data received,
+     *                 see valueChanged()
+     * @param input The input line that received the event
+     * @param event The event type, see ClockEvent
+     * @param timestamp When the event has been received, see clockTimestamp()
+     * @param value The event value, depending on its type
+     */
+    void clockEventReceived(quint32 universe, quint32 input, int event,
+                            qint64 timestamp, qint64 value);
+
     /*************************************************************************
      * Configure
      *************************************************************************/
@@ -213,6 +213,35 @@ void AlsaMidiInputThread::readEvent()
             continue;
         Q_ASSERT(device != NULL);
 
+        // timing messages feed the device clock, as soon as possible
+        switch (ev->type)
+        {
+            case SND_SEQ_EVENT_CLOCK:
+                device->processTiming(MIDI_BEAT_CLOCK, 0, 0);
+            break;
+            case SND_SEQ_EVENT_START:
+                device->processTiming(MIDI_BEAT_START, 0, 0);
+            break;
+            case SND_SEQ_EVENT_CONTINUE:
+                device->processTiming(MIDI_BEAT_CONTINUE, 0, 0);
+            break;
+            case SND_SEQ_EVENT_STOP:
+                device->processTiming(MIDI_BEAT_STOP, 0, 0);
+            break;
+            case SND_SEQ_EVENT_SONGPOS:
+                device->processTiming(MIDI_SONG_POSITION, ev->data.control.value & 0x7F,
+                                      (ev->data.control.value >> 7) & 0x7F);
+            break;
+            case SND_SEQ_EVENT_QFRAME:
+                device->processTiming(MIDI_TIME_CODE, ev->data.control.value, 0);
+            break;
+            case SND_SEQ_EVENT_SYSEX:
+                device->processSysEx((const uchar*)ev->data.ext.ptr, ev->data.ext.len);
+            break;
+            default:
+            break;
+        }
+
         uchar cmd = 0;
         uchar data1 = 0;
         uchar data2 = 0;
@@ -18,11 +18,56 @@
 */
 
 #include <alsa/asoundlib.h>
+#include <QCoreApplication>
 #include <QDebug>
 
 #include "alsamidioutputdevice.h"
 #include "midiprotocol.h"
 
+/* Fill an ALSA event with a MIDI channel message */
+static bool setupChannelEvent(snd_seq_event_t *ev, uchar cmd, uchar data1, uchar data2)
+{
+    uchar midiCmd = MIDI_CMD(cmd);
+    uchar midiCh = MIDI_CH(cmd);
+
+    switch(midiCmd)
+    {
+    case MIDI_NOTE_OFF:
+        snd_seq_ev_set_noteoff(ev, midiCh, data1, data2);
+        break;
+
+    case MIDI_NOTE_ON:
+        snd_seq_ev_set_noteon(ev, midiCh, data1, data2);
+        break;
+
+    case MIDI_CONTROL_CHANGE:
+        snd_seq_ev_set_controller(ev, midiCh, data1, data2);
+        break;
+
+    case MIDI_PROGRAM_CHANGE:
+        snd_seq_ev_set_pgmchange(ev, midiCh, data1);
+        break;
+
+    case MIDI_NOTE_AFTERTOUCH:
+        snd_seq_ev_set_keypress(ev, midiCh, data1, data2);
+        break;
+
+    case MIDI_CHANNEL_AFTERTOUCH:
+        snd_seq_ev_set_chanpress(ev, midiCh, data1);
+        break;
+
+    case MIDI_PITCH_WHEEL:
+        snd_seq_ev_set_pitchbend(ev, midiCh, ((data1 & 0x7f) | ((data2 & 0x7f) << 7)) - 8192);
+        break;
+
+    default:
+        // What to do here ??
+        return false;
+    }
+
+    return true;
+}
+
 /****************************************************************************
  * AlsaMidiOutputDevice
  ****************************************************************************/
@@ -37,7 +82,6 @@ AlsaMidiOutputDevice::AlsaMidiOutputDevice(const QVariant& uid,
     , m_alsa(alsa)
     , m_receiver_address(new snd_seq_addr_t)
     , m_open(false)
-    , m_universe(MAX_MIDI_DMX_CHANNELS, char(0))
 {
     Q_ASSERT(alsa != NULL);
     Q_ASSERT(recv_address != NULL);
@@ -46,6 +90,7 @@ AlsaMidiOutputDevice::AlsaMidiOutputDevice(const QVariant& uid,
     m_sender_address = send_address;
     qDebug() << "[AlsaMidiOutputDevice] receiver client: " << m_receiver_address->client << ", port: " << m_receiver_address->port;
     qDebug() << "[AlsaMidiOutputDevice] sender client (QLC+): " << m_sender_address->client << ", port: " << m_sender_address->port;
+    m_clock.start();
 }
 
 AlsaMidiOutputDevice::~AlsaMidiOutputDevice()
@@ -98,22 +143,11 @@ bool AlsaMidiOutputDevice::isOpen() const
 
 void AlsaMidiOutputDevice::writeChannel(ushort channel, uchar value)
 {
-    // m_universe contains scaled values (0-127), so we have to compare scaled value as well
-    // however, since writeUniverse scales the value again, we have to store unscaled value.
-    char scaled = DMX2MIDI(value);
-    if (channel < ushort(m_universe.size()) && m_universe[channel] != scaled)
-    {
-        QByteArray tmp(m_universe);
-
-        for (uchar ch = 0; ch < MAX_MIDI_DMX_CHANNELS && ch < tmp.size(); ++ch)
-        {
-           char midi = tmp[ch];
-           tmp[ch] = (char)MIDI2DMX(midi);
-        }
+    if (isOpen() == false)
+        return;
 
-        tmp[channel] = value;
-        writeUniverse(tmp);
-    }
+    m_scheduler.setChannel(channel, value);
+    sendPendingData();
 }
 
 void AlsaMidiOutputDevice::writeUniverse(const QByteArray& universe)
@@ -121,6 +155,35 @@ void AlsaMidiOutputDevice::writeUniverse(const QByteArray& universe)
     if (isOpen() == false)
         return;
 
+    // Only the latest value of each channel is kept, so a universe
+    // written before the previous one was completely sent is coalesced
+    m_scheduler.setUniverse(universe);
+    sendPendingData();
+}
+
+bool AlsaMidiOutputDevice::hasPendingData() const
+{
+    return m_scheduler.hasPendingData();
+}
+
+void AlsaMidiOutputDevice::sendPendingData()
+{
+    uchar cmd;
+
+    if (mode() == Note)
+        cmd = MIDI_NOTE_ON;
+    else if (mode() == ProgramChange)
+        cmd = MIDI_PROGRAM_CHANGE;
+    else
+        cmd = MIDI_CONTROL_CHANGE;
+
+    m_scheduler.setBandwidth(bandwidth());
+    m_scheduler.setCommand(cmd | MIDI_CH(midiChannel()), sendNoteOff());
+
+    const QVector<MidiOutputScheduler::Message>& messages = m_scheduler.schedule(m_clock.nsecsElapsed());
+    if (messages.isEmpty())
+        return;
+
     // Setup a common event structure for all values
     snd_seq_event_t ev;
     snd_seq_ev_clear(&ev);
@@ -128,56 +191,43 @@ void AlsaMidiOutputDevice::writeUniverse(const QByteArray& universe)
     //snd_seq_ev_set_subs(&ev);
     snd_seq_ev_set_direct(&ev);
 
-    // Since MIDI devices can have only 128 real channels, we don't
-    // attempt to write more than that.
-    for (uchar channel = 0; channel < MAX_MIDI_DMX_CHANNELS &&
-                            channel < universe.size(); channel++)
+    foreach (const MidiOutputScheduler::Message &msg, messages)
     {
-        // Scale 0-255 to 0-127
-        char scaled = DMX2MIDI(universe[channel]);
-        bool invalidData = false;
-
-        // Since MIDI is so slow, we only send values that are actually changed
-        if (m_universe[channel] == scaled)
+        if (setupChannelEvent(&ev, msg.cmd, msg.data1, msg.data2) == false)
             continue;
 
-        // Store the changed MIDI value
-        m_universe[channel] = scaled;
-
-        if (mode() == Note)
-        {
-            qDebug() << "Send out NOTE";
-            // 0 is sent as a note off
-            // 1-127 is sent as note on
-            if (scaled == 0)
-                snd_seq_ev_set_noteoff(&ev, midiChannel(), channel, scaled);
-            else
-                snd_seq_ev_set_noteon(&ev, midiChannel(), channel, scaled);
-        }
-        else if (mode() == ProgramChange)
-        {
-            qDebug() << "Send out Program Change";
-            snd_seq_ev_set_pgmchange(&ev, midiChannel(), channel);
-        }
-        else if (mode() == ControlChange)
-        {
-            qDebug() << "Send out CC. Channel: " << midiChannel() << ", CC: " << channel << ", val: " << scaled;
-
-            // Control change
-            snd_seq_ev_set_controller(&ev, midiChannel(), channel, scaled);
-        }
-        else
-            invalidData = true;
-
-        if (!invalidData)
-            if (snd_seq_event_output(m_alsa, &ev) < 0)
-                qDebug() << "snd_seq_event_output ERROR";
+        if (snd_seq_event_output(m_alsa, &ev) < 0)
+            qDebug() << "snd_seq_event_output ERROR";
     }
 
-    // Make sure that all values go to the MIDI endpoint
+    // Make sure that all the values of this write go to the MIDI endpoint
     snd_seq_drain_output(m_alsa);
 }
 
+QString AlsaMidiOutputDevice::statisticsInfo() const
+{
+    QString info;
+
+    info += QString("<BR>");
+    if (bandwidth() == 0)
+        info += QString("%1: %2").arg(QCoreApplication::translate("MidiPlugin", "Bandwidth"))
+                                 .arg(QCoreApplication::translate("MidiPlugin", "Unlimited"));
+    else
+        info += QString("%1: %2 bytes/s").arg(QCoreApplication::translate("MidiPlugin", "Bandwidth"))
+                                         .arg(bandwidth());
+    info += QString("<BR>");
+    info += QString("%1: %2").arg(QCoreApplication::translate("MidiPlugin", "Messages sent"))
+                             .arg(m_scheduler.sentCount());
+    info += QString("<BR>");
+    info += QString("%1: %2").arg(QCoreApplication::translate("MidiPlugin", "Messages deferred"))
+                             .arg(m_scheduler.deferredCount());
+    info += QString("<BR>");
+    info += QString("%1: %2").arg(QCoreApplication::translate("MidiPlugin", "Values coalesced"))
+                             .arg(m_scheduler.coalescedCount());
+
+    return info;
+}
+
 void AlsaMidiOutputDevice::writeFeedback(uchar cmd, uchar data1, uchar data2)
 {
     if (isOpen() == false)
@@ -190,51 +240,15 @@ void AlsaMidiOutputDevice::writeFeedback(uchar cmd, uchar data1, uchar data2)
     //snd_seq_ev_set_subs(&ev);
     snd_seq_ev_set_direct(&ev);
 
-    uchar midiCmd = MIDI_CMD(cmd);
-    uchar midiCh = MIDI_CH(cmd);
-
-    bool invalidCmd = false;
-
-    switch(midiCmd)
-    {
-    case MIDI_NOTE_OFF:
-        snd_seq_ev_set_noteoff(&ev, midiCh, data1, data2);
-        break;
-
-    case MIDI_NOTE_ON:
-        snd_seq_ev_set_noteon(&ev, midiCh, data1, data2);
-        break;
-
-    case MIDI_CONTROL_CHANGE:
-        snd_seq_ev_set_controller(&ev, midiCh, data1, data2);
-        break;
-
-    case MIDI_PROGRAM_CHANGE:
-        snd_seq_ev_set_pgmchange(&ev, midiCh, data1);
-        break;
-
-    case MIDI_NOTE_AFTERTOUCH:
-        snd_seq_ev_set_keypress(&ev, midiCh, data1, data2);
-        break;
-
-    case MIDI_CHANNEL_AFTERTOUCH:
-        snd_seq_ev_set_chanpress(&ev, midiCh, data1);
-        break;
-
-    case MIDI_PITCH_WHEEL:
-        snd_seq_ev_set_pitchbend(&ev, midiCh, ((data1 & 0x7f) | ((data2 & 0x7f) << 7)) - 8192);
-        break;
-
-    default:
-        // What to do here ??
-        invalidCmd = true;
-        break;
-    }
+    bool invalidCmd = !setupChannelEvent(&ev, cmd, data1, data2);
 
     if (!invalidCmd)
     {
         if (snd_seq_event_output(m_alsa, &ev) < 0)
             qDebug() << "snd_seq_event_output ERROR";
+
+        // feedback breaks the running status of the universe messages
+        m_scheduler.resetRunningStatus();
     }
 
     // Make sure that all values go to the MIDI endpoint
@@ -261,6 +275,8 @@ void AlsaMidiOutputDevice::writeSysEx(QByteArray message)
     if (snd_seq_event_output(m_alsa, &ev) < 0)
         qDebug() << "snd_seq_event_output ERROR";
 
+    m_scheduler.resetRunningStatus();
+
     // Make sure that all values go to the MIDI endpoint
     snd_seq_drain_output(m_alsa);
 }
@@ -20,6 +20,9 @@
 #ifndef ALSAMIDIOUTPUTDEVICE_H
 #define ALSAMIDIOUTPUTDEVICE_H
 
+#include <QElapsedTimer>
+
+#include "midioutputscheduler.h"
 #include "midioutputdevice.h"
 
 struct _snd_seq;
@@ -45,12 +48,21 @@ public:
     void writeFeedback(uchar cmd, uchar data1, uchar data2) override;
     void writeSysEx(QByteArray message) override;
 
+    bool hasPendingData() const override;
+    QString statisticsInfo() const override;
+
+private:
+    /** Send the values of m_scheduler that fit the bandwidth budget,
+     *  draining the ALSA output once for all of them */
+    void sendPendingData();
+
 private:
     snd_seq_t* m_alsa;
     snd_seq_addr_t* m_receiver_address;
     snd_seq_addr_t* m_sender_address;
     bool m_open;
-    QByteArray m_universe;
+    MidiOutputScheduler m_scheduler;
+    QElapsedTimer m_clock;
 };
 
 #endif
@@ -8,22 +8,28 @@ QT      += core widgets
 
 HEADERS     += ../../../interfaces/qlcioplugin.h
 HEADERS     += ../../../../engine/src/qlcfile.h
-HEADERS += ../common/mididevice.h \
+HEADERS += ../common/midiclock.h \
+           ../common/mididevice.h \
            ../common/midiinputdevice.h \
            ../common/midioutputdevice.h \
+           ../common/midioutputscheduler.h \
            ../common/midiplugin.h \
            ../common/midiprotocol.h \
            ../common/miditemplate.h \
+           ../common/miditimecode.h \
            ../common/midienumerator.h \
            ../common/configuremidiplugin.h
 
 SOURCES += ../../../interfaces/qlcioplugin.cpp
-SOURCES += ../common/mididevice.cpp \
+SOURCES += ../common/midiclock.cpp \
+           ../common/mididevice.cpp \
            ../common/midiinputdevice.cpp \
            ../common/midioutputdevice.cpp \
+           ../common/midioutputscheduler.cpp \
            ../common/midiplugin.cpp \
            ../common/midiprotocol.cpp \
            ../common/miditemplate.cpp \
+           ../common/miditimecode.cpp \
            ../common/configuremidiplugin.cpp
 
 SOURCES += ../../../../engine/src/qlcfile.cpp
@@ -37,6 +37,7 @@
 #define COL_CHANNEL     1
 #define COL_MODE        2
 #define COL_INITMESSAGE 3
+#define COL_BANDWIDTH   4
 
 #define SETTINGS_GEOMETRY "configuremidiplugin/geometry"
 
@@ -129,6 +130,19 @@ void ConfigureMidiPlugin::slotInitMessageChanged(QString midiTemplateName)
 }
 
 
+void ConfigureMidiPlugin::slotBandwidthValueChanged(int value)
+{
+    QWidget* widget = qobject_cast<QWidget*> (QObject::sender());
+    Q_ASSERT(widget != NULL);
+
+    QVariant var = widget->property(PROP_DEV);
+    Q_ASSERT(var.isValid() == true);
+
+    MidiOutputDevice* dev = (MidiOutputDevice*) var.toULongLong();
+    Q_ASSERT(dev != NULL);
+    dev->setBandwidth(value);
+}
+
 void ConfigureMidiPlugin::slotUpdateTree()
 {
     m_tree->clear();
@@ -154,6 +168,10 @@ void ConfigureMidiPlugin::slotUpdateTree()
         widget = createInitMessageWidget(dev->midiTemplateName());
         widget->setProperty(PROP_DEV, (qulonglong) dev);
         m_tree->setItemWidget(item, COL_INITMESSAGE, widget);
+
+        widget = createBandwidthWidget(dev->bandwidth());
+        widget->setProperty(PROP_DEV, (qulonglong) dev);
+        m_tree->setItemWidget(item, COL_BANDWIDTH, widget);
     }
 
     QTreeWidgetItem* inputs = new QTreeWidgetItem(m_tree);
@@ -245,3 +263,18 @@ QWidget* ConfigureMidiPlugin::createInitMessageWidget(QString midiTemplateName)
 
     return combo;
 }
+
+QWidget* ConfigureMidiPlugin::createBandwidthWidget(int bandwidth)
+{
+    // Zero means unlimited. DIN ports can't go beyond MIDI_DIN_BANDWIDTH
+    QSpinBox* spin = new QSpinBox;
+    spin->setRange(0, 1000000);
+    spin->setSingleStep(MIDI_DIN_BANDWIDTH);
+    spin->setSuffix(QString(" bytes/s"));
+    spin->setSpecialValueText(tr("Unlimited"));
+    spin->setToolTip(tr("Set %1 bytes/s for an output connected to a DIN port.\n"
+                        "Only the ALSA outputs (Linux) apply this limit").arg(MIDI_DIN_BANDWIDTH));
+    spin->setValue(bandwidth);
+    connect(spin, SIGNAL(valueChanged(int)), this, SLOT(slotBandwidthValueChanged(int)));
+    return spin;
+}
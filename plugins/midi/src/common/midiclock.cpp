@@ -0,0 +1,156 @@
+/*
+  Q Light Controller Plus
+  midiclock.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include "midiclock.h"
+#include "midiprotocol.h"
+
+#define NSECS_PER_MINUTE    60000000000.0
+
+/* A longer gap between two pulses (20 BPM) means the clock has been
+   interrupted, so the tempo is measured again from scratch */
+#define MAX_PULSE_GAP       qint64(NSECS_PER_MINUTE / (20 * MIDI_BEAT_CLOCK_PPQ))
+
+/* Pulses needed before the tempo is reported */
+#define MIN_PULSES          6
+
+/* Weight of a new measurement in the smoothed tempo, and the change
+   that is followed immediately, because the tempo really changed */
+#define TEMPO_SMOOTHING     0.1
+#define TEMPO_JUMP          0.05
+
+MidiClock::MidiClock()
+    : m_pulsesCount(0)
+    , m_lastPulse(0)
+    , m_pulsePeriod(0)
+    , m_pulseIndex(0)
+    , m_beatNumber(-1)
+    , m_beatTime(0)
+    , m_running(true)
+{
+}
+
+MidiClock::~MidiClock()
+{
+}
+
+bool MidiClock::pulse(qint64 timestamp)
+{
+    if (m_pulsesCount > 0)
+    {
+        qint64 gap = timestamp - m_pulses[m_lastPulse];
+        if (gap <= 0 || gap > MAX_PULSE_GAP)
+            reset();
+    }
+
+    m_lastPulse = (m_lastPulse + 1) % MIDI_CLOCK_WINDOW;
+    m_pulses[m_lastPulse] = timestamp;
+    if (m_pulsesCount < MIDI_CLOCK_WINDOW)
+        m_pulsesCount++;
+
+    // measuring over many pulses divides the jitter of each one
+    if (m_pulsesCount >= MIN_PULSES)
+    {
+        int oldest = (m_lastPulse - m_pulsesCount + 1 + MIDI_CLOCK_WINDOW) % MIDI_CLOCK_WINDOW;
+        double period = double(timestamp - m_pulses[oldest]) / (m_pulsesCount - 1);
+
+        if (m_pulsePeriod == 0 || qAbs(period - m_pulsePeriod) > TEMPO_JUMP * m_pulsePeriod)
+            m_pulsePeriod = period;
+        else
+            m_pulsePeriod += TEMPO_SMOOTHING * (period - m_pulsePeriod);
+    }
+
+    bool beat = (m_pulseIndex == 0);
+    m_pulseIndex = (m_pulseIndex + 1) % MIDI_BEAT_CLOCK_PPQ;
+
+    if (beat == false)
+        return false;
+
+    m_beatNumber++;
+    m_beatTime = timestamp;
+
+    // the beat happened where the pulses of the last beat say,
+    // which is less affected by the jitter of the last pulse
+    if (m_pulsePeriod > 0)
+    {
+        double sum = 0;
+        for (int i = 0; i < m_pulsesCount; i++)
+        {
+            int idx = (m_lastPulse - i + MIDI_CLOCK_WINDOW) % MIDI_CLOCK_WINDOW;
+            sum += m_pulses[idx] + i * m_pulsePeriod;
+        }
+        m_beatTime = qint64(sum / m_pulsesCount);
+    }
+
+    return true;
+}
+
+void MidiClock::start()
+{
+    // the next pulse is the first beat of the song
+    m_pulseIndex = 0;
+    m_beatNumber = -1;
+    m_running = true;
+}
+
+void MidiClock::resume()
+{
+    m_running = true;
+}
+
+void MidiClock::stop()
+{
+    m_running = false;
+}
+
+void MidiClock::setSongPosition(int position)
+{
+    // a MIDI beat is a 16th note, that is 6 pulses
+    int pulses = qMax(0, position) * 6;
+    m_pulseIndex = pulses % MIDI_BEAT_CLOCK_PPQ;
+    m_beatNumber = pulses / MIDI_BEAT_CLOCK_PPQ - (m_pulseIndex == 0 ? 1 : 0);
+}
+
+bool MidiClock::isRunning() const
+{
+    return m_running;
+}
+
+qint64 MidiClock::beatTime() const
+{
+    return m_beatTime;
+}
+
+int MidiClock::beatNumber() const
+{
+    return m_beatNumber;
+}
+
+double MidiClock::bpm() const
+{
+    if (m_pulsePeriod <= 0)
+        return 0;
+
+    return NSECS_PER_MINUTE / (m_pulsePeriod * MIDI_BEAT_CLOCK_PPQ);
+}
+
+void MidiClock::reset()
+{
+    m_pulsesCount = 0;
+    m_pulsePeriod = 0;
+}
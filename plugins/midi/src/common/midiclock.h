@@ -0,0 +1,98 @@
+/*
+  Q Light Controller Plus
+  midiclock.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef MIDICLOCK_H
+#define MIDICLOCK_H
+
+#include <QtGlobal>
+
+/** Number of pulses used to measure the tempo: one beat */
+#define MIDI_CLOCK_WINDOW   24
+
+/**
+ * MidiClock follows a MIDI Beat Clock (24 pulses per quarter note).
+ *
+ * Each pulse is timestamped as soon as it is received. The tempo is
+ * measured over the last beat worth of pulses and smoothed, so the
+ * jitter of a single pulse is divided among many. Beats are reported on
+ * every 24th pulse, counting from Start or from the Song Position
+ * Pointer, with a timestamp fitted on the pulses of the whole beat
+ * rather than the one of the last pulse.
+ *
+ * Timestamps are in nanoseconds of a monotonic clock.
+ */
+class MidiClock
+{
+public:
+    MidiClock();
+    ~MidiClock();
+
+    /**
+     * Process a clock pulse received at $timestamp.
+     *
+     * @return true if the pulse starts a new beat
+     */
+    bool pulse(qint64 timestamp);
+
+    /** The transport started from the beginning of the song */
+    void start();
+
+    /** The transport continued from the current position */
+    void resume();
+
+    /** The transport stopped */
+    void stop();
+
+    /** Set the song position, in MIDI beats (16th notes) */
+    void setSongPosition(int position);
+
+    /** Return true if the transport is running. It is assumed to be until a
+     *  Stop is received, since the source may have started before us */
+    bool isRunning() const;
+
+    /** Get the time of the last beat, fitted on its pulses */
+    qint64 beatTime() const;
+
+    /** Get the number of beats since the beginning of the song */
+    int beatNumber() const;
+
+    /** Get the smoothed tempo in beats per minute, 0 if unknown */
+    double bpm() const;
+
+    /** Forget the pulses received so far */
+    void reset();
+
+private:
+    /** Timestamps of the last pulses */
+    qint64 m_pulses[MIDI_CLOCK_WINDOW];
+    int m_pulsesCount;
+    int m_lastPulse;
+
+    /** The smoothed duration of a pulse in ns, 0 if unknown */
+    double m_pulsePeriod;
+
+    /** Index of the next pulse within the beat, and beats since the song start */
+    int m_pulseIndex;
+    int m_beatNumber;
+    qint64 m_beatTime;
+
+    bool m_running;
+};
+
+#endif
@@ -18,7 +18,10 @@
 */
 
 #include <QDebug>
+
 #include "midiinputdevice.h"
+#include "midiprotocol.h"
+#include "qlcioplugin.h"
 
 MidiInputDevice::MidiInputDevice(const QVariant& uid, const QString& name, QObject* parent)
     : MidiDevice(uid, name, Input, parent)
@@ -35,3 +38,63 @@ void MidiInputDevice::emitValueChanged(uint channel, uchar value)
 {
     emit valueChanged(uid(), channel, value);
 }
+
+/****************************************************************************
+ * Clock
+ ****************************************************************************/
+
+bool MidiInputDevice::processTiming(uchar cmd, uchar data1, uchar data2)
+{
+    qint64 timestamp = QLCIOPlugin::clockTimestamp();
+
+    switch (cmd)
+    {
+        case MIDI_BEAT_CLOCK:
+            if (m_clock.pulse(timestamp) == false)
+                return true;
+
+            // the tempo goes first, so the beat is measured with it
+            if (m_clock.bpm() > 0)
+                emit clockEvent(uid(), QLCIOPlugin::ClockTempo, m_clock.beatTime(),
+                                qRound64(m_clock.bpm() * 1000));
+            if (m_clock.isRunning())
+                emit clockEvent(uid(), QLCIOPlugin::ClockBeat, m_clock.beatTime(),
+                                m_clock.beatNumber());
+            return true;
+
+        case MIDI_BEAT_START:
+            m_clock.start();
+            emit clockEvent(uid(), QLCIOPlugin::ClockStart, timestamp, 0);
+            return true;
+
+        case MIDI_BEAT_CONTINUE:
+            m_clock.resume();
+            emit clockEvent(uid(), QLCIOPlugin::ClockContinue, timestamp, 0);
+            return true;
+
+        case MIDI_BEAT_STOP:
+            m_clock.stop();
+            emit clockEvent(uid(), QLCIOPlugin::ClockStop, timestamp, 0);
+            return true;
+
+        case MIDI_SONG_POSITION:
+            m_clock.setSongPosition((data2 << 7) | data1);
+            return true;
+
+        case MIDI_TIME_CODE:
+            if (m_timecode.quarterFrame(data1))
+                emit clockEvent(uid(), QLCIOPlugin::ClockTimecode, timestamp, m_timecode.position());
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+void MidiInputDevice::processSysEx(const uchar* data, int length)
+{
+    qint64 timestamp = QLCIOPlugin::clockTimestamp();
+
+    if (m_timecode.fullFrame(data, length))
+        emit clockEvent(uid(), QLCIOPlugin::ClockTimecode, timestamp, m_timecode.position());
+}
@@ -21,6 +21,8 @@
 #define MIDIINPUTDEVICE_H
 
 #include "mididevice.h"
+#include "midiclock.h"
+#include "miditimecode.h"
 
 class MidiInputDevice : public MidiDevice
 {
@@ -34,6 +36,31 @@ public:
 
 signals:
     void valueChanged(const QVariant& uid, ushort channel, uchar value);
+
+    /*********************************************************************
+     * Clock
+     *********************************************************************/
+public:
+    /**
+     * Process a timing message: beat clock, transport, song position or
+     * time code quarter frame. The message is timestamped here, so this
+     * must be called as soon as it is received. The resulting events
+     * are emitted with clockEvent().
+     *
+     * @return true if $cmd is a timing message
+     */
+    bool processTiming(uchar cmd, uchar data1, uchar data2);
+
+    /** Process a SysEx message, looking for time code full frames */
+    void processSysEx(const uchar* data, int length);
+
+signals:
+    /** A clock event, see QLCIOPlugin::ClockEvent */
+    void clockEvent(const QVariant& uid, int event, qint64 timestamp, qint64 value);
+
+private:
+    MidiClock m_clock;
+    MidiTimeCode m_timecode;
 };
 
 #endif
@@ -19,9 +19,11 @@
 
 #include <QDebug>
 #include "midioutputdevice.h"
+#include "midiprotocol.h"
 
 MidiOutputDevice::MidiOutputDevice(const QVariant& uid, const QString& name, QObject* parent)
     : MidiDevice(uid, name, Output, parent)
+    , m_bandwidth(MIDI_DEFAULT_BANDWIDTH)
 {
     //qDebug() << Q_FUNC_INFO;
 }
@@ -30,3 +32,27 @@ MidiOutputDevice::~MidiOutputDevice()
 {
     //qDebug() << Q_FUNC_INFO;
 }
+
+bool MidiOutputDevice::hasPendingData() const
+{
+    return false;
+}
+
+/****************************************************************************
+ * Bandwidth
+ ****************************************************************************/
+
+void MidiOutputDevice::setBandwidth(int bytesPerSecond)
+{
+    m_bandwidth = qMax(0, bytesPerSecond);
+}
+
+int MidiOutputDevice::bandwidth() const
+{
+    return m_bandwidth;
+}
+
+QString MidiOutputDevice::statisticsInfo() const
+{
+    return QString();
+}
@@ -35,6 +35,29 @@ public:
     virtual void writeUniverse(const QByteArray& universe) = 0;
     virtual void writeFeedback(uchar cmd, uchar data1, uchar data2) = 0;
     virtual void writeSysEx(QByteArray message) = 0;
+
+    /** Return true if the device is still holding values that
+     *  have to be written even if the universe didn't change */
+    virtual bool hasPendingData() const;
+
+    /************************************************************************
+     * Bandwidth
+     ************************************************************************/
+public:
+    /** Set the maximum amount of bytes per second that the device should
+     *  send when writing a universe. 0 means unlimited, which is the default.
+     *  Outputs driving a DIN port should use MIDI_DIN_BANDWIDTH.
+     *  The value is stored for every backend, but only the ALSA output
+     *  device paces its messages with it: CoreMIDI and WinMM ignore it */
+    void setBandwidth(int bytesPerSecond);
+    int bandwidth() const;
+
+    /** Return the output statistics formatted for the plugin output info,
+     *  or an empty string if the device doesn't collect any */
+    virtual QString statisticsInfo() const;
+
+private:
+    int m_bandwidth;
 };
 
 #endif
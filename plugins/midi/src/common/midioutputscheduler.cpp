@@ -0,0 +1,223 @@
+/*
+  Q Light Controller Plus
+  midioutputscheduler.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include "midioutputscheduler.h"
+#include "midiprotocol.h"
+
+/* The budget can't accumulate more than this amount of time,
+   to avoid sending a burst after a long idle period */
+#define MAX_BURST_MS    50
+
+MidiOutputScheduler::MidiOutputScheduler()
+    : m_bandwidth(MIDI_DEFAULT_BANDWIDTH)
+    , m_cmd(MIDI_CONTROL_CHANGE)
+    , m_sendNoteOff(true)
+    , m_pending(MAX_MIDI_DMX_CHANNELS, char(0))
+    , m_sent(MAX_MIDI_DMX_CHANNELS, char(0))
+    , m_hasPending(false)
+    , m_deferred(MAX_MIDI_DMX_CHANNELS)
+    , m_nextChannel(0)
+    , m_lastStatus(0)
+    , m_budget(0)
+    , m_lastTimestamp(-1)
+    , m_sentCount(0)
+    , m_coalescedCount(0)
+    , m_deferredCount(0)
+{
+    m_messages.reserve(MAX_MIDI_DMX_CHANNELS);
+}
+
+MidiOutputScheduler::~MidiOutputScheduler()
+{
+}
+
+void MidiOutputScheduler::setBandwidth(int bytesPerSecond)
+{
+    m_bandwidth = qMax(0, bytesPerSecond);
+}
+
+int MidiOutputScheduler::bandwidth() const
+{
+    return m_bandwidth;
+}
+
+void MidiOutputScheduler::setCommand(uchar cmd, bool sendNoteOff)
+{
+    m_cmd = cmd;
+    m_sendNoteOff = sendNoteOff;
+}
+
+void MidiOutputScheduler::setUniverse(const QByteArray& universe)
+{
+    // Since MIDI devices can have only 128 real channels, we don't
+    // attempt to write more than that.
+    int count = qMin(int(MAX_MIDI_DMX_CHANNELS), universe.size());
+    for (int channel = 0; channel < count; channel++)
+        storeValue(channel, DMX2MIDI(universe.at(channel)));
+}
+
+void MidiOutputScheduler::setChannel(ushort channel, uchar value)
+{
+    if (channel < MAX_MIDI_DMX_CHANNELS)
+        storeValue(channel, DMX2MIDI(value));
+}
+
+void MidiOutputScheduler::storeValue(int channel, char value)
+{
+    if (m_pending.at(channel) == value)
+        return;
+
+    // the previous value never reached the device
+    if (m_pending.at(channel) != m_sent.at(channel))
+        m_coalescedCount.ref();
+
+    m_pending[channel] = value;
+
+    if (value == m_sent.at(channel))
+        m_deferred.clearBit(channel);
+    else
+        m_hasPending = true;
+}
+
+bool MidiOutputScheduler::hasPendingData() const
+{
+    return m_hasPending;
+}
+
+int MidiOutputScheduler::buildMessage(int channel, Message& msg) const
+{
+    uchar value = uchar(m_pending.at(channel));
+    int size = 3;
+
+    switch (MIDI_CMD(m_cmd))
+    {
+        case MIDI_NOTE_ON:
+            if (value == 0 && m_sendNoteOff)
+                msg.cmd = MIDI_NOTE_OFF | MIDI_CH(m_cmd);
+            else
+                msg.cmd = m_cmd;
+            msg.data1 = uchar(channel);
+            msg.data2 = value;
+        break;
+        case MIDI_PROGRAM_CHANGE:
+            msg.cmd = m_cmd;
+            msg.data1 = uchar(channel);
+            msg.data2 = 0;
+            size = 2;
+        break;
+        default:
+            msg.cmd = m_cmd;
+            msg.data1 = uchar(channel);
+            msg.data2 = value;
+        break;
+    }
+
+    if (msg.cmd == m_lastStatus)
+        size--;
+
+    return size;
+}
+
+const QVector<MidiOutputScheduler::Message>& MidiOutputScheduler::schedule(qint64 timestamp)
+{
+    m_messages.clear();
+
+    if (m_hasPending == false)
+        return m_messages;
+
+    if (m_bandwidth > 0)
+    {
+        double maxBudget = qMax(3.0, double(m_bandwidth) * MAX_BURST_MS / 1000.0);
+
+        if (m_lastTimestamp < 0)
+            m_budget = maxBudget;
+        else if (timestamp > m_lastTimestamp)
+            m_budget = qMin(maxBudget, m_budget + double(timestamp - m_lastTimestamp) * m_bandwidth / 1000000000.0);
+    }
+    m_lastTimestamp = timestamp;
+
+    bool deferred = false;
+
+    for (int i = 0; i < MAX_MIDI_DMX_CHANNELS; i++)
+    {
+        int channel = (m_nextChannel + i) % MAX_MIDI_DMX_CHANNELS;
+
+        if (m_pending.at(channel) == m_sent.at(channel))
+            continue;
+
+        if (deferred == false)
+        {
+            Message msg;
+            int size = buildMessage(channel, msg);
+
+            if (m_bandwidth == 0 || m_budget >= size)
+            {
+                m_messages.append(msg);
+                m_sent[channel] = m_pending.at(channel);
+                m_deferred.clearBit(channel);
+                m_lastStatus = msg.cmd;
+                m_budget -= size;
+                continue;
+            }
+
+            // out of budget: restart from here on the next schedule
+            m_nextChannel = channel;
+            deferred = true;
+        }
+
+        // keep the channel for the next schedule, counting it once
+        if (m_deferred.testBit(channel) == false)
+        {
+            m_deferred.setBit(channel);
+            m_deferredCount.ref();
+        }
+    }
+
+    if (deferred == false)
+        m_nextChannel = 0;
+
+    m_hasPending = deferred;
+    m_sentCount.fetchAndAddRelaxed(m_messages.count());
+
+    return m_messages;
+}
+
+void MidiOutputScheduler::resetRunningStatus()
+{
+    m_lastStatus = 0;
+}
+
+/*********************************************************************
+ * Statistics
+ *********************************************************************/
+
+int MidiOutputScheduler::sentCount() const
+{
+    return m_sentCount.loadAcquire();
+}
+
+int MidiOutputScheduler::coalescedCount() const
+{
+    return m_coalescedCount.loadAcquire();
+}
+
+int MidiOutputScheduler::deferredCount() const
+{
+    return m_deferredCount.loadAcquire();
+}
@@ -0,0 +1,143 @@
+/*
+  Q Light Controller Plus
+  midioutputscheduler.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef MIDIOUTPUTSCHEDULER_H
+#define MIDIOUTPUTSCHEDULER_H
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QBitArray>
+#include <QVector>
+
+/**
+ * MidiOutputScheduler turns the DMX values written to a MIDI output
+ * into a paced stream of MIDI messages.
+ *
+ * Only the latest value of each channel is kept until it is sent, so
+ * a burst of changes is coalesced into one message per channel.
+ * Consecutive messages sharing the same status byte are accounted with
+ * running status, and the bytes sent never exceed the bandwidth budget
+ * accumulated over time. Whatever doesn't fit is deferred to the next
+ * call, starting from the first channel that was left behind.
+ */
+class MidiOutputScheduler
+{
+public:
+    typedef struct
+    {
+        uchar cmd;
+        uchar data1;
+        uchar data2;
+    } Message;
+
+    MidiOutputScheduler();
+    ~MidiOutputScheduler();
+
+    /** Set the bandwidth budget in bytes per second. 0 means unlimited */
+    void setBandwidth(int bytesPerSecond);
+
+    /** Get the bandwidth budget in bytes per second */
+    int bandwidth() const;
+
+    /**
+     * Set the command used to send channel values.
+     *
+     * @param cmd MIDI_CONTROL_CHANGE, MIDI_NOTE_ON or MIDI_PROGRAM_CHANGE,
+     *            or'ed with the MIDI channel
+     * @param sendNoteOff if true, a Note value of 0 is sent as Note Off.
+     *                    If false, Note On with velocity 0 is sent, which
+     *                    keeps running status.
+     */
+    void setCommand(uchar cmd, bool sendNoteOff);
+
+    /** Store the latest DMX values of a universe */
+    void setUniverse(const QByteArray& universe);
+
+    /** Store the latest DMX value of a single channel */
+    void setChannel(ushort channel, uchar value);
+
+    /** Return true if some values are still waiting to be sent */
+    bool hasPendingData() const;
+
+    /**
+     * Return the messages fitting the bandwidth accumulated since the
+     * previous call. The returned vector is reused by the next call.
+     *
+     * @param timestamp a monotonic time in nanoseconds
+     */
+    const QVector<Message>& schedule(qint64 timestamp);
+
+    /** Forget the last status byte sent, because something else has
+     *  been sent in between (for example feedback or SysEx) */
+    void resetRunningStatus();
+
+private:
+    /** Store a scaled MIDI value and account the coalesced ones */
+    void storeValue(int channel, char value);
+
+    /** Build the message for the given channel and return its size
+     *  in bytes, taking running status into account */
+    int buildMessage(int channel, Message& msg) const;
+
+private:
+    int m_bandwidth;
+    uchar m_cmd;
+    bool m_sendNoteOff;
+
+    /** The latest values requested and the values actually sent,
+     *  both already scaled to 0-127 */
+    QByteArray m_pending;
+    QByteArray m_sent;
+    bool m_hasPending;
+
+    /** Channels whose message has been already accounted as deferred */
+    QBitArray m_deferred;
+
+    /** The channel to start from on the next schedule */
+    int m_nextChannel;
+
+    /** The status byte of the last message sent, or 0 if unknown */
+    uchar m_lastStatus;
+
+    /** Bytes that can be sent right now, and when it was computed */
+    double m_budget;
+    qint64 m_lastTimestamp;
+
+    QVector<Message> m_messages;
+
+    /*********************************************************************
+     * Statistics
+     *********************************************************************/
+public:
+    /** Get the number of messages sent */
+    int sentCount() const;
+
+    /** Get the number of values replaced by a newer one before being sent */
+    int coalescedCount() const;
+
+    /** Get the number of messages postponed because of the bandwidth budget */
+    int deferredCount() const;
+
+private:
+    QAtomicInt m_sentCount;
+    QAtomicInt m_coalescedCount;
+    QAtomicInt m_deferredCount;
+};
+
+#endif
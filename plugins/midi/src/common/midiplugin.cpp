@@ -164,6 +164,7 @@ QString MidiPlugin::outputInfo(quint32 output)
         else
             status = tr("Not Open");
         str += QString("%1: %2").arg(tr("Status")).arg(status);
+        str += dev->statisticsInfo();
         str += QString("</P>");
     }
     else
@@ -183,7 +184,8 @@ void MidiPlugin::writeUniverse(quint32 universe, quint32 output, const QByteArra
     Q_UNUSED(universe)
 
     MidiOutputDevice* dev = outputDevice(output);
-    if (dev != NULL && dataChanged)
+    // deferred values must be flushed even if nothing changed
+    if (dev != NULL && (dataChanged || dev->hasPendingData()))
         dev->writeUniverse(data);
 }
 
@@ -209,6 +211,8 @@ bool MidiPlugin::openInput(quint32 input, quint32 universe)
     {
         connect(dev, SIGNAL(valueChanged(QVariant,ushort,uchar)),
                 this, SLOT(slotValueChanged(QVariant,ushort,uchar)));
+        connect(dev, SIGNAL(clockEvent(QVariant,int,qint64,qint64)),
+                this, SLOT(slotClockEvent(QVariant,int,qint64,qint64)));
         addToMap(universe, input, Input);
         return dev->open();
     }
@@ -226,6 +230,8 @@ void MidiPlugin::closeInput(quint32 input, quint32 universe)
         dev->close();
         disconnect(dev, SIGNAL(valueChanged(QVariant,ushort,uchar)),
                    this, SLOT(slotValueChanged(QVariant,ushort,uchar)));
+        disconnect(dev, SIGNAL(clockEvent(QVariant,int,qint64,qint64)),
+                   this, SLOT(slotClockEvent(QVariant,int,qint64,qint64)));
     }
 }
 
@@ -334,8 +340,20 @@ void MidiPlugin::slotValueChanged(const QVariant& uid, ushort channel, uchar val
         MidiInputDevice* dev = m_enumerator->inputDevices().at(i);
         if (dev->uid() == uid)
         {
-            emit valueChanged(UINT_MAX, i, channel, value,
-                              channel == CHANNEL_OFFSET_MBC_BEAT ? "beat" : "");
+            emit valueChanged(UINT_MAX, i, channel, value);
+            break;
+        }
+    }
+}
+
+void MidiPlugin::slotClockEvent(const QVariant& uid, int event, qint64 timestamp, qint64 value)
+{
+    for (int i = 0; i < m_enumerator->inputDevices().size(); i++)
+    {
+        MidiInputDevice* dev = m_enumerator->inputDevices().at(i);
+        if (dev->uid() == uid)
+        {
+            emit clockEventReceived(UINT_MAX, i, event, timestamp, value);
             break;
         }
     }
@@ -406,6 +424,9 @@ void MidiPlugin::configure()
                 if (dev->midiTemplateName().isEmpty() == false)
                     QLCIOPlugin::setParameter(universe, outLine, Output,
                                               MIDI_INITMESSAGE, dev->midiTemplateName());
+                if (dev->bandwidth() != MIDI_DEFAULT_BANDWIDTH)
+                    QLCIOPlugin::setParameter(universe, outLine, Output,
+                                              MIDI_BANDWIDTH, dev->bandwidth());
             }
             else
                 qDebug() << "[MIDI] couldn't find device for line:" << outLine;
@@ -436,6 +457,12 @@ void MidiPlugin::setParameter(quint32 universe, quint32 line, Capability type,
             dev->setMode(MidiDevice::stringToMode(value.toString()));
         else if (name == "initmessage")
             dev->setMidiTemplateName(value.toString());
+        else if (name == MIDI_BANDWIDTH)
+        {
+            MidiOutputDevice *outDev = outputDevice(line);
+            if (type == Output && outDev != NULL)
+                outDev->setBandwidth(value.toInt());
+        }
         else if (name == "MIDISendNoteOff")
         {
             dev = qobject_cast<MidiDevice*>(outputDevice(line));
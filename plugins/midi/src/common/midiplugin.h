@@ -39,6 +39,7 @@ class QString;
 #define MIDI_MIDICHANNEL "midichannel"
 #define MIDI_MODE "mode"
 #define MIDI_INITMESSAGE "initmessage"
+#define MIDI_BANDWIDTH "bandwidth"
 
 class MidiPlugin final : public QLCIOPlugin
 {
@@ -122,6 +123,9 @@ private slots:
     /** Catch MIDI input device valueChanged signals */
     void slotValueChanged(const QVariant& uid, ushort channel, uchar value);
 
+    /** Catch MIDI input device clockEvent signals */
+    void slotClockEvent(const QVariant& uid, int event, qint64 timestamp, qint64 value);
+
     /*************************************************************************
      * Configuration
      *************************************************************************/
@@ -99,6 +99,14 @@ namespace QLCMIDIProtocol
 #define MAX_MIDI_DMX_CHANNELS   128
 #define MAX_MIDI_CHANNELS       16
 
+/** The default output bandwidth: no limit. USB and virtual ports
+ *  are not bound to the DIN rate, so the limit must be set per device */
+#define MIDI_DEFAULT_BANDWIDTH  0
+
+/** The MIDI DIN bandwidth in bytes per second (31250 baud, 10 bits per byte),
+ *  to be set on the outputs driving a DIN/serial port */
+#define MIDI_DIN_BANDWIDTH      3125
+
 /****************************************************************************
  * MIDI commands with a MIDI channel (0-16)
  ****************************************************************************/
@@ -0,0 +1,168 @@
+/*
+  Q Light Controller Plus
+  miditimecode.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <string.h>
+
+#include "miditimecode.h"
+#include "midiprotocol.h"
+
+/* Full frame message: F0 7F <device> 01 01 hh mm ss ff F7 */
+#define MTC_FULL_FRAME_LENGTH   10
+#define MTC_SUB_ID1             0x01
+#define MTC_SUB_ID2             0x01
+#define MIDI_SYSEX_REALTIME     0x7F
+
+MidiTimeCode::MidiTimeCode()
+{
+    reset();
+}
+
+MidiTimeCode::~MidiTimeCode()
+{
+}
+
+bool MidiTimeCode::quarterFrame(uchar data)
+{
+    int piece = (data >> 4) & 0x07;
+
+    // a piece out of sequence means that the source located, reversed
+    // or some messages got lost: wait for a new series from piece 0
+    if (piece != m_nextPiece)
+    {
+        m_complete = false;
+        if (piece != 0)
+        {
+            m_nextPiece = 0;
+            return false;
+        }
+    }
+
+    m_pieces[piece] = data & 0x0F;
+    m_nextPiece = (piece + 1) % 8;
+
+    if (piece == 7)
+    {
+        // the series is complete: it carries the time
+        // of the frame where piece 0 has been sent
+        int frames = m_pieces[0] | (m_pieces[1] << 4);
+        int seconds = m_pieces[2] | (m_pieces[3] << 4);
+        int minutes = m_pieces[4] | (m_pieces[5] << 4);
+        int hours = m_pieces[6] | ((m_pieces[7] & 0x01) << 4);
+        m_rate = FrameRate((m_pieces[7] >> 1) & 0x03);
+
+        qint64 time = toMsecs(hours, minutes, seconds, frames, m_rate);
+        m_position = time + qRound64(quarterFramesToMsecs(7));
+        m_seriesStart = time + qRound64(quarterFramesToMsecs(8));
+        m_complete = true;
+        m_valid = true;
+        return true;
+    }
+
+    if (m_complete == false)
+        return false;
+
+    // follow the series, one quarter frame at a time
+    m_position = m_seriesStart + qRound64(quarterFramesToMsecs(piece));
+    return true;
+}
+
+bool MidiTimeCode::fullFrame(const uchar *data, int length)
+{
+    if (data == NULL || length < MTC_FULL_FRAME_LENGTH)
+        return false;
+
+    if (data[0] != MIDI_SYSEX || data[1] != MIDI_SYSEX_REALTIME ||
+        data[3] != MTC_SUB_ID1 || data[4] != MTC_SUB_ID2)
+        return false;
+
+    m_rate = FrameRate((data[5] >> 5) & 0x03);
+    m_position = toMsecs(data[5] & 0x1F, data[6] & 0x3F, data[7] & 0x3F, data[8] & 0x1F, m_rate);
+    m_valid = true;
+
+    // quarter frames will restart from piece 0
+    m_complete = false;
+    m_nextPiece = 0;
+
+    return true;
+}
+
+bool MidiTimeCode::isValid() const
+{
+    return m_valid;
+}
+
+qint64 MidiTimeCode::position() const
+{
+    return m_position;
+}
+
+MidiTimeCode::FrameRate MidiTimeCode::frameRate() const
+{
+    return m_rate;
+}
+
+void MidiTimeCode::reset()
+{
+    memset(m_pieces, 0, sizeof(m_pieces));
+    m_nextPiece = 0;
+    m_complete = false;
+    m_seriesStart = 0;
+    m_position = 0;
+    m_valid = false;
+    m_rate = Fps25;
+}
+
+qint64 MidiTimeCode::toMsecs(int hours, int minutes, int seconds, int frames, FrameRate rate)
+{
+    int totalMinutes = hours * 60 + minutes;
+
+    switch (rate)
+    {
+        case Fps24:
+            return (totalMinutes * 60 + seconds) * qint64(1000) + qRound64(frames * 1000.0 / 24);
+        case Fps30:
+            return (totalMinutes * 60 + seconds) * qint64(1000) + qRound64(frames * 1000.0 / 30);
+        case Fps2997Drop:
+        {
+            // frame numbers 0 and 1 are skipped at the start of
+            // each minute, except for every tenth minute
+            qint64 frameNumber = (qint64(totalMinutes) * 60 + seconds) * 30 + frames
+                                 - 2 * (totalMinutes - totalMinutes / 10);
+            return qRound64(frameNumber * 1001.0 / 30);
+        }
+        default:
+        case Fps25:
+            return (totalMinutes * 60 + seconds) * qint64(1000) + frames * 40;
+    }
+}
+
+double MidiTimeCode::quarterFramesToMsecs(int quarters) const
+{
+    double fps;
+
+    switch (m_rate)
+    {
+        case Fps24: fps = 24; break;
+        case Fps2997Drop: fps = 30000.0 / 1001; break;
+        case Fps30: fps = 30; break;
+        default: fps = 25; break;
+    }
+
+    return quarters * 1000.0 / (fps * 4);
+}
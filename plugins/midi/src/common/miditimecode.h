@@ -0,0 +1,96 @@
+/*
+  Q Light Controller Plus
+  miditimecode.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef MIDITIMECODE_H
+#define MIDITIMECODE_H
+
+#include <QtGlobal>
+
+/**
+ * MidiTimeCode decodes a MIDI Time Code (MTC) stream into a position.
+ *
+ * Quarter frame messages carry the time code in 8 pieces, sent at a rate
+ * of 4 per frame. Once all the pieces have been received in order, every
+ * quarter frame advances the position, so it is updated 4 times per frame.
+ * Full frame SysEx messages, sent when the source locates, set the
+ * position immediately.
+ *
+ * Drop frame time codes are converted to real time.
+ */
+class MidiTimeCode
+{
+public:
+    MidiTimeCode();
+    ~MidiTimeCode();
+
+    enum FrameRate
+    {
+        Fps24 = 0,
+        Fps25,
+        Fps2997Drop,
+        Fps30
+    };
+
+    /**
+     * Process the data byte of a quarter frame message.
+     *
+     * @return true if the position has been updated
+     */
+    bool quarterFrame(uchar data);
+
+    /**
+     * Process a SysEx message, including the SysEx start and end bytes.
+     *
+     * @return true if it is a full frame message
+     */
+    bool fullFrame(const uchar *data, int length);
+
+    /** Return true if a position has been decoded */
+    bool isValid() const;
+
+    /** Get the current position in milliseconds */
+    qint64 position() const;
+
+    /** Get the frame rate of the time code */
+    FrameRate frameRate() const;
+
+    /** Forget the position and the pieces received so far */
+    void reset();
+
+    /** Get the real time in milliseconds of a time code, at $rate */
+    static qint64 toMsecs(int hours, int minutes, int seconds, int frames, FrameRate rate);
+
+private:
+    /** Get the duration of $quarters quarter frames in ms at the current rate */
+    double quarterFramesToMsecs(int quarters) const;
+
+private:
+    /** The nibbles received, and the next piece expected */
+    uchar m_pieces[8];
+    int m_nextPiece;
+    bool m_complete;
+
+    /** Position of the quarter frame with piece 0 of the current series */
+    qint64 m_seriesStart;
+    qint64 m_position;
+    bool m_valid;
+    FrameRate m_rate;
+};
+
+#endif
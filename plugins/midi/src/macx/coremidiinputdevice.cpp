@@ -53,7 +53,11 @@ static void MidiInProc(const MIDIPacketList* pktList, void* readProcRefCon,
             if (!MIDI_IS_CMD(cmd))
                 continue; // Not a MIDI command. Skip to the next byte.
             if (cmd == MIDI_SYSEX)
-                break; // Sysex reserves the whole packet. Not interested.
+            {
+                // Sysex reserves the whole packet. Only time code is interesting
+                self->processSysEx(packet->data + i, packet->length - i);
+                break;
+            }
 
             // 1 or 2 MIDI Data bytes
             if (packet->length > (i + 1) && !MIDI_IS_CMD(packet->data[i + 1]))
@@ -67,6 +71,10 @@ static void MidiInProc(const MIDIPacketList* pktList, void* readProcRefCon,
                     data2 = 127;
             }
 
+            // timing messages feed the device clock, as soon as possible
+            if (MIDI_IS_SYSCOMMON(cmd))
+                self->processTiming(cmd, data1, data2);
+
             if (cmd >= MIDI_BEAT_CLOCK && cmd <= MIDI_BEAT_STOP)
             {
                 if (self->processMBC(cmd) == false)
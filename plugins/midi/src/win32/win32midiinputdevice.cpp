@@ -38,6 +38,10 @@ static void CALLBACK MidiInProc(HMIDIIN hMidiIn, UINT wMsg,
         BYTE data1 = (dwParam1 & 0xFF00) >> 8;
         BYTE data2 = (dwParam1 & 0xFF0000) >> 16;
 
+        // timing messages feed the device clock, as soon as possible
+        if (MIDI_IS_SYSCOMMON(cmd))
+            self->processTiming(cmd, data1, data2);
+
         if (cmd >= MIDI_BEAT_CLOCK && cmd <= MIDI_BEAT_STOP)
         {
             if (self->processMBC(cmd) == false)
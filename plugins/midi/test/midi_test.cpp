@@ -22,6 +22,9 @@
 #define private public
 #include "midi_test.h"
 #include "midiprotocol.h"
+#include "midioutputscheduler.h"
+#include "miditimecode.h"
+#include "midiclock.h"
 
 #undef private
 
@@ -45,4 +48,261 @@ void Midi_Test::midiToInput()
     QCOMPARE(value, uchar(255U));
 }
 
+void Midi_Test::schedulerCoalesce()
+{
+    MidiOutputScheduler sch;
+    sch.setBandwidth(0);
+    QVERIFY(sch.hasPendingData() == false);
+    QVERIFY(sch.schedule(0).isEmpty());
+
+    QByteArray uni(512, char(0));
+    uni[3] = char(100);
+    sch.setUniverse(uni);
+    uni[3] = char(200);
+    sch.setUniverse(uni);
+    QVERIFY(sch.hasPendingData() == true);
+    QCOMPARE(sch.coalescedCount(), 1);
+
+    // only the latest value is sent
+    QVector<MidiOutputScheduler::Message> msgs = sch.schedule(0);
+    QCOMPARE(msgs.count(), 1);
+    QCOMPARE(msgs.at(0).cmd, uchar(MIDI_CONTROL_CHANGE));
+    QCOMPARE(msgs.at(0).data1, uchar(3));
+    QCOMPARE(msgs.at(0).data2, uchar(100));
+    QVERIFY(sch.hasPendingData() == false);
+    QCOMPARE(sch.sentCount(), 1);
+
+    // unchanged values are not sent again
+    sch.setUniverse(uni);
+    QVERIFY(sch.schedule(0).isEmpty());
+
+    // channels beyond 127 are ignored
+    sch.setChannel(200, 255);
+    QVERIFY(sch.hasPendingData() == false);
+}
+
+void Midi_Test::schedulerBandwidth()
+{
+    MidiOutputScheduler sch;
+    QCOMPARE(sch.bandwidth(), 0);
+    sch.setBandwidth(MIDI_DIN_BANDWIDTH);
+    QCOMPARE(sch.bandwidth(), MIDI_DIN_BANDWIDTH);
+
+    QByteArray uni(128, char(254));
+    sch.setUniverse(uni);
+
+    // the initial burst is 50ms of bandwidth: 156 bytes,
+    // that are 1 full CC message plus 76 with running status
+    QVector<MidiOutputScheduler::Message> msgs = sch.schedule(0);
+    QCOMPARE(msgs.count(), 77);
+    QVERIFY(sch.hasPendingData() == true);
+    QCOMPARE(sch.deferredCount(), 51);
+
+    // 20ms later there are 62.5 bytes more, and the deferred
+    // channels are resumed from where they were left
+    msgs = sch.schedule(20000000);
+    QCOMPARE(msgs.count(), 31);
+    QCOMPARE(msgs.at(0).data1, uchar(77));
+    QCOMPARE(sch.deferredCount(), 51);
+
+    // a new value for a deferred channel doesn't count twice
+    sch.setChannel(120, 2);
+    QCOMPARE(sch.coalescedCount(), 1);
+    QCOMPARE(sch.deferredCount(), 51);
+
+    msgs = sch.schedule(40000000);
+    QCOMPARE(msgs.count(), 20);
+    QCOMPARE(msgs.at(0).data1, uchar(108));
+    QCOMPARE(msgs.at(12).data1, uchar(120));
+    QCOMPARE(msgs.at(12).data2, uchar(1));
+    QVERIFY(sch.hasPendingData() == false);
+    QCOMPARE(sch.sentCount(), 128);
+}
+
+void Midi_Test::schedulerRunningStatus()
+{
+    MidiOutputScheduler sch;
+    sch.setBandwidth(100);
+    sch.setCommand(MIDI_NOTE_ON | 2, true);
+
+    // the budget is at least 5 bytes (50ms), one full message is 3
+    sch.setChannel(10, 255);
+    QVector<MidiOutputScheduler::Message> msgs = sch.schedule(0);
+    QCOMPARE(msgs.count(), 1);
+    QCOMPARE(msgs.at(0).cmd, uchar(MIDI_NOTE_ON | 2));
+    QCOMPARE(msgs.at(0).data1, uchar(10));
+    QCOMPARE(msgs.at(0).data2, uchar(127));
+
+    // Note Off has a different status byte: 3 bytes don't fit in 2
+    sch.setChannel(10, 0);
+    sch.setChannel(11, 254);
+    msgs = sch.schedule(0);
+    QCOMPARE(msgs.count(), 0);
+    QCOMPARE(sch.deferredCount(), 2);
+
+    msgs = sch.schedule(10000000);
+    QCOMPARE(msgs.count(), 1);
+    QCOMPARE(msgs.at(0).cmd, uchar(MIDI_NOTE_OFF | 2));
+    QCOMPARE(msgs.at(0).data1, uchar(10));
+    QCOMPARE(msgs.at(0).data2, uchar(0));
+
+    msgs = sch.schedule(30000000);
+    QCOMPARE(msgs.count(), 0);
+
+    msgs = sch.schedule(40000000);
+    QCOMPARE(msgs.count(), 1);
+    QCOMPARE(msgs.at(0).cmd, uchar(MIDI_NOTE_ON | 2));
+    QCOMPARE(msgs.at(0).data1, uchar(11));
+    QCOMPARE(sch.deferredCount(), 2);
+
+    // without Note Off, a 0 value keeps the running status: 2 bytes
+    sch.setCommand(MIDI_NOTE_ON | 2, false);
+    sch.setChannel(11, 0);
+    msgs = sch.schedule(60000000);
+    QCOMPARE(msgs.count(), 1);
+    QCOMPARE(msgs.at(0).cmd, uchar(MIDI_NOTE_ON | 2));
+    QCOMPARE(msgs.at(0).data2, uchar(0));
+
+    // something else was sent in between: the status byte is needed again
+    sch.resetRunningStatus();
+    sch.setChannel(11, 254);
+    msgs = sch.schedule(80000000);
+    QCOMPARE(msgs.count(), 0);
+    QVERIFY(sch.hasPendingData() == true);
+
+    msgs = sch.schedule(90000000);
+    QCOMPARE(msgs.count(), 1);
+    QVERIFY(sch.hasPendingData() == false);
+    QCOMPARE(sch.sentCount(), 5);
+}
+
+/* 120 BPM: a pulse every 500ms / 24 */
+#define PULSE   qint64(500000000 / MIDI_BEAT_CLOCK_PPQ)
+
+void Midi_Test::clockTempo()
+{
+    MidiClock clock;
+    QVERIFY(clock.isRunning() == true);
+    QCOMPARE(clock.bpm(), 0.0);
+
+    // beats are reported every 24 pulses, from the first one
+    int beats = 0;
+    for (int i = 0; i < 4 * MIDI_BEAT_CLOCK_PPQ; i++)
+    {
+        // +/-1ms of jitter on every pulse
+        qint64 jitter = (i % 2 ? 1 : -1) * 1000000;
+        if (clock.pulse(i * PULSE + jitter))
+        {
+            QCOMPARE(clock.beatNumber(), beats);
+            beats++;
+        }
+    }
+    QCOMPARE(beats, 4);
+    QVERIFY(qAbs(clock.bpm() - 120.0) < 0.1);
+
+    // the beat time is fitted on the pulses, not on the last one
+    QVERIFY(qAbs(clock.beatTime() - 3 * 24 * PULSE) < 100000);
+
+    // a stop doesn't forget the tempo
+    clock.stop();
+    QVERIFY(clock.isRunning() == false);
+    QVERIFY(clock.bpm() > 0);
+
+    // a long gap does
+    clock.pulse(1000 * PULSE);
+    QCOMPARE(clock.bpm(), 0.0);
+}
+
+void Midi_Test::clockSongPosition()
+{
+    MidiClock clock;
+
+    // 4 16ths after the song start: the second beat
+    clock.setSongPosition(4);
+    QVERIFY(clock.pulse(0) == true);
+    QCOMPARE(clock.beatNumber(), 1);
+
+    // 2 16ths after it: the next pulse is in the middle of the
+    // second beat, so the third one is 12 pulses later
+    clock.setSongPosition(6);
+    for (int i = 1; i <= 12; i++)
+        QVERIFY(clock.pulse(i * PULSE) == false);
+    QVERIFY(clock.pulse(13 * PULSE) == true);
+    QCOMPARE(clock.beatNumber(), 2);
+
+    // start goes back to the first beat
+    clock.start();
+    QVERIFY(clock.pulse(14 * PULSE) == true);
+    QCOMPARE(clock.beatNumber(), 0);
+}
+
+void Midi_Test::timecodeQuarterFrames()
+{
+    MidiTimeCode tc;
+    QVERIFY(tc.isValid() == false);
+
+    // 01:02:03:04 at 25 fps
+    const uchar series[8] = { 0x04, 0x10, 0x23, 0x30, 0x42, 0x50, 0x61, 0x72 };
+    const qint64 time = ((1 * 60 + 2) * 60 + 3) * 1000 + 4 * 40;
+
+    // a series must start from piece 0
+    QVERIFY(tc.quarterFrame(series[3]) == false);
+
+    for (int i = 0; i < 7; i++)
+        QVERIFY(tc.quarterFrame(series[i]) == false);
+    QVERIFY(tc.isValid() == false);
+
+    // the last piece completes the time of piece 0, 7 quarters ago
+    QVERIFY(tc.quarterFrame(series[7]) == true);
+    QVERIFY(tc.isValid() == true);
+    QCOMPARE(tc.frameRate(), MidiTimeCode::Fps25);
+    QCOMPARE(tc.position(), time + 70);
+
+    // then every quarter frame moves on by 10ms
+    QVERIFY(tc.quarterFrame(0x06) == true);
+    QCOMPARE(tc.position(), time + 80);
+    QVERIFY(tc.quarterFrame(0x10) == true);
+    QCOMPARE(tc.position(), time + 90);
+
+    // a piece out of sequence waits for a new series
+    QVERIFY(tc.quarterFrame(0x50) == false);
+    QVERIFY(tc.quarterFrame(0x30) == false);
+    QCOMPARE(tc.position(), time + 90);
+    QVERIFY(tc.isValid() == true);
+}
+
+void Midi_Test::timecodeFullFrame()
+{
+    MidiTimeCode tc;
+
+    // 10:00:01:15 at 30 fps
+    const uchar frame[10] = { 0xF0, 0x7F, 0x7F, 0x01, 0x01, (3 << 5) | 10, 0, 1, 15, 0xF7 };
+    QVERIFY(tc.fullFrame(frame, 5) == false);
+    QVERIFY(tc.fullFrame(frame, 10) == true);
+    QVERIFY(tc.isValid() == true);
+    QCOMPARE(tc.frameRate(), MidiTimeCode::Fps30);
+    QCOMPARE(tc.position(), qint64(10 * 3600000 + 1000 + 500));
+
+    // other SysEx messages are ignored
+    const uchar other[10] = { 0xF0, 0x7E, 0x7F, 0x06, 0x01, 0, 0, 0, 0, 0xF7 };
+    QVERIFY(tc.fullFrame(other, 10) == false);
+    QCOMPARE(tc.position(), qint64(10 * 3600000 + 1000 + 500));
+}
+
+void Midi_Test::timecodeDropFrame()
+{
+    MidiTimeCode::FrameRate rate = MidiTimeCode::Fps2997Drop;
+
+    QCOMPARE(MidiTimeCode::toMsecs(0, 0, 0, 0, rate), qint64(0));
+    QCOMPARE(MidiTimeCode::toMsecs(0, 0, 1, 0, rate), qint64(1001));
+
+    // frames 0 and 1 don't exist at 00:01:00, so 00:01:00:02
+    // is the 1800th frame
+    QCOMPARE(MidiTimeCode::toMsecs(0, 1, 0, 2, rate), qint64(60060));
+
+    // but they do every ten minutes, so time code stays close to real time
+    QCOMPARE(MidiTimeCode::toMsecs(0, 10, 0, 0, rate), qint64(599999));
+    QCOMPARE(MidiTimeCode::toMsecs(1, 0, 0, 0, rate), qint64(3599996));
+}
+
 QTEST_MAIN(Midi_Test)
@@ -28,6 +28,14 @@ class Midi_Test final : public QObject
 
 private slots:
     void midiToInput();
+    void schedulerCoalesce();
+    void schedulerBandwidth();
+    void schedulerRunningStatus();
+    void clockTempo();
+    void clockSongPosition();
+    void timecodeQuarterFrames();
+    void timecodeFullFrame();
+    void timecodeDropFrame();
 };
 
 #endif
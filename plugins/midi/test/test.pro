@@ -14,5 +14,9 @@ INCLUDEPATH += ../src/common
 DEPENDPATH  += ../src
 
 # Test sources
-HEADERS += midi_test.h ../../interfaces/qlcioplugin.h ../src/common/midiprotocol.h
-SOURCES += midi_test.cpp  ../src/common/midiprotocol.cpp ../../interfaces/qlcioplugin.cpp
+HEADERS += midi_test.h ../../interfaces/qlcioplugin.h ../src/common/midiprotocol.h \
+           ../src/common/midioutputscheduler.h ../src/common/midiclock.h \
+           ../src/common/miditimecode.h
+SOURCES += midi_test.cpp  ../src/common/midiprotocol.cpp ../../interfaces/qlcioplugin.cpp \
+           ../src/common/midioutputscheduler.cpp ../src/common/midiclock.cpp \
+           ../src/common/miditimecode.cpp
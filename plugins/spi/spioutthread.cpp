@@ -20,19 +20,46 @@
 #include <QMutexLocker>
 #include <QSettings>
 #include <QDebug>
+#include <QFile>
 
 #include <time.h>
+#include <errno.h>
+#include <string.h>
 #include <sys/ioctl.h>
-#include <linux/spi/spidev.h>
 
 #include "spioutthread.h"
 
+/** Where the spidev module exposes the maximum size of a message */
+#define SPIDEV_BUFSIZ_PARAMETER "/sys/module/spidev/parameters/bufsiz"
+#define SPIDEV_DEFAULT_BUFSIZ   4096
+
+/** Time the bus is kept idle after a frame, so that pixel
+ *  drivers like WS2801 latch the data received (500us minimum) */
+#define SPI_LATCH_TIME_NS       1000000LL
+
+/** Refresh period when there is nothing to send */
+#define SPI_IDLE_PERIOD_NS      20000000LL
+
+#define NSEC_PER_SEC            1000000000LL
+
 SPIOutThread::SPIOutThread()
-    : m_isRunning(false)
-    , m_dataSize(0)
-    , m_estimatedWireTime(50000)
+    : m_spifd(-1)
+    , m_bitsPerWord(8)
+    , m_speed(1000000)
+    , m_isRunning(false)
+    , m_frameReady(false)
+    , m_maxTransferSize(SPIDEV_DEFAULT_BUFSIZ)
 {
-
+    QFile bufsiz(SPIDEV_BUFSIZ_PARAMETER);
+    if (bufsiz.open(QIODevice::ReadOnly))
+    {
+        bool ok = false;
+        int size = bufsiz.readAll().trimmed().toInt(&ok);
+        if (ok && size > 0)
+            m_maxTransferSize = size;
+        bufsiz.close();
+    }
+    qDebug() << "[SPI out thread] max transfer size:" << m_maxTransferSize;
 }
 
 void SPIOutThread::runThread(int fd, int speed)
@@ -59,6 +86,9 @@ void SPIOutThread::runThread(int fd, int speed)
     if (status < 0)
         qWarning() << "Could not set SPI speed (WR)...ioctl fail";
 
+    // speed is stored in every transfer
+    m_transfers.clear();
+
     m_isRunning = true;
     start();
 }
@@ -80,65 +110,163 @@ void SPIOutThread::setSpeed(int speed)
         wait();
         runThread(m_spifd, speed);
     }
+    else
+    {
+        m_speed = speed;
+    }
 }
 
 void SPIOutThread::run()
 {
+    qint64 deadline = now();
+
     while (m_isRunning)
     {
-        struct spi_ioc_transfer spi;
+        {
+            QMutexLocker locker(&m_mutex);
+            if (m_frameReady)
+            {
+                m_frontFrame.swap(m_readyFrame);
+                m_frameReady = false;
+            }
+        }
 
-        struct timespec ts_start;
-        struct timespec ts_end;
-#ifdef CLOCK_MONOTONIC
-        clock_gettime(CLOCK_MONOTONIC, &ts_start);
-#else
-        clock_gettime(CLOCK_REALTIME, &ts_start);
-#endif
+        qint64 period = SPI_IDLE_PERIOD_NS;
 
-        if (m_spifd != -1 && m_pluginData.size() > 0)
+        if (m_spifd != -1 && m_frontFrame.size() > 0)
         {
-            QMutexLocker locker(&m_mutex);
-            memset(&spi, 0, sizeof(spi));
-            spi.tx_buf        = reinterpret_cast<__u64>(m_pluginData.data());
-            spi.len           = m_pluginData.size();
-            spi.delay_usecs   = 0;
-            spi.speed_hz      = m_speed;
-            spi.bits_per_word = m_bitsPerWord;
-            spi.cs_change = 0;
-
-            int retVal = ioctl(m_spifd, SPI_IOC_MESSAGE(1), &spi);
-            if (retVal < 0)
-                qWarning() << "Problem transmitting SPI data: ioctl failed";
+            sendFrame();
+            period = wireTime(m_frontFrame.size()) + SPI_LATCH_TIME_NS;
         }
 
-#ifdef CLOCK_MONOTONIC
-        clock_gettime(CLOCK_MONOTONIC, &ts_end);
-#else
-        clock_gettime(CLOCK_REALTIME, &ts_end);
-#endif
-        int uSecDiff = (difftime(ts_end.tv_sec, ts_start.tv_sec) * 1000000) + ((ts_end.tv_nsec - ts_start.tv_nsec) / 1000);
-        //qDebug() << "[SPI] ioctl took" << microseconds << "uSecDiff";
-        usleep(m_estimatedWireTime - uSecDiff);
+        // Frames are paced against absolute deadlines, so the time spent
+        // in the ioctl doesn't accumulate. If the transfer took longer than
+        // expected, the bus is still given the time to latch the data.
+        deadline += period;
+
+        qint64 earliest = now() + SPI_LATCH_TIME_NS;
+        if (deadline < earliest)
+            deadline = earliest;
+
+        sleepUntil(deadline);
     }
 }
 
-void SPIOutThread::writeData(const QByteArray &data)
+/*********************************************************************
+ * Frames
+ *********************************************************************/
+
+void SPIOutThread::setFrameSize(int size)
+{
+    resizeFrame(m_backFrame, size);
+}
+
+void SPIOutThread::writeData(int address, const QByteArray &data, int length)
+{
+    int len = qMin(qMin(data.size(), length), m_backFrame.size() - address);
+    if (address < 0 || len <= 0)
+        return;
+
+    memcpy(m_backFrame.data() + address, data.constData(), len);
+}
+
+void SPIOutThread::commitFrame()
 {
     QMutexLocker locker(&m_mutex);
-    m_pluginData = data;
-    if (m_dataSize != data.size())
+    m_backFrame.swap(m_readyFrame);
+    m_frameReady = true;
+
+    // the buffer given back may be older than a frame size change
+    resizeFrame(m_backFrame, m_readyFrame.size());
+}
+
+void SPIOutThread::resizeFrame(QByteArray &frame, int size)
+{
+    int oldSize = frame.size();
+    if (size == oldSize)
+        return;
+
+    frame.resize(size);
+    if (size > oldSize)
+        memset(frame.data() + oldSize, 0, size - oldSize);
+}
+
+void SPIOutThread::prepareTransfers()
+{
+    int segments = (m_frontFrame.size() + m_maxTransferSize - 1) / m_maxTransferSize;
+    int remaining = m_frontFrame.size();
+
+    m_transfers.resize(segments);
+
+    for (int i = 0; i < segments; i++)
+    {
+        struct spi_ioc_transfer &spi = m_transfers[i];
+        memset(&spi, 0, sizeof(spi));
+        spi.len           = qMin(remaining, m_maxTransferSize);
+        spi.delay_usecs   = 0;
+        spi.speed_hz      = m_speed;
+        spi.bits_per_word = m_bitsPerWord;
+        spi.cs_change     = 0;
+        remaining -= spi.len;
+    }
+
+    qDebug() << "[SPI out thread] frame of" << m_frontFrame.size()
+             << "bytes sent in" << segments << "segments";
+}
+
+void SPIOutThread::sendFrame()
+{
+    int total = 0;
+    foreach (const struct spi_ioc_transfer &spi, m_transfers)
+        total += spi.len;
+
+    if (total != m_frontFrame.size())
+        prepareTransfers();
+
+    // The spidev module limits the size of a whole message to its bufsiz,
+    // so long chains are sent with back to back messages, one per segment
+    __u64 txBuf = reinterpret_cast<__u64>(m_frontFrame.constData());
+
+    for (int i = 0; i < m_transfers.count(); i++)
     {
-        // Data size has changed! I need to estimate the
-        // time that the SPI writes will take on the wire.
-        // The estimation is very unprecise and it is based
-        // on Simon Newton's measurements on a Raspberry Pi
-        // where 512 bytes at 1Mhz takes about 70ms to be sent
-
-        double byteWriteTimeuS = (double)(70000.0 / ((double)m_speed / 1000000.0)) / 512.0; // time taken to write a byte
-        m_estimatedWireTime = byteWriteTimeuS * (double)data.size();
-        m_dataSize = data.size();
-        qDebug() << "[SPI out thread] estimated sleep time:" << m_estimatedWireTime;
+        struct spi_ioc_transfer &spi = m_transfers[i];
+        spi.tx_buf = txBuf;
+        txBuf += spi.len;
+
+        int retVal = ioctl(m_spifd, SPI_IOC_MESSAGE(1), &spi);
+        if (retVal < 0)
+        {
+            qWarning() << "Problem transmitting SPI data: ioctl failed";
+            break;
+        }
     }
 }
 
+/*********************************************************************
+ * Timing
+ *********************************************************************/
+
+qint64 SPIOutThread::now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return qint64(ts.tv_sec) * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+void SPIOutThread::sleepUntil(qint64 deadline)
+{
+    struct timespec ts;
+    ts.tv_sec = deadline / NSEC_PER_SEC;
+    ts.tv_nsec = deadline % NSEC_PER_SEC;
+
+    // an absolute sleep can simply be restarted when interrupted by a signal
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {}
+}
+
+qint64 SPIOutThread::wireTime(int bytes) const
+{
+    if (m_speed <= 0)
+        return 0;
+
+    return qint64(bytes) * m_bitsPerWord * NSEC_PER_SEC / m_speed;
+}
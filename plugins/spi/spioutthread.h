@@ -20,7 +20,10 @@
 #ifndef SPIOUTTHREAD_H
 #define SPIOUTTHREAD_H
 
+#include <linux/spi/spidev.h>
+#include <QVector>
 #include <QThread>
+#include <QMutex>
 
 class SPIOutThread final : public QThread
 {
@@ -33,7 +36,30 @@ public:
 
     void run() override;
 
-    void writeData(const QByteArray& data);
+    /*********************************************************************
+     * Frames
+     *********************************************************************/
+public:
+    /** Set the size in bytes of the frames assembled by the SPI plugin */
+    void setFrameSize(int size);
+
+    /** Copy at most $length bytes of a universe into the frame
+     *  being assembled, starting at the given absolute address */
+    void writeData(int address, const QByteArray& data, int length);
+
+    /** Hand the assembled frame over to the output thread.
+     *  Buffers are swapped, so no data is copied */
+    void commitFrame();
+
+private:
+    /** Resize a frame buffer, clearing the bytes added */
+    static void resizeFrame(QByteArray& frame, int size);
+
+    /** Split m_frontFrame into transfers no bigger than m_maxTransferSize */
+    void prepareTransfers();
+
+    /** Send m_frontFrame on the wire */
+    void sendFrame();
 
 protected:
     /** File handle for /dev/spidev0.0 */
@@ -43,18 +69,38 @@ protected:
 
     bool m_isRunning;
 
-    /** Copy of data received from the SPI plugin */
-    QByteArray m_pluginData;
+    /** Frames are triple buffered: the plugin assembles m_backFrame,
+     *  m_readyFrame holds the last complete frame and m_frontFrame
+     *  is the one being sent on the wire */
+    QByteArray m_backFrame;
+    QByteArray m_readyFrame;
+    QByteArray m_frontFrame;
+    bool m_frameReady;
 
-    /** Last size of data sent to the SPI bus */
-    int m_dataSize;
+    /** The maximum size of a SPI message, as set by the spidev
+     *  module bufsiz parameter */
+    int m_maxTransferSize;
 
-    /** Roughly estimated time that SPI writes will take on the wire (in uS) */
-    quint32 m_estimatedWireTime;
+    /** The segments used to send m_frontFrame */
+    QVector<struct spi_ioc_transfer> m_transfers;
 
-    /** Mutex used to synchronize data between the SPI plugin
+    /** Mutex used to swap the frames between the SPI plugin
      *  and the output thread */
     QMutex m_mutex;
+
+    /*********************************************************************
+     * Timing
+     *********************************************************************/
+private:
+    /** Return the current monotonic time in nanoseconds */
+    static qint64 now();
+
+    /** Sleep until the given monotonic time in nanoseconds */
+    static void sleepUntil(qint64 deadline);
+
+    /** Return the time in nanoseconds that the given amount
+     *  of bytes takes on the wire at the current speed */
+    qint64 wireTime(int bytes) const;
 };
 
 #endif // SPIOUTTHREAD_H
@@ -17,6 +17,7 @@
   limitations under the License.
 */
 
+#include <QMutexLocker>
 #include <QStringList>
 #include <QSettings>
 #include <QString>
@@ -49,6 +50,7 @@ void SPIPlugin::init()
 {
     m_spifd = -1;
     m_referenceCount = 0;
+    m_frameSize = 0;
     m_outThread = NULL;
 }
 
@@ -71,6 +73,8 @@ bool SPIPlugin::openOutput(quint32 output, quint32 universe)
     if (output != 0)
         return false;
 
+    QMutexLocker locker(&m_frameMutex);
+
     m_referenceCount++;
 
     addToMap(universe, output, Output);
@@ -92,6 +96,7 @@ bool SPIPlugin::openOutput(quint32 output, quint32 universe)
         speed = value.toUInt();
 
     m_outThread = new SPIOutThread();
+    m_outThread->setFrameSize(m_frameSize);
     m_outThread->runThread(m_spifd, speed);
 
     return true;
@@ -104,10 +109,22 @@ void SPIPlugin::closeOutput(quint32 output, quint32 universe)
 
     removeFromMap(output, universe, Output);
 
+    // Wait for any universe being written to finish
+    // before tearing down the output thread
+    QMutexLocker locker(&m_frameMutex);
+
     m_referenceCount--;
 
     if (m_referenceCount == 0)
     {
+        if (m_outThread != NULL)
+        {
+            m_outThread->stopThread();
+            delete m_outThread;
+            m_outThread = NULL;
+        }
+        m_frameUniverses.clear();
+
         if (m_spifd != -1)
             close(m_spifd);
         m_spifd = -1;
@@ -162,8 +179,10 @@ void SPIPlugin::setAbsoluteAddress(quint32 uniID, SPIUniverse *uni)
     totalChannels += uni->m_channels;
     qDebug() << "[SPI] universe" << uniID << "has" << uni->m_channels
              << "channels and starts at" << uni->m_absoluteAddress;
-    m_serializedData.resize(totalChannels);
-    qDebug() << "[SPI] total bytes to transmit:" << m_serializedData.size();
+    m_frameSize = totalChannels;
+    if (m_outThread != NULL)
+        m_outThread->setFrameSize(m_frameSize);
+    qDebug() << "[SPI] total bytes to transmit:" << m_frameSize;
 }
 
 QString SPIPlugin::outputInfo(quint32 output)
@@ -185,12 +204,27 @@ void SPIPlugin::writeUniverse(quint32 universe, quint32 output, const QByteArray
 {
     Q_UNUSED(dataChanged)
 
-    if (output != 0 || m_spifd == -1)
+    if (output != 0)
         return;
 
-    qDebug() << "[SPI] write" << universe << "size" << data.size();
+    // Universes may be written by different threads. The whole
+    // sequence assembling and committing a frame must be atomic
+    QMutexLocker locker(&m_frameMutex);
 
-    SPIUniverse *uniInfo = m_uniChannelsMap[universe];
+    if (m_spifd == -1 || m_outThread == NULL)
+        return;
+
+    //qDebug() << "[SPI] write" << universe << "size" << data.size();
+
+    // A universe written twice means that a new MasterTimer tick
+    // started before the previous frame was complete
+    if (m_frameUniverses.contains(universe))
+    {
+        m_outThread->commitFrame();
+        m_frameUniverses.clear();
+    }
+
+    SPIUniverse *uniInfo = m_uniChannelsMap.value(universe, NULL);
     if (uniInfo != NULL)
     {
         if (uniInfo->m_autoDetection == true)
@@ -201,18 +235,25 @@ void SPIPlugin::writeUniverse(quint32 universe, quint32 output, const QByteArray
                 setAbsoluteAddress(universe, uniInfo);
             }
         }
-        m_serializedData.replace(uniInfo->m_absoluteAddress, data.size(), data);
     }
     else
     {
-        SPIUniverse *newUni = new SPIUniverse;
-        newUni->m_channels = data.size();
-        newUni->m_autoDetection = true;
-        setAbsoluteAddress(universe, newUni);
-        m_uniChannelsMap[universe] = newUni;
+        uniInfo = new SPIUniverse;
+        uniInfo->m_channels = data.size();
+        uniInfo->m_autoDetection = true;
+        setAbsoluteAddress(universe, uniInfo);
+        m_uniChannelsMap[universe] = uniInfo;
     }
 
-    m_outThread->writeData(m_serializedData);
+    m_outThread->writeData(uniInfo->m_absoluteAddress, data, uniInfo->m_channels);
+
+    // Assemble all the universes of a tick in a single frame
+    m_frameUniverses.insert(universe);
+    if (m_frameUniverses.count() >= m_uniChannelsMap.count())
+    {
+        m_outThread->commitFrame();
+        m_frameUniverses.clear();
+    }
 }
 
 /*****************************************************************************
@@ -226,6 +267,7 @@ void SPIPlugin::configure()
     {
         QSettings settings;
         settings.setValue(SETTINGS_OUTPUT_FREQUENCY, QVariant(conf.frequency()));
+        QMutexLocker locker(&m_frameMutex);
         if (m_outThread != NULL)
             m_outThread->setSpeed(conf.frequency());
     }
@@ -250,6 +292,7 @@ void SPIPlugin::setParameter(quint32 universe, quint32 line, Capability type,
         uniStruct->m_channels = chans;
         uniStruct->m_autoDetection = false;
 
+        QMutexLocker locker(&m_frameMutex);
         setAbsoluteAddress(universe, uniStruct);
 
         m_uniChannelsMap[universe] = uniStruct;
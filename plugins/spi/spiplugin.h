@@ -24,6 +24,7 @@
 #include <QMutex>
 #include <QFile>
 #include <QHash>
+#include <QSet>
 
 #include "qlcioplugin.h"
 
@@ -34,7 +35,7 @@ typedef struct
     /** number of channels used in a universe */
     ushort m_channels;
     /** absolute address where data of this universe
-     *  starts in the m_serializedData array */
+     *  starts in the frame sent on the wire */
     ushort m_absoluteAddress;
     /** flag to instruct the SPI plugin to autodetect
      *  a universe size during a writeUniverse */
@@ -99,13 +100,21 @@ protected:
     /** Map of <Universe ID/number of channels> */
     QHash<quint32, SPIUniverse*> m_uniChannelsMap;
 
-    /** Array holding all the universes data controlled
-     *  by the SPI plugin, ready to be sent as a serial
-     *  transfer */
-    QByteArray m_serializedData;
+    /** Total size of a frame holding all the universes
+     *  controlled by the SPI plugin, sent as one serial transfer */
+    int m_frameSize;
+
+    /** The universes written in the frame being assembled. When all
+     *  of them have been written, the frame is committed */
+    QSet<quint32> m_frameUniverses;
 
     SPIOutThread *m_outThread;
 
+    /** Mutex serializing the frame assembly: the universe map, the frame
+     *  layout and the output thread are shared by all the universes
+     *  writers and by the open/close/configuration calls */
+    QMutex m_frameMutex;
+
     /*********************************************************************
      * Configuration
      *********************************************************************/
@@ -1641,11 +1641,8 @@ void ContextManager::slotSimpleDeskValueChanged(quint32 fxID, quint32 channel, q
 
 void ContextManager::slotUniverseWritten(quint32 idx, const QByteArray &ua)
 {
-    for (Fixture *fixture : m_doc->fixtures())
+    for (Fixture *fixture : m_doc->fixturesInUniverse(idx))
     {
-        if (fixture->universe() != idx)
-            continue;
-
         QByteArray prevValues;
         prevValues.append(fixture->channelValues());
 
@@ -0,0 +1,206 @@
+/*
+  Q Light Controller Plus
+  fixturevisualdecoder.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include "fixturevisualdecoder.h"
+#include "qlcfixturemode.h"
+#include "fixtureutils.h"
+#include "qlcchannel.h"
+#include "fixture.h"
+
+FixtureVisualDecoder::FixtureVisualDecoder(const Fixture *fixture)
+    : m_modeName(fixture->fixtureMode() != nullptr ? fixture->fixtureMode()->name() : QString())
+    , m_channelsCount(fixture->channels())
+    , m_masterDimmer(fixture->masterIntensityChannel())
+{
+    int headsCount = fixture->fixtureMode() != nullptr ? fixture->heads() : 0;
+    m_heads.resize(headsCount);
+
+    for (int h = 0; h < headsCount; h++)
+    {
+        HeadChannels &head = m_heads[h];
+
+        head.dimmer = fixture->channelNumber(QLCChannel::Intensity, QLCChannel::MSB, h);
+        if (head.dimmer == QLCChannel::invalid())
+            head.dimmer = m_masterDimmer;
+        head.applyMaster = head.dimmer != m_masterDimmer;
+
+        QVector<quint32> rgb = fixture->rgbChannels(h);
+        head.hasRGB = rgb.size() == 3;
+        for (int i = 0; i < 3; i++)
+            head.rgb[i] = head.hasRGB ? rgb.at(i) : QLCChannel::invalid();
+
+        QVector<quint32> cmy = fixture->cmyChannels(h);
+        head.hasCMY = cmy.size() == 3;
+        for (int i = 0; i < 3; i++)
+            head.cmy[i] = head.hasCMY ? cmy.at(i) : QLCChannel::invalid();
+
+        head.white = fixture->channelNumber(QLCChannel::White, QLCChannel::MSB, h);
+        head.amber = fixture->channelNumber(QLCChannel::Amber, QLCChannel::MSB, h);
+        head.uv = fixture->channelNumber(QLCChannel::UV, QLCChannel::MSB, h);
+        head.lime = fixture->channelNumber(QLCChannel::Lime, QLCChannel::MSB, h);
+        head.indigo = fixture->channelNumber(QLCChannel::Indigo, QLCChannel::MSB, h);
+
+        head.hasColor = head.hasRGB || head.hasCMY ||
+                        head.white != QLCChannel::invalid() || head.amber != QLCChannel::invalid() ||
+                        head.uv != QLCChannel::invalid() || head.lime != QLCChannel::invalid() ||
+                        head.indigo != QLCChannel::invalid();
+    }
+
+    for (quint32 i = 0; i < m_channelsCount; i++)
+    {
+        const QLCChannel *ch = fixture->channel(i);
+        if (ch == nullptr)
+            continue;
+
+        switch (ch->group())
+        {
+            case QLCChannel::Pan:
+            case QLCChannel::Tilt:
+            case QLCChannel::Colour:
+            case QLCChannel::Gobo:
+            case QLCChannel::Shutter:
+            case QLCChannel::Speed:
+            case QLCChannel::Beam:
+            {
+                CapabilityChannel capCh;
+                capCh.index = i;
+                capCh.group = ch->group();
+                capCh.msb = ch->controlByte() == QLCChannel::MSB;
+                capCh.channel = ch;
+                m_capabilityChannels.append(capCh);
+            }
+            break;
+            default:
+            break;
+        }
+    }
+}
+
+FixtureVisualDecoder::~FixtureVisualDecoder()
+{
+}
+
+bool FixtureVisualDecoder::isValidFor(const Fixture *fixture) const
+{
+    const QLCFixtureMode *mode = fixture->fixtureMode();
+
+    return (mode != nullptr ? mode->name() : QString()) == m_modeName &&
+           fixture->channels() == m_channelsCount &&
+           (mode == nullptr || fixture->heads() == m_heads.count());
+}
+
+int FixtureVisualDecoder::heads() const
+{
+    return m_heads.count();
+}
+
+qreal FixtureVisualDecoder::headIntensity(Fixture *fixture, int headIndex) const
+{
+    const HeadChannels &head = m_heads.at(headIndex);
+
+    if (head.dimmer == QLCChannel::invalid())
+        return 1.0;
+
+    qreal intensity = qreal(fixture->channelValueAt(int(head.dimmer))) / 255.0;
+
+    if (head.applyMaster && m_masterDimmer != QLCChannel::invalid())
+        intensity *= qreal(fixture->channelValueAt(int(m_masterDimmer))) / 255.0;
+
+    return intensity;
+}
+
+QColor FixtureVisualDecoder::headColor(Fixture *fixture, int headIndex) const
+{
+    const HeadChannels &head = m_heads.at(headIndex);
+
+    if (head.hasColor == false)
+        return Qt::white;
+
+    QColor finalColor = head.dimmer != QLCChannel::invalid() ? Qt::black : Qt::white;
+
+    if (head.hasRGB)
+    {
+        finalColor.setRgb(fixture->channelValueAt(head.rgb[0]),
+                          fixture->channelValueAt(head.rgb[1]),
+                          fixture->channelValueAt(head.rgb[2]));
+    }
+
+    if (head.hasCMY)
+    {
+        finalColor.setCmyk(fixture->channelValueAt(head.cmy[0]),
+                           fixture->channelValueAt(head.cmy[1]),
+                           fixture->channelValueAt(head.cmy[2]), 0);
+    }
+
+    uchar value;
+
+    if (head.white != QLCChannel::invalid() && (value = fixture->channelValueAt(head.white)))
+        finalColor = FixtureUtils::blendColors(finalColor, Qt::white, float(value) / 255.0);
+
+    if (head.amber != QLCChannel::invalid() && (value = fixture->channelValueAt(head.amber)))
+        finalColor = FixtureUtils::blendColors(finalColor, QColor(0xFFFF7E00), float(value) / 255.0);
+
+    if (head.uv != QLCChannel::invalid() && (value = fixture->channelValueAt(head.uv)))
+        finalColor = FixtureUtils::blendColors(finalColor, QColor(0xFF9400D3), float(value) / 255.0);
+
+    if (head.lime != QLCChannel::invalid() && (value = fixture->channelValueAt(head.lime)))
+        finalColor = FixtureUtils::blendColors(finalColor, QColor(0xFFADFF2F), float(value) / 255.0);
+
+    if (head.indigo != QLCChannel::invalid() && (value = fixture->channelValueAt(head.indigo)))
+        finalColor = FixtureUtils::blendColors(finalColor, QColor(0xFF4B0082), float(value) / 255.0);
+
+    return finalColor;
+}
+
+const QVector<FixtureVisualDecoder::CapabilityChannel> &FixtureVisualDecoder::capabilityChannels() const
+{
+    return m_capabilityChannels;
+}
+
+/*********************************************************************
+ * Cache
+ *********************************************************************/
+
+QSharedPointer<FixtureVisualDecoder> FixtureVisualDecoder::decoder(Cache &cache, const Fixture *fixture)
+{
+    const QLCFixtureMode *mode = fixture->fixtureMode();
+    QPair<quint32, QString> key(fixture->id(), mode != nullptr ? mode->name() : QString());
+
+    QSharedPointer<FixtureVisualDecoder> dec = cache.value(key);
+
+    if (dec.isNull() || dec->isValidFor(fixture) == false)
+    {
+        dec = QSharedPointer<FixtureVisualDecoder>(new FixtureVisualDecoder(fixture));
+        cache.insert(key, dec);
+    }
+
+    return dec;
+}
+
+void FixtureVisualDecoder::invalidate(Cache &cache, quint32 fixtureID)
+{
+    Cache::iterator it = cache.begin();
+    while (it != cache.end())
+    {
+        if (it.key().first == fixtureID)
+            it = cache.erase(it);
+        else
+            ++it;
+    }
+}
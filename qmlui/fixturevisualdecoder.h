@@ -0,0 +1,129 @@
+/*
+  Q Light Controller Plus
+  fixturevisualdecoder.h
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#ifndef FIXTUREVISUALDECODER_H
+#define FIXTUREVISUALDECODER_H
+
+#include <QSharedPointer>
+#include <QVector>
+#include <QString>
+#include <QColor>
+#include <QHash>
+#include <QPair>
+
+class QLCFixtureMode;
+class QLCChannel;
+class Fixture;
+
+/**
+ * FixtureVisualDecoder holds what the 2D and 3D previews need to know
+ * about the channels of a fixture mode: the intensity and colour mixing
+ * channels of each head, and the channels with "common" capabilities
+ * like pan/tilt, colour wheels, gobos, shutters, speed and zoom.
+ *
+ * It is compiled once per fixture and mode and then used to decode
+ * its channel values, so that the previews don't have to look up
+ * channel roles on every value change. Since it keeps references to
+ * the mode channels, it must be dropped when the fixture changes.
+ */
+class FixtureVisualDecoder
+{
+public:
+    FixtureVisualDecoder(const Fixture *fixture);
+    ~FixtureVisualDecoder();
+
+    /** Return true if this decoder has been compiled for the mode of $fixture */
+    bool isValidFor(const Fixture *fixture) const;
+
+    /** Get the number of heads decoded */
+    int heads() const;
+
+    /** Get the intensity (0.0 - 1.0) of the given head, master dimmer included */
+    qreal headIntensity(Fixture *fixture, int headIndex) const;
+
+    /** Get the colour of the given head, as FixtureUtils::headColor() would */
+    QColor headColor(Fixture *fixture, int headIndex) const;
+
+    /** A channel with a capability the previews display */
+    typedef struct
+    {
+        quint32 index;
+        int group;
+        bool msb;
+        const QLCChannel *channel;
+    } CapabilityChannel;
+
+    /** Get the pan, tilt, colour, gobo, shutter, speed and beam
+     *  channels, in channel order */
+    const QVector<CapabilityChannel>& capabilityChannels() const;
+
+private:
+    typedef struct
+    {
+        quint32 dimmer;
+        bool applyMaster;
+        quint32 rgb[3];
+        bool hasRGB;
+        quint32 cmy[3];
+        bool hasCMY;
+        quint32 white;
+        quint32 amber;
+        quint32 uv;
+        quint32 lime;
+        quint32 indigo;
+        bool hasColor;
+    } HeadChannels;
+
+    QString m_modeName;
+    quint32 m_channelsCount;
+    quint32 m_masterDimmer;
+
+    QVector<HeadChannels> m_heads;
+    QVector<CapabilityChannel> m_capabilityChannels;
+
+    /*********************************************************************
+     * Cache
+     *********************************************************************/
+public:
+    /** The decoders of a preview, by fixture ID and mode name */
+    typedef QHash<QPair<quint32, QString>, QSharedPointer<FixtureVisualDecoder> > Cache;
+
+    /** Get the decoder for the mode of $fixture from $cache,
+     *  compiling it when not present or outdated */
+    static QSharedPointer<FixtureVisualDecoder> decoder(Cache &cache, const Fixture *fixture);
+
+    /** Remove the decoders of the given fixture from $cache.
+     *  To be called when the fixture changes or is removed */
+    static void invalidate(Cache &cache, quint32 fixtureID);
+};
+
+/**
+ * The last visual state pushed to a preview item.
+ * Previews compare a new state against this one and update
+ * only the properties of the item that actually changed.
+ */
+typedef struct
+{
+    QVector<qreal> intensity;
+    QVector<QRgb> color;
+    int pan;
+    int tilt;
+} FixtureVisualState;
+
+#endif // FIXTUREVISUALDECODER_H
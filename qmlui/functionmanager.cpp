@@ -1123,7 +1123,7 @@ void FunctionManager::dumpDmxValues(QList<SceneValue> dumpValues, QList<quint32>
     qDebug() << "[DUMP] Scene name/ID:" << sceneName << sceneID;
     qDebug() << "[DUMP] Only non-zero?" << nonZeroOnly;
 
-    QList<Universe*> ua = m_doc->inputOutputMap()->claimUniverses();
+    QList<Universe*> ua = m_doc->inputOutputMap()->universes();
 
     // 1- load current pre-GM values from all the universes
     QByteArray preGMValues(ua.size() * UNIVERSE_SIZE, 0);
@@ -1131,7 +1131,7 @@ void FunctionManager::dumpDmxValues(QList<SceneValue> dumpValues, QList<quint32>
     for (int i = 0; i < ua.count(); ++i)
     {
         const int offset = i * UNIVERSE_SIZE;
-        preGMValues.replace(offset, UNIVERSE_SIZE, ua.at(i)->preGMValues());
+        preGMValues.replace(offset, UNIVERSE_SIZE, ua.at(i)->snapshotPreGMValues());
         if (ua.at(i)->passthrough())
         {
             for (int j = 0; j < UNIVERSE_SIZE; ++j)
@@ -1143,8 +1143,6 @@ void FunctionManager::dumpDmxValues(QList<SceneValue> dumpValues, QList<quint32>
         }
     }
 
-    m_doc->inputOutputMap()->releaseUniverses(false);
-
     // 2- determine if we're dumping on a new or existing Scene
     Scene *targetScene = nullptr;
     if (sceneID != Function::invalidId())
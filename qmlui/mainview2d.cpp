@@ -45,6 +45,9 @@ MainView2D::MainView2D(QQuickView *view, Doc *doc, QObject *parent)
     fixtureComponent = new QQmlComponent(m_view->engine(), QUrl("qrc:/Fixture2DItem.qml"));
     if (fixtureComponent->isError())
         qDebug() << fixtureComponent->errors();
+
+    connect(m_doc, &Doc::fixtureChanged, this, &MainView2D::slotFixtureChanged);
+    connect(m_doc, &Doc::fixtureRemoved, this, &MainView2D::slotFixtureChanged);
 }
 
 MainView2D::~MainView2D()
@@ -95,6 +98,8 @@ void MainView2D::resetItems()
         delete it.value();
     }
     m_itemsMap.clear();
+    m_itemStates.clear();
+    m_decoders.clear();
 }
 
 bool MainView2D::initialize2DProperties()
@@ -152,6 +157,9 @@ void MainView2D::createFixtureItem(quint32 fxID, quint16 headIndex, quint16 link
     QQuickItem *newFixtureItem = qobject_cast<QQuickItem*>(fixtureComponent->create());
     quint32 itemFlags = m_monProps->fixtureFlags(fxID, headIndex, linkedIndex);
 
+    // a new item has nothing pushed yet
+    m_itemStates.remove(itemID);
+
     newFixtureItem->setParentItem(m_gridItem);
     newFixtureItem->setProperty("itemID", itemID);
     newFixtureItem->setProperty("fixtureName", fixture->name());
@@ -307,6 +315,11 @@ int MainView2D::itemIDAtPos(QPointF pos)
     return -1;
 }
 
+void MainView2D::slotFixtureChanged(quint32 fxID)
+{
+    FixtureVisualDecoder::invalidate(m_decoders, fxID);
+}
+
 void MainView2D::slotRefreshView()
 {
     if (isEnabled() == false)
@@ -391,55 +404,56 @@ void MainView2D::updateFixtureItem(Fixture *fixture, quint16 headIndex, quint16
         return;
     }
 
-    quint32 masterDimmerChannel = fixture->masterIntensityChannel();
-    qreal masterDimmerValue = masterDimmerChannel != QLCChannel::invalid() ?
-                              qreal(fixture->channelValueAt(int(masterDimmerChannel))) / 255.0 : 1.0;
+    QSharedPointer<FixtureVisualDecoder> decoder = FixtureVisualDecoder::decoder(m_decoders, fixture);
+    int headsCount = decoder->heads();
 
-    for (int headIdx = 0; headIdx < fixture->heads(); headIdx++)
+    // the item properties are updated only when they actually change.
+    // An empty $previous means that everything has to be refreshed
+    bool newState = m_itemStates.contains(itemID) == false;
+    FixtureVisualState &state = m_itemStates[itemID];
+    if (newState || previous.isEmpty() || state.intensity.count() != headsCount)
     {
-        quint32 headDimmerChannel = fixture->channelNumber(QLCChannel::Intensity, QLCChannel::MSB, headIdx);
-        if (headDimmerChannel == QLCChannel::invalid())
-            headDimmerChannel = masterDimmerChannel;
+        state.intensity.fill(-1.0, headsCount);
+        state.color.fill(0, headsCount);
+        state.pan = state.tilt = -1;
+    }
 
-        //qDebug() << "Head" << headIdx << "dimmer channel:" << headDimmerChannel;
-        qreal intensityValue = 1.0;
-        bool hasDimmer = false;
+    for (int headIdx = 0; headIdx < headsCount; headIdx++)
+    {
+        qreal intensityValue = decoder->headIntensity(fixture, headIdx);
 
-        if (headDimmerChannel != QLCChannel::invalid())
+        if (intensityValue != state.intensity.at(headIdx))
         {
-            intensityValue = (qreal)fixture->channelValueAt(headDimmerChannel) / 255;
-            hasDimmer = true;
+            QMetaObject::invokeMethod(fxItem, "setHeadIntensity",
+                    Q_ARG(QVariant, headIdx),
+                    Q_ARG(QVariant, intensityValue));
+            state.intensity[headIdx] = intensityValue;
         }
 
-        if (headDimmerChannel != masterDimmerChannel)
-            intensityValue *= masterDimmerValue;
+        color = decoder->headColor(fixture, headIdx);
 
-        QMetaObject::invokeMethod(fxItem, "setHeadIntensity",
-                Q_ARG(QVariant, headIdx),
-                Q_ARG(QVariant, intensityValue));
-
-        color = FixtureUtils::headColor(fixture, hasDimmer, headIdx);
-
-        QMetaObject::invokeMethod(fxItem, "setHeadRGBColor",
-                                  Q_ARG(QVariant, headIdx),
-                                  Q_ARG(QVariant, color));
+        if (color.rgba() != state.color.at(headIdx))
+        {
+            QMetaObject::invokeMethod(fxItem, "setHeadRGBColor",
+                                      Q_ARG(QVariant, headIdx),
+                                      Q_ARG(QVariant, color));
+            state.color[headIdx] = color.rgba();
+        }
         colorSet = true;
     } // for heads
 
-    // now scan all the channels for "common" capabilities
-    for (quint32 i = 0; i < fixture->channels(); i++)
+    // now scan the channels with "common" capabilities
+    for (const FixtureVisualDecoder::CapabilityChannel &capCh : decoder->capabilityChannels())
     {
-        const QLCChannel *ch = fixture->channel(i);
-        if (ch == nullptr)
-            continue;
-
+        const QLCChannel *ch = capCh.channel;
+        quint32 i = capCh.index;
         uchar value = fixture->channelValueAt(i);
 
-        switch (ch->group())
+        switch (capCh.group)
         {
             case QLCChannel::Pan:
             {
-                if (ch->controlByte() == QLCChannel::MSB)
+                if (capCh.msb)
                     panDegrees += (value << 8);
                 else
                     panDegrees += (value);
@@ -448,7 +462,7 @@ void MainView2D::updateFixtureItem(Fixture *fixture, quint16 headIndex, quint16
             break;
             case QLCChannel::Tilt:
             {
-                if (ch->controlByte() == QLCChannel::MSB)
+                if (capCh.msb)
                     tiltDegrees += (value << 8);
                 else
                     tiltDegrees += (value);
@@ -487,6 +501,8 @@ void MainView2D::updateFixtureItem(Fixture *fixture, quint16 headIndex, quint16
                         QMetaObject::invokeMethod(fxItem, "setHeadRGBColor",
                                                   Q_ARG(QVariant, 0),
                                                   Q_ARG(QVariant, wheelColor1));
+                        if (state.color.isEmpty() == false)
+                            state.color[0] = wheelColor1.rgba();
                     }
                     colorSet = true;
                 }
@@ -548,11 +564,13 @@ void MainView2D::updateFixtureItem(Fixture *fixture, quint16 headIndex, quint16
         }
     }
 
-    if (setPosition)
+    if (setPosition && (panDegrees != state.pan || tiltDegrees != state.tilt))
     {
         QMetaObject::invokeMethod(fxItem, "setPosition",
                 Q_ARG(QVariant, panDegrees),
                 Q_ARG(QVariant, tiltDegrees));
+        state.pan = panDegrees;
+        state.tilt = tiltDegrees;
     }
 }
 
@@ -671,6 +689,7 @@ void MainView2D::removeFixtureItem(quint32 itemID)
 
     QQuickItem *fixtureItem = m_itemsMap.take(itemID);
     delete fixtureItem;
+    m_itemStates.remove(itemID);
 }
 
 QSize MainView2D::gridSize() const
@@ -23,6 +23,7 @@
 #include <QObject>
 #include <QQuickView>
 
+#include "fixturevisualdecoder.h"
 #include "previewcontext.h"
 
 class Doc;
@@ -139,6 +140,10 @@ public slots:
     /** @reimp */
     void slotRefreshView() override;
 
+protected slots:
+    /** Drop the visual decoders of a fixture that changed or was removed */
+    void slotFixtureChanged(quint32 fxID);
+
 private:
     /** References to the 2D grid item for positioning */
     QQuickItem *m_gridItem;
@@ -159,6 +164,12 @@ private:
 
     /** Pre-cached QML component for quick item creation */
     QQmlComponent *fixtureComponent;
+
+    /** Visual decoders of the fixtures in the preview */
+    FixtureVisualDecoder::Cache m_decoders;
+
+    /** Last visual state pushed to each fixture item, by item ID */
+    QHash<quint32, FixtureVisualState> m_itemStates;
 };
 
 #endif // MAINVIEW2D_H
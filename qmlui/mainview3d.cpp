@@ -87,6 +87,9 @@ MainView3D::MainView3D(QQuickView *view, Doc *doc, QObject *parent)
     m_genericItemsList->setRoleNames(listRoles);
 
     resetCameraPosition();
+
+    connect(m_doc, &Doc::fixtureChanged, this, &MainView3D::slotFixtureChanged);
+    connect(m_doc, &Doc::fixtureRemoved, this, &MainView3D::slotFixtureChanged);
 }
 
 MainView3D::~MainView3D()
@@ -123,6 +126,11 @@ void MainView3D::enableContext(bool enable)
     }
 }
 
+void MainView3D::slotFixtureChanged(quint32 fxID)
+{
+    FixtureVisualDecoder::invalidate(m_decoders, fxID);
+}
+
 void MainView3D::slotRefreshView()
 {
     if (isEnabled() == false)
@@ -182,6 +190,8 @@ void MainView3D::resetItems()
     //for (auto it = m_entitiesMap.begin(); it != end; ++it)
     //    delete it.value();
     m_entitiesMap.clear();
+    m_itemStates.clear();
+    m_decoders.clear();
 
     QMapIterator<quint32, SceneItem*> it2(m_genericMap);
     while (it2.hasNext())
@@ -644,6 +654,7 @@ void MainView3D::createFixtureItem(quint32 fxID, quint16 headIndex, quint16 link
 
     // at last, add the new fixture to the items map
     m_entitiesMap[itemID] = mesh;
+    m_itemStates.remove(itemID);
 
     newItem->setProperty("itemID", itemID);
     if (meshPath.isEmpty() == false)
@@ -1189,73 +1200,73 @@ void MainView3D::updateFixtureItem(Fixture *fixture, quint16 headIndex, quint16
         return;
     }
 
-    quint32 masterDimmerChannel = fixture->masterIntensityChannel();
-    qreal masterDimmerValue = masterDimmerChannel != QLCChannel::invalid() ?
-                              qreal(fixture->channelValueAt(int(masterDimmerChannel))) / 255.0 : 1.0;
+    QSharedPointer<FixtureVisualDecoder> decoder = FixtureVisualDecoder::decoder(m_decoders, fixture);
+    int headsCount = decoder->heads();
 
-    for (int headIdx = 0; headIdx < fixture->heads(); headIdx++)
+    // the entity properties are updated only when they actually change.
+    // An empty $previous means that everything has to be refreshed
+    bool newState = m_itemStates.contains(itemID) == false;
+    FixtureVisualState &state = m_itemStates[itemID];
+    if (newState || previous.isEmpty() || state.intensity.count() != headsCount)
     {
-        quint32 headDimmerChannel = fixture->channelNumber(QLCChannel::Intensity, QLCChannel::MSB, headIdx);
-        if (headDimmerChannel == QLCChannel::invalid())
-            headDimmerChannel = masterDimmerChannel;
+        state.intensity.fill(-1.0, headsCount);
+        state.color.fill(0, headsCount);
+        state.pan = state.tilt = -1;
+    }
+
+    for (int headIdx = 0; headIdx < headsCount; headIdx++)
+    {
+        qreal intensityValue = decoder->headIntensity(fixture, headIdx);
 
-        qreal intensityValue = 1.0;
-        bool hasDimmer = false;
+        //qDebug() << "Head" << headIdx << "intensity" << intensityValue;
 
-        if (headDimmerChannel != QLCChannel::invalid())
+        if (intensityValue != state.intensity.at(headIdx))
         {
-            intensityValue = qreal(fixture->channelValueAt(int(headDimmerChannel))) / 255.0;
-            hasDimmer = true;
+            QMetaObject::invokeMethod(fixtureItem, "setHeadIntensity",
+                    Q_ARG(QVariant, headIdx),
+                    Q_ARG(QVariant, intensityValue));
+            state.intensity[headIdx] = intensityValue;
         }
 
-        if (headDimmerChannel != masterDimmerChannel)
-            intensityValue *= masterDimmerValue;
-
-        //qDebug() << "Head" << headIdx << "dimmer channel:" << headDimmerIndex << "intensity" << intensityValue;
+        color = decoder->headColor(fixture, headIdx);
 
-        QMetaObject::invokeMethod(fixtureItem, "setHeadIntensity",
-                Q_ARG(QVariant, headIdx),
-                Q_ARG(QVariant, intensityValue));
-
-        color = FixtureUtils::headColor(fixture, hasDimmer, headIdx);
-
-        QMetaObject::invokeMethod(fixtureItem, "setHeadRGBColor",
-                                  Q_ARG(QVariant, headIdx),
-                                  Q_ARG(QVariant, color));
+        if (color.rgba() != state.color.at(headIdx))
+        {
+            QMetaObject::invokeMethod(fixtureItem, "setHeadRGBColor",
+                                      Q_ARG(QVariant, headIdx),
+                                      Q_ARG(QVariant, color));
+            state.color[headIdx] = color.rgba();
+        }
         colorSet = true;
     } // for heads
 
-    // now scan all the channels for "common" capabilities
-    for (int i = 0; i < int(fixture->channels()); i++)
+    // now scan the channels with "common" capabilities
+    for (const FixtureVisualDecoder::CapabilityChannel &capCh : decoder->capabilityChannels())
     {
-        const QLCChannel *ch = fixture->channel(quint32(i));
-        if (ch == nullptr)
-            continue;
-
+        const QLCChannel *ch = capCh.channel;
+        int i = int(capCh.index);
         uchar value = fixture->channelValueAt(i);
 
-        switch (ch->group())
+        switch (capCh.group)
         {
             case QLCChannel::Pan:
             {
-                if (ch->controlByte() == QLCChannel::MSB)
+                if (capCh.msb)
                     panValue += (value << 8);
                 else
                     panValue += (value);
 
-                if (previous.isEmpty() || value != uchar(previous.at(i)))
-                    setPosition = true;
+                setPosition = true;
             }
             break;
             case QLCChannel::Tilt:
             {
-                if (ch->controlByte() == QLCChannel::MSB)
+                if (capCh.msb)
                     tiltValue += (value << 8);
                 else
                     tiltValue += (value);
 
-                if (previous.isEmpty() || value != uchar(previous.at(i)))
-                    setPosition = true;
+                setPosition = true;
             }
             break;
             case QLCChannel::Speed:
@@ -1291,6 +1302,8 @@ void MainView3D::updateFixtureItem(Fixture *fixture, quint16 headIndex, quint16
                     QMetaObject::invokeMethod(fixtureItem, "setHeadRGBColor",
                                               Q_ARG(QVariant, 0),
                                               Q_ARG(QVariant, color));
+                    if (state.color.isEmpty() == false)
+                        state.color[0] = color.rgba();
                 }
             }
             break;
@@ -1374,11 +1387,13 @@ void MainView3D::updateFixtureItem(Fixture *fixture, quint16 headIndex, quint16
         }
     }
 
-    if (setPosition)
+    if (setPosition && (panValue != state.pan || tiltValue != state.tilt))
     {
         QMetaObject::invokeMethod(fixtureItem, "setPosition",
                 Q_ARG(QVariant, panValue),
                 Q_ARG(QVariant, tiltValue));
+        state.pan = panValue;
+        state.tilt = tiltValue;
     }
 }
 
@@ -1543,6 +1558,7 @@ void MainView3D::removeFixtureItem(quint32 itemID)
     mesh->m_rootItem->setProperty("enabled", false); // workaround for the above
 
     delete mesh;
+    m_itemStates.remove(itemID);
 }
 
 /*********************************************************************
@@ -35,6 +35,7 @@
 #include <Qt3DRender/QRenderTarget>
 #include <Qt3DRender/QPaintedTextureImage>
 
+#include "fixturevisualdecoder.h"
 #include "previewcontext.h"
 
 class Doc;
@@ -154,6 +155,10 @@ public slots:
     /** @reimp */
     void slotRefreshView() override;
 
+protected slots:
+    /** Drop the visual decoders of a fixture that changed or was removed */
+    void slotFixtureChanged(quint32 fxID);
+
 signals:
     void cameraPositionChanged();
     void cameraUpVectorChanged();
@@ -294,6 +299,12 @@ private:
     /** Map of QLC+ item IDs and SceneItem references */
     QMap<quint32, SceneItem*> m_entitiesMap;
 
+    /** Visual decoders of the fixtures in the preview */
+    FixtureVisualDecoder::Cache m_decoders;
+
+    /** Last visual state pushed to each fixture entity, by item ID */
+    QHash<quint32, FixtureVisualState> m_itemStates;
+
     /** Cache of the loaded models against bounding volumes */
     QMap<QUrl, BoundingVolume> m_boundingVolumesMap;
 
@@ -215,6 +215,8 @@ Rectangle
                             paramSection.sectionContents = textAlgoComponent
                         else if (displayText === "Image")
                             paramSection.sectionContents = imageAlgoComponent
+                        else if (displayText === "Video")
+                            paramSection.sectionContents = videoAlgoComponent
                         else
                             paramSection.sectionContents = scriptAlgoComponent
                     }
@@ -1027,6 +1029,75 @@ Rectangle
         }
     }
 
+    /* *************************************************************
+     * **************** Video Algorithm parameters *************** */
+    Component
+    {
+        id: videoAlgoComponent
+
+        GridLayout
+        {
+            columns: 2
+            columnSpacing: 5
+
+            RobotoText
+            {
+                height: UISettings.listItemHeight
+                label: qsTr("Video")
+            }
+            Rectangle
+            {
+                Layout.fillWidth: true
+                height: editorColumn.itemsHeight
+                color: "transparent"
+
+                Rectangle
+                {
+                    height: parent.height
+                    width: parent.width - videoButton.width - 5
+                    radius: 3
+                    color: UISettings.bgMedium
+                    border.color: UISettings.bgStrong
+                    clip: true
+
+                    TextInput
+                    {
+                        anchors.fill: parent
+                        anchors.margins: 4
+                        anchors.verticalCenter: parent.verticalCenter
+                        text: rgbMatrixEditor.algoImagePath
+                        font.pixelSize: UISettings.textSizeDefault
+                        color: "white"
+
+                        onTextEdited: rgbMatrixEditor.algoImagePath = text
+                    }
+                }
+                IconButton
+                {
+                    id: videoButton
+                    width: UISettings.iconSizeMedium
+                    height: width
+                    anchors.right: parent.right
+                    faSource: FontAwesome.fa_film
+                    faColor: "lightyellow"
+                    tooltip: qsTr("Select a video file")
+
+                    onClicked: videoDialog.visible = true
+
+                    FileDialog
+                    {
+                        id: videoDialog
+                        visible: false
+                        title: qsTr("Select a video")
+                        nameFilters: [ "Video files (*.mp4 *.mov *.avi *.mkv *.webm *.wmv *.m4v)", "All files (*)" ]
+
+                        onAccepted: rgbMatrixEditor.algoImagePath = videoDialog.selectedFile
+                    }
+                }
+            }
+        }
+    }
+
     /* ************************************************************ */
     /* ***************  Script Algorithm parameters *************** */
     Component
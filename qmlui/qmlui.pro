@@ -46,6 +46,7 @@ HEADERS += \
     fixturegroupeditor.h \
     fixturemanager.h \
     fixtureutils.h \
+    fixturevisualdecoder.h \
     folderbrowser.h \
     functioneditor.h \
     functionmanager.h \
@@ -82,6 +83,7 @@ SOURCES += main.cpp \
     fixturegroupeditor.cpp \
     fixturemanager.cpp \
     fixtureutils.cpp \
+    fixturevisualdecoder.cpp \
     folderbrowser.cpp \
     functioneditor.cpp \
     functionmanager.cpp \
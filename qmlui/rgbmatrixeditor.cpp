@@ -27,6 +27,7 @@
 #include "rgbimage.h"
 #include "sequence.h"
 #include "rgbtext.h"
+#include "rgbvideo.h"
 #include "tardis.h"
 #include "scene.h"
 #include "doc.h"
@@ -321,6 +322,12 @@ QString RGBMatrixEditor::algoImagePath() const
         RGBImage *algo = static_cast<RGBImage*> (m_matrix->algorithm());
         return algo->filename();
     }
+    else if (m_matrix != nullptr && m_matrix->algorithm() != nullptr &&
+             m_matrix->algorithm()->type() == RGBAlgorithm::Video)
+    {
+        RGBVideo *algo = static_cast<RGBVideo*> (m_matrix->algorithm());
+        return algo->filename();
+    }
 
     return QString();
 }
@@ -332,6 +339,22 @@ void RGBMatrixEditor::setAlgoImagePath(QString path)
     {
         RGBImage *algo = static_cast<RGBImage*> (m_matrix->algorithm());
 
+        if (path.startsWith("file:"))
+            path = QUrl(path).toLocalFile();
+
+        if (algo->filename() == path)
+            return;
+
+        Tardis::instance()->enqueueAction(Tardis::RGBMatrixSetImage, m_matrix->id(), algo->filename(), path);
+        QMutexLocker algorithmLocker(&m_matrix->algorithmMutex());
+        algo->setFilename(path);
+        emit algoImagePathChanged(path);
+    }
+    else if (m_matrix != nullptr && m_matrix->algorithm() != nullptr &&
+             m_matrix->algorithm()->type() == RGBAlgorithm::Video)
+    {
+        RGBVideo *algo = static_cast<RGBVideo*> (m_matrix->algorithm());
+
         if (path.startsWith("file:"))
             path = QUrl(path).toLocalFile();
 
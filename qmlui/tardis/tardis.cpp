@@ -40,6 +40,7 @@
 #include "vcbutton.h"
 #include "vcslider.h"
 #include "universe.h"
+#include "rgbvideo.h"
 #include "vcframe.h"
 #include "rgbtext.h"
 #include "chaser.h"
@@ -1073,8 +1074,16 @@ int Tardis::processAction(TardisAction &action, bool undo)
         case RGBMatrixSetImage:
         {
             RGBMatrix *matrix = qobject_cast<RGBMatrix *>(m_doc->function(action.m_objID));
-            RGBImage* algo = static_cast<RGBImage*> (matrix->algorithm());
-            algo->setFilename(value->toString());
+            if (matrix->algorithm()->type() == RGBAlgorithm::Image)
+            {
+                RGBImage* algo = static_cast<RGBImage*> (matrix->algorithm());
+                algo->setFilename(value->toString());
+            }
+            else if (matrix->algorithm()->type() == RGBAlgorithm::Video)
+            {
+                RGBVideo* algo = static_cast<RGBVideo*> (matrix->algorithm());
+                algo->setFilename(value->toString());
+            }
         }
         break;
         case RGBMatrixSetOffset:
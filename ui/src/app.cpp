@@ -564,13 +564,8 @@ void App::slotDocAutosave()
 
 void App::slotUniverseWritten(quint32 idx, const QByteArray &ua)
 {
-    foreach (Fixture *fixture, m_doc->fixtures())
-    {
-        if (fixture->universe() != idx)
-            continue;
-
+    foreach (Fixture *fixture, m_doc->fixturesInUniverse(idx))
         fixture->setChannelValues(ua);
-    }
 }
 
 /*****************************************************************************
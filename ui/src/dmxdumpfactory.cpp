@@ -213,14 +213,14 @@ void DmxDumpFactory::slotDumpNonZeroChanged(bool active)
 void DmxDumpFactory::accept()
 {
     QByteArray dumpMask = m_properties->channelsMask();
-    QList<Universe*> ua = m_doc->inputOutputMap()->claimUniverses();
+    QList<Universe*> ua = m_doc->inputOutputMap()->universes();
 
     QByteArray preGMValues(ua.size() * UNIVERSE_SIZE, 0); //= ua->preGMValues();
 
     for (int i = 0; i < ua.count(); ++i)
     {
         const int offset = i * UNIVERSE_SIZE;
-        preGMValues.replace(offset, UNIVERSE_SIZE, ua.at(i)->preGMValues());
+        preGMValues.replace(offset, UNIVERSE_SIZE, ua.at(i)->snapshotPreGMValues());
         if (ua.at(i)->passthrough())
         {
             for (int j = 0; j < UNIVERSE_SIZE; ++j)
@@ -232,8 +232,6 @@ void DmxDumpFactory::accept()
         }
     }
 
-    m_doc->inputOutputMap()->releaseUniverses(false);
-
     Scene *newScene = NULL;
     if (m_selectedSceneID != Function::invalidId())
         newScene = qobject_cast<Scene*>(m_doc->function(m_selectedSceneID));
@@ -62,6 +62,7 @@ InputOutputManager::InputOutputManager(QWidget* parent, Doc* doc)
     , m_deleteUniverseAction(NULL)
     , m_uniNameEdit(NULL)
     , m_uniPassthroughCheck(NULL)
+    , m_uniHighPrecisionCheck(NULL)
     , m_editor(NULL)
     , m_editorUniverse(UINT_MAX)
 {
@@ -121,6 +122,12 @@ InputOutputManager::InputOutputManager(QWidget* parent, Doc* doc)
     m_uniPassthroughCheck->setFont(font);
     m_toolbar->addWidget(m_uniPassthroughCheck);
 
+    m_uniHighPrecisionCheck = new QCheckBox(tr("High precision"), this);
+    m_uniHighPrecisionCheck->setLayoutDirection(Qt::RightToLeft);
+    m_uniHighPrecisionCheck->setFont(font);
+    m_uniHighPrecisionCheck->setToolTip(tr("Mix fades with extra precision and output it on the fine channels"));
+    m_toolbar->addWidget(m_uniHighPrecisionCheck);
+
     m_splitter->widget(0)->layout()->addWidget(m_toolbar);
 
     connect(m_uniNameEdit, SIGNAL(textChanged(QString)),
@@ -129,6 +136,9 @@ InputOutputManager::InputOutputManager(QWidget* parent, Doc* doc)
     connect(m_uniPassthroughCheck, SIGNAL(toggled(bool)),
             this, SLOT(slotPassthroughChanged(bool)));
 
+    connect(m_uniHighPrecisionCheck, SIGNAL(toggled(bool)),
+            this, SLOT(slotHighPrecisionChanged(bool)));
+
     /* Universes list */
     m_list = new QListWidget(this);
     m_list->setItemDelegate(new UniverseItemWidget(m_list));
@@ -211,6 +221,7 @@ void InputOutputManager::updateList()
         m_uniNameEdit->setEnabled(true);
         m_uniNameEdit->setText(m_ioMap->getUniverseNameByIndex(0));
         m_uniPassthroughCheck->setChecked(m_ioMap->getUniversePassthrough(0));
+        m_uniHighPrecisionCheck->setChecked(m_ioMap->getUniverseHighPrecision(0));
     }
 }
 
@@ -322,6 +333,7 @@ void InputOutputManager::slotCurrentItemChanged()
     int uniIdx = m_list->currentRow();
     m_uniNameEdit->setText(m_ioMap->getUniverseNameByIndex(uniIdx));
     m_uniPassthroughCheck->setChecked(m_ioMap->getUniversePassthrough(uniIdx));
+    m_uniHighPrecisionCheck->setChecked(m_ioMap->getUniverseHighPrecision(uniIdx));
 }
 
 void InputOutputManager::slotMappingChanged()
@@ -422,6 +434,20 @@ void InputOutputManager::slotPassthroughChanged(bool checked)
     m_doc->inputOutputMap()->saveDefaults();
 }
 
+void InputOutputManager::slotHighPrecisionChanged(bool checked)
+{
+    QListWidgetItem *currItem = m_list->currentItem();
+    if (currItem == NULL)
+        return;
+
+    int uniIdx = m_list->currentRow();
+    if (m_ioMap->getUniverseHighPrecision(uniIdx) == checked)
+        return;
+
+    m_ioMap->setUniverseHighPrecision(uniIdx, checked);
+    m_doc->setModified();
+}
+
 void InputOutputManager::showEvent(QShowEvent *ev)
 {
     Q_UNUSED(ev);
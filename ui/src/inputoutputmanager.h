@@ -94,6 +94,7 @@ private slots:
     void slotUniverseNameChanged(QString name);
     void slotUniverseAdded(quint32 universe);
     void slotPassthroughChanged(bool checked);
+    void slotHighPrecisionChanged(bool checked);
 
 protected:
     /** @reimp */
@@ -107,6 +108,7 @@ private:
     QAction* m_deleteUniverseAction;
     QLineEdit *m_uniNameEdit;
     QCheckBox *m_uniPassthroughCheck;
+    QCheckBox *m_uniHighPrecisionCheck;
     QListWidget *m_list;
     QIcon m_icon;
     QTimer* m_timer;
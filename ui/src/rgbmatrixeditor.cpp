@@ -44,6 +44,7 @@
 #include "sequence.h"
 #include "rgbitem.h"
 #include "rgbtext.h"
+#include "rgbvideo.h"
 #include "scene.h"
 
 #define SETTINGS_GEOMETRY "rgbmatrixeditor/geometry"
@@ -364,6 +365,7 @@ void RGBMatrixEditor::updateExtraOptions()
     {
         m_textGroup->hide();
         m_imageGroup->show();
+        m_imageAnimationCombo->show();
         m_offsetGroup->show();
 
         RGBImage *image = static_cast<RGBImage*> (m_matrix->algorithm());
@@ -378,6 +380,17 @@ void RGBMatrixEditor::updateExtraOptions()
         m_yOffsetSpin->setValue(image->yOffset());
 
     }
+    else if (m_matrix->algorithm()->type() == RGBAlgorithm::Video)
+    {
+        m_textGroup->hide();
+        m_imageGroup->show();
+        m_imageAnimationCombo->hide();
+        m_offsetGroup->hide();
+
+        RGBVideo *video = static_cast<RGBVideo*> (m_matrix->algorithm());
+        Q_ASSERT(video != NULL);
+        m_imageEdit->setText(video->filename());
+    }
     else if (m_matrix->algorithm()->type() == RGBAlgorithm::Text)
     {
         m_textGroup->show();
@@ -1036,6 +1049,16 @@ void RGBMatrixEditor::slotImageEdited()
         }
         slotRestartTest();
     }
+    else if (m_matrix->algorithm() != NULL && m_matrix->algorithm()->type() == RGBAlgorithm::Video)
+    {
+        RGBVideo *algo = static_cast<RGBVideo*> (m_matrix->algorithm());
+        Q_ASSERT(algo != NULL);
+        {
+            QMutexLocker algorithmLocker(&m_matrix->algorithmMutex());
+            algo->setFilename(m_imageEdit->text());
+        }
+        slotRestartTest();
+    }
 }
 
 void RGBMatrixEditor::slotImageButtonClicked()
@@ -1060,6 +1083,26 @@ void RGBMatrixEditor::slotImageButtonClicked()
             slotRestartTest();
         }
     }
+    else if (m_matrix->algorithm() != NULL && m_matrix->algorithm()->type() == RGBAlgorithm::Video)
+    {
+        RGBVideo *algo = static_cast<RGBVideo*> (m_matrix->algorithm());
+        Q_ASSERT(algo != NULL);
+
+        QString path = algo->filename();
+        path = QFileDialog::getOpenFileName(this,
+                                            tr("Select video"),
+                                            path,
+                                            QString("%1 (*.mp4 *.mov *.avi *.mkv *.webm *.wmv *.m4v)").arg(tr("Videos")));
+        if (path.isEmpty() == false)
+        {
+            {
+                QMutexLocker algorithmLocker(&m_matrix->algorithmMutex());
+                algo->setFilename(path);
+            }
+            m_imageEdit->setText(path);
+            slotRestartTest();
+        }
+    }
 }
 
 void RGBMatrixEditor::slotImageAnimationActivated(int index)
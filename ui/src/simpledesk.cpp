@@ -393,14 +393,12 @@ uchar SimpleDesk::getAbsoluteChannelValue(uint address)
     }
     else
     {
-        QList<Universe*> ua = m_doc->inputOutputMap()->claimUniverses();
+        QList<Universe*> ua = m_doc->inputOutputMap()->universes();
         int uni = address >> 9;
         uint channel = address & 0x01FF;
         if (uni >= ua.count())
             return 0;
-        uchar value = ua.at(uni)->preGMValue(channel);
-        m_doc->inputOutputMap()->releaseUniverses(false);
-        return value;
+        return ua.at(uni)->snapshotPreGMValue(channel);
     }
 }
 
@@ -92,6 +92,7 @@ VCSlider::VCSlider(QWidget *parent, Doc *doc)
     , m_levelValue(0)
     , m_monitorEnabled(false)
     , m_monitorValue(0)
+    , m_levelBindingsValid(false)
     , m_playbackFunction(Function::invalidId())
     , m_playbackValue(0)
     , m_playbackChangeCounter(0)
@@ -207,6 +208,12 @@ VCSlider::VCSlider(QWidget *parent, Doc *doc)
        they no longer point to an existing fixture->channel */
     connect(m_doc, SIGNAL(fixtureRemoved(quint32)),
             this, SLOT(slotFixtureRemoved(quint32)));
+
+    /* Fixtures being patched again invalidate the level channels bindings */
+    connect(m_doc, SIGNAL(fixtureAdded(quint32)),
+            this, SLOT(slotFixturesChanged()));
+    connect(m_doc, SIGNAL(fixtureChanged(quint32)),
+            this, SLOT(slotFixturesChanged()));
 }
 
 VCSlider::~VCSlider()
@@ -559,18 +566,21 @@ void VCSlider::addLevelChannel(quint32 fixture, quint32 channel)
     {
         m_levelChannels.append(lch);
         std::sort(m_levelChannels.begin(), m_levelChannels.end());
+        invalidateLevelBindings();
     }
 }
 
 void VCSlider::removeLevelChannel(quint32 fixture, quint32 channel)
 {
     LevelChannel lch(fixture, channel);
-    m_levelChannels.removeAll(lch);
+    if (m_levelChannels.removeAll(lch))
+        invalidateLevelBindings();
 }
 
 void VCSlider::clearLevelChannels()
 {
     m_levelChannels.clear();
+    invalidateLevelBindings();
 }
 
 QList <VCSlider::LevelChannel> VCSlider::levelChannels()
@@ -665,6 +675,8 @@ void VCSlider::slotFixtureRemoved(quint32 fxi_id)
         if (it.value().fixture == fxi_id)
             it.remove();
     }
+
+    invalidateLevelBindings();
 }
 
 void VCSlider::slotMonitorDMXValueChanged(int value)
@@ -1150,6 +1162,50 @@ void VCSlider::writeDMX(MasterTimer *timer, QList<Universe *> universes)
         writeDMXPlayback(timer, universes);
 }
 
+void VCSlider::resolveLevelBindings()
+{
+    if (m_levelBindingsValid)
+        return;
+
+    m_levelBindings.clear();
+    m_levelBindings.reserve(m_levelChannels.count());
+
+    foreach (const LevelChannel &lch, m_levelChannels)
+    {
+        Fixture *fxi = m_doc->fixture(lch.fixture);
+        if (fxi == NULL)
+            continue;
+
+        const QLCChannel *qlcch = fxi->channel(lch.channel);
+        if (qlcch == NULL)
+            continue;
+
+        LevelChannelBinding binding;
+        binding.universe = fxi->universe();
+        binding.channel = FadeChannel(m_doc, lch.fixture, lch.channel);
+        if (binding.channel.universe() == Universe::invalid())
+            continue;
+
+        binding.colour = qlcch->colour();
+        // request to autoremove LTP channels when set
+        binding.autoRemove = (qlcch->group() != QLCChannel::Intensity);
+        m_levelBindings.append(binding);
+    }
+
+    m_levelBindingsValid = true;
+}
+
+void VCSlider::invalidateLevelBindings()
+{
+    QMutexLocker locker(&m_levelValueMutex);
+    m_levelBindingsValid = false;
+}
+
+void VCSlider::slotFixturesChanged()
+{
+    invalidateLevelBindings();
+}
+
 void VCSlider::writeDMXLevel(MasterTimer *timer, QList<Universe *> universes)
 {
     Q_UNUSED(timer);
@@ -1191,16 +1247,14 @@ void VCSlider::writeDMXLevel(MasterTimer *timer, QList<Universe *> universes)
 
     if (m_levelValueChanged)
     {
-        QListIterator <LevelChannel> it(m_levelChannels);
-        while (it.hasNext() == true)
+        resolveLevelBindings();
+
+        foreach (const LevelChannelBinding &binding, m_levelBindings)
         {
-            LevelChannel lch(it.next());
-            Fixture *fxi = m_doc->fixture(lch.fixture);
-            if (fxi == NULL)
+            quint32 universe = binding.universe;
+            if (universe >= quint32(universes.count()))
                 continue;
 
-            quint32 universe = fxi->universe();
-
             QSharedPointer<GenericFader> fader = m_fadersMap.value(universe, QSharedPointer<GenericFader>());
             if (fader.isNull())
             {
@@ -1216,44 +1270,38 @@ void VCSlider::writeDMXLevel(MasterTimer *timer, QList<Universe *> universes)
                 }
             }
 
-            FadeChannel *fc = fader->getChannelFader(m_doc, universes[universe], lch.fixture, lch.channel);
+            FadeChannel *fc = fader->getChannelFader(universes[universe], binding.channel);
             if (fc->universe() == Universe::invalid())
             {
                 fader->remove(fc);
                 continue;
             }
 
-            int chType = fc->flags();
-            const QLCChannel *qlcch = fxi->channel(lch.channel);
-            if (qlcch == NULL)
-                continue;
-
             // set override flag if needed
             if (m_isOverriding)
                 fc->addFlag(FadeChannel::Override);
 
-            // request to autoremove LTP channels when set
-            if (qlcch->group() != QLCChannel::Intensity)
+            if (binding.autoRemove)
                 fc->addFlag(FadeChannel::AutoRemove);
 
-            if (chType & FadeChannel::Intensity)
+            if (fc->flags() & FadeChannel::Intensity)
             {
                 if (m_cngType == ClickAndGoWidget::RGB)
                 {
-                    if (qlcch->colour() == QLCChannel::Red)
+                    if (binding.colour == QLCChannel::Red)
                         modLevel = uchar(r);
-                    else if (qlcch->colour() == QLCChannel::Green)
+                    else if (binding.colour == QLCChannel::Green)
                         modLevel = uchar(g);
-                    else if (qlcch->colour() == QLCChannel::Blue)
+                    else if (binding.colour == QLCChannel::Blue)
                         modLevel = uchar(b);
                 }
                 else if (m_cngType == ClickAndGoWidget::CMY)
                 {
-                    if (qlcch->colour() == QLCChannel::Cyan)
+                    if (binding.colour == QLCChannel::Cyan)
                         modLevel = uchar(c);
-                    else if (qlcch->colour() == QLCChannel::Magenta)
+                    else if (binding.colour == QLCChannel::Magenta)
                         modLevel = uchar(m);
-                    else if (qlcch->colour() == QLCChannel::Yellow)
+                    else if (binding.colour == QLCChannel::Yellow)
                         modLevel = uchar(y);
                 }
             }
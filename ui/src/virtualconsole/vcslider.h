@@ -22,11 +22,13 @@
 #define VCSLIDER_H
 
 #include <QToolButton>
+#include <QVector>
 #include <QMutex>
 #include <QList>
 
 #include "clickandgoslider.h"
 #include "clickandgowidget.h"
+#include "fadechannel.h"
 #include "knobwidget.h"
 #include "dmxsource.h"
 #include "vcwidget.h"
@@ -357,6 +359,37 @@ protected:
     bool m_monitorEnabled;
     uchar m_monitorValue;
 
+    /*********************************************************************
+     * Level channel bindings
+     *********************************************************************/
+protected:
+    /** A level channel resolved against the current fixtures setup.
+     *  The FadeChannel is a template that already carries the channel
+     *  address and its detected flags */
+    typedef struct
+    {
+        quint32 universe;
+        FadeChannel channel;
+        QLCChannel::PrimaryColour colour;
+        bool autoRemove;
+    } LevelChannelBinding;
+
+    /** Resolve m_levelChannels into m_levelBindings, if they're outdated.
+     *  Must be called with m_levelValueMutex locked */
+    void resolveLevelBindings();
+
+    /** Mark m_levelBindings as outdated, so that they will be
+     *  resolved again on the next level write */
+    void invalidateLevelBindings();
+
+protected slots:
+    /** Slot that captures Doc::fixtureAdded/fixtureChanged signals */
+    void slotFixturesChanged();
+
+protected:
+    QVector<LevelChannelBinding> m_levelBindings;
+    bool m_levelBindingsValid;
+
     /*********************************************************************
      * Playback
      *********************************************************************/
@@ -97,6 +97,9 @@ VCWidget::VCWidget(QWidget* parent, Doc* doc)
 
 VCWidget::~VCWidget()
 {
+    VirtualConsole *vc = VirtualConsole::instance();
+    if (vc != NULL)
+        vc->removeWidgetInputRoutes(this);
 }
 
 /*****************************************************************************
@@ -597,8 +600,6 @@ void VCWidget::setInputSource(QSharedPointer<QLCInputSource> const& source, quin
     // Connect when the first valid input source is set
     if (m_inputs.isEmpty() == true && !source.isNull() && source->isValid() == true)
     {
-        connect(m_doc->inputOutputMap(), SIGNAL(inputValueChanged(quint32,quint32,uchar)),
-                this, SLOT(slotInputValueChanged(quint32,quint32,uchar)));
         connect(m_doc->inputOutputMap(), SIGNAL(profileChanged(quint32,QString)),
                 this, SLOT(slotInputProfileChanged(quint32,QString)));
     }
@@ -678,11 +679,15 @@ void VCWidget::setInputSource(QSharedPointer<QLCInputSource> const& source, quin
     // Disconnect when there are no more input sources present
     if (m_inputs.isEmpty() == true)
     {
-        disconnect(m_doc->inputOutputMap(), SIGNAL(inputValueChanged(quint32,quint32,uchar)),
-                   this, SLOT(slotInputValueChanged(quint32,quint32,uchar)));
         disconnect(m_doc->inputOutputMap(), SIGNAL(profileChanged(quint32,QString)),
                    this, SLOT(slotInputProfileChanged(quint32,QString)));
     }
+
+    // External input is delivered by the Virtual Console
+    // only to the widgets listening to it
+    VirtualConsole *vc = VirtualConsole::instance();
+    if (vc != NULL)
+        vc->updateWidgetInputRoutes(this);
 }
 
 QSharedPointer<QLCInputSource> VCWidget::inputSource(quint8 id) const
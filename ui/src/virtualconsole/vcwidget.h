@@ -82,6 +82,9 @@ class VCWidget : public QWidget
     Q_OBJECT
     Q_DISABLE_COPY(VCWidget)
 
+    /** VirtualConsole dispatches external input to the widgets */
+    friend class VirtualConsole;
+
     /*********************************************************************
      * Initialization
      *********************************************************************/
@@ -157,6 +157,10 @@ VirtualConsole::VirtualConsole(QWidget* parent, Doc* doc)
     connect(m_doc, SIGNAL(modeChanged(Doc::Mode)),
             this, SLOT(slotModeChanged(Doc::Mode)));
 
+    // Dispatch external input to the widgets
+    connect(m_doc->inputOutputMap(), SIGNAL(inputValueChanged(quint32,quint32,uchar)),
+            this, SLOT(slotInputValueChanged(quint32,quint32,uchar)));
+
     // Use the initial mode
     slotModeChanged(m_doc->mode());
 
@@ -1613,6 +1617,78 @@ void VirtualConsole::initContents()
     resetContents();
 }
 
+/*****************************************************************************
+ * External input
+ *****************************************************************************/
+
+void VirtualConsole::updateWidgetInputRoutes(VCWidget *widget)
+{
+    removeWidgetInputRoutes(widget);
+
+    QList<quint64> keys;
+    foreach (QSharedPointer<QLCInputSource> const& src, widget->m_inputs)
+    {
+        if (src.isNull() || src->isValid() == false)
+            continue;
+
+        quint64 key = inputRouteKey(src->universe(), src->channel() & 0xFFFF);
+        if (keys.contains(key))
+            continue;
+
+        keys.append(key);
+        m_inputRoutes[key].append(widget);
+    }
+
+    if (keys.isEmpty() == false)
+        m_widgetInputRoutes[widget] = keys;
+}
+
+void VirtualConsole::removeWidgetInputRoutes(VCWidget *widget)
+{
+    QHash <VCWidget *, QList<quint64> >::iterator it = m_widgetInputRoutes.find(widget);
+    if (it == m_widgetInputRoutes.end())
+        return;
+
+    foreach (quint64 key, it.value())
+    {
+        QHash <quint64, QList<VCWidget *> >::iterator route = m_inputRoutes.find(key);
+        if (route == m_inputRoutes.end())
+            continue;
+
+        route.value().removeAll(widget);
+        if (route.value().isEmpty())
+            m_inputRoutes.erase(route);
+    }
+
+    m_widgetInputRoutes.erase(it);
+}
+
+quint64 VirtualConsole::inputRouteKey(quint32 universe, quint32 channel)
+{
+    return (quint64(universe) << 32) | channel;
+}
+
+void VirtualConsole::slotInputValueChanged(quint32 universe, quint32 channel, uchar value)
+{
+    QHash <quint64, QList<VCWidget *> >::const_iterator route =
+            m_inputRoutes.constFind(inputRouteKey(universe, channel));
+    if (route == m_inputRoutes.constEnd())
+        return;
+
+    // work on a copy, since a widget might change the routes
+    // while handling the value (e.g. a frame switching page)
+    const QList<VCWidget *> widgets = route.value();
+    foreach (VCWidget *widget, widgets)
+    {
+        // skip widgets removed in the meantime and
+        // widgets disabled or on an inactive frame page
+        if (m_widgetInputRoutes.contains(widget) == false || widget->isEnabled() == false)
+            continue;
+
+        widget->slotInputValueChanged(universe, channel, value);
+    }
+}
+
 /*****************************************************************************
  * Key press handler
  *****************************************************************************/
@@ -342,6 +342,34 @@ protected:
     VCFrame* m_contents;
     QHash <quint32, VCWidget *> m_widgetsMap;
 
+    /*********************************************************************
+     * External input
+     *********************************************************************/
+public:
+    /** Update the input routes of $widget with its current input sources.
+     *  Called by VCWidget every time its input sources change */
+    void updateWidgetInputRoutes(VCWidget *widget);
+
+    /** Remove all the input routes of $widget */
+    void removeWidgetInputRoutes(VCWidget *widget);
+
+protected:
+    /** Build the route key of an input universe/channel pair */
+    static quint64 inputRouteKey(quint32 universe, quint32 channel);
+
+protected slots:
+    /** Deliver an input value to the widgets subscribed to it only */
+    void slotInputValueChanged(quint32 universe, quint32 channel, uchar value);
+
+protected:
+    /** Map of (universe, channel) to the widgets that have an input source
+     *  on it. Channels are stored without page, since widgets on inactive
+     *  frame pages are disabled and skipped on delivery */
+    QHash <quint64, QList<VCWidget *> > m_inputRoutes;
+
+    /** Map of a widget to its route keys, to quickly update them */
+    QHash <VCWidget *, QList<quint64> > m_widgetInputRoutes;
+
     /*********************************************************************
      * Key press handler
      *********************************************************************/
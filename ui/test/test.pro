@@ -21,6 +21,7 @@ SUBDIRS += vcframe
 SUBDIRS += vcframeproperties
 SUBDIRS += vclabel
 SUBDIRS += vcproperties
+SUBDIRS += vcslider
 SUBDIRS += vcwidget
 SUBDIRS += vcwidgetproperties
 SUBDIRS += vcxypad
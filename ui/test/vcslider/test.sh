@@ -0,0 +1,4 @@
+#!/bin/sh
+export LD_LIBRARY_PATH=../../src:../../../engine/src
+export DYLD_FALLBACK_LIBRARY_PATH=../../src:../../../engine/src
+./vcslider_test
@@ -0,0 +1,25 @@
+include(../../../variables.pri)
+
+TEMPLATE = app
+LANGUAGE = C++
+TARGET   = vcslider_test
+
+QT      += testlib gui widgets
+qmlui|greaterThan(QT_MAJOR_VERSION, 5) {
+  QT += qml
+} else {
+  QT += script
+}
+
+INCLUDEPATH += ../../../plugins/interfaces
+INCLUDEPATH += ../../../engine/src
+INCLUDEPATH += ../../src ../../src/virtualconsole
+DEPENDPATH  += ../../src
+
+QMAKE_LIBDIR += ../../../engine/src
+QMAKE_LIBDIR += ../../src
+LIBS        += -lqlcplusengine -lqlcplusui
+
+# Test sources
+SOURCES += vcslider_test.cpp
+HEADERS += vcslider_test.h
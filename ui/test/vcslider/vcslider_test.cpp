@@ -0,0 +1,165 @@
+/*
+  Q Light Controller Plus - Unit test
+  vcslider_test.cpp
+
+  Copyright (c) Massimo Callegari
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0.txt
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+*/
+
+#include <QObject>
+#include <QtTest>
+
+#define protected public
+#define private public
+#include "virtualconsole.h"
+#include "vcslider_test.h"
+#include "genericfader.h"
+#include "mastertimer.h"
+#include "vcslider.h"
+#include "universe.h"
+#include "fixture.h"
+#include "doc.h"
+#undef private
+#undef protected
+
+void VCSlider_Test::initTestCase()
+{
+    m_doc = NULL;
+}
+
+void VCSlider_Test::init()
+{
+    m_doc = new Doc(this);
+    new VirtualConsole(NULL, m_doc);
+
+    Fixture* fxi = new Fixture(m_doc);
+    QLCFixtureDef *def = fxi->genericDimmerDef(4);
+    QLCFixtureMode *mode = fxi->genericDimmerMode(def, 4);
+    fxi->setFixtureDefinition(def, mode);
+    m_doc->addFixture(fxi);
+}
+
+void VCSlider_Test::cleanup()
+{
+    delete VirtualConsole::instance();
+    delete m_doc;
+}
+
+void VCSlider_Test::levelBindings()
+{
+    QWidget w;
+
+    VCSlider slider(&w, m_doc);
+    slider.setSliderMode(VCSlider::Level);
+    slider.addLevelChannel(0, 1);
+    slider.addLevelChannel(0, 3);
+    // a missing fixture is not bound
+    slider.addLevelChannel(42, 0);
+    QVERIFY(slider.m_levelBindingsValid == false);
+
+    QList<Universe*> ua = m_doc->inputOutputMap()->universes();
+    slider.setLevelValue(100, true);
+    slider.writeDMX(m_doc->masterTimer(), ua);
+
+    QVERIFY(slider.m_levelBindingsValid == true);
+    QCOMPARE(slider.m_levelBindings.count(), 2);
+    QCOMPARE(slider.m_levelBindings.at(0).universe, quint32(0));
+    QCOMPARE(slider.m_levelBindings.at(0).channel.channel(), quint32(1));
+    QCOMPARE(slider.m_levelBindings.at(1).channel.channel(), quint32(3));
+    QVERIFY(slider.m_levelBindings.at(0).autoRemove == false);
+
+    QSharedPointer<GenericFader> fader = slider.m_fadersMap.value(0);
+    QVERIFY(fader.isNull() == false);
+    QCOMPARE(fader->channelsCount(), 2);
+    QCOMPARE(fader->channels().value(GenericFader::channelHash(0, 1)).target(), quint32(100));
+    QCOMPARE(fader->channels().value(GenericFader::channelHash(0, 3)).target(), quint32(100));
+
+    // the same bindings are used by the next writes
+    slider.setLevelValue(50, true);
+    slider.writeDMX(m_doc->masterTimer(), ua);
+    QVERIFY(slider.m_levelBindingsValid == true);
+    QCOMPARE(fader->channelsCount(), 2);
+    QCOMPARE(fader->channels().value(GenericFader::channelHash(0, 1)).target(), quint32(50));
+
+    // nothing is written if the level didn't change
+    slider.writeDMX(m_doc->masterTimer(), ua);
+    QCOMPARE(fader->channels().value(GenericFader::channelHash(0, 1)).target(), quint32(50));
+}
+
+void VCSlider_Test::levelBindingsInvalidated()
+{
+    QWidget w;
+
+    VCSlider slider(&w, m_doc);
+    slider.setSliderMode(VCSlider::Level);
+    slider.addLevelChannel(0, 0);
+
+    QList<Universe*> ua = m_doc->inputOutputMap()->universes();
+    slider.setLevelValue(100, true);
+    slider.writeDMX(m_doc->masterTimer(), ua);
+    QVERIFY(slider.m_levelBindingsValid == true);
+
+    // a fixture patched again
+    emit m_doc->fixtureChanged(0);
+    QVERIFY(slider.m_levelBindingsValid == false);
+    slider.setLevelValue(90, true);
+    slider.writeDMX(m_doc->masterTimer(), ua);
+    QVERIFY(slider.m_levelBindingsValid == true);
+
+    // the level channels changed
+    slider.addLevelChannel(0, 2);
+    QVERIFY(slider.m_levelBindingsValid == false);
+    slider.setLevelValue(80, true);
+    slider.writeDMX(m_doc->masterTimer(), ua);
+    QCOMPARE(slider.m_levelBindings.count(), 2);
+
+    slider.removeLevelChannel(0, 2);
+    QVERIFY(slider.m_levelBindingsValid == false);
+    slider.setLevelValue(70, true);
+    slider.writeDMX(m_doc->masterTimer(), ua);
+    QCOMPARE(slider.m_levelBindings.count(), 1);
+
+    // a fixture removed
+    QVERIFY(m_doc->deleteFixture(0) == true);
+    QVERIFY(slider.m_levelBindingsValid == false);
+    slider.setLevelValue(60, true);
+    slider.writeDMX(m_doc->masterTimer(), ua);
+    QCOMPARE(slider.m_levelBindings.count(), 0);
+}
+
+void VCSlider_Test::levelInvalidUniverse()
+{
+    QWidget w;
+
+    VCSlider slider(&w, m_doc);
+    slider.setSliderMode(VCSlider::Level);
+    slider.addLevelChannel(0, 0);
+    slider.resolveLevelBindings();
+    QCOMPARE(slider.m_levelBindings.count(), 1);
+
+    // a binding whose fixture is gone has no universe,
+    // so its channel is removed from the fader
+    slider.m_levelBindings[0].channel = FadeChannel(m_doc, 42, 0);
+    QCOMPARE(slider.m_levelBindings.at(0).channel.universe(), Universe::invalid());
+
+    QList<Universe*> ua = m_doc->inputOutputMap()->universes();
+    slider.setLevelValue(100, true);
+    slider.writeDMX(m_doc->masterTimer(), ua);
+
+    QSharedPointer<GenericFader> fader = slider.m_fadersMap.value(0);
+    QVERIFY(fader.isNull() == false);
+    QCOMPARE(fader->channelsCount(), 0);
+}
+
+QTEST_MAIN(VCSlider_Test)
@@ -24,6 +24,7 @@
 #include "stubwidget.h"
 
 StubWidget::StubWidget(QWidget* parent, Doc* doc) : VCWidget(parent, doc)
+    , m_inputValuesCount(0)
 {
 }
 
@@ -47,3 +48,11 @@ bool StubWidget::saveXML(QXmlStreamWriter *doc)
     Q_UNUSED(doc);
     return true;
 }
+
+void StubWidget::slotInputValueChanged(quint32 universe, quint32 channel, uchar value)
+{
+    Q_UNUSED(universe);
+    Q_UNUSED(channel);
+    Q_UNUSED(value);
+    m_inputValuesCount++;
+}
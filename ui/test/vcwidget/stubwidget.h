@@ -37,6 +37,13 @@ public:
     void updateFeedback() override { }
     bool loadXML(QXmlStreamReader &root) override;
     bool saveXML(QXmlStreamWriter *doc) override;
+
+    /** Count the input values delivered to this widget */
+    int m_inputValuesCount;
+
+protected slots:
+    /** @reimp */
+    void slotInputValueChanged(quint32 universe, quint32 channel, uchar value) override;
 };
 
 #endif
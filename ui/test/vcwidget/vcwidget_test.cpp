@@ -333,6 +333,69 @@ void VCWidget_Test::inputSource()
     stub.slotInputValueChanged(0, 1, 2);
 }
 
+void VCWidget_Test::inputRoutes()
+{
+    VirtualConsole *vc = VirtualConsole::instance();
+    QWidget w;
+
+    StubWidget *stub = new StubWidget(&w, m_doc);
+    StubWidget other(&w, m_doc);
+    QCOMPARE(vc->m_inputRoutes.count(), 0);
+    QCOMPARE(vc->m_widgetInputRoutes.count(), 0);
+
+    stub->setInputSource(QSharedPointer<QLCInputSource>(new QLCInputSource(1, 2)));
+    QCOMPARE(vc->m_inputRoutes.count(), 1);
+    QCOMPARE(vc->m_inputRoutes[VirtualConsole::inputRouteKey(1, 2)].count(), 1);
+    QVERIFY(vc->m_inputRoutes[VirtualConsole::inputRouteKey(1, 2)].first() == stub);
+
+    /* Page bits are not part of the route */
+    stub->setInputSource(QSharedPointer<QLCInputSource>(new QLCInputSource(3, (1 << 16) | 4)), 1);
+    QCOMPARE(vc->m_inputRoutes.count(), 2);
+    QVERIFY(vc->m_inputRoutes.contains(VirtualConsole::inputRouteKey(3, 4)) == true);
+    QCOMPARE(vc->m_widgetInputRoutes[stub].count(), 2);
+
+    /* Two widgets on the same channel */
+    other.setInputSource(QSharedPointer<QLCInputSource>(new QLCInputSource(1, 2)));
+    QCOMPARE(vc->m_inputRoutes.count(), 2);
+    QCOMPARE(vc->m_inputRoutes[VirtualConsole::inputRouteKey(1, 2)].count(), 2);
+
+    /* Values are delivered to the subscribed widgets only */
+    vc->slotInputValueChanged(1, 2, 100);
+    QCOMPARE(stub->m_inputValuesCount, 1);
+    QCOMPARE(other.m_inputValuesCount, 1);
+
+    vc->slotInputValueChanged(3, 4, 100);
+    QCOMPARE(stub->m_inputValuesCount, 2);
+    QCOMPARE(other.m_inputValuesCount, 1);
+
+    vc->slotInputValueChanged(5, 6, 100);
+    QCOMPARE(stub->m_inputValuesCount, 2);
+    QCOMPARE(other.m_inputValuesCount, 1);
+
+    /* Disabled widgets are skipped */
+    other.setEnabled(false);
+    vc->slotInputValueChanged(1, 2, 100);
+    QCOMPARE(stub->m_inputValuesCount, 3);
+    QCOMPARE(other.m_inputValuesCount, 1);
+    other.setEnabled(true);
+
+    /* Clearing a source removes its route */
+    stub->setInputSource(QSharedPointer<QLCInputSource>(new QLCInputSource()), 1);
+    QVERIFY(vc->m_inputRoutes.contains(VirtualConsole::inputRouteKey(3, 4)) == false);
+    QCOMPARE(vc->m_widgetInputRoutes[stub].count(), 1);
+
+    /* Deleting a widget removes all its routes */
+    delete stub;
+    QVERIFY(vc->m_widgetInputRoutes.contains(stub) == false);
+    QCOMPARE(vc->m_inputRoutes[VirtualConsole::inputRouteKey(1, 2)].count(), 1);
+    vc->slotInputValueChanged(1, 2, 100);
+    QCOMPARE(other.m_inputValuesCount, 2);
+
+    other.setInputSource(QSharedPointer<QLCInputSource>(new QLCInputSource()));
+    QCOMPARE(vc->m_inputRoutes.count(), 0);
+    QCOMPARE(vc->m_widgetInputRoutes.count(), 0);
+}
+
 void VCWidget_Test::copy()
 {
     QWidget w;
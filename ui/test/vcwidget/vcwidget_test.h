@@ -42,6 +42,7 @@ private slots:
     void caption();
     void frame();
     void inputSource();
+    void inputRoutes();
     void copy();
     void stripKeySequence();
     void keyPress();